@@ -0,0 +1,140 @@
+/** Host Benchmark Suite */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "bench.h"
+#include "mqtt.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "wlan.h"
+
+#define BENCH_STACK_PAINT   32768
+#define BENCH_STACK_MAGIC   0xA5
+
+// Paint the stack below the caller with a known pattern
+__attribute__((noinline)) static void stack_paint() {
+    volatile uint8_t area[BENCH_STACK_PAINT];
+    for (size_t i = 0; i < sizeof(area); i++) {
+        area[i] = BENCH_STACK_MAGIC;
+    }
+}
+
+__attribute__((noinline)) static size_t stack_probe(bench_fn fn, void * ctx) {
+    volatile uint8_t marker = 0;
+    volatile uint8_t * top = &marker;
+
+    stack_paint();
+    fn(ctx);
+
+    // Find the deepest byte that no longer holds the pattern
+    volatile uint8_t * p = top - BENCH_STACK_PAINT;
+    while (p < top && *p == BENCH_STACK_MAGIC) {
+        p++;
+    }
+
+    return (size_t)(top - p);
+}
+
+static void noop(void *) {
+}
+
+size_t bench_stack(bench_fn fn, void * ctx) {
+    size_t base = stack_probe(noop, NULL);
+    size_t used = stack_probe(fn, ctx);
+
+    return used > base ? used - base : 0;
+}
+
+void bench_run(const char * name, bench_fn fn, void * ctx, uint32_t iterations) {
+    // Warm up caches and lazily-initialized state
+    for (uint32_t i = 0; i < iterations / 10 + 1; i++) {
+        fn(ctx);
+    }
+
+    uint64_t sim_start = sim_clock_us;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn(ctx);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    uint64_t sim_us = sim_clock_us - sim_start;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    size_t stack = bench_stack(fn, ctx);
+
+    printf("  %-36s %12.1f ns/op %12.1f sim-us/op %8zu B stack\n",
+        name, ns, (double)sim_us / iterations, stack);
+}
+
+void bench_report(const char * name, const char * fmt, ...) {
+    char value[160];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(value, sizeof(value), fmt, args);
+    va_end(args);
+
+    printf("  %-36s %s\n", name, value);
+}
+
+void bench_header(const char * name) {
+    printf("\n%s\n", name);
+}
+
+void bench_device_init(char * sn, size_t len) {
+    sim_reset();
+
+    if (setup_sensors(sn, len)) {
+        fprintf(stderr, "bench: sensor setup failed\n");
+    }
+    if (setup_wlan()) {
+        fprintf(stderr, "bench: WiFi setup failed\n");
+    }
+    if (setup_mqtt(sn)) {
+        fprintf(stderr, "bench: MQTT setup failed\n");
+    }
+
+    // Step the connection manager until the session opens
+    uint64_t deadline = sim_clock_us + 30000000ULL;
+    while (connect_mqtt(sn) && sim_clock_us < deadline) {
+        check_wlan();
+        sim_advance_us(10000);
+    }
+    if (!connected_mqtt()) {
+        fprintf(stderr, "bench: MQTT connect failed\n");
+    }
+}
+
+int main() {
+    printf("AirQualityESP host benchmarks\n");
+
+    bench_pipeline();
+    bench_aggregate();
+    bench_fixed();
+    bench_payload();
+    bench_cbor();
+    bench_queue();
+    bench_mqtt();
+    bench_wlan();
+    bench_sensors();
+    bench_metrics();
+    bench_discovery();
+    bench_publish();
+    bench_batch();
+    bench_lowpower();
+    bench_journal();
+    bench_aqi();
+    bench_fleet();
+    bench_command();
+    bench_probe();
+    bench_memory();
+    bench_transport();
+    bench_humidity();
+    bench_i2cbus();
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+/** Host Benchmark Suite */
+
+#ifndef BENCH_H__
+#define BENCH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Benchmark Body
+typedef void (*bench_fn)(void *);
+
+/**
+ * Run a Benchmark
+ * @param [in] name benchmark name
+ * @param [in] fn benchmark body
+ * @param [in] ctx context passed to the body
+ * @param [in] iterations number of timed iterations
+ *
+ * Prints host ns/op, simulated device time per op (delays and I2C traffic
+ * charged to the simulated clock) and the peak stack depth of one call.
+ */
+void bench_run(const char *, bench_fn, void *, uint32_t);
+
+/**
+ * Measure Stack Usage
+ * @param [in] fn function to measure
+ * @param [in] ctx context passed to the function
+ * @return peak stack bytes used by one call
+ */
+size_t bench_stack(bench_fn, void *);
+
+/**
+ * Print a Benchmark Result Line
+ * @param [in] name result name
+ * @param [in] fmt printf-style format for the value column
+ */
+void bench_report(const char *, const char *, ...) __attribute__((format(printf, 2, 3)));
+
+/** Print a Suite Header */
+void bench_header(const char *);
+
+/** Bring up the simulated device: sensors, WiFi and MQTT */
+void bench_device_init(char *, size_t);
+
+// Benchmark Suites
+void bench_pipeline();
+void bench_aggregate();
+void bench_fixed();
+void bench_payload();
+void bench_cbor();
+void bench_queue();
+void bench_mqtt();
+void bench_wlan();
+void bench_sensors();
+void bench_metrics();
+void bench_discovery();
+void bench_publish();
+void bench_batch();
+void bench_lowpower();
+void bench_journal();
+void bench_aqi();
+void bench_fleet();
+void bench_command();
+void bench_probe();
+void bench_memory();
+void bench_transport();
+void bench_humidity();
+void bench_i2cbus();
+
+#endif // BENCH_H__
@@ -0,0 +1,89 @@
+/** Host Benchmark Suite - Sample Window Aggregation */
+
+#include "aggregate.h"
+#include "bench.h"
+#include "sensor.h"
+#include "sim/sim_sensors.h"
+
+static char sn[16];
+static SensorData sample;
+static SampleWindow bwindow;
+
+static void b_agg_push(void *) {
+    agg_push(& bwindow, & sample);
+}
+
+static void b_agg_stats(void *) {
+    AggStats stats;
+    agg_stats(& bwindow, AGG_PM25, & stats);
+}
+
+static void b_agg_result(void *) {
+    SensorData stat;
+    agg_result(& bwindow, AGG_MEDIAN, & stat);
+}
+
+void bench_aggregate() {
+    bench_header("Sample Window Aggregation");
+    bench_device_init(sn, sizeof(sn));
+
+    // Fill the window with real readings so evictions are exercised
+    agg_reset(& bwindow);
+    for (int i = 0; i < AGGREGATE_WINDOW; i++) {
+        read_sensors(& sample);
+        agg_push(& bwindow, & sample);
+    }
+
+    bench_run("agg_push (full window)", b_agg_push, NULL, 200000);
+    bench_run("agg_stats (one channel)", b_agg_stats, NULL, 200000);
+    bench_run("agg_result (median)", b_agg_result, NULL, 200000);
+    bench_report("window length", "%d samples", AGGREGATE_WINDOW);
+    bench_report("sizeof(SampleWindow)", "%zu B", sizeof(SampleWindow));
+
+    // Spike rejection: how often the published PM2.5 value is a transient
+    // spike when sending the latest sample versus the window median
+    const int windows = 200;
+    int point_spikes = 0, median_spikes = 0;
+
+    sim_pms5003.spike_pct = 5;
+    for (int w = 0; w < windows; w++) {
+        SensorData stat;
+        for (int i = 0; i < AGGREGATE_WINDOW; i++) {
+            read_sensors(& sample);
+            agg_push(& bwindow, & sample);
+        }
+        agg_result(& bwindow, AGG_MEDIAN, & stat);
+
+        AggStats stats;
+        agg_stats(& bwindow, AGG_PM25, & stats);
+        uint32_t limit = stats.mean + 3 * stats.stddev;
+        if (sample.pm25 > limit) point_spikes++;
+        if (stat.pm25 > limit) median_spikes++;
+    }
+    sim_pms5003.spike_pct = 0;
+
+    bench_report("PM2.5 spikes published (latest)", "%d / %d", point_spikes, windows);
+    bench_report("PM2.5 spikes published (median)", "%d / %d", median_spikes, windows);
+
+    // A failed BME280 read is left out of the window statistics, and a
+    // window of nothing but failed reads publishes the sentinel
+    AggStats before, after;
+    SensorData stat;
+    agg_stats(& bwindow, AGG_T, & before);
+    read_sensors(& sample);
+    sample.temperature = SENSOR_T_INVALID;
+    sample.pressure = SENSOR_P_INVALID;
+    sample.humidity = SENSOR_RH_INVALID;
+    agg_push(& bwindow, & sample);
+    agg_stats(& bwindow, AGG_T, & after);
+    bench_report("one failed BME280 read", "mean %+d, min %+d, stddev %+d (0.01 °C)",
+        after.mean - before.mean, after.min - before.min, (int)after.stddev - (int)before.stddev);
+
+    for (int i = 0; i < AGGREGATE_WINDOW; i++) {
+        agg_push(& bwindow, & sample);
+    }
+    agg_result(& bwindow, AGG_MEAN, & stat);
+    bench_report("window of failed BME280 reads", "%s",
+        stat.temperature == SENSOR_T_INVALID && stat.pressure == SENSOR_P_INVALID
+            && stat.humidity == SENSOR_RH_INVALID ? "sentinel published" : "value published");
+}
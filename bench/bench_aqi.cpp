@@ -0,0 +1,237 @@
+/** Host Benchmark Suite - EPA NowCast and AQI */
+
+#include <Arduino.h>
+#include <math.h>
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+#include "aqi.h"
+#include "bench.h"
+#include "payload.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+#define TRACE_HOURS     48
+
+//! PM Trace at 1 Hz (time in seconds)
+typedef struct {
+    std::vector<uint32_t> t;
+    std::vector<SensorData> samples;
+} Trace;
+
+// Clean air with a six-hour smoke event and a two-hour sensor outage
+static void make_trace(Trace * trace) {
+    SensorData d;
+    memset(&d, 0, sizeof(d));
+
+    for (uint32_t t = 0; t < TRACE_HOURS * 3600; t++) {
+        double h = t / 3600.0;
+        if (h >= 30 && h < 32) continue;
+
+        double pm = 6;
+        if (h >= 14 && h < 20) pm += 170 * sin((h - 14) / 6 * M_PI);
+        pm += (int)(sim_rand() % 7) - 3;
+        if (pm < 0) pm = 0;
+
+        d.pm25 = (uint16_t)pm;
+        d.pm100 = (uint16_t)(pm * 1.4 + sim_rand() % 10);
+        trace->t.push_back(t);
+        trace->samples.push_back(d);
+    }
+}
+
+// Reference NowCast: floating point over the raw samples of the last
+// twelve hours, recomputed from scratch
+typedef struct {
+    uint32_t t;
+    uint16_t pm[NOWCAST_CHANNELS];
+} RefSample;
+
+typedef struct {
+    std::deque<RefSample> samples;
+} RefNowCast;
+
+static void ref_push(RefNowCast * ref, uint32_t t, const SensorData * d) {
+    RefSample s = { t, { d->pm25, d->pm100 } };
+    ref->samples.push_back(s);
+    while (ref->samples.front().t / 3600 + NOWCAST_HOURS < t / 3600) {
+        ref->samples.pop_front();
+    }
+}
+
+// NowCast over the hours before the given one (NAN if not available)
+static double ref_nowcast(const RefNowCast * ref, uint32_t hour, uint8_t channel) {
+    double sum[NOWCAST_HOURS] = { 0 }, c[NOWCAST_HOURS];
+    uint32_t n[NOWCAST_HOURS] = { 0 };
+
+    for (const RefSample & s : ref->samples) {
+        uint32_t age = hour - s.t / 3600;
+        if (age >= 1 && age <= NOWCAST_HOURS) {
+            sum[age - 1] += s.pm[channel];
+            n[age - 1]++;
+        }
+    }
+
+    double lo = INFINITY, hi = 0;
+    for (int i = 0; i < NOWCAST_HOURS; i++) {
+        c[i] = n[i] ? sum[i] / n[i] : NAN;
+        if (n[i]) {
+            lo = fmin(lo, c[i]);
+            hi = fmax(hi, c[i]);
+        }
+    }
+    if ((n[0] > 0) + (n[1] > 0) + (n[2] > 0) < 2) return NAN;
+
+    double w = hi > 0 ? fmax(lo / hi, 0.5) : 1, num = 0, den = 0;
+    for (int i = 0; i < NOWCAST_HOURS; i++) {
+        if (n[i]) {
+            num += pow(w, i) * c[i];
+            den += pow(w, i);
+        }
+    }
+
+    // PM2.5 truncated to 0.1 µg/m³, PM10 to 1 µg/m³
+    return channel == NOWCAST_PM25 ? floor(num / den * 10) / 10 : floor(num / den);
+}
+
+static int ref_aqi(double c, uint8_t channel) {
+    static const double pm25[][4] = {
+        { 0, 9.0, 0, 50 }, { 9.1, 35.4, 51, 100 }, { 35.5, 55.4, 101, 150 },
+        { 55.5, 125.4, 151, 200 }, { 125.5, 225.4, 201, 300 }, { 225.5, 325.4, 301, 500 },
+    };
+    static const double pm100[][4] = {
+        { 0, 54, 0, 50 }, { 55, 154, 51, 100 }, { 155, 254, 101, 150 },
+        { 255, 354, 151, 200 }, { 355, 424, 201, 300 }, { 425, 604, 301, 500 },
+    };
+    const double (*bp)[4] = channel == NOWCAST_PM25 ? pm25 : pm100;
+
+    for (int i = 0; i < 6; i++) {
+        if (c <= bp[i][1] + 1e-9) {
+            return (int)floor((bp[i][3] - bp[i][2]) / (bp[i][1] - bp[i][0]) * (c - bp[i][0]) + bp[i][2] + 0.5);
+        }
+    }
+    return 500;
+}
+
+// Per-sample update costs
+typedef struct {
+    const Trace * trace;
+    size_t i;
+    RefNowCast * ref;
+} UpdateCtx;
+
+static void b_update(void * p) {
+    UpdateCtx * ctx = (UpdateCtx *)p;
+    size_t i = ctx->i++ % ctx->trace->t.size();
+    aqi_update(&ctx->trace->samples[i], ctx->trace->t[i] / 3600);
+}
+
+static void b_reference(void * p) {
+    UpdateCtx * ctx = (UpdateCtx *)p;
+    size_t i = ctx->i++ % ctx->trace->t.size();
+    uint32_t t = ctx->trace->t[i];
+    ref_push(ctx->ref, t, &ctx->trace->samples[i]);
+    double c25 = ref_nowcast(ctx->ref, t / 3600, NOWCAST_PM25);
+    double c100 = ref_nowcast(ctx->ref, t / 3600, NOWCAST_PM100);
+    if (!isnan(c25) && !isnan(c100)) {
+        ref_aqi(c25, NOWCAST_PM25);
+        ref_aqi(c100, NOWCAST_PM100);
+    }
+}
+
+// Messages on the aqi topic
+static uint32_t aqi_messages, aqi_retained;
+static char aqi_last[128];
+
+static void on_publish(int, const char * topic, const uint8_t * payload, size_t len, bool retain) {
+    size_t n = strlen(topic);
+    if (n > 4 && !strcmp(topic + n - 4, "/aqi")) {
+        aqi_messages++;
+        aqi_retained += retain;
+        len = len < sizeof(aqi_last) - 1 ? len : sizeof(aqi_last) - 1;
+        memcpy(aqi_last, payload, len);
+        aqi_last[len] = 0;
+    }
+}
+
+void bench_aqi() {
+    static Trace trace;
+    static RefNowCast ref;
+    uint32_t hours = 0, valid = 0, mismatch = 0, category = 0;
+    double worst25 = 0, worst100 = 0;
+
+    bench_header("EPA NowCast and AQI (48 h trace with a smoke event)");
+
+    sim_reset(5);
+    make_trace(& trace);
+
+    // Compare the engine with the reference at every hour it closes
+    aqi_reset();
+    for (size_t i = 0; i < trace.t.size(); i++) {
+        uint32_t t = trace.t[i];
+        ref_push(& ref, t, & trace.samples[i]);
+        if (!aqi_update(& trace.samples[i], t / 3600)) continue;
+
+        hours++;
+        double c25 = ref_nowcast(& ref, t / 3600, NOWCAST_PM25);
+        double c100 = ref_nowcast(& ref, t / 3600, NOWCAST_PM100);
+        bool ref_valid = !isnan(c25) && !isnan(c100);
+        if (ref_valid != (bool)aqi_status->valid) {
+            mismatch++;
+            continue;
+        }
+        if (!ref_valid) continue;
+
+        valid++;
+        int ref_index = ref_aqi(c25, NOWCAST_PM25);
+        int i100 = ref_aqi(c100, NOWCAST_PM100);
+        if (i100 > ref_index) ref_index = i100;
+
+        worst25 = fmax(worst25, fabs(aqi_status->pm25 / 10.0 - c25));
+        worst100 = fmax(worst100, fabs(aqi_status->pm100 / 10.0 - c100));
+        if (aqi_status->aqi != ref_index) mismatch++;
+        if (aqi_category(ref_index) != aqi_status->category) category++;
+    }
+
+    bench_report("hours closed", "%u (%u with a NowCast, %u reference mismatches)", hours, valid, mismatch);
+    bench_report("NowCast vs reference", "max %.1f µg/m³ PM2.5, %.1f µg/m³ PM10, %u category differences",
+        worst25, worst100, category);
+
+    // Memory: fixed engine state against twelve hours of raw samples
+    bench_report("state", "%zu B (reference: %zu B for 12 h at 1 Hz)",
+        sizeof(NowCastState) + sizeof(AqiStatus), (size_t)NOWCAST_HOURS * 3600 * sizeof(RefSample));
+
+    UpdateCtx ctx = { & trace, 0, & ref };
+    aqi_reset();
+    bench_run("aqi_update, per sample", b_update, & ctx, 200000);
+
+    // The reference with a full twelve hours of history
+    ref.samples.clear();
+    for (ctx.i = 0; ctx.i < NOWCAST_HOURS * 3600; ) {
+        ref_push(& ref, trace.t[ctx.i], & trace.samples[ctx.i]);
+        ctx.i++;
+    }
+    bench_run("reference, recompute per sample", b_reference, & ctx, 50);
+
+    // The firmware over three hours: one retained message per closed hour
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    aqi_messages = aqi_retained = 0;
+    aqi_last[0] = 0;
+    setup();
+    uint64_t end = sim_clock_us + 3 * 3600 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+    sim_broker.on_publish = NULL;
+
+    bench_report("firmware aqi topic, 3 h", "%u messages (%u retained): %s", aqi_messages, aqi_retained, aqi_last);
+}
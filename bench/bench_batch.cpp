@@ -0,0 +1,253 @@
+/** Host Benchmark Suite - Batched Columnar Sample Encoding */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <vector>
+
+#include "batch.h"
+#include "bench.h"
+#include "config.h"
+#include "payload.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+#include "sim/sim_sensors.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+static char sn[16];
+
+// Payload room in one packet after the header and a 40-character topic
+#define BATCH_PAYLOAD   (MQTT_TX_BUFFER - 45)
+
+// Epoch time of the first recorded sample
+#define TRACE_EPOCH_MS  1700000000000ULL
+
+//! Recorded Trace (samples and their millis() times)
+typedef struct {
+    std::vector<SensorData> samples;
+    std::vector<uint32_t> ms;
+} Trace;
+
+// Record one sample per READ_SENSOR_INTERVAL with a few ms of scheduling jitter
+static void record(Trace * trace, uint32_t seconds) {
+    SensorData d;
+    trace->samples.clear();
+    trace->ms.clear();
+    for (uint32_t t = 0; t < seconds; t += READ_SENSOR_INTERVAL) {
+        read_sensors(& d);
+        trace->samples.push_back(d);
+        trace->ms.push_back(t * 1000 + random(20));
+    }
+}
+
+// Fields equal (padding ignored)
+static bool same_sample(const SensorData * a, const SensorData * b) {
+    for (size_t i = 0; i < data_field_count; i++) {
+        size_t size = data_fields[i].type == FIELD_UINT32 ? 4 : 2;
+        if (memcmp((const uint8_t *)a + data_fields[i].offset,
+            (const uint8_t *)b + data_fields[i].offset, size)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! Encoding Results for one Trace
+typedef struct {
+    size_t messages;
+    size_t bytes;
+    size_t samples;
+    size_t errors;              //< Samples that did not round-trip
+} BatchResult;
+
+// Split a trace into batches of n samples, encode each into as many
+// packets as it needs and check every packet decodes back to its samples
+static void encode_trace(const Trace & trace, uint8_t n, BatchResult * r) {
+    static SampleBatch batch;
+    static SensorData decoded[BATCH_MAX];
+    static uint64_t times[BATCH_MAX];
+    uint8_t buf[BATCH_PAYLOAD];
+
+    memset(r, 0, sizeof(*r));
+    batch_reset(& batch);
+    for (size_t i = 0; i < trace.samples.size(); i++) {
+        batch_push(& batch, & trace.samples[i], trace.ms[i]);
+        if (batch.count < n && i + 1 < trace.samples.size()) {
+            continue;
+        }
+
+        while (batch.count) {
+            uint8_t encoded;
+            uint64_t base_ms = TRACE_EPOCH_MS + batch.ms[0];
+            size_t len = batch_encode(buf, sizeof(buf), & batch, base_ms,
+                READ_SENSOR_INTERVAL * 1000, & encoded);
+
+            int count = batch_decode(buf, len, decoded, times, BATCH_MAX);
+            if (count != encoded) {
+                r->errors += encoded;
+            } else {
+                for (uint8_t j = 0; j < encoded; j++) {
+                    if (!same_sample(& decoded[j], & batch.samples[j])
+                        || times[j] != TRACE_EPOCH_MS + batch.ms[j]) {
+                        r->errors++;
+                    }
+                }
+            }
+
+            r->messages++;
+            r->bytes += len;
+            r->samples += encoded;
+            batch_drop(& batch, encoded);
+        }
+    }
+}
+
+// Corrupted input must be rejected, never overrun the output
+static size_t check_rejects(const Trace & trace) {
+    static SampleBatch batch;
+    static SensorData decoded[BATCH_MAX];
+    static uint64_t times[BATCH_MAX];
+    uint8_t buf[BATCH_PAYLOAD];
+    uint8_t encoded;
+    size_t failures = 0;
+
+    batch_reset(& batch);
+    for (uint8_t i = 0; i < 20; i++) {
+        batch_push(& batch, & trace.samples[i], trace.ms[i]);
+    }
+    size_t len = batch_encode(buf, sizeof(buf), & batch, 0, 1000, & encoded);
+
+    // Every truncation, a bad version, and too little room in the output
+    for (size_t n = 0; n < len; n++) {
+        if (batch_decode(buf, n, decoded, times, BATCH_MAX) >= 0) {
+            failures++;
+        }
+    }
+    if (batch_decode(buf, len, decoded, times, encoded - 1) >= 0) {
+        failures++;
+    }
+    buf[0]++;
+    if (batch_decode(buf, len, decoded, times, BATCH_MAX) >= 0) {
+        failures++;
+    }
+
+    return failures;
+}
+
+typedef struct {
+    const SampleBatch * batch;
+    uint8_t * buf;
+} EncodeCtx;
+
+static void encode_one(void * ctx) {
+    EncodeCtx * c = (EncodeCtx *)ctx;
+    uint8_t encoded;
+    batch_encode(c->buf, BATCH_PAYLOAD, c->batch, TRACE_EPOCH_MS, 1000, & encoded);
+}
+
+#ifdef PUBLISH_BATCH
+static uint32_t batch_messages;
+static size_t batch_bytes;
+
+static void on_publish(int, const char * topic, const uint8_t *, size_t len, bool) {
+    size_t n = strlen(topic);
+    if (n > 6 && !strcmp(topic + n - 6, "/batch")) {
+        batch_messages++;
+        batch_bytes += len;
+    }
+}
+#endif
+
+void bench_batch() {
+    static const uint8_t sizes[] = { 10, 20, 60 };
+    static SampleBatch batch;
+    uint8_t buf[BATCH_PAYLOAD];
+    Trace quiet, spiky;
+    BatchResult r;
+
+    bench_header("Batched Columnar Encoding (recorded sensor traces)");
+    bench_device_init(sn, sizeof(sn));
+
+    record(& quiet, 3600);
+    sim_pms5003.spike_pct = 5;
+    record(& spiky, 3600);
+    sim_pms5003.spike_pct = 0;
+
+    // Per-sample baselines for the same data
+    size_t json = payload_json_length(data_fields, data_field_count, & quiet.samples[0]);
+    size_t cbor = payload_cbor_length(data_fields, data_field_count, & quiet.samples[0]);
+    bench_report("bytes/sample, single messages", "struct %zu, JSON %zu, CBOR %zu",
+        sizeof(SensorData), json, cbor);
+
+    size_t errors = 0;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        char name[48];
+
+        encode_trace(quiet, sizes[s], & r);
+        errors += r.errors;
+        snprintf(name, sizeof(name), "batch of %u, quiet room", sizes[s]);
+        bench_report(name, "%.1f bytes/sample (%.1fx vs JSON), %zu messages/h",
+            (double)r.bytes / r.samples, (double)json * r.samples / r.bytes, r.messages);
+
+        encode_trace(spiky, sizes[s], & r);
+        errors += r.errors;
+        snprintf(name, sizeof(name), "batch of %u, 5%% PM spikes", sizes[s]);
+        bench_report(name, "%.1f bytes/sample (%.1fx vs JSON), %zu messages/h",
+            (double)r.bytes / r.samples, (double)json * r.samples / r.bytes, r.messages);
+    }
+
+    // Invalid readings keep their sentinels through the deltas
+    Trace faults = quiet;
+    for (size_t i = 0; i < faults.samples.size(); i += 7) {
+        faults.samples[i].temperature = INT16_MIN;
+        faults.samples[i].pressure = UINT32_MAX;
+        faults.samples[i].humidity = UINT32_MAX;
+    }
+    encode_trace(faults, BATCH_MAX, & r);
+    errors += r.errors;
+    bench_report("batch of 64, invalid readings", "%.1f bytes/sample",
+        (double)r.bytes / r.samples);
+
+    bench_report("round trip", "%zu samples differ, %zu bad inputs accepted",
+        errors, check_rejects(quiet));
+
+    // Samples in one packet when a long outage has filled the batch
+    uint8_t encoded;
+    batch_reset(& batch);
+    for (size_t i = 0; i < BATCH_MAX; i++) {
+        batch_push(& batch, & spiky.samples[i], spiky.ms[i]);
+    }
+    batch_encode(buf, sizeof(buf), & batch, TRACE_EPOCH_MS, 1000, & encoded);
+    bench_report("samples per packet", "%u of %u (%d-byte payload)",
+        encoded, BATCH_MAX, BATCH_PAYLOAD);
+
+    // Encoding cost per batch of PUBLISH_BATCH-sized inputs
+    batch_reset(& batch);
+    for (size_t i = 0; i < 20; i++) {
+        batch_push(& batch, & quiet.samples[i], quiet.ms[i]);
+    }
+    EncodeCtx ctx = { & batch, buf };
+    bench_run("batch_encode, 20 samples", encode_one, & ctx, 20000);
+
+#ifdef PUBLISH_BATCH
+    // The firmware as configured, end to end
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    setup();
+    uint64_t end = sim_clock_us + 3600 * 1000000ULL;
+    batch_messages = 0;
+    batch_bytes = 0;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+    sim_broker.on_publish = NULL;
+
+    bench_report("firmware batch topic, 1 h", "%u messages, %zu bytes", batch_messages, batch_bytes);
+#endif
+}
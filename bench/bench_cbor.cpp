@@ -0,0 +1,186 @@
+/** Host Benchmark Suite - CBOR Payloads */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "fixed.h"
+#include "mqtt.h"
+#include "mqtt_client.h"
+#include "payload.h"
+#include "sensor.h"
+#include "sim/sim_broker.h"
+
+static char sn[16];
+static SensorData sample;
+static StatusPayload status;
+static uint8_t out[512];
+
+// Last message received by the broker
+static uint8_t rx[512];
+static size_t rx_len;
+
+static void on_publish(int, const char *, const uint8_t * payload, size_t len, bool) {
+    rx_len = len < sizeof(rx) ? len : sizeof(rx);
+    memcpy(rx, payload, rx_len);
+}
+
+static void b_encode_json(void *) {
+    payload_json_length(data_fields, data_field_count, &sample);
+    payload_json(out, data_fields, data_field_count, &sample);
+}
+
+static void b_encode_cbor(void *) {
+    payload_cbor_length(data_fields, data_field_count, &sample);
+    payload_cbor(out, data_fields, data_field_count, &sample);
+}
+
+/* --- Minimal CBOR Decoder ----------------------------------------------- */
+
+// Read a CBOR head, returning false on malformed or unsupported input
+static bool cbor_read(const uint8_t ** p, const uint8_t * end, uint8_t * major, uint64_t * arg) {
+    if (*p >= end) return false;
+
+    uint8_t ib = *(*p)++;
+    uint8_t ai = ib & 0x1F;
+    *major = ib >> 5;
+
+    if (ai < 24) {
+        *arg = ai;
+        return true;
+    }
+    if (ai > 27) return false;
+
+    size_t n = (size_t)1 << (ai - 24);
+    if ((size_t)(end - *p) < n) return false;
+
+    *arg = 0;
+    while (n--) *arg = (*arg << 8) | *(*p)++;
+    return true;
+}
+
+static bool cbor_read_int(const uint8_t ** p, const uint8_t * end, int64_t * value) {
+    uint8_t major;
+    uint64_t arg;
+
+    if (!cbor_read(p, end, &major, &arg) || major > 1) return false;
+    *value = major ? -1 - (int64_t)arg : (int64_t)arg;
+    return true;
+}
+
+/**
+ * Decode a CBOR payload back into the equivalent JSON text, using the field
+ * table to map integer keys to JSON keys. Returns the JSON length or zero if
+ * the payload could not be decoded.
+ */
+static size_t cbor_to_json(const uint8_t * p, size_t len, const PayloadField * fields,
+    size_t count, char * json)
+{
+    const uint8_t * end = p + len;
+    char * o = json;
+    uint8_t major;
+    uint64_t n;
+
+    if (!cbor_read(&p, end, &major, &n) || major != 5) return 0;
+
+    *o++ = '{';
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t id;
+        if (!cbor_read(&p, end, &major, &id) || major != 0) return 0;
+
+        const PayloadField * f = NULL;
+        for (size_t k = 0; k < count; k++) {
+            if (fields[k].id == id) f = &fields[k];
+        }
+        if (!f) return 0;
+
+        o += sprintf(o, "%s\"%s\":", i ? "," : "", f->key);
+
+        const uint8_t * v = p;
+        uint64_t arg;
+        if (!cbor_read(&p, end, &major, &arg)) return 0;
+
+        if (major == 0 || major == 1) {
+            int64_t x;
+            p = v;
+            if (!cbor_read_int(&p, end, &x)) return 0;
+            o += sprintf(o, "%lld", (long long)x);
+        } else if (major == 3) {
+            if ((uint64_t)(end - p) < arg) return 0;
+            o += sprintf(o, "\"%.*s\"", (int)arg, (const char *)p);
+            p += arg;
+        } else if (major == 6 && arg == 4) {
+            // Decimal fraction [exponent, mantissa]
+            int64_t e, m;
+            if (!cbor_read(&p, end, &major, &arg) || major != 4 || arg != 2) return 0;
+            if (!cbor_read_int(&p, end, &e) || !cbor_read_int(&p, end, &m) || e != -1) return 0;
+            uint64_t a = m < 0 ? -m : m;
+            o += sprintf(o, "%s%llu.%llu", m < 0 ? "-" : "",
+                (unsigned long long)(a / 10), (unsigned long long)(a % 10));
+        } else if (major == 7 && arg == 0x7E00) {
+            o += sprintf(o, "nan");
+        } else {
+            return 0;
+        }
+    }
+    *o++ = '}';
+    *o = 0;
+
+    return p == end ? (size_t)(o - json) : 0;
+}
+
+// Publish one sample both ways and check the CBOR decodes to the JSON
+static bool round_trip(const PayloadField * fields, size_t count, const void * base,
+    uint64_t * json_bytes, uint64_t * cbor_bytes)
+{
+    char topic[40], decoded[512], json[512];
+
+    sprintf(topic, "sensor/aq/%s/bench", sn);
+
+    uint64_t before = sim_broker.stats.bytes_in;
+    mqtt_session->mqtt->publishFields(topic, fields, count, base);
+    *json_bytes += sim_broker.stats.bytes_in - before;
+    memcpy(json, rx, rx_len);
+    json[rx_len] = 0;
+
+    before = sim_broker.stats.bytes_in;
+    mqtt_session->mqtt->publishFields(topic, fields, count, base, PAYLOAD_CBOR);
+    *cbor_bytes += sim_broker.stats.bytes_in - before;
+
+    size_t n = cbor_to_json(rx, rx_len, fields, count, decoded);
+    return n && !strcmp(decoded, json);
+}
+
+void bench_cbor() {
+    bench_header("CBOR Payloads");
+    bench_device_init(sn, sizeof(sn));
+    sim_broker.on_publish = on_publish;
+    read_sensors(& sample);
+
+    bench_run("encode data: JSON", b_encode_json, NULL, 100000);
+    bench_run("encode data: CBOR", b_encode_cbor, NULL, 100000);
+
+    // Decode every CBOR message received by the broker and compare to the JSON
+    const int samples = 1000;
+    uint64_t json_bytes = 0, cbor_bytes = 0;
+    int bad = 0;
+    for (int i = 0; i < samples; i++) {
+        read_sensors(& sample);
+        if (i % 50 == 0) sample.humidity = SENSOR_RH_INVALID;
+        if (i % 70 == 0) sample.temperature = -(int16_t)(i * 3);
+        if (!round_trip(data_fields, data_field_count, &sample, &json_bytes, &cbor_bytes)) bad++;
+    }
+    bench_report("data: JSON bytes per message", "%.1f B", (double)json_bytes / samples);
+    bench_report("data: CBOR bytes per message", "%.1f B", (double)cbor_bytes / samples);
+
+    json_bytes = cbor_bytes = 0;
+    status.status = "ONLINE";
+    status.sensor = *sensor_status;
+    status.wlan = *wlan_status;
+    if (!round_trip(status_fields, status_field_count, &status, &json_bytes, &cbor_bytes)) bad++;
+    bench_report("status: JSON / CBOR bytes", "%llu / %llu B",
+        (unsigned long long)json_bytes, (unsigned long long)cbor_bytes);
+
+    bench_report("CBOR decode mismatches", "%d / %d", bad, samples + 1);
+    sim_broker.on_publish = NULL;
+}
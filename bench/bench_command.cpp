@@ -0,0 +1,147 @@
+/** Host Benchmark Suite - Command Protocol and Runtime Settings */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <string>
+
+#include "bench.h"
+#include "command.h"
+#include "config.h"
+#include "error.h"
+#include "settings.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+#include "storage.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+extern char module_sn[16];
+
+//! Parser Case: a command line and the result it must give
+typedef struct {
+    const char * line;
+    int ret;
+    const char * reply;         //< Expected in the reply
+} CommandCase;
+
+static const CommandCase cases[] = {
+    { "set publish_interval 10", 0, "{\"cmd\":\"set\",\"publish_interval\":10,\"ok\":true}" },
+    { "SET Publish_Interval 15", 0, "\"publish_interval\":15" },
+    { "  set\tsample_interval   2 \r\n", 0, "\"sample_interval\":2" },
+    { "get publish_interval", 0, "{\"cmd\":\"get\",\"publish_interval\":15,\"ok\":true}" },
+    { "get config", 0, "\"sample_interval\":2,\"publish_interval\":15,\"baseline_interval\":" },
+    { "set publish_interval 0", ERROR_SETTING_RANGE, "\"min\":1,\"max\":3600,\"ok\":false" },
+    { "set publish_interval 3601", ERROR_SETTING_RANGE, "value out of range" },
+    { "set publish_interval -5", ERROR_SETTING_RANGE, "value out of range" },
+    { "set publish_interval 10s", ERROR_SETTING_RANGE, "value out of range" },
+    { "set publish_interval 99999999999", ERROR_SETTING_RANGE, "value out of range" },
+    { "set sgp30_interval 5", ERROR_SETTING_UNKNOWN, "unknown setting" },
+    { "get nothing", ERROR_SETTING_UNKNOWN, "unknown setting" },
+    { "set publish_interval", ERROR_COMMAND_ARGS, "wrong number of arguments" },
+    { "get config now", ERROR_COMMAND_ARGS, "wrong number of arguments" },
+    { "set a b c d e f", ERROR_COMMAND_ARGS, "\"cmd\":\"set\"" },
+    { "reboot", ERROR_COMMAND_UNKNOWN, "{\"cmd\":null,\"ok\":false,\"error\":\"unknown command\"}" },
+    { "", ERROR_COMMAND_UNKNOWN, "unknown command" },
+    { "\"}{", ERROR_COMMAND_UNKNOWN, "{\"cmd\":null," },
+    { "resetbaseline", 0, "{\"cmd\":\"resetBaseline\",\"ok\":true}" },
+};
+
+static void b_command(void * p) {
+    char reply[160];
+    command_run((const char *)p, reply, sizeof(reply));
+}
+
+// Messages on the data and reply topics
+static uint32_t data_messages;
+static std::string last_reply;
+
+static void on_publish(int, const char * topic, const uint8_t * payload, size_t len, bool) {
+    size_t n = strlen(topic);
+    if (n > 5 && !strcmp(topic + n - 5, "/data")) {
+        data_messages++;
+    } else if (n > 11 && !strcmp(topic + n - 11, "/echo/reply")) {
+        last_reply.assign((const char *)payload, len);
+    }
+}
+
+static void run_for(uint32_t seconds) {
+    uint64_t end = sim_clock_us + seconds * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+}
+
+// Send a command to the running firmware and wait for its reply
+static void send_command(const char * line) {
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s/cmd", MQTT_TOPIC_BASE, module_sn);
+    last_reply.clear();
+    sim_broker.publish(topic, line);
+    run_for(1);
+}
+
+// Data messages and I2C bus time per minute over a stretch of firmware time
+static void measure(const char * name, uint32_t minutes) {
+    uint32_t before = data_messages;
+    uint64_t bus_us = sim_i2c_stats.bus_us;
+
+    run_for(minutes * 60);
+    bench_report(name, "%.1f data messages/min, %.0f ms I2C bus time/min",
+        (data_messages - before) / (double)minutes, (sim_i2c_stats.bus_us - bus_us) / 1e3 / minutes);
+}
+
+void bench_command() {
+    uint32_t passed = 0;
+    char reply[160], sn[16];
+
+    bench_header("Command Protocol and Runtime Settings");
+
+    // Parser and dispatcher against the table above
+    bench_device_init(sn, sizeof(sn));
+    settings_init(NULL);
+    for (const CommandCase & c : cases) {
+        int ret = command_run(c.line, reply, sizeof(reply));
+        if (ret == c.ret && strstr(reply, c.reply)) {
+            passed++;
+        } else {
+            printf("    FAIL \"%s\": %d %s\n", c.line, ret, reply);
+        }
+    }
+    bench_report("parser cases", "%u of %zu passed", passed, sizeof(cases) / sizeof(cases[0]));
+
+    bench_run("command_run, set", b_command, (void *)"set publish_interval 20", 100000);
+    bench_run("command_run, get config", b_command, (void *)"get config", 100000);
+
+    // Live reconfiguration of the firmware's tasks from the cmd topic
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    data_messages = 0;
+    setup();
+    run_for(60);
+    measure("defaults", 5);
+
+    uint32_t commits = eeprom.commits();
+    send_command("set publish_interval 10");
+    bench_report("reply", "%s", last_reply.c_str());
+    measure("publish_interval 10", 5);
+
+    send_command("set pms5003_interval 5");
+    measure("  and pms5003_interval 5", 5);
+
+    // Setting the same value again must not wear the EEPROM
+    send_command("set pms5003_interval 5");
+    bench_report("EEPROM commits", "%u for 3 set commands (2 changes)", eeprom.commits() - commits);
+
+    // A reset keeps the new intervals
+    setup();
+    run_for(60);
+    measure("after reset", 5);
+    send_command("get config");
+    bench_report("reply", "%s", last_reply.c_str());
+
+    sim_broker.on_publish = NULL;
+}
@@ -0,0 +1,98 @@
+/** Host Benchmark Suite - Home Assistant Discovery */
+
+#include <Arduino.h>
+#include <string.h>
+
+
+#include "bench.h"
+#include "config.h"
+#include "discovery.h"
+#include "mqtt.h"
+#include "payload.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+static char sn[16];
+
+// Discovery traffic seen by the broker
+static uint32_t disc_messages;
+static uint64_t disc_bytes;
+static uint64_t disc_last_us;
+
+static void on_publish(int, const char * topic, const uint8_t *, size_t len, bool) {
+    if (!strncmp(topic, "homeassistant/", 14)) {
+        disc_messages++;
+        disc_bytes += strlen(topic) + len;
+        disc_last_us = sim_clock_us;
+    }
+}
+
+// Run the firmware main loop for a stretch of simulated time
+static void run(uint64_t seconds) {
+    uint64_t end = sim_clock_us + seconds * 1000000;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+}
+
+// Boot the firmware and report the first minute of traffic; the simulated
+// flash and EEPROM survive unless sim_reset() was called first
+static void boot(const char * name) {
+    disc_messages = 0;
+    disc_bytes = 0;
+
+    sim_broker.drop_all();
+    uint64_t bytes = sim_broker.stats.bytes_in;
+    setup();
+    run(60);
+
+    bench_report(name, "%u discovery msgs (%llu B), %llu B sent in 60 s", disc_messages,
+        (unsigned long long)disc_bytes, (unsigned long long)(sim_broker.stats.bytes_in - bytes));
+}
+
+static void b_discovery(void *) {
+    haDiscovery(sn, MQTT_RETAIN_DISCOVERY);
+}
+
+static void b_config(void * ctx) {
+    static uint8_t out[MQTT_TX_BUFFER];
+    discovery_config(out, sizeof(out), ctx);
+}
+
+void bench_discovery() {
+    bench_header("Home Assistant Discovery");
+
+    bench_device_init(sn, sizeof(sn));
+    DiscoveryConfig cfg = { sn, "sensor/aq/000000000000/data", &data_fields[0] };
+    bench_run("discovery_config (one message)", b_config, &cfg, 100000);
+    bench_run("haDiscovery (full round)", b_discovery, NULL, 1000);
+
+    // Boot traffic: blank EEPROM, then reboots with the same config
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    boot("first boot");
+    boot("reboot, config unchanged");
+
+    // Home Assistant's retained birth message must not trigger a round
+    sim_broker.publish(DISCOVERY_HA_STATUS, "online", true);
+    boot("reboot, retained HA birth");
+
+    // A live birth message (Home Assistant restarting) does
+    disc_messages = 0;
+    disc_bytes = 0;
+    uint64_t t0 = sim_clock_us;
+    sim_broker.publish(DISCOVERY_HA_STATUS, "online", true);
+    run(DISCOVERY_JITTER + 5);
+    bench_report("HA restart", "%u discovery msgs (%llu B) after %.1f s", disc_messages,
+        (unsigned long long)disc_bytes, disc_messages ? (disc_last_us - t0) / 1e6 : 0.0);
+
+    bench_report("discovery rounds / HA requests", "%u / %u",
+        discovery_status->published, discovery_status->requests);
+
+    sim_broker.on_publish = NULL;
+}
@@ -0,0 +1,78 @@
+/** Host Benchmark Suite - Fixed-Point vs Floating-Point BME280 Path */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bme280_fixed.h"
+#include "fixed.h"
+#include "sensor.h"
+
+extern BME280_Fixed bme;
+
+static char sn[16];
+
+static volatile float f_t, f_p, f_h;
+static int16_t x_t;
+static uint32_t x_p, x_h;
+
+static void b_read_float(void *) {
+    f_t = bme.readTemperature();
+    f_p = bme.readPressure();
+    f_h = bme.readHumidity();
+}
+
+static void b_read_fixed(void *) {
+    bme.readFixed(&x_t, &x_p, &x_h);
+}
+
+static void b_format_float(void *) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.1f,%.1f,%.1f", (double)f_t, (double)f_p, (double)f_h);
+}
+
+static void b_format_fixed(void *) {
+    char buf[48];
+    char * p = buf;
+    p += fixed_format1(p, x_t, 100);
+    *p++ = ',';
+    p += fixed_format1(p, x_p, 256);
+    *p++ = ',';
+    fixed_format1(p, x_h, 1024);
+}
+
+// Compare fixed_format1 against printf of the float driver result
+static uint32_t check(int64_t lo, int64_t hi, int64_t step, uint32_t den, uint32_t * count) {
+    char a[FIXED_FORMAT_MAX], b[32];
+    uint32_t bad = 0;
+
+    for (int64_t v = lo; v <= hi; v += step) {
+        fixed_format1(a, v, den);
+        snprintf(b, sizeof(b), "%.1f", (double)(float)((double)v / den));
+        if (strcmp(a, b)) bad++;
+        (*count)++;
+    }
+
+    return bad;
+}
+
+void bench_fixed() {
+    bench_header("BME280 Fixed Point vs Float");
+    bench_device_init(sn, sizeof(sn));
+    b_read_float(NULL);
+    b_read_fixed(NULL);
+
+    bench_run("read (float driver, 3 calls)", b_read_float, NULL, 2000);
+    bench_run("read (fixed, one burst)", b_read_fixed, NULL, 2000);
+    bench_run("format %.1f x3 (float)", b_format_float, NULL, 100000);
+    bench_run("format x3 (fixed_format1)", b_format_fixed, NULL, 100000);
+
+    // Output must match the float path byte for byte
+    uint32_t count = 0, bad = 0;
+    bad += check(-4000, 8500, 1, 100, &count);
+    bad += check(0, 102400, 1, 1024, &count);
+    bad += check(30000 * 256, 110000 * 256, 37, 256, &count);
+    bench_report("format mismatches vs float path", "%u / %u", bad, count);
+
+    bench_report("sizeof(SensorData)", "%zu B (48 B with double)", sizeof(SensorData));
+}
@@ -0,0 +1,295 @@
+/** Host Benchmark Suite - Fleet Load on the Broker */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "bench.h"
+#include "config.h"
+#include "discovery.h"
+#include "mqtt.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+#include "sim/sim_session.h"
+#include "wlan.h"
+
+#define FLEET_SIZE          200
+#define FLEET_TICK_US       100000ULL
+#define FLEET_BOOT_S        10      // Devices power up over this many seconds
+
+// Assumed broker costs (a small single-board Mosquitto host)
+#define BROKER_SERVICE_US   50
+#define BROKER_DELIVERY_US  10
+
+//! Simulated Device
+typedef struct {
+    char sn[16];
+    SimSession session;
+    uint64_t free_us;           //< Busy in a blocking network call until
+    uint64_t data_us;           //< Next sample publish
+    uint64_t status_us;         //< Next status publish
+    bool connected;
+} Device;
+
+//! Broker Load over one Phase
+typedef struct {
+    uint64_t start_us;
+    SimBrokerStats before;
+    std::vector<uint32_t> latency_us;   //< Publish to delivery at Home Assistant
+    uint32_t peak_publishes;    //< Most PUBLISH packets in one second
+    uint32_t peak_connects;     //< Most CONNECTs in one second
+    uint64_t all_connected_us;  //< First time every device was connected, or 0
+} Phase;
+
+static Device fleet[FLEET_SIZE];
+static SensorData sample;
+static uint32_t interval_s;
+
+// Home Assistant: one broker session subscribed to the fleet's topics
+static int ha;
+
+static void put_string(std::vector<uint8_t> & pkt, const char * s) {
+    size_t n = strlen(s);
+    pkt.push_back(n >> 8);
+    pkt.push_back(n & 0xFF);
+    pkt.insert(pkt.end(), s, s + n);
+}
+
+static void ha_send(uint8_t hdr, const std::vector<uint8_t> & body) {
+    std::vector<uint8_t> pkt(1, hdr);
+    pkt.push_back((uint8_t)body.size());
+    pkt.insert(pkt.end(), body.begin(), body.end());
+    sim_broker.receive(ha, pkt.data(), pkt.size());
+}
+
+// Connect Home Assistant and announce it with a live birth message
+static void ha_start() {
+    std::vector<uint8_t> connect, subscribe;
+    uint8_t buf[1024];
+
+    ha = sim_broker.attach();
+    put_string(connect, "MQTT");
+    connect.push_back(4);
+    connect.push_back(0x02);
+    connect.push_back(0);
+    connect.push_back(60);
+    put_string(connect, "homeassistant");
+    ha_send(0x10, connect);
+
+    subscribe.push_back(0);
+    subscribe.push_back(1);
+    put_string(subscribe, MQTT_TOPIC_BASE "/#");
+    subscribe.push_back(0);
+    ha_send(0x82, subscribe);
+
+    while (sim_broker.take(ha, buf, sizeof(buf))) { }
+    sim_broker.publish(DISCOVERY_HA_STATUS, "online");
+}
+
+// One pass of a device's MQTT work, on its own clock
+static void step(Device * d, uint64_t now, Phase * ph) {
+    sim_clock_us = d->free_us > now ? d->free_us : now;
+    sim_session_select(& d->session);
+
+    // Home Assistant's birth message reaches ha_status_cb from process_mqtt()
+    d->connected = !connect_mqtt(d->sn);
+    if (d->connected) {
+        process_mqtt(1);
+
+        if (discovery_due()) {
+            haDiscovery(d->sn, MQTT_RETAIN_DISCOVERY);
+        }
+        if (sim_clock_us >= d->status_us) {
+            publish_status("ONLINE");
+            d->status_us += READ_BASELINE_INTERVAL * 60 * 1000000ULL;
+        }
+        if (sim_clock_us >= d->data_us) {
+            if (!publish_data(& sample) && ph) {
+                ph->latency_us.push_back(sim_broker.rtt_us + (uint32_t)sim_broker.last_latency_us);
+            }
+            d->data_us += interval_s * 1000000ULL;
+        }
+    }
+
+    d->free_us = sim_clock_us;
+    sim_clock_us = now;
+}
+
+// Run the fleet for a stretch of simulated time
+static void run(uint32_t seconds, Phase * ph) {
+    uint64_t end = sim_clock_us + seconds * 1000000ULL;
+    uint64_t second = sim_clock_us;
+    SimBrokerStats last = sim_broker.stats;
+    uint8_t buf[1024];
+
+    ph->start_us = sim_clock_us;
+    ph->before = sim_broker.stats;
+    ph->latency_us.clear();
+    ph->peak_publishes = ph->peak_connects = 0;
+    ph->all_connected_us = 0;
+
+    for (uint64_t now = sim_clock_us; now < end; now += FLEET_TICK_US) {
+        uint32_t up = 0;
+        for (Device & d : fleet) {
+            if (d.free_us <= now) step(& d, now, ph);
+            up += d.connected;
+        }
+        if (up == FLEET_SIZE && !ph->all_connected_us) {
+            ph->all_connected_us = now;
+        }
+
+        while (sim_broker.take(ha, buf, sizeof(buf))) { }
+
+        if (now - second >= 1000000) {
+            ph->peak_publishes = std::max(ph->peak_publishes, sim_broker.stats.publishes - last.publishes);
+            ph->peak_connects = std::max(ph->peak_connects, sim_broker.stats.connects - last.connects);
+            last = sim_broker.stats;
+            second = now;
+        }
+        sim_clock_us = now + FLEET_TICK_US;
+    }
+}
+
+// Connection attempts started by the whole fleet
+static uint32_t fleet_attempts() {
+    uint32_t n = 0;
+    for (Device & d : fleet) {
+        sim_session_select(& d.session);
+        n += mqtt_status->attempts;
+    }
+    return n;
+}
+
+static void report_load(const char * name, const Phase * ph) {
+    double s = (sim_clock_us - ph->start_us) / 1e6;
+    const SimBrokerStats & a = ph->before;
+    const SimBrokerStats & b = sim_broker.stats;
+
+    bench_report(name, "%.1f msg/s (peak %u/s), %.1f KiB/s in, %.1f KiB/s out",
+        (b.publishes - a.publishes) / s, ph->peak_publishes,
+        (b.bytes_in - a.bytes_in) / s / 1024, (b.bytes_out - a.bytes_out) / s / 1024);
+}
+
+static void report_latency(const char * name, Phase * ph) {
+    std::vector<uint32_t> & l = ph->latency_us;
+    if (l.empty()) {
+        bench_report(name, "no samples");
+        return;
+    }
+
+    std::sort(l.begin(), l.end());
+    bench_report(name, "p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms (%zu samples)",
+        l[l.size() / 2] / 1e3, l[l.size() * 95 / 100] / 1e3, l[l.size() * 99 / 100] / 1e3,
+        l.back() / 1e3, l.size());
+}
+
+// Power up the fleet and let it settle
+static void boot(uint32_t interval) {
+    for (Device & d : fleet) {
+        sim_session_close(& d.session);
+    }
+
+    sim_reset(18);
+    sim_broker.service_us = BROKER_SERVICE_US;
+    sim_broker.delivery_us = BROKER_DELIVERY_US;
+    interval_s = interval;
+
+    setup_wlan();
+    while (!connected_wlan()) {
+        check_wlan();
+        sim_advance_us(10000);
+    }
+
+    ha_start();
+
+    memset(& sample, 0, sizeof(sample));
+    sample.pressure = 101325 * 256;
+    sample.humidity = 45 * 1024;
+    sample.temperature = 2150;
+    sample.tvoc = 35;
+    sample.eCO2 = 450;
+    sample.pm25 = 6;
+    sample.pm100 = 9;
+
+    for (uint32_t i = 0; i < FLEET_SIZE; i++) {
+        Device & d = fleet[i];
+        snprintf(d.sn, sizeof(d.sn), "%012X", 0xA0000 + i);
+        sim_session_select(& d.session);
+        setup_mqtt(d.sn);
+
+        // Discovery (a new config for each device) and status go out as soon
+        // as each device connects
+        d.free_us = sim_clock_us + random(FLEET_BOOT_S * 1000UL) * 1000ULL;
+        d.status_us = d.free_us;
+        d.data_us = d.free_us + random(interval * 1000UL) * 1000ULL;
+        d.connected = false;
+    }
+}
+
+void bench_fleet() {
+    Phase ph;
+    char name[64];
+
+    snprintf(name, sizeof(name), "Fleet Load on the Broker (%u sensors)", FLEET_SIZE);
+    bench_header(name);
+
+    // Power-on: every device connects and announces itself
+    boot(PUBLISH_INTERVAL);
+    run(60, & ph);
+    report_load("power-on, first 60 s", & ph);
+    bench_report("power-on, all connected", "after %.1f s, peak %u CONNECT/s",
+        (ph.all_connected_us - ph.start_us) / 1e6, ph.peak_connects);
+
+    // Steady state at the configured interval and at a shorter one
+    run(5 * 60, & ph);
+    snprintf(name, sizeof(name), "steady state, %u s interval", PUBLISH_INTERVAL);
+    report_load(name, & ph);
+    report_latency("  publish to Home Assistant", & ph);
+
+    boot(10);
+    run(60, & ph);
+    run(5 * 60, & ph);
+    report_load("steady state, 10 s interval", & ph);
+    report_latency("  publish to Home Assistant", & ph);
+
+    // Broker restart: 30 s down, then the fleet's backoff spreads the return
+    boot(PUBLISH_INTERVAL);
+    run(120, & ph);
+    uint32_t attempts = fleet_attempts();
+    sim_broker.online = false;
+    sim_broker.drop_all();
+    run(30, & ph);
+    sim_broker.online = true;
+    run(120, & ph);
+    bench_report("broker restart, 30 s down", "%u connect attempts, all back after %.1f s, peak %u CONNECT/s",
+        fleet_attempts() - attempts,
+        ph.all_connected_us ? (ph.all_connected_us - ph.start_us) / 1e6 : -1.0, ph.peak_connects);
+    report_latency("  publish to Home Assistant", & ph);
+
+    // Home Assistant restart: every device resends discovery. Without the
+    // jitter each device would answer as soon as the birth message arrives,
+    // which a request with no delay stands in for; the firmware's own request
+    // then keeps that earlier slot.
+    for (int j = 1; j >= 0; j--) {
+        boot(PUBLISH_INTERVAL);
+        run(120, & ph);
+        if (!j) {
+            for (Device & d : fleet) {
+                sim_session_select(& d.session);
+                discovery_request(0);
+            }
+        }
+        sim_broker.detach(ha);
+        ha_start();
+        run(DISCOVERY_JITTER + 30, & ph);
+
+        snprintf(name, sizeof(name), "HA restart, %s", j ? "jittered discovery" : "no jitter");
+        report_load(name, & ph);
+        report_latency("  publish to Home Assistant", & ph);
+    }
+
+    sim_session_select(NULL);
+}
@@ -0,0 +1,98 @@
+/** Host Benchmark Suite - SGP30 Humidity Compensation */
+
+#include <Arduino.h>
+#include <math.h>
+
+#include "bench.h"
+#include "humidity.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_sensors.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+// Reference: Sensirion's formula in double precision, rounded to 8.8
+static uint32_t reference(int16_t temperature, uint32_t humidity) {
+    double t = temperature / 100.0, rh = humidity / 1024.0;
+    double ah = 216.7 * (rh / 100 * 6.112 * exp(17.62 * t / (243.12 + t)) / (273.15 + t));
+    double q = floor(ah * 256 + 0.5);
+    return q > HUMIDITY_AH_MAX ? HUMIDITY_AH_MAX : (uint32_t)q;
+}
+
+// The float code the table replaced: mg/m³, then scaled to 8.8
+static uint16_t float_formula(float temperature, float humidity) {
+    const float ah = 216.7f * ((humidity / 100.0f) * 6.112f * expf((17.62f * temperature) / (243.12f + temperature)) / (273.15f + temperature));
+    uint32_t mg = static_cast<uint32_t>(1000.0f * ah);
+    return (uint16_t)(((uint64_t)mg * 256 * 16777) >> 24);
+}
+
+// Inputs stepped through the range so neither path sees a constant
+static int16_t bench_t = HUMIDITY_T_MIN;
+static volatile uint16_t sink;
+
+static void b_table(void *) {
+    bench_t = bench_t >= HUMIDITY_T_MAX ? HUMIDITY_T_MIN : bench_t + 7;
+    sink = humidity_absolute(bench_t, 50 * 1024);
+}
+
+static void b_float(void *) {
+    bench_t = bench_t >= HUMIDITY_T_MAX ? HUMIDITY_T_MIN : bench_t + 7;
+    sink = float_formula(bench_t / 100.0f, 50.0f);
+}
+
+void bench_humidity() {
+    uint32_t worst = 0, exact = 0, n = 0;
+
+    bench_header("SGP30 Humidity Compensation");
+
+    // Every 0.01 °C of the range at 0.5 %RH steps, against the formula
+    for (int32_t t = HUMIDITY_T_MIN; t <= HUMIDITY_T_MAX; t++) {
+        for (uint32_t rh = 0; rh <= 100 * 1024; rh += 512) {
+            uint32_t ref = reference(t, rh);
+            uint32_t got = humidity_absolute(t, rh);
+            uint32_t err = got > ref ? got - ref : ref - got;
+            worst = err > worst ? err : worst;
+            exact += err == 0;
+            n++;
+        }
+    }
+    bench_report("table vs formula, -40 to 85 °C", "max error %u LSB, %.1f %% exact", worst, 100.0 * exact / n);
+
+    bench_run("humidity_absolute (table)", b_table, NULL, 1000000);
+    bench_run("float formula with expf", b_float, NULL, 1000000);
+
+    // Each SGP30 read is compensated for the BME280 reading before it
+    char sn[16];
+    SensorData d;
+    bench_device_init(sn, sizeof(sn));
+    read_sensors(& d);
+    int16_t t = d.temperature;
+    uint32_t rh = d.humidity;
+    read_sensors(& d);
+    bench_report("SGP30 compensation", "%.2f g/m³ at %.2f °C, %.1f %%RH (formula %.2f)",
+        sim_sgp30.humidity / 256.0, t / 100.0, rh / 1024.0, reference(t, rh) / 256.0);
+
+    // The firmware only sends a value that changed
+    sim_reset();
+    uint32_t reads = sim_sgp30.measurements, writes = sim_sgp30.humidity_writes;
+#ifdef LOW_POWER
+    uint64_t end = sim_clock_us + 3600 * 1000000ULL;
+    while (sim_clock_us < end) {
+        setup();
+        sim_wake();
+    }
+    const char * name = "humidity writes, 1 hour of wakes";
+#else
+    setup();
+    uint64_t end = sim_clock_us + 600 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+    const char * name = "humidity writes, 10 minutes";
+#endif
+    bench_report(name, "%u for %u SGP30 reads",
+        sim_sgp30.humidity_writes - writes, sim_sgp30.measurements - reads);
+}
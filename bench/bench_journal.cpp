@@ -0,0 +1,125 @@
+/** Host Benchmark Suite - SGP30 Baseline Journal */
+
+#include <Arduino.h>
+#include <flash_hal.h>
+
+#include "bench.h"
+#include "config.h"
+#include "journal.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_flash.h"
+#include "sim/sim_sensors.h"
+#include "storage.h"
+
+#define HOURS_PER_YEAR      8760
+
+static void b_init(void *) {
+    journal_init();
+}
+
+// Baseline erases over a year of hourly writes
+static void year_of_writes() {
+    char sn[16];
+    uint32_t worst = 0, erases = 0;
+
+    sim_reset(3);
+    setup_sensors(sn, sizeof(sn));
+
+    // Assumed drift: a random walk of up to 24 counts per hour on each word
+    SimFlashStats before = sim_flash.stats;
+    for (uint32_t h = 0; h < HOURS_PER_YEAR * 60 / READ_BASELINE_INTERVAL; h++) {
+        sim_sgp30.bl_eco2 += (int)(sim_rand() % 49) - 24;
+        sim_sgp30.bl_tvoc += (int)(sim_rand() % 49) - 24;
+        read_baselines();
+    }
+    double flash_s = ((sim_flash.stats.erases - before.erases) * (double)sim_flash.erase_us
+        + (sim_flash.stats.writes - before.writes) * (double)sim_flash.page_us) / 1e6;
+
+    for (uint32_t s = 0; s < JOURNAL_SECTORS; s++) {
+        uint32_t n = sim_flash.sector_erases[FLASH_SECTOR_JOURNAL + s];
+        erases += n;
+        if (n > worst) worst = n;
+    }
+
+    // EEPROM_Rotate erases one of its sectors and programs 4 KiB per commit
+    uint32_t commits = HOURS_PER_YEAR * 60 / READ_BASELINE_INTERVAL;
+    bench_report("EEPROM_Rotate, 1 year", "%u erases (%u per sector), %u KiB programmed, %.0f s flash time",
+        commits, commits / EEPROM_SECTORS, commits * 4,
+        commits * (sim_flash.erase_us + 16.0 * sim_flash.page_us) / 1e6);
+    bench_report("journal, 1 year", "%u erases (%u per sector), %u records, %u skipped, %.1f s flash time",
+        erases, worst, journal_status->writes, journal_status->skipped, flash_s);
+
+    // Boot cost of finding the newest record in a full journal
+    bench_run("journal_init, full journal", b_init, NULL, 100);
+}
+
+// Append while cutting power at random points, rebooting after each cut
+static void power_loss(uint32_t cuts) {
+    uint32_t n = 0, acked = 0, newest = 0, previous = 0, bad = 0, torn = 0;
+    uint16_t eco2, tvoc;
+
+    sim_reset(11);
+    journal_init();
+
+    for (uint32_t c = 0; c < cuts; c++) {
+        // Values move past the deadband on every write
+        sim_flash.cut_after = sim_rand() % 200;
+        while (sim_flash.powered) {
+            n++;
+            if (!journal_write((uint16_t)(n * 101), (uint16_t)(n * 53))) {
+                acked = n;
+            }
+        }
+
+        // Reboot: the newest acknowledged baseline must be read back, or
+        // the one torn by the cut if it happened to complete
+        sim_flash.power_on();
+        journal_init();
+        if (acked != n) torn++;
+        if (journal_read(&eco2, &tvoc)) {
+            if (acked) bad++;
+            continue;
+        }
+
+        if (eco2 == (uint16_t)(n * 101) && tvoc == (uint16_t)(n * 53)) {
+            newest++;
+        } else if (acked && eco2 == (uint16_t)(acked * 101) && tvoc == (uint16_t)(acked * 53)) {
+            previous++;
+        } else {
+            bad++;
+        }
+    }
+
+    bench_report("power cuts during writes", "%u cuts (%u tearing a record), %u sector erases",
+        cuts, torn, sim_flash.stats.erases);
+    bench_report("baseline after reboot", "%u newest, %u last acknowledged, %u lost or wrong",
+        newest, previous, bad);
+}
+
+// A reset is stored even when the newest baseline is inside the deadband
+static void clear_near_zero() {
+    uint16_t eco2 = UINT16_MAX, tvoc = UINT16_MAX;
+
+    sim_reset(5);
+    journal_init();
+    journal_write(BASELINE_DEADBAND, BASELINE_DEADBAND);
+    uint32_t writes = journal_status->writes;
+    journal_clear();
+    writes = journal_status->writes - writes;
+
+    // Reboot and read the stored baseline back
+    journal_init();
+    journal_read(&eco2, &tvoc);
+
+    bench_report("clear inside the deadband", "%u record written, read back %u/%u after reboot",
+        writes, eco2, tvoc);
+}
+
+void bench_journal() {
+    bench_header("SGP30 Baseline Journal (simulated flash)");
+
+    year_of_writes();
+    power_loss(2000);
+    clear_near_zero();
+}
@@ -0,0 +1,193 @@
+/** Host Benchmark Suite - Deep-Sleep Duty Cycling */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "bench.h"
+#include "config.h"
+#include "lowpower.h"
+#include "payload.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+#include "sim/sim_sensors.h"
+#include "storage.h"
+
+// Firmware entry point (src/main.cpp)
+void setup();
+
+static char sn[16];
+
+// Fields equal (padding ignored)
+static bool same_sample(const SensorData * a, const SensorData * b) {
+    for (size_t i = 0; i < data_field_count; i++) {
+        size_t size = data_fields[i].type == FIELD_UINT32 ? 4 : 2;
+        if (memcmp((const uint8_t *)a + data_fields[i].offset,
+            (const uint8_t *)b + data_fields[i].offset, size)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Every corrupted byte and every power-on pattern must be rejected
+static void check_restore() {
+    static LowPowerState state, check;
+    SensorData d;
+    uint32_t accepted = 0, trials = 0;
+
+    // Power-on: RTC memory holds whatever it powered up with
+    for (uint32_t seed = 1; seed <= 1000; seed++) {
+        sim_reset(seed);
+        if (lowpower_restore(& state)) accepted++;
+        trials++;
+    }
+
+    // A real state survives, and any damaged byte is caught
+    sim_reset();
+    bench_device_init(sn, sizeof(sn));
+    lowpower_restore(& state);
+    for (uint8_t i = 0; i < 6; i++) {
+        read_sensors(& d);
+        lowpower_push(& state, & d, 16000);
+        lowpower_sleep(& state, 16000);
+    }
+    lowpower_save(& state);
+
+    bool restored = lowpower_restore(& check) && !memcmp(& check, & state, sizeof(state));
+    for (size_t i = 0; i < sizeof(state); i++) {
+        ((uint8_t *)sim_rtc_mem)[RTC_BLOCK_LOWPOWER * 4 + i] ^= 0x10;
+        if (lowpower_restore(& check)) accepted++;
+        ((uint8_t *)sim_rtc_mem)[RTC_BLOCK_LOWPOWER * 4 + i] ^= 0x10;
+        trials++;
+    }
+
+    bench_report("state round trip", "%s, %zu B of RTC memory", restored ? "ok" : "FAILED", sizeof(state));
+    bench_report("corrupt states accepted", "%u / %u (power-on and bit flips)", accepted, trials);
+}
+
+// Samples held across sleep before the oldest are dropped
+static void check_window() {
+    static LowPowerState state;
+    static SampleBatch batch;
+    static SensorData trace[BATCH_MAX];
+    uint32_t n = 0, bad = 0;
+
+    // Start from power-on, not the state saved above
+    sim_reset();
+    bench_device_init(sn, sizeof(sn));
+    lowpower_restore(& state);
+    while (n < BATCH_MAX) {
+        read_sensors(& trace[n]);
+        lowpower_push(& state, & trace[n], 16000);
+        lowpower_sleep(& state, 16000);
+        n++;
+        if (state.dropped) break;
+    }
+
+    // The newest samples decode exactly, with their times
+    uint8_t kept = lowpower_samples(& state, & batch);
+    for (uint8_t i = 0; i < kept; i++) {
+        uint32_t expect = (n - kept + i) * SLEEP_INTERVAL * 1000UL + 16000;
+        if (!same_sample(& batch.samples[i], & trace[n - kept + i]) || batch.ms[i] != expect) {
+            bad++;
+        }
+    }
+
+    bench_report("window capacity", "%u samples in %d B (%.1f B/sample)", kept,
+        LOWPOWER_WINDOW_BYTES, (double)state.window_len / kept);
+    bench_report("window round trip", "%u / %u samples differ", bad, kept);
+}
+
+// Flush attempts over a day with the broker down for the middle eight hours
+static void check_schedule() {
+    static LowPowerState state;
+    uint32_t cycles = 24 * 3600 / SLEEP_INTERVAL;
+    uint32_t attempts = 0, outage_attempts = 0;
+
+    lowpower_restore(& state);
+    for (uint32_t c = 0; c < cycles; c++) {
+        bool outage = c >= cycles / 3 && c < 2 * cycles / 3;
+        if (lowpower_flush_due(& state)) {
+            attempts++;
+            if (outage) outage_attempts++;
+            lowpower_flushed(& state, !outage);
+        }
+        lowpower_sleep(& state, 16000);
+    }
+
+    bench_report("network wakes per day", "%u of %u (%u during an 8 h outage)",
+        attempts, cycles, outage_attempts);
+}
+
+#ifdef LOW_POWER
+// Assumed ESP8266 supply current: running with the radio off or on, and in
+// deep sleep (sensors not included)
+#define CURRENT_AWAKE_MA    15.0
+#define CURRENT_RADIO_MA    70.0
+#define CURRENT_SLEEP_MA    0.02
+
+static uint32_t data_messages;
+
+static void on_publish(int, const char * topic, const uint8_t *, size_t, bool) {
+    size_t n = strlen(topic);
+    if (n > 5 && !strcmp(topic + n - 5, "/data")) {
+        data_messages++;
+    }
+}
+
+// The firmware through a day of deep-sleep cycles
+static void run_firmware() {
+    uint64_t awake_us = 0, radio_us = 0, sleep_us = 0;
+    uint32_t wakes = 0, radio_wakes = 0;
+
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    data_messages = 0;
+
+    uint64_t end = sim_clock_us + 24 * 3600 * 1000000ULL;
+    while (sim_clock_us < end) {
+        uint64_t start = sim_clock_us;
+        bool radio = !sim_rf_disabled;
+        setup();
+        if (!sim_sleep_us) {
+            fprintf(stderr, "bench: firmware did not sleep\n");
+            break;
+        }
+
+        wakes++;
+        awake_us += sim_clock_us - start;
+        if (radio) {
+            radio_wakes++;
+            radio_us += sim_clock_us - start;
+        }
+        sleep_us += sim_sleep_us;
+        sim_wake();
+    }
+    sim_broker.on_publish = NULL;
+
+    double total = (double)(awake_us + sleep_us);
+    double ma = ((awake_us - radio_us) * CURRENT_AWAKE_MA + radio_us * CURRENT_RADIO_MA
+        + sleep_us * CURRENT_SLEEP_MA) / total;
+
+    bench_report("firmware, 24 h", "%u wakes, %u with radio, %u data messages", wakes, radio_wakes, data_messages);
+    bench_report("awake per wake", "%.1f s sampling, %.1f s with radio",
+        (awake_us - radio_us) / 1e6 / (wakes - radio_wakes), radio_us / 1e6 / radio_wakes);
+    bench_report("duty cycle", "%.2f %% measured, %u.%u %% reported",
+        100.0 * awake_us / total, lowpower_status->duty / 10, lowpower_status->duty % 10);
+    bench_report("est. ESP8266 current", "%.2f mA average (always on: %.0f mA)", ma, CURRENT_RADIO_MA);
+}
+#endif
+
+void bench_lowpower() {
+    bench_header("Deep-Sleep Duty Cycling (simulated RTC memory)");
+
+    check_restore();
+    check_window();
+    check_schedule();
+
+#ifdef LOW_POWER
+    run_firmware();
+#endif
+}
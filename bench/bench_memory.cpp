@@ -0,0 +1,213 @@
+/** Host Benchmark Suite - Static Memory Plan and Stack Budget */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include "batch.h"
+#include "bench.h"
+#include "config.h"
+#include "discovery.h"
+#include "memstat.h"
+#include "mqtt.h"
+#include "payload.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+// Stack budgets. The loop stack of the ESP8266 Arduino core is 4 KB; each
+// call path may use 1 KB of it for the firmware's own frames, and the loop as
+// a whole 1.5 KB. Paths that format text are also allowed what the C library's
+// printf takes on this host (about 2 KB with glibc, measured below). The
+// simulated broker runs on the same stack, so the figures are upper bounds.
+#define STACK_BUDGET        1024
+#define STACK_BUDGET_LOOP   1536
+
+// Heap allocations through operator new, counted while enabled
+static bool count_allocs;
+static uint32_t allocs;
+
+void * operator new(size_t n) {
+    if (count_allocs) allocs++;
+    void * p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void * p) noexcept {
+    free(p);
+}
+
+void operator delete(void * p, size_t) noexcept {
+    free(p);
+}
+
+static char sn[16];
+static SensorData sample;
+
+// Call paths, each run once from a connected session
+static void p_connect(void *) {
+    disconnect_mqtt();
+    while (connect_mqtt(sn)) {
+        sim_advance_us(1000);
+    }
+}
+
+static void p_publish_data(void *) {
+    publish_data(& sample);
+}
+
+static void p_publish_history(void *) {
+    publish_history(& sample, SIM_EPOCH, 0);
+}
+
+static void p_publish_status(void *) {
+    publish_status("ONLINE");
+}
+
+static void p_discovery(void *) {
+    haDiscovery(sn, MQTT_RETAIN_DISCOVERY);
+}
+
+#ifdef PUBLISH_BATCH
+static void p_publish_batch(void *) {
+    static SampleBatch batch;
+    batch_reset(& batch);
+    for (uint32_t i = 0; i < PUBLISH_BATCH; i++) {
+        batch_push(& batch, & sample, i * 1000);
+    }
+    publish_batch(& batch, 0);
+}
+#endif
+
+#ifdef METRICS
+static void p_publish_metrics(void *) {
+    publish_metrics();
+}
+#endif
+
+// A message on one of the device's topics, read by process_mqtt()
+static void p_receive(void * p) {
+    char topic[64];
+    const char ** msg = (const char **)p;
+
+    snprintf(topic, sizeof(topic), "%s/%s/%s", MQTT_TOPIC_BASE, sn, msg[0]);
+    sim_broker.publish(topic, msg[1]);
+    process_mqtt(100);
+}
+
+#ifdef LOW_POWER
+// The firmware over an hour of wakes; each runs setup() and sleeps
+static void p_loop(void *) {
+    uint64_t end = sim_clock_us + 3600 * 1000000ULL;
+    while (sim_clock_us < end) {
+        setup();
+        sim_wake();
+    }
+}
+#else
+// The firmware's own loop over ten minutes
+static void p_loop(void *) {
+    uint64_t end = sim_clock_us + 600 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+}
+#endif
+
+static void p_snprintf(void *) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%u", (unsigned)sim_clock_us);
+}
+
+// Messages on the device's topics
+static const char * msg_echo[] = { "echo", "0123456789012345678901234567890123456789012345678901234567890123456789" };
+static const char * msg_probe[] = { "echo", "probe 1" };
+static const char * msg_get[] = { "cmd", "get config" };
+static const char * msg_set[] = { "cmd", "set publish_interval 60" };
+
+//! Call Path and its Stack Budget
+typedef struct {
+    const char * name;
+    bench_fn fn;
+    void * ctx;
+    bool formats;               //< Calls printf
+} StackPath;
+
+static const StackPath paths[] = {
+    { "connect_mqtt, offline to open", p_connect, NULL, true },
+    { "publish_data", p_publish_data, NULL, false },
+    { "publish_history", p_publish_history, NULL, false },
+    { "publish_status", p_publish_status, NULL, false },
+    { "haDiscovery", p_discovery, NULL, false },
+#ifdef PUBLISH_BATCH
+    { "publish_batch", p_publish_batch, NULL, false },
+#endif
+#ifdef METRICS
+    { "publish_metrics", p_publish_metrics, NULL, true },
+#endif
+    { "process_mqtt, echo", p_receive, msg_echo, true },
+    { "process_mqtt, probe", p_receive, msg_probe, true },
+    { "process_mqtt, get config", p_receive, msg_get, true },
+    { "process_mqtt, set publish_interval", p_receive, msg_set, true },
+};
+
+static uint32_t over;
+static size_t printf_stack;
+
+static void check(const char * name, bench_fn fn, void * ctx, size_t budget) {
+    char label[64];
+    size_t used = bench_stack(fn, ctx);
+
+    snprintf(label, sizeof(label), "  %s", name);
+    over += used > budget;
+    bench_report(label, "%5zu B of %5zu B%s", used, budget, used > budget ? "  OVER BUDGET" : "");
+}
+
+void bench_memory() {
+    bench_header("Static Memory Plan and Stack Budget");
+
+    // setup_mqtt() constructs the client and feeds in static storage
+    bench_device_init(sn, sizeof(sn));
+    count_allocs = true;
+    allocs = 0;
+    setup_mqtt(sn);
+    count_allocs = false;
+    bench_report("setup_mqtt heap allocations", "%u", allocs);
+
+    while (connect_mqtt(sn)) {
+        sim_advance_us(10000);
+    }
+    read_sensors(& sample);
+
+    // Peak stack of each call path the loop can take
+    over = 0;
+    printf_stack = bench_stack(p_snprintf, NULL);
+    bench_report("stack per call path", "%zu B for snprintf alone", printf_stack);
+    for (const StackPath & p : paths) {
+        check(p.name, p.fn, p.ctx, STACK_BUDGET + (p.formats ? printf_stack : 0));
+    }
+
+    // Everything the firmware runs, including the offline queue and AQI
+    sim_reset();
+#ifdef LOW_POWER
+    check("wake cycles, 1 hour", p_loop, NULL, STACK_BUDGET_LOOP + printf_stack);
+#else
+    setup();
+    check("loop, 10 minutes", p_loop, NULL, STACK_BUDGET_LOOP + printf_stack);
+#endif
+    bench_report("paths over budget", "%u of %zu", over, sizeof(paths) / sizeof(paths[0]) + 1);
+
+    // What the status message reports (fixed values on the host)
+    memstat_update();
+    bench_report("status memory fields", "stack_free %u, heap_free %u, heap_block %u",
+        memory_status->stack_free, memory_status->heap_free, memory_status->heap_block);
+}
@@ -0,0 +1,153 @@
+/** Host Benchmark Suite - Execution Time Metrics */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+
+#include "bench.h"
+#include "metrics.h"
+#include "mqtt.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+#ifdef METRICS
+
+// The lx106 issues at most one instruction per cycle at 80 MHz against a
+// multi-GHz superscalar host; charging the host cost 100 times over is a
+// conservative estimate of the device cost
+#define BENCH_DEVICE_SLOWDOWN   100
+
+// Last metrics message seen by the broker
+static std::string last_metrics;
+static uint32_t metrics_messages;
+
+static void on_publish(int, const char * topic, const uint8_t * payload, size_t len, bool) {
+    size_t n = strlen(topic);
+    if (n > 8 && !strcmp(topic + n - 8, "/metrics")) {
+        last_metrics.assign((const char *)payload, len);
+        metrics_messages++;
+    }
+}
+
+static void bm_record(void *) {
+    static uint32_t cycles = 1;
+    metrics_record(METRIC_PUBLISH, cycles);
+    cycles = cycles * 1103515245 + 12345;
+}
+
+static void bm_scope(void *) {
+    METRICS_SCOPE(METRIC_PUBLISH);
+}
+
+static void bm_format(void * ctx) {
+    char * buf = (char *)ctx;
+    metrics_format(buf, 450, true);
+}
+
+// Host nanoseconds per call
+static double host_ns(bench_fn fn, uint32_t iterations) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn(NULL);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+// Samples recorded across all metrics in the current window
+static uint64_t total_records() {
+    uint64_t n = 0;
+    for (uint8_t i = 0; i < METRIC_COUNT; i++) {
+        n += metrics_table[i].count;
+    }
+
+    return n;
+}
+
+//! Main Loop Cost over one Phase
+typedef struct {
+    uint32_t loops;
+    uint64_t records;           //< Instrumentation points hit
+    uint64_t sim_us;            //< Simulated time inside loop() and between passes
+} LoopCost;
+
+// Run the firmware main loop, counting instrumentation points per pass
+static void run_phase(uint64_t seconds, LoopCost * lc) {
+    uint64_t start = sim_clock_us;
+    uint64_t end = start + seconds * 1000000;
+
+    *lc = LoopCost();
+    while (sim_clock_us < end) {
+        uint64_t before = total_records();
+        loop();
+
+        // A metrics message in this pass clears the window
+        uint64_t after = total_records();
+        lc->records += after >= before ? after - before : after + 1;
+        lc->loops++;
+
+        sim_advance_us(1000);
+    }
+
+    lc->sim_us = sim_clock_us - start;
+}
+
+static void report_phase(const char * name, const LoopCost * lc, double scope_ns) {
+    double per_loop = (double)lc->records / lc->loops;
+    double device_us = per_loop * scope_ns * BENCH_DEVICE_SLOWDOWN / 1e3;
+    double loop_us = (double)lc->sim_us / lc->loops;
+
+    bench_report(name, "%.2f records/pass, %.2f ms/pass", per_loop, loop_us / 1e3);
+    bench_report("  device cost / share of loop time", "%.2f us/pass = %.3f %%",
+        device_us, 100.0 * device_us / loop_us);
+}
+
+void bench_metrics() {
+    char buf[512];
+    LoopCost lc;
+
+    bench_header("Execution Time Metrics");
+
+    metrics_reset();
+    bench_run("metrics_record", bm_record, NULL, 1000000);
+    bench_run("METRICS_SCOPE (two cycle reads)", bm_scope, NULL, 1000000);
+    bench_run("metrics_format (full window)", bm_format, buf, 10000);
+    double scope_ns = host_ns(bm_scope, 1000000);
+
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    metrics_messages = 0;
+    setup();
+
+    // Online the loop mostly waits in process_mqtt(); offline it only runs
+    // the scheduler, and the harness paces passes at 1 ms
+    run_phase(20 * 60, &lc);
+    report_phase("broker online", &lc, scope_ns);
+
+    sim_broker.online = false;
+    sim_broker.drop_all();
+    run_phase(5 * 60, &lc);
+    report_phase("broker offline", &lc, scope_ns);
+    sim_broker.online = true;
+
+    bench_report("metrics messages, 20 min online", "%u (%zu B last)", metrics_messages, last_metrics.size());
+    bench_report("metrics message", "%s", last_metrics.c_str());
+
+    sim_broker.on_publish = NULL;
+}
+
+#else
+
+void bench_metrics() {
+    bench_header("Execution Time Metrics");
+    bench_report("metrics", "disabled (METRICS not defined)");
+}
+
+#endif // METRICS
@@ -0,0 +1,94 @@
+/** Host Benchmark Suite - MQTT Connection Manager */
+
+#include <Arduino.h>
+
+#include "bench.h"
+#include "mqtt.h"
+#include "queue.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+//! Main Loop Latency over one Phase
+typedef struct {
+    uint32_t loops;
+    uint64_t max_us;
+    uint64_t total_us;
+    uint64_t first_change_us;   //< Time until connected_mqtt() changed, or 0
+} LoopStats;
+
+// Run the firmware main loop for a stretch of simulated time, timing each pass
+static void run_timed(uint64_t seconds, LoopStats * ls) {
+    uint64_t start = sim_clock_us;
+    uint64_t end = start + seconds * 1000000;
+    bool was = connected_mqtt();
+
+    *ls = LoopStats();
+    while (sim_clock_us < end) {
+        uint64_t t0 = sim_clock_us;
+        loop();
+
+        uint64_t dt = sim_clock_us - t0;
+        if (dt > ls->max_us) ls->max_us = dt;
+        ls->total_us += dt;
+        ls->loops++;
+
+        if (!ls->first_change_us && connected_mqtt() != was) {
+            ls->first_change_us = sim_clock_us - start;
+        }
+
+        sim_advance_us(1000);
+    }
+}
+
+static void report_phase(const char * name, const LoopStats * ls) {
+    bench_report(name, "max %.1f ms, mean %.2f ms (%u loops)",
+        ls->max_us / 1e3, ls->loops ? ls->total_us / 1e3 / ls->loops : 0.0, ls->loops);
+}
+
+void bench_mqtt() {
+    LoopStats ls;
+
+    bench_header("MQTT Connection Manager");
+
+    sim_reset();
+    setup();
+
+    // Steady state: traffic is publishes plus keepalive pings
+    run_timed(60, &ls);
+    SimBrokerStats before = sim_broker.stats;
+    run_timed(10 * 60, &ls);
+    report_phase("loop latency, broker online", &ls);
+    bench_report("pings per hour, broker online", "%.0f",
+        (sim_broker.stats.pings - before.pings) * 6.0);
+
+    // Broker down: the TCP handshake goes unanswered until the attempt times out
+    uint32_t queued = queue_status->pending;
+    uint32_t attempts = mqtt_status->attempts;
+    sim_broker.online = false;
+    sim_broker.drop_all();
+    run_timed(10 * 60, &ls);
+    report_phase("loop latency, broker offline", &ls);
+    bench_report("connect attempts, 10 min offline", "%u",
+        mqtt_status->attempts - attempts);
+    bench_report("samples queued, 10 min offline", "%u",
+        queue_status->pending - queued);
+
+    sim_broker.online = true;
+    run_timed(5 * 60, &ls);
+    bench_report("reconnect after broker returns", "%.1f s", ls.first_change_us / 1e6);
+
+    // Half-open link: the socket stays up but nothing comes back
+    sim_broker.stalled = true;
+    run_timed(10 * 60, &ls);
+    report_phase("loop latency, broker stalled", &ls);
+    bench_report("stalled link detected after", "%.1f s", ls.first_change_us / 1e6);
+
+    sim_broker.stalled = false;
+    sim_broker.drop_all();
+    run_timed(5 * 60, &ls);
+    bench_report("reconnect after stall clears", "%.1f s", ls.first_change_us / 1e6);
+}
@@ -0,0 +1,128 @@
+/** Host Benchmark Suite - Table-Driven Serializer vs snprintf Templates */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "fixed.h"
+#include "payload.h"
+#include "sensor.h"
+
+// The snprintf templates previously used by publish_data/publish_status
+#define MQTT_JSON "{" \
+    "\"t\":%s," \
+    "\"p\":%s," \
+    "\"rh\":%s," \
+    "\"tvoc\":%d," \
+    "\"co2\":%d," \
+    "\"pm10\":%d," \
+    "\"pm25\":%d," \
+    "\"pm100\":%d," \
+    "\"particles03\":%d," \
+    "\"particles05\":%d," \
+    "\"particles10\":%d," \
+    "\"particles25\":%d," \
+    "\"particles50\":%d," \
+    "\"particles100\":%d" \
+"}"
+
+#define MQTT_STATUS_JSON "{" \
+    "\"status\":\"%s\"," \
+    "\"sgp30_errors\":%d," \
+    "\"pms5003_errors\":%d," \
+    "\"bl_tvoc\":%d," \
+    "\"bl_eco2\":%d," \
+    "\"wifi_reconnects\":%u," \
+    "\"wifi_offline\":%u," \
+    "\"stale\":%d," \
+    "\"stack_free\":%u," \
+    "\"heap_free\":%u," \
+    "\"heap_block\":%u," \
+    "\"i2c_bme280_ms\":%u," \
+    "\"i2c_sgp30_ms\":%u," \
+    "\"i2c_pms5003_ms\":%u," \
+    "\"i2c_nacks\":%u," \
+    "\"i2c_timeouts\":%u," \
+    "\"i2c_checksums\":%u," \
+    "\"i2c_recoveries\":%u" \
+"}"
+
+static char sn[16];
+static SensorData sample;
+static StatusPayload status;
+static char json[1024];
+static uint8_t packet[512];
+
+static void b_snprintf_data(void *) {
+    char t[FIXED_FORMAT_MAX], p[FIXED_FORMAT_MAX], rh[FIXED_FORMAT_MAX];
+
+    fixed_format1(t, sample.temperature, 100);
+    fixed_format1(p, sample.pressure, 256);
+    fixed_format1(rh, sample.humidity, 1024);
+
+    snprintf(json, 1023, MQTT_JSON, t, p, rh,
+        sample.tvoc, sample.eCO2, sample.pm10, sample.pm25, sample.pm100,
+        sample.pc03, sample.pc05, sample.pc10, sample.pc25, sample.pc50, sample.pc100);
+}
+
+static void b_snprintf_status(void *) {
+    snprintf(json, 1023, MQTT_STATUS_JSON, status.status,
+        status.sensor.sgp30_errors, status.sensor.pms5003_errors,
+        status.sensor.bl_tvoc, status.sensor.bl_eCO2,
+        status.wlan.reconnects, status.wlan.offline_s, status.sensor.stale,
+        status.memory.stack_free, status.memory.heap_free, status.memory.heap_block,
+        status.i2c.device[SENSOR_BME280].bus_ms, status.i2c.device[SENSOR_SGP30].bus_ms,
+        status.i2c.device[SENSOR_PMS5003].bus_ms, status.i2c.nacks, status.i2c.timeouts,
+        status.i2c.checksums, status.i2c.recoveries);
+}
+
+static void b_table_data(void *) {
+    payload_json_length(data_fields, data_field_count, &sample);
+    payload_json(packet, data_fields, data_field_count, &sample);
+}
+
+static void b_table_status(void *) {
+    payload_json_length(status_fields, status_field_count, &status);
+    payload_json(packet, status_fields, status_field_count, &status);
+}
+
+// Check the serializer output and length against the snprintf template
+static bool matches(bench_fn ref, const PayloadField * fields, size_t count, const void * base) {
+    ref(NULL);
+    size_t len = payload_json_length(fields, count, base);
+    size_t n = payload_json(packet, fields, count, base);
+    return len == n && n == strlen(json) && !memcmp(packet, json, n);
+}
+
+void bench_payload() {
+    bench_header("Payload Serialization (table vs snprintf)");
+    bench_device_init(sn, sizeof(sn));
+    read_sensors(& sample);
+    status.status = "ONLINE";
+    status.sensor = *sensor_status;
+    status.wlan = *wlan_status;
+    memstat_update();
+    status.memory = *memory_status;
+    status.i2c = *i2cbus_status;
+
+    bench_run("data: snprintf template", b_snprintf_data, NULL, 100000);
+    bench_run("data: field table", b_table_data, NULL, 100000);
+    bench_run("status: snprintf template", b_snprintf_status, NULL, 100000);
+    bench_run("status: field table", b_table_status, NULL, 100000);
+
+    // Identical output over a range of readings, including invalid ones
+    uint32_t bad = 0, count = 0;
+    for (int i = 0; i < 2000; i++) {
+        read_sensors(& sample);
+        if (i % 100 == 0) sample.temperature = -(int16_t)i / 10;
+        if (!matches(b_snprintf_data, data_fields, data_field_count, &sample)) bad++;
+        count++;
+    }
+    status.sensor.sgp30_errors = 123456;
+    status.wlan.offline_s = 86400;
+    status.i2c.device[SENSOR_PMS5003].bus_ms = 4000000000U;
+    status.i2c.recoveries = 65535;
+    if (!matches(b_snprintf_status, status_fields, status_field_count, &status)) bad++;
+    count++;
+    bench_report("output mismatches vs snprintf", "%u / %u", bad, count);
+}
@@ -0,0 +1,56 @@
+/** Host Benchmark Suite - Read/Format/Publish Pipeline */
+
+#include "bench.h"
+#include "config.h"
+#include "mqtt.h"
+#include "sensor.h"
+#include "sim/sim_broker.h"
+
+static char sn[16];
+static SensorData sample;
+
+static void b_read_sensors(void *) {
+    read_sensors(& sample);
+}
+
+static void b_publish_data(void *) {
+    publish_data(& sample);
+}
+
+static void b_publish_status(void *) {
+    publish_status("ONLINE");
+}
+
+static void b_connect_mqtt(void *) {
+    connect_mqtt(sn);
+}
+
+static void b_discovery(void *) {
+    haDiscovery(sn, MQTT_RETAIN_DISCOVERY);
+}
+
+static void b_pipeline(void *) {
+    read_sensors(& sample);
+    if (!connect_mqtt(sn)) {
+        publish_data(& sample);
+    }
+}
+
+void bench_pipeline() {
+    bench_header("Pipeline (read -> format -> publish)");
+    bench_device_init(sn, sizeof(sn));
+    read_sensors(& sample);
+
+    bench_run("read_sensors", b_read_sensors, NULL, 2000);
+    bench_run("publish_data", b_publish_data, NULL, 20000);
+    bench_run("publish_status", b_publish_status, NULL, 20000);
+    bench_run("connect_mqtt (connected)", b_connect_mqtt, NULL, 20000);
+    bench_run("haDiscovery", b_discovery, NULL, 1000);
+    bench_run("read + connect + publish", b_pipeline, NULL, 2000);
+
+    // Wire cost of one data message
+    uint64_t bytes = sim_broker.stats.bytes_in;
+    publish_data(& sample);
+    bench_report("data message on the wire", "%llu B",
+        (unsigned long long)(sim_broker.stats.bytes_in - bytes));
+}
@@ -0,0 +1,178 @@
+/** Host Benchmark Suite - Echo Latency Probes */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "bench.h"
+#include "config.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+extern char module_sn[16];
+
+#define PROBE_RATE_HZ       5
+#define PROBE_SECONDS       120
+
+//! Latency Samples of one Device (us)
+typedef struct {
+    std::vector<uint32_t> rtt;          //< Send to reply, as seen by the host
+    std::vector<uint32_t> sched;        //< Waiting for the scheduled tasks before process_mqtt()
+    std::vector<uint32_t> poll;         //< In process_mqtt() before the probe was read
+    std::vector<uint32_t> reply;        //< Building the reply
+    std::vector<uint32_t> network;      //< The rest: network and broker
+} ProbeStats;
+
+// Probes in flight, by id, and the results
+static std::map<uint32_t, uint64_t> sent_us;
+static ProbeStats stats;
+
+// Probe Source
+static char probe_topic[64];
+static uint32_t probe_id;
+static uint64_t probe_end_us;
+
+static void on_publish(int session, const char * topic, const uint8_t * payload, size_t len, bool) {
+    size_t n = strlen(topic);
+    char buf[128];
+    unsigned long id;
+    unsigned poll, reply;
+
+    if (n < 11 || strcmp(topic + n - 11, "/echo/reply") || len >= sizeof(buf)) return;
+    memcpy(buf, payload, len);
+    buf[len] = 0;
+    if (sscanf(buf, "{\"probe\":%lu,\"poll_us\":%u,\"reply_us\":%u}", &id, &poll, &reply) != 3
+        || !sent_us.count(id)) return;
+
+    // The reply pays the round trip. On the device the probe reached the
+    // socket at `arrived`, was read at `read` and process_mqtt() started
+    // polling at `start`: before that it was waiting for the scheduled tasks.
+    uint64_t arrived = sim_broker.arrived(session);
+    uint64_t read = sim_clock_us - reply;
+    uint64_t start = read - poll;
+    uint32_t rtt = (uint32_t)(sim_clock_us - sent_us[id]) + sim_broker.rtt_us;
+    uint32_t device = (uint32_t)(sim_clock_us - arrived);
+    sent_us.erase(id);
+
+    stats.rtt.push_back(rtt);
+    stats.sched.push_back(start > arrived ? (uint32_t)(start - arrived) : 0);
+    stats.poll.push_back((uint32_t)(read - (start > arrived ? start : arrived)));
+    stats.reply.push_back(reply);
+    stats.network.push_back(rtt > device ? rtt - device : 0);
+}
+
+// Clock event: send the next probe wherever the firmware happens to be,
+// including the middle of a task
+static void send_probe() {
+    char msg[32];
+
+    snprintf(msg, sizeof(msg), "probe %u", ++probe_id);
+    sent_us[probe_id] = sim_clock_us;
+    sim_broker.publish(probe_topic, msg);
+
+    if (sim_event_us + 1000000 / PROBE_RATE_HZ < probe_end_us) {
+        sim_event_us += 1000000 / PROBE_RATE_HZ;
+        sim_event = send_probe;
+    }
+}
+
+static void report_samples(const char * name, std::vector<uint32_t> & l) {
+    if (l.empty()) {
+        bench_report(name, "no samples");
+        return;
+    }
+
+    std::sort(l.begin(), l.end());
+    bench_report(name, "p50 %.1f ms, p99 %.1f ms, max %.1f ms",
+        l[l.size() / 2] / 1e3, l[l.size() * 99 / 100] / 1e3, l.back() / 1e3);
+}
+
+// Round-trip histogram in power-of-two millisecond buckets
+static void report_histogram(const std::vector<uint32_t> & l) {
+    uint32_t buckets[12] = { 0 };
+    char line[160];
+    size_t n = 0;
+
+    for (uint32_t us : l) {
+        uint32_t b = 0;
+        while (b < 11 && us >= (1000U << b)) b++;
+        buckets[b]++;
+    }
+
+    line[0] = 0;
+    for (uint32_t b = 0; b < 12 && n < sizeof(line); b++) {
+        if (buckets[b]) {
+            n += snprintf(line + n, sizeof(line) - n, "%s<%u:%u", n ? " " : "", 1U << b, buckets[b]);
+        }
+    }
+    bench_report("  histogram (ms)", "%s", line);
+}
+
+// Send probes to the running firmware at a fixed rate
+static void run_probes(const char * name) {
+    uint32_t lost;
+
+    snprintf(probe_topic, sizeof(probe_topic), "%s/%s/echo", MQTT_TOPIC_BASE, module_sn);
+    sent_us.clear();
+    stats = ProbeStats();
+
+    // Offset from the loop's 1 ms steps, so probes land inside tasks too
+    probe_id = 0;
+    probe_end_us = sim_clock_us + PROBE_SECONDS * 1000000ULL;
+    sim_event_us = sim_clock_us + 317;
+    sim_event = send_probe;
+
+    while (sim_clock_us < probe_end_us) {
+        loop();
+        sim_advance_us(1000);
+    }
+    sim_event = NULL;
+    lost = sent_us.size();
+
+    bench_report(name, "%u probes, %u unanswered", probe_id, lost);
+    report_samples("  round trip", stats.rtt);
+    report_histogram(stats.rtt);
+    report_samples("  device: scheduler wait", stats.sched);
+    report_samples("  device: in process_mqtt", stats.poll);
+    report_samples("  device: reply", stats.reply);
+    report_samples("  network and broker", stats.network);
+}
+
+// Boot the firmware and let it connect (sim_reset() drops the observer)
+static void start_device() {
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    setup();
+    uint64_t end = sim_clock_us + 60 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+}
+
+void bench_probe() {
+    bench_header("Echo Latency Probes (5 per second)");
+
+    start_device();
+    run_probes("baseline");
+
+    // A slow broker shows up outside the device
+    start_device();
+    sim_broker.rtt_us = 150000;
+    run_probes("slow broker (150 ms round trip)");
+
+    // Firmware stall: sensor reads on a slow I2C bus hold up the loop
+    start_device();
+    sim_i2c_clock_hz = 10000;
+    run_probes("slow I2C bus (10 kHz)");
+
+    sim_broker.on_publish = NULL;
+}
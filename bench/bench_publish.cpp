@@ -0,0 +1,203 @@
+/** Host Benchmark Suite - Report-by-Exception Publishing */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <vector>
+
+#include "aggregate.h"
+#include "bench.h"
+#include "config.h"
+#include "report.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+#include "sim/sim_sensors.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+static char sn[16];
+
+//! One Published Sample
+typedef struct {
+    uint32_t t;                 //< Seconds into the trace
+    SensorData data;
+} Publish;
+
+//! Step Event Overlaid on a Trace
+typedef struct {
+    const char * name;
+    uint32_t start;             //< Onset (seconds)
+    uint32_t length;            //< Duration (seconds)
+    int32_t step;               //< Change in SensorData units
+    size_t offset;              //< Field offset in SensorData
+    bool is_int16;
+} TraceEvent;
+
+static const TraceEvent events[] = {
+    { "PM2.5 +40 ug/m3 for 5 min", 600, 300, 40, offsetof(SensorData, pm25), false },
+    { "temperature +1.5 C", 1500, 2100, 150, offsetof(SensorData, temperature), true },
+    { "eCO2 +200 ppm for 10 min", 2400, 600, 200, offsetof(SensorData, eCO2), false },
+};
+
+static int32_t field(const SensorData * d, const TraceEvent * e) {
+    const uint8_t * p = (const uint8_t *)d + e->offset;
+    if (e->is_int16) {
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void add_field(SensorData * d, const TraceEvent * e) {
+    uint8_t * p = (uint8_t *)d + e->offset;
+    if (e->is_int16) {
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        v += e->step;
+        memcpy(p, &v, sizeof(v));
+    } else {
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        v += e->step;
+        memcpy(p, &v, sizeof(v));
+    }
+}
+
+// Record one sample per READ_SENSOR_INTERVAL from the simulated sensors
+static void record(std::vector<SensorData> * trace, uint32_t seconds) {
+    SensorData d;
+    trace->clear();
+    for (uint32_t t = 0; t < seconds; t += READ_SENSOR_INTERVAL) {
+        read_sensors(& d);
+        trace->push_back(d);
+    }
+}
+
+// Replay through the fixed-interval publisher (the window statistic, or the
+// latest sample without PUBLISH_WINDOW_STAT, every PUBLISH_INTERVAL seconds,
+// first publish after the first sample)
+static void replay_fixed(const std::vector<SensorData> & trace, std::vector<Publish> * pubs) {
+    static SampleWindow w;
+    uint32_t next = 0;
+
+    agg_reset(& w);
+    pubs->clear();
+    for (size_t i = 0; i < trace.size(); i++) {
+        uint32_t t = i * READ_SENSOR_INTERVAL;
+        agg_push(& w, & trace[i]);
+        if (t < next) {
+            continue;
+        }
+
+        Publish p = { t, trace[i] };
+#ifdef PUBLISH_WINDOW_STAT
+        agg_result(& w, PUBLISH_WINDOW_STAT, & p.data);
+#endif
+        pubs->push_back(p);
+        next = t + PUBLISH_INTERVAL;
+    }
+}
+
+// Replay through the report-by-exception publisher
+static void replay_rbe(const std::vector<SensorData> & trace, std::vector<Publish> * pubs) {
+    ReportState rs;
+    uint32_t next = 0;
+
+    report_reset(& rs);
+    pubs->clear();
+    for (size_t i = 0; i < trace.size(); i++) {
+        uint32_t t = i * READ_SENSOR_INTERVAL;
+        if (!report_push(& rs, & trace[i]) && t < next) {
+            continue;
+        }
+
+        Publish p = { t, rs.current };
+        pubs->push_back(p);
+        report_sent(& rs);
+        next = t + PUBLISH_HEARTBEAT;
+    }
+}
+
+// Seconds from an event's onset until a publish shows half of its step
+static int32_t latency(const std::vector<SensorData> & trace, const std::vector<Publish> & pubs,
+    const TraceEvent * e)
+{
+    int32_t base = field(& trace[e->start / READ_SENSOR_INTERVAL - 1], e);
+    for (size_t i = 0; i < pubs.size(); i++) {
+        if (pubs[i].t >= e->start && field(& pubs[i].data, e) - base >= e->step / 2) {
+            return pubs[i].t - e->start;
+        }
+    }
+
+    return -1;
+}
+
+static uint32_t data_messages;
+
+static void on_publish(int, const char * topic, const uint8_t *, size_t, bool) {
+    size_t n = strlen(topic);
+    if (n > 5 && !strcmp(topic + n - 5, "/data")) {
+        data_messages++;
+    }
+}
+
+void bench_publish() {
+    std::vector<SensorData> trace;
+    std::vector<Publish> fixed, rbe;
+
+    bench_header("Report-by-Exception Publishing (replayed sensor traces)");
+    bench_device_init(sn, sizeof(sn));
+
+    // A quiet room for an hour, then the same with PM spikes
+    record(& trace, 3600);
+    replay_fixed(trace, & fixed);
+    replay_rbe(trace, & rbe);
+    bench_report("messages/hour, quiet room", "fixed %zu, on change %zu", fixed.size(), rbe.size());
+
+    sim_pms5003.spike_pct = 5;
+    record(& trace, 3600);
+    sim_pms5003.spike_pct = 0;
+    replay_fixed(trace, & fixed);
+    replay_rbe(trace, & rbe);
+    bench_report("messages/hour, 5% PM spikes", "fixed %zu, on change %zu", fixed.size(), rbe.size());
+
+    // An hour with step events overlaid on the recorded readings
+    record(& trace, 3600);
+    for (size_t e = 0; e < sizeof(events) / sizeof(events[0]); e++) {
+        for (uint32_t t = events[e].start; t < events[e].start + events[e].length; t += READ_SENSOR_INTERVAL) {
+            add_field(& trace[t / READ_SENSOR_INTERVAL], & events[e]);
+        }
+    }
+    replay_fixed(trace, & fixed);
+    replay_rbe(trace, & rbe);
+    bench_report("messages/hour, with events", "fixed %zu, on change %zu", fixed.size(), rbe.size());
+    for (size_t e = 0; e < sizeof(events) / sizeof(events[0]); e++) {
+        bench_report(events[e].name, "detected after: fixed %d s, on change %d s",
+            latency(trace, fixed, & events[e]), latency(trace, rbe, & events[e]));
+    }
+
+    // The firmware as configured, end to end
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    setup();
+    uint64_t end = sim_clock_us + 3600 * 1000000ULL;
+    data_messages = 0;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+    sim_broker.on_publish = NULL;
+
+#ifdef PUBLISH_ON_CHANGE
+    bench_report("firmware data messages, 1 h", "%u (on change)", data_messages);
+#else
+    bench_report("firmware data messages, 1 h", "%u (fixed interval)", data_messages);
+#endif
+}
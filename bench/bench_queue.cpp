@@ -0,0 +1,204 @@
+/** Host Benchmark Suite - Offline Queue */
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <set>
+
+#include "bench.h"
+#include "config.h"
+#include "queue.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+#include "sim/sim_flash.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+static SensorData sample;
+static uint32_t pushed;
+
+static void b_push(void *) {
+    sample.pm25 = (uint16_t)pushed;
+    queue_push(&sample, ++pushed);
+}
+
+static void b_peek_pop(void *) {
+    if (!queue_peek(&sample, NULL)) {
+        queue_pop();
+    }
+}
+
+// Messages seen by the broker, by topic
+static uint32_t rx_data, rx_history, burst, max_burst;
+static uint64_t last_history_us, first_history_us;
+static std::set<uint32_t> history_ts;
+
+static void on_publish(int, const char * topic, const uint8_t * payload, size_t len, bool) {
+    size_t n = strlen(topic);
+    if (n > 5 && !strcmp(topic + n - 5, "/data")) {
+        rx_data++;
+    } else if (n > 8 && !strcmp(topic + n - 8, "/history")) {
+        if (!rx_history) first_history_us = sim_clock_us;
+        burst = (sim_clock_us - last_history_us < 100000) ? burst + 1 : 1;
+        if (burst > max_burst) max_burst = burst;
+        last_history_us = sim_clock_us;
+        rx_history++;
+
+        // Distinct samples, by timestamp
+        char buf[256];
+        const char * ts;
+        len = len < sizeof(buf) - 1 ? len : sizeof(buf) - 1;
+        memcpy(buf, payload, len);
+        buf[len] = 0;
+        if ((ts = strstr(buf, "\"ts\":"))) {
+            history_ts.insert(strtoul(ts + 5, NULL, 10));
+        }
+    }
+}
+
+// Run the firmware main loop for a stretch of simulated time
+static void run_for(uint64_t seconds) {
+    uint64_t end = sim_clock_us + seconds * 1000000;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+}
+
+// Push records while cutting power at random points, rebooting after each cut
+static void crash_test(uint32_t cuts, uint32_t * lost, uint32_t * bad) {
+    uint32_t next = 1, expect = 1;
+
+    sim_reset(7);
+    queue_init();
+    memset(&sample, 0, sizeof(sample));
+
+    for (uint32_t c = 0; c < cuts; c++) {
+        uint32_t acked = 0;
+
+        sim_flash.cut_after = sim_rand() % 2000;
+        while (sim_flash.powered) {
+            sample.tvoc = (uint16_t)next;
+            if (!queue_push(&sample, next)) acked++;
+            next++;
+        }
+
+        // Reboot: every acknowledged sample must still be queued
+        sim_flash.power_on();
+        queue_init();
+        if (queue_status->pending < acked) {
+            *lost += acked - queue_status->pending;
+        }
+
+        // Replay everything, checking order and contents
+        uint32_t ts;
+        while (!queue_peek(&sample, &ts)) {
+            if (ts < expect || sample.tvoc != (uint16_t)ts) (*bad)++;
+            expect = ts + 1;
+            queue_pop();
+        }
+        expect = next;
+    }
+}
+
+void bench_queue() {
+    bench_header("Offline Queue (flash ring)");
+
+    // Raw queue cost and flash wear
+    sim_reset();
+    queue_init();
+    memset(&sample, 0, sizeof(sample));
+    pushed = 0;
+
+    const uint32_t n = 1000;
+    bench_run("queue_push", b_push, NULL, n);
+    SimFlashStats push_stats = sim_flash.stats;
+    bench_run("queue_peek + queue_pop", b_peek_pop, NULL, queue_status->pending);
+
+    uint64_t logical = (uint64_t)pushed * (sizeof(SensorData) + 4);
+    uint64_t physical = sim_flash.stats.bytes_written + (uint64_t)sim_flash.stats.erases * 4096;
+    bench_report("capacity", "%u samples in %d sectors", queue_status->capacity, QUEUE_SECTORS);
+    bench_report("flash bytes programmed per sample", "%.1f B",
+        (double)sim_flash.stats.bytes_written / pushed);
+    bench_report("sector erases per 1000 samples", "%.1f",
+        1000.0 * push_stats.erases / pushed);
+    bench_report("write amplification (incl. erase)", "%.2fx", (double)physical / logical);
+
+    // Overfill by half the capacity: the oldest sectors are recycled
+    uint32_t over = queue_status->capacity * 3 / 2;
+    for (uint32_t i = 0; i < over; i++) b_push(NULL);
+    bench_report("overfilled: pending / dropped", "%u / %u of %u",
+        queue_status->pending, queue_status->dropped, over);
+
+    // Crash safety
+    uint32_t lost = 0, bad = 0;
+    crash_test(200, &lost, &bad);
+    bench_report("power cuts: acked samples lost", "%u (200 cuts)", lost);
+    bench_report("power cuts: bad replays", "%u", bad);
+
+    // Firmware outage and replay through the real main loop
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    rx_data = rx_history = burst = max_burst = 0;
+    setup();
+    run_for(5 * 60);
+
+    // Count only what the outage queues (a sample taken before the first
+    // connection at boot is replayed too)
+    rx_data = rx_history = burst = max_burst = 0;
+    sim_broker.online = false;
+    sim_broker.drop_all();
+    uint64_t outage = sim_clock_us;
+    run_for(30 * 60);
+    uint32_t queued = queue_status->pending;
+    sim_broker.online = true;
+    bench_report("outage (simulated)", "%.0f min, %u samples queued",
+        (sim_clock_us - outage) / 60e6, queued);
+
+    uint64_t restored = sim_clock_us;
+    while (queue_status->pending && sim_clock_us - restored < 3600ULL * 1000000) {
+        run_for(1);
+    }
+    double replay_s = (last_history_us - first_history_us) / 1e6;
+    bench_report("replayed on history topic", "%u / %u", rx_history, queued);
+    bench_report("replay time", "%.1f s after reconnect", (last_history_us - restored) / 1e6);
+    bench_report("replay throughput", "%.1f samples/s (burst <= %u)",
+        replay_s > 0 ? (rx_history - 1) / replay_s : 0.0, max_burst);
+    bench_report("live samples during replay", "%u on data topic", rx_data);
+
+    // The link goes half-open mid-replay: the burst in flight gets no
+    // PUBACK, so it stays queued and is sent again on the next session
+    sim_broker.online = false;
+    sim_broker.drop_all();
+    run_for(30 * 60);
+    queued = queue_status->pending;
+    sim_broker.online = true;
+    uint32_t last_ts = SIM_EPOCH + (uint32_t)(sim_clock_us / 1000000);
+    history_ts.clear();
+    rx_history = 0;
+    restored = sim_clock_us;
+    while (!rx_history && sim_clock_us - restored < 3600ULL * 1000000) {
+        run_for(1);
+    }
+    sim_broker.stalled = true;
+    run_for(60);
+    sim_broker.stalled = false;
+    sim_broker.drop_all();
+    restored = sim_clock_us;
+    while (queue_status->pending && sim_clock_us - restored < 3600ULL * 1000000) {
+        run_for(1);
+    }
+
+    uint32_t replayed = 0;
+    for (uint32_t ts : history_ts) {
+        if (ts <= last_ts) replayed++;
+    }
+    bench_report("replayed across a stalled link", "%u / %u (%u sent twice)",
+        replayed, queued, rx_history - (uint32_t)history_ts.size());
+
+    sim_broker.on_publish = NULL;
+}
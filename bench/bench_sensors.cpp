@@ -0,0 +1,163 @@
+/** Host Benchmark Suite - Split-Phase Sensor Acquisition */
+
+#include <Arduino.h>
+
+#include "TaskScheduler.h"
+
+#include "bench.h"
+#include "config.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_sensors.h"
+
+// Firmware entry points and tasks (src/main.cpp)
+void setup();
+void loop();
+
+extern Task tReadBME;
+extern Task tReadSGP;
+extern Task tReadPMS;
+extern Task tCollectData;
+extern Task tSample;
+extern Task tPublish;
+extern Task tReplay;
+
+//! I2C Traffic over a Run
+typedef struct {
+    uint64_t bus_us;            //< Bus time
+    uint32_t transactions;
+    uint64_t worst_tick_us;     //< Most bus time in one scheduler tick
+    uint32_t bme, sgp, pms;     //< Reads of each sensor
+} BusTraffic;
+
+static void traffic_start(BusTraffic * t) {
+    t->bus_us = sim_i2c_stats.bus_us;
+    t->transactions = sim_i2c_stats.transactions;
+    t->worst_tick_us = 0;
+    t->bme = sim_bme280.measurements;
+    t->sgp = sim_sgp30.measurements;
+    t->pms = sim_pms5003.frames;
+}
+
+static void traffic_tick(BusTraffic * t, uint64_t before_us) {
+    uint64_t us = sim_i2c_stats.bus_us - before_us;
+    if (us > t->worst_tick_us) {
+        t->worst_tick_us = us;
+    }
+}
+
+static void traffic_end(BusTraffic * t) {
+    t->bus_us = sim_i2c_stats.bus_us - t->bus_us;
+    t->transactions = sim_i2c_stats.transactions - t->transactions;
+    t->bme = sim_bme280.measurements - t->bme;
+    t->sgp = sim_sgp30.measurements - t->sgp;
+    t->pms = sim_pms5003.frames - t->pms;
+}
+
+static void report_traffic(const char * name, const BusTraffic * t) {
+    bench_report(name, "%.1f ms bus/min, %u xfers, worst tick %.2f ms, reads %u/%u/%u",
+        t->bus_us / 1e3, t->transactions, t->worst_tick_us / 1e3, t->bme, t->sgp, t->pms);
+}
+
+// The previous schedule: every sensor started together each
+// READ_SENSOR_INTERVAL and polled as one until all were collected
+static void lockstep_minute(BusTraffic * t) {
+    SensorData d;
+    bool reading = false;
+
+    traffic_start(t);
+    for (uint32_t ms = 0; ms < 60000; ms++) {
+        uint64_t before = sim_i2c_stats.bus_us;
+        if (ms % (READ_SENSOR_INTERVAL * 1000) == 0 && !start_sensors()) {
+            reading = true;
+        } else if (reading && ms % SENSOR_POLL_INTERVAL == 0) {
+            reading = poll_sensors(& d) == SENSOR_PENDING;
+        }
+        traffic_tick(t, before);
+        sim_advance_us(1000);
+    }
+    traffic_end(t);
+}
+
+// The firmware for a minute, one scheduler pass per millisecond
+static void firmware_minute(BusTraffic * t) {
+    traffic_start(t);
+    uint64_t end = sim_clock_us + 60 * 1000000ULL;
+    while (sim_clock_us < end) {
+        uint64_t before = sim_i2c_stats.bus_us;
+        loop();
+        traffic_tick(t, before);
+        sim_advance_us(1000);
+    }
+    traffic_end(t);
+}
+
+void bench_sensors() {
+    BusTraffic lockstep, staggered;
+    char sn[16];
+
+    bench_header("Sensor Acquisition (worst-case task callback)");
+
+    // I2C traffic of the previous lockstep schedule on a quiet device
+    sim_reset();
+    setup_sensors(sn, sizeof(sn));
+    lockstep_minute(& lockstep);
+
+    sim_reset();
+    setup();
+
+    // Let discovery and the first publish pass, then measure steady state
+    uint64_t end = sim_clock_us + 60 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+
+    tReadBME.resetMaxRunMicros();
+    tReadSGP.resetMaxRunMicros();
+    tReadPMS.resetMaxRunMicros();
+    tCollectData.resetMaxRunMicros();
+    tSample.resetMaxRunMicros();
+    tPublish.resetMaxRunMicros();
+    tReplay.resetMaxRunMicros();
+
+    firmware_minute(& staggered);
+    end = sim_clock_us + 9 * 60 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+
+    bench_report("tReadSGP/PMS/BME (start reads)", "max %.2f / %.2f / %.2f ms",
+        tReadSGP.getMaxRunMicros() / 1e3, tReadPMS.getMaxRunMicros() / 1e3, tReadBME.getMaxRunMicros() / 1e3);
+    bench_report("tCollectData (poll and collect)", "max %.2f ms", tCollectData.getMaxRunMicros() / 1e3);
+    bench_report("tSample", "max %.2f ms", tSample.getMaxRunMicros() / 1e3);
+    bench_report("tPublish", "max %.2f ms", tPublish.getMaxRunMicros() / 1e3);
+    bench_report("tReplay", "max %.2f ms", tReplay.getMaxRunMicros() / 1e3);
+
+    report_traffic("I2C, all sensors at 1 Hz together", & lockstep);
+    report_traffic("I2C, per-sensor schedules", & staggered);
+    bench_report("I2C bus time saved", "%.1f ms/min (%.0f%%)",
+        ((double)lockstep.bus_us - staggered.bus_us) / 1e3,
+        100.0 * ((double)lockstep.bus_us - staggered.bus_us) / lockstep.bus_us);
+
+    // A failing particle sensor leaves the other sensors' channels current
+    uint32_t sgp = sim_sgp30.measurements;
+    uint32_t bme = sim_bme280.measurements;
+    sim_pms5003.fail_pct = 100;
+    end = sim_clock_us + 30 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+    bench_report("PMS5003 failing for 30 s", "stale mask 0x%x, SGP30/BME280 reads %u/%u",
+        sensor_status->stale, sim_sgp30.measurements - sgp, sim_bme280.measurements - bme);
+
+    sim_pms5003.fail_pct = 0;
+    end = sim_clock_us + 5 * 1000000ULL;
+    while (sim_clock_us < end) {
+        loop();
+        sim_advance_us(1000);
+    }
+    bench_report("PMS5003 recovered", "stale mask 0x%x", sensor_status->stale);
+}
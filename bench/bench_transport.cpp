@@ -0,0 +1,170 @@
+/** Host Benchmark Suite - MQTT Transport */
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <string.h>
+
+#include <string>
+
+#include "Adafruit_MQTT_Client.h"
+#include "bench.h"
+#include "config.h"
+#include "discovery.h"
+#include "mqtt_client.h"
+#include "payload.h"
+#include "sensor.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+#define TRANSPORT_MESSAGES  200
+#define TRANSPORT_LARGE     2000    // Payload bytes of the oversized message
+
+// Assumed device cost of one socket write (lwIP segment and TLS record)
+#define TRANSPORT_WRITE_US  150
+
+// The two clients, each on its own broker session
+static WiFiClient ada_net, own_net;
+static Adafruit_MQTT_Client * ada;
+static MQTT_Client * own;
+
+static char sn[16];
+static char topic[40], cfg_topic[80];
+static SensorData sample;
+static HistoryPayload history;
+static DiscoveryConfig cfg;
+
+// Last message the broker received
+static std::string last;
+
+static void on_publish(int, const char *, const uint8_t * payload, size_t len, bool) {
+    last.assign((const char *)payload, len);
+}
+
+// Adafruit client: the payload is serialized into a buffer, then copied into
+// the library's packet buffer
+static bool ada_fields(const PayloadField * fields, size_t count, const void * base, uint8_t qos) {
+    uint8_t buf[MAXBUFFERSIZE];
+    size_t n = payload_json(buf, fields, count, base);
+    return ada->publish(topic, buf, n, qos);
+}
+
+static void b_ada_data(void *) {
+    ada_fields(data_fields, data_field_count, & sample, 0);
+}
+
+static void b_own_data(void *) {
+    own->publishFields(topic, data_fields, data_field_count, & sample);
+}
+
+static void b_ada_discovery(void *) {
+    uint8_t buf[MAXBUFFERSIZE];
+    size_t n = discovery_config(buf, sizeof(buf), & cfg);
+    ada->publish(cfg_topic, buf, n);
+}
+
+static void b_own_discovery(void *) {
+    own->publishStream(cfg_topic, discovery_config_stream, & cfg);
+}
+
+// Simulated time to publish and have acknowledged a run of history messages
+static double ada_rate(uint8_t qos) {
+    uint64_t start = sim_clock_us;
+    for (uint32_t i = 0; i < TRANSPORT_MESSAGES; i++) {
+        ada_fields(history_fields, history_field_count, & history, qos);
+    }
+    return TRANSPORT_MESSAGES / ((sim_clock_us - start) / 1e6);
+}
+
+static double own_rate(uint8_t qos) {
+    uint64_t start = sim_clock_us;
+    for (uint32_t i = 0; i < TRANSPORT_MESSAGES; i++) {
+        own->publishFields(topic, history_fields, history_field_count, & history, PAYLOAD_JSON, false, qos);
+    }
+    own->drain(MQTT_ACK_TIMEOUT_MS);
+    return TRANSPORT_MESSAGES / ((sim_clock_us - start) / 1e6);
+}
+
+// Socket writes per message
+static double segments(bench_fn fn) {
+    uint32_t before = sim_broker.stats.segments;
+    for (uint32_t i = 0; i < TRANSPORT_MESSAGES; i++) {
+        fn(NULL);
+    }
+    return (sim_broker.stats.segments - before) / (double)TRANSPORT_MESSAGES;
+}
+
+void bench_transport() {
+    char name[64];
+
+    bench_header("MQTT Transport (Adafruit client vs MQTT_Client)");
+
+    bench_device_init(sn, sizeof(sn));
+    read_sensors(& sample);
+    history.timestamp = SIM_EPOCH;
+    history.data = sample;
+    snprintf(topic, sizeof(topic), "%s/%s/bench", MQTT_TOPIC_BASE, sn);
+    cfg.module_sn = sn;
+    cfg.state_topic = topic;
+    cfg.field = & data_fields[0];
+    discovery_topic(cfg_topic, sizeof(cfg_topic), sn, cfg.field);
+
+    // Both clients on their own sessions with the same broker
+    static Adafruit_MQTT_Client ada_client(& ada_net, mqtt_host, mqtt_port, "bench-ada");
+    static MQTT_Client own_client(& own_net, mqtt_host, mqtt_port, "bench-own");
+    ada = & ada_client;
+    own = & own_client;
+    ada->connect();
+    own->beginConnect();
+    while (own->pollConnect() == MQTT_CONNECT_PENDING) {
+        delay(1);
+    }
+
+    // Same bytes on the wire
+    sim_broker.on_publish = on_publish;
+    b_ada_data(NULL);
+    std::string a = last;
+    b_own_data(NULL);
+    bool same = a == last;
+    b_ada_discovery(NULL);
+    a = last;
+    b_own_discovery(NULL);
+    same = same && a == last;
+    bench_report("data and discovery payloads", "%s", same ? "identical" : "DIFFERENT");
+    sim_broker.on_publish = NULL;
+
+    // Host cost, and device time with a cost per socket write
+    sim_broker.write_us = TRANSPORT_WRITE_US;
+    bench_run("Adafruit publish, data", b_ada_data, NULL, 100000);
+    bench_run("MQTT_Client publishFields, data", b_own_data, NULL, 100000);
+    bench_run("Adafruit publish, discovery", b_ada_discovery, NULL, 100000);
+    bench_run("MQTT_Client publishStream, discovery", b_own_discovery, NULL, 100000);
+    bench_report("socket writes per discovery message", "Adafruit %.1f, MQTT_Client %.1f",
+        segments(b_ada_discovery), segments(b_own_discovery));
+
+    // Larger than any buffer on the device
+    static uint8_t large[TRANSPORT_LARGE];
+    memset(large, 'x', sizeof(large));
+    uint32_t before = sim_broker.stats.publishes;
+    ada->publish(topic, large, sizeof(large));
+    uint32_t ada_sent = sim_broker.stats.publishes - before;
+    own->publish(topic, large, sizeof(large));
+    snprintf(name, sizeof(name), "%u B payload delivered", TRANSPORT_LARGE);
+    bench_report(name, "Adafruit %s, MQTT_Client %s", ada_sent ? "yes" : "no",
+        sim_broker.stats.publishes - before > ada_sent ? "yes" : "no");
+
+    // Simulated throughput of history messages over a 20 ms round trip
+    snprintf(name, sizeof(name), "QoS 0, %u messages", TRANSPORT_MESSAGES);
+    bench_report(name, "Adafruit %.0f msg/s, MQTT_Client %.0f msg/s", ada_rate(0), own_rate(0));
+    bench_report("QoS 1, Adafruit, one at a time", "%.1f msg/s", ada_rate(1));
+    for (uint8_t w = 1; w <= MQTT_INFLIGHT; w *= 2) {
+        own->setWindow(w);
+        snprintf(name, sizeof(name), "QoS 1, MQTT_Client window %u", w);
+        double rate = own_rate(1);
+        bench_report(name, "%.1f msg/s, %u unacknowledged", rate, own->inflight());
+    }
+    own->setWindow(MQTT_INFLIGHT);
+    sim_broker.write_us = 0;
+
+    ada->disconnect();
+    own->disconnect();
+}
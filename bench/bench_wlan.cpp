@@ -0,0 +1,93 @@
+/** Host Benchmark Suite - WiFi Link Supervisor */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include <string>
+
+#include "bench.h"
+#include "mqtt.h"
+#include "queue.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+#include "wlan.h"
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+// Last status message seen by the broker
+static std::string last_status;
+
+static void on_publish(int, const char * topic, const uint8_t * payload, size_t len, bool) {
+    size_t n = strlen(topic);
+    if (n > 7 && !strcmp(topic + n - 7, "/status")) {
+        last_status.assign((const char *)payload, len);
+    }
+}
+
+// Run the firmware main loop until a condition holds or time runs out,
+// returning the elapsed time and the longest single pass
+static uint64_t run_until(bool (*done)(), uint64_t seconds, uint64_t * max_loop_us) {
+    uint64_t start = sim_clock_us;
+    uint64_t end = start + seconds * 1000000;
+
+    while (sim_clock_us < end && !(done && done())) {
+        uint64_t t0 = sim_clock_us;
+        loop();
+        if (sim_clock_us - t0 > *max_loop_us) *max_loop_us = sim_clock_us - t0;
+        sim_advance_us(1000);
+    }
+
+    return sim_clock_us - start;
+}
+
+static bool wlan_up() { return connected_wlan(); }
+static bool mqtt_up() { return connected_mqtt(); }
+
+void bench_wlan() {
+    uint64_t max_us = 0;
+
+    bench_header("WiFi Link Supervisor");
+
+    // Boot with the access point down: setup() must return and sampling run
+    sim_reset();
+    sim_broker.on_publish = on_publish;
+    sim_wifi_ap_up = false;
+
+    uint64_t t0 = sim_clock_us;
+    setup();
+    bench_report("setup() with access point down", "%.1f s", (sim_clock_us - t0) / 1e6);
+
+    uint32_t queued = queue_status->pending;
+    run_until(NULL, 2 * 60, &max_us);
+    bench_report("samples queued, 2 min without AP", "%u", queue_status->pending - queued);
+    bench_report("loop latency without AP", "max %.1f ms", max_us / 1e3);
+
+    sim_wifi_ap_up = true;
+    uint64_t wifi_s = run_until(wlan_up, 60, &max_us);
+    uint64_t mqtt_s = wifi_s + run_until(mqtt_up, 60, &max_us);
+    bench_report("AP returns: WiFi / MQTT up after", "%.1f s / %.1f s", wifi_s / 1e6, mqtt_s / 1e6);
+
+    // Lose the access point at runtime for five minutes
+    run_until(NULL, 60, &max_us);
+    uint32_t offline_s = wlan_status->offline_s;
+
+    max_us = 0;
+    sim_wifi_ap_up = false;
+    run_until(NULL, 5 * 60, &max_us);
+    bench_report("loop latency, AP lost 5 min", "max %.1f ms", max_us / 1e3);
+
+    sim_wifi_ap_up = true;
+    wifi_s = run_until(wlan_up, 5 * 60, &max_us);
+    mqtt_s = wifi_s + run_until(mqtt_up, 60, &max_us);
+    bench_report("AP returns: WiFi / MQTT up after", "%.1f s / %.1f s", wifi_s / 1e6, mqtt_s / 1e6);
+    bench_report("reconnects / offline time", "%u / %u s (+%u s)",
+        wlan_status->reconnects, wlan_status->offline_s, wlan_status->offline_s - offline_s);
+
+    publish_status("ONLINE");
+    run_until(NULL, 1, &max_us);
+    bench_report("status message", "%s", last_status.c_str());
+
+    sim_broker.on_publish = NULL;
+}
@@ -0,0 +1,101 @@
+/** Air Quality Sensor - Sample Window Aggregation */
+
+#ifndef AGGREGATE_H__
+#define AGGREGATE_H__
+
+#include <stdint.h>
+
+#include "config.h"
+#include "sensor.h"
+
+//! Window Statistics
+#define AGG_MEAN    0
+#define AGG_MEDIAN  1
+#define AGG_MIN     2
+#define AGG_MAX     3
+
+//! Aggregated Channels (one per SensorData field)
+#define AGG_CHANNEL(ch, ...)    AGG_##ch,
+enum {
+    SENSOR_CHANNELS(AGG_CHANNEL)
+    AGG_CHANNELS
+};
+
+#if AGGREGATE_WINDOW < 1 || AGGREGATE_WINDOW > 64
+#error "AGGREGATE_WINDOW must be between 1 and 64 samples"
+#endif
+
+//! Per-Channel Window Statistics (in channel units)
+typedef struct {
+    int32_t mean;
+    int32_t median;
+    int32_t min;
+    int32_t max;
+    uint32_t stddev;
+} AggStats;
+
+//! Sliding Sample Window
+typedef struct {
+    // Samples in arrival order (ring buffer)
+    int32_t ring[AGGREGATE_WINDOW][AGG_CHANNELS];
+
+    // Valid samples ordered by value, per channel
+    int32_t sorted[AGG_CHANNELS][AGGREGATE_WINDOW];
+
+    // Running sums of (x - ref) and (x - ref)^2 over the valid samples
+    int32_t ref[AGG_CHANNELS];
+    int64_t sum[AGG_CHANNELS];
+    int64_t sumsq[AGG_CHANNELS];
+
+    // Valid samples per channel
+    uint8_t valid[AGG_CHANNELS];
+
+    uint8_t head;
+    uint8_t count;
+} SampleWindow;
+
+/**
+ * Reset a Sample Window
+ * @param [out] window sample window
+ */
+void agg_reset(SampleWindow *);
+
+/**
+ * Add a Sample to the Window
+ * @param [in,out] window sample window
+ * @param [in] data sensor sample
+ *
+ * Once the window is full the oldest sample is evicted. Sums are updated in
+ * constant time; the per-channel ordered copies are kept sorted with a binary
+ * search and a short move, so min, max and median read in constant time.
+ * Invalid BME280 readings (SENSOR_T_INVALID etc.) take a slot in the window
+ * but are left out of that channel's sums and ordered copy.
+ */
+void agg_push(SampleWindow *, const SensorData *);
+
+/**
+ * Get Statistics for one Channel
+ * @param [in] window sample window
+ * @param [in] channel channel index (AGG_T ... AGG_PC100)
+ * @param [out] stats channel statistics
+ * @return zero on success, or non-zero if the channel has no valid samples
+ *
+ * Values use the same units as SensorData: temperature in 0.01 °C, pressure
+ * in 1/256 Pa and humidity in 1/1024 %RH. A channel with no valid samples
+ * reports its invalid sentinel for every statistic and a zero deviation.
+ */
+int agg_stats(const SampleWindow *, uint8_t, AggStats *);
+
+/**
+ * Reduce the Window to a Single Sample
+ * @param [in] window sample window
+ * @param [in] statistic one of AGG_MEAN, AGG_MEDIAN, AGG_MIN or AGG_MAX
+ * @param [out] data sensor data holding the statistic for every channel
+ * @return zero on success, or non-zero if the window is empty
+ *
+ * Channels with no valid samples in the window are set to their invalid
+ * sentinel.
+ */
+int agg_result(const SampleWindow *, uint8_t, SensorData *);
+
+#endif // AGGREGATE_H__
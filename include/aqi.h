@@ -0,0 +1,105 @@
+/** Air Quality Sensor - EPA NowCast and Air Quality Index */
+
+#ifndef AQI_H__
+#define AQI_H__
+
+#include <stdint.h>
+
+#include "sensor.h"
+
+//! The aqi Topic is Published (it needs the PMS5003, and is left out with
+//! LOW_POWER)
+#if !defined(LOW_POWER) && !defined(NO_PMS5003)
+#define AQI_TOPIC
+#endif
+
+//! Hours of History in the NowCast
+#define NOWCAST_HOURS       12
+
+//! NowCast Channels
+#define NOWCAST_PM25        0
+#define NOWCAST_PM100       1
+#define NOWCAST_CHANNELS    2
+
+//! Hourly Average Not Available
+#define NOWCAST_INVALID     UINT16_MAX
+
+//! AQI Categories
+#define AQI_GOOD            0
+#define AQI_MODERATE        1
+#define AQI_SENSITIVE       2   //< Unhealthy for sensitive groups
+#define AQI_UNHEALTHY       3
+#define AQI_VERY_UNHEALTHY  4
+#define AQI_HAZARDOUS       5
+
+//! NowCast Engine State (hourly averages, newest last)
+typedef struct {
+    uint32_t hour;              //< Hour of the open bucket
+    uint32_t sum[NOWCAST_CHANNELS];     //< Open bucket sums (µg/m³)
+    uint16_t count;             //< Samples in the open bucket
+    uint8_t newest;             //< Ring index of the newest closed hour
+    uint8_t started;            //< A bucket is open
+    uint16_t avg[NOWCAST_CHANNELS][NOWCAST_HOURS];  //< Hourly averages (0.1 µg/m³)
+} NowCastState;
+
+//! NowCast and AQI Status (the aqi topic)
+typedef struct {
+    uint8_t valid;              //< Enough hours for a NowCast
+    uint8_t category;           //< AQI_GOOD ... AQI_HAZARDOUS
+    uint16_t pm25;              //< PM2.5 NowCast (0.1 µg/m³)
+    uint16_t pm100;             //< PM10 NowCast (0.1 µg/m³, truncated to 1 µg/m³)
+    uint16_t aqi;               //< Air Quality Index (0 - 500)
+    uint32_t hour;              //< Last closed hour
+    const char * category_name;
+    const char * pollutant;     //< Pollutant setting the AQI ("pm25" or "pm100")
+} AqiStatus;
+
+//! Global NowCast and AQI Status
+extern const AqiStatus * aqi_status;
+
+/** Reset the NowCast History */
+void aqi_reset();
+
+/**
+ * Add a Sample to the NowCast
+ * @param [in] data sensor sample (PM2.5 and PM10 are used)
+ * @param [in] hour sample time in hours (since the epoch, or since boot)
+ * @return true if an hour was closed and the NowCast and AQI were updated
+ *
+ * Samples are summed into the open hour in constant time. When a sample
+ * arrives in a later hour the open hour's average is kept, skipped hours
+ * are marked missing, and the NowCast is recomputed from the last
+ * NOWCAST_HOURS hourly averages with the EPA weighting (minimum weight
+ * factor 0.5). The NowCast needs two of the three most recent hours. A jump
+ * back in time or of more than NOWCAST_HOURS starts the history again.
+ */
+bool aqi_update(const SensorData *, uint32_t);
+
+/**
+ * Compute a NowCast from Hourly Averages
+ * @param [in] avg hourly averages in 0.1 µg/m³ (newest first, or
+ *   NOWCAST_INVALID if missing)
+ * @param [in] hours number of hours
+ * @return NowCast in 0.1 µg/m³, or NOWCAST_INVALID if two of the three most
+ *   recent hours are missing
+ */
+uint16_t nowcast(const uint16_t *, uint8_t);
+
+/**
+ * Get the AQI for a Concentration
+ * @param [in] channel NOWCAST_PM25 or NOWCAST_PM100
+ * @param [in] c concentration in 0.1 µg/m³ (already truncated)
+ * @return AQI (0 - 500; higher concentrations report 500)
+ *
+ * Uses the EPA breakpoints as revised in 2024.
+ */
+uint16_t aqi_index(uint8_t, uint16_t);
+
+/**
+ * Get the AQI Category for an Index
+ * @param [in] aqi Air Quality Index
+ * @return AQI_GOOD ... AQI_HAZARDOUS
+ */
+uint8_t aqi_category(uint16_t);
+
+#endif // AQI_H__
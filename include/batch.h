@@ -0,0 +1,93 @@
+/** Air Quality Sensor - Batched Columnar Sample Encoding */
+
+#ifndef BATCH_H__
+#define BATCH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "sensor.h"
+
+//! Batch Encoding Format Version (first byte of every batch)
+#define BATCH_VERSION   1
+
+//! Most Samples Held in one Batch
+#define BATCH_MAX       64
+
+#if defined(PUBLISH_BATCH) && (PUBLISH_BATCH < 2 || PUBLISH_BATCH > BATCH_MAX)
+#error "PUBLISH_BATCH must be between 2 and 64 samples"
+#endif
+
+//! Samples Waiting to be Sent as a Batch
+typedef struct {
+    SensorData samples[BATCH_MAX];
+    uint32_t ms[BATCH_MAX];     //< millis() when each sample was read
+    uint8_t count;
+    uint32_t dropped;           //< Samples discarded while the batch was full
+} SampleBatch;
+
+/**
+ * Reset a Batch
+ * @param [out] batch sample batch
+ */
+void batch_reset(SampleBatch *);
+
+/**
+ * Add a Sample to a Batch
+ * @param [in,out] batch sample batch
+ * @param [in] data sensor sample
+ * @param [in] ms millis() when the sample was read
+ *
+ * A full batch discards its oldest sample, so a batch that could not be
+ * sent keeps the most recent BATCH_MAX samples.
+ */
+void batch_push(SampleBatch *, const SensorData *, uint32_t);
+
+/**
+ * Remove Samples from the Front of a Batch
+ * @param [in,out] batch sample batch
+ * @param [in] count number of samples to remove
+ */
+void batch_drop(SampleBatch *, uint8_t);
+
+/**
+ * Encode the Start of a Batch
+ * @param [out] out output buffer
+ * @param [in] len output buffer size
+ * @param [in] batch sample batch
+ * @param [in] base_ms epoch time of the first sample in ms, or 0 if unknown
+ * @param [in] interval_ms nominal time between samples in ms
+ * @param [out] encoded number of samples encoded
+ * @return bytes written, or zero if not even one sample fit
+ *
+ * Encodes as many samples from the front of the batch as fit in the buffer.
+ * The layout is columnar, with all integers as LEB128 varints and signed
+ * values zig-zag encoded:
+ *
+ *   version, sample count, channel count, base_ms, interval_ms
+ *   (count - 1) x zig-zag(time step - interval_ms)
+ *   per channel, in data_fields order:
+ *     count x zig-zag(value - previous value), the first from zero
+ *
+ * Slowly changing channels therefore cost one byte per sample. Invalid
+ * readings keep their sentinel values and round-trip exactly.
+ */
+size_t batch_encode(uint8_t *, size_t, const SampleBatch *, uint64_t, uint32_t, uint8_t *);
+
+/**
+ * Decode a Batch
+ * @param [in] in encoded batch
+ * @param [in] len encoded batch size
+ * @param [out] samples decoded samples
+ * @param [out] times sample times in ms (epoch if base_ms was sent)
+ * @param [in] max room in samples and times
+ * @return number of samples decoded, or -1 if the batch is malformed, of an
+ *   unknown version, or holds more than max samples
+ *
+ * The reference decoder for consumers of the batch topic; it is not used
+ * by the firmware itself.
+ */
+int batch_decode(const uint8_t *, size_t, SensorData *, uint64_t *, uint8_t);
+
+#endif // BATCH_H__
@@ -0,0 +1,61 @@
+/** Air Quality Sensor - Fixed-Point BME280 Driver */
+
+#ifndef BME280_FIXED_H__
+#define BME280_FIXED_H__
+
+#include <stdint.h>
+
+#include "Adafruit_BME280.h"
+
+/**
+ * BME280 with Integer Compensation
+ *
+ * Extends the Adafruit driver to return the Bosch integer compensation
+ * results directly instead of converting them to float, and to read all three
+ * measurements in one burst so they come from the same conversion.
+ *
+ * In forced mode a conversion can also be split into start and poll steps,
+ * so the caller does not have to wait in takeForcedMeasurement().
+ */
+class BME280_Fixed : public Adafruit_BME280 {
+public:
+    /**
+     * Start a Forced-Mode Conversion
+     * @return false if the sensor is not configured for forced mode or the
+     *   command was not acknowledged
+     */
+    bool startForced();
+
+    /**
+     * Check for a Conversion in Progress
+     * @param [out] busy true while the sensor is still measuring
+     * @return false if the status register could not be read
+     */
+    bool measuring(bool * busy);
+
+    /**
+     * Maximum Conversion Time
+     * @return worst-case conversion time in microseconds at the current
+     *   oversampling settings (BME280 datasheet 9.1)
+     */
+    uint32_t conversionTime();
+
+    /**
+     * Read Temperature, Pressure and Humidity
+     * @param [out] t temperature in 0.01 °C
+     * @param [out] p pressure in 1/256 Pa (Q24.8)
+     * @param [out] h relative humidity in 1/1024 %RH (Q22.10)
+     * @return true if all three values are valid
+     *
+     * Values that could not be read are set to SENSOR_T_INVALID,
+     * SENSOR_P_INVALID or SENSOR_RH_INVALID respectively.
+     */
+    bool readFixed(int16_t * t, uint32_t * p, uint32_t * h);
+
+protected:
+    int32_t compensateT(int32_t adc_T);
+    uint32_t compensateP(int32_t adc_P);
+    uint32_t compensateH(int32_t adc_H);
+};
+
+#endif // BME280_FIXED_H__
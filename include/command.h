@@ -0,0 +1,30 @@
+/** Air Quality Sensor - Command Protocol */
+
+#ifndef COMMAND_H__
+#define COMMAND_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Most Words in a Command
+#define COMMAND_MAX_ARGS    4
+
+/**
+ * Run a Command from the cmd Topic
+ * @param [in] line command line (words separated by spaces)
+ * @param [out] reply JSON reply for the reply topic
+ * @param [in] len reply buffer size
+ * @return zero if the command succeeded, or an ERROR_* code
+ *
+ * Commands (names are not case sensitive):
+ *   set <setting> <value>  change a runtime setting (see settings.h)
+ *   get <setting>|config   read one setting, or all of them
+ *   resetBaseline          reset the SGP30 baseline
+ *
+ * The reply names the command (null if unknown), the values set or read,
+ * and "ok" with an "error" message on failure, for example
+ * {"cmd":"set","publish_interval":10,"ok":true}.
+ */
+int command_run(const char *, char *, size_t);
+
+#endif // COMMAND_H__
@@ -6,12 +6,89 @@
 //! Baseline Read Interval (minutes)
 #define READ_BASELINE_INTERVAL  60
 
-//! Sensor Read Interval (seconds)
+//! Baseline Journal: flash sectors after the offline queue, and the change in
+//! either raw SGP30 baseline word below which nothing is written
+#define JOURNAL_SECTORS         2
+#define BASELINE_DEADBAND       16
+
+//! Sample Interval (seconds): the latest reading of every sensor is combined
+//! into one sample for aggregation and publishing
 #define READ_SENSOR_INTERVAL    1
 
+//! Per-Sensor Read Intervals (seconds) and Phase Offsets (milliseconds into
+//! the interval); the offsets keep the sensors' I2C traffic apart and finish
+//! every read before the sample is taken
+#define READ_SGP30_INTERVAL     1       // The SGP30 baseline algorithm needs 1 Hz
+#define READ_SGP30_PHASE        0
+#define READ_PMS5003_INTERVAL   1       // The PMS5003 updates about once a second
+#define READ_PMS5003_PHASE      400
+#define READ_BME280_INTERVAL    10
+#define READ_BME280_PHASE       600
+#define READ_SAMPLE_PHASE       900
+
+//! Sensors Fitted: uncomment for a unit without a BME280 or a PMS5003, and
+//! the sensor's driver, channels and status fields are left out of the build
+//! (the SGP30 serial number names the unit, so it is always fitted)
+// #define NO_BME280
+// #define NO_PMS5003
+
+//! Sensor Poll Interval while a Read is in Progress (milliseconds)
+#define SENSOR_POLL_INTERVAL    5
+
+//! I2C Bus: the longest clock stretch (microseconds) before a transaction
+//! times out, and the consecutive failures of a device that trigger a bus
+//! recovery; while the failures persist the count doubles up to the maximum
+#define I2C_STRETCH_LIMIT_US    1000
+#define I2C_RECOVER_FAILURES    3
+#define I2C_RECOVER_MAX         48
+
 //! Sensor Publishing Interval (seconds)
 #define PUBLISH_INTERVAL        30
 
+//! Sample Window Length (samples aggregated per publish)
+#define AGGREGATE_WINDOW        (PUBLISH_INTERVAL / READ_SENSOR_INTERVAL)
+
+//! Publish a Window Statistic instead of the Latest Sample
+//! (AGG_MEAN, AGG_MEDIAN, AGG_MIN or AGG_MAX; comment out for point samples).
+//! The always-on firmware cannot combine it with PUBLISH_ON_CHANGE, which
+//! publishes its own filtered value; LOW_POWER sends it for each flush.
+// #define PUBLISH_WINDOW_STAT     AGG_MEDIAN
+
+//! Report by Exception: publish as soon as a field moves past its deadband,
+//! and otherwise every PUBLISH_HEARTBEAT seconds (comment out to publish
+//! every PUBLISH_INTERVAL seconds)
+#define PUBLISH_ON_CHANGE
+#define PUBLISH_HEARTBEAT       300
+
+//! Report-by-Exception Deadbands: absolute (SensorData units), relative
+//! (percent of the last published value); the larger applies, 0, 0 never
+//! triggers
+#define DEADBAND_T              20, 0       // 0.2 °C
+#define DEADBAND_P              25600, 0    // 1 hPa
+#define DEADBAND_RH             2048, 0     // 2 %RH
+#define DEADBAND_TVOC           25, 20      // ppb
+#define DEADBAND_ECO2           50, 10      // ppm
+#define DEADBAND_PM             8, 30       // PM1.0, PM2.5 and PM10 (µg/m³)
+#define DEADBAND_PARTICLES      0, 0        // Particle counts
+
+//! Deep-Sleep Duty Cycling for Battery Power: wake every SLEEP_INTERVAL
+//! seconds, take one sample after SLEEP_SGP30_READS 1 Hz SGP30 reads, and
+//! bring the network up every SLEEP_FLUSH_CYCLES wakes to send the samples
+//! (comment out for the always-on firmware)
+// #define LOW_POWER
+#define SLEEP_INTERVAL          300
+#define SLEEP_FLUSH_CYCLES      6
+#define SLEEP_SGP30_READS       15      // The first 15 s after init read 400 ppm / 0 ppb
+#define SLEEP_CONNECT_TIMEOUT   10      // Seconds to wait for WiFi and MQTT
+#define SLEEP_MIN_MS            1000
+
+//! Offline Queue Size (4 KiB flash sectors, 85 samples each)
+#define QUEUE_SECTORS           16
+
+//! Offline Queue Replay (samples per burst, seconds between bursts)
+#define QUEUE_REPLAY_BATCH      10
+#define QUEUE_REPLAY_INTERVAL   1
+
 //! Publish Error Counts
 // #define PUBLISH_ERROR_COUNT
 
@@ -29,20 +106,76 @@ extern const char * mqtt_passwd;
 extern const char * mqtt_fingerprint;
 extern uint16_t mqtt_port;
 
+/** WiFi Link Supervisor (seconds between checks, seconds before re-joining) */
+#define WIFI_CHECK_INTERVAL 1
+#define WIFI_RETRY_INTERVAL 30
+
+/** NTP Server for Sample Timestamps */
+#define NTP_SERVER "pool.ntp.org"
+
 /** MQTT Topic Path */
 #define MQTT_TOPIC_BASE "sensor/aq"
 
+/** Also Publish CBOR Payloads on the data/cbor and status/cbor Topics */
+// #define MQTT_CBOR
+
+/** Also Publish Samples in Batches of this many on the batch Topic
+ *  (compact columnar encoding, see batch.h; at most 64) */
+// #define PUBLISH_BATCH 20
+
 /** MQTT Use TLS */
 #define MQTT_SECURE
 
 /** Number of milliseconds to wait for Subscription Packets */
 #define MQTT_PROCESS_MS 100
 
+/** MQTT Keepalive (seconds); the server is pinged after half of it in silence */
+#define MQTT_KEEPALIVE 60
+
+/** Milliseconds to wait for the TCP connect, the CONNACK or a PINGRESP */
+#define MQTT_CONNECT_TIMEOUT_MS 2000
+
+/** Milliseconds the blocking TLS connect may take with MQTT_SECURE (DNS, TCP
+ *  and the BearSSL handshake, which alone takes 1-3 s on an 80 MHz ESP8266
+ *  with an RSA-2048 certificate); the loop stalls for it on each attempt */
+#define MQTT_TLS_TIMEOUT_MS 8000
+
+/** MQTT Reconnect Backoff (milliseconds, doubled per failure with jitter) */
+#define MQTT_BACKOFF_MIN_MS 1000
+#define MQTT_BACKOFF_MAX_MS 30000
+
+/** MQTT Transmit Buffer (bytes): packets go to the socket in writes of up to
+ *  this size, and payloads built in place (command replies, metrics and
+ *  batches) must fit in it. Streamed payloads may be any length. */
+#define MQTT_TX_BUFFER 512
+
+/** MQTT Receive Buffer (bytes); longer inbound messages are dropped */
+#define MQTT_RX_BUFFER 256
+
+/** QoS 1 Messages in Flight before a Publish Waits for a PUBACK */
+#define MQTT_INFLIGHT 4
+
+/** QoS of Queued Samples Replayed on the history Topic (0 or 1) */
+#define MQTT_HISTORY_QOS 1
+
+/** Execution Time Metrics on the metrics Topic (comment out to compile out) */
+#define METRICS
+
+/** Metrics Publishing Interval (seconds) */
+#define METRICS_INTERVAL 300
+
 /** Retain Home Assistant Discovery Messages */
 #define MQTT_RETAIN_DISCOVERY true
 
+/** Spread Discovery after a Home Assistant Restart over this many Seconds */
+#define DISCOVERY_JITTER 30
+
 /** Debug Output to Serial Port */
 #define DEBUG
 #define DEBUG_BAUD 115200
 
+#if defined(PUBLISH_ON_CHANGE) && defined(PUBLISH_WINDOW_STAT) && !defined(LOW_POWER)
+#error "PUBLISH_ON_CHANGE and PUBLISH_WINDOW_STAT are exclusive; comment out one of them"
+#endif
+
 #endif // CONFIG_H__
@@ -0,0 +1,21 @@
+/** Air Quality Sensor - CRC-32 */
+
+#ifndef CRC_H__
+#define CRC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC-32 (IEEE 802.3)
+ * @param [in] data bytes to check
+ * @param [in] len number of bytes
+ * @return checksum
+ *
+ * Bitwise, without a lookup table: the settings, the offline queue, the
+ * baseline journal and the deep-sleep state each check a few dozen bytes
+ * at a time, so 1 KiB of table would buy nothing.
+ */
+uint32_t crc32(const uint8_t *, size_t);
+
+#endif // CRC_H__
@@ -0,0 +1,120 @@
+/** Air Quality Sensor - Home Assistant Discovery */
+
+#ifndef DISCOVERY_H__
+#define DISCOVERY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "payload.h"
+
+//! Home Assistant Birth/Will Topic
+#define DISCOVERY_HA_STATUS "homeassistant/status"
+
+//! Discovery Status
+typedef struct {
+    uint32_t hash;              //< Hash of the current discovery config
+    uint32_t stored;            //< Hash last published (from EEPROM)
+    uint8_t pending;            //< Discovery messages need to be sent
+    uint32_t requests;          //< Home Assistant birth messages seen
+    uint32_t published;         //< Complete discovery rounds sent
+} DiscoveryStatus;
+
+//! Discovery State
+typedef struct {
+    DiscoveryStatus status;
+    uint32_t due_ms;            //< Time a pending discovery may be sent
+} DiscoveryState;
+
+//! State the Discovery Routines Act On (the firmware has one; a host
+//! simulation points this at each simulated device's own)
+extern DiscoveryState * discovery_state;
+
+//! Global Discovery Status
+#define discovery_status    ((const DiscoveryStatus *)&discovery_state->status)
+
+//! Fields Announced to Home Assistant from one State Topic
+typedef struct {
+    const char * state_topic;
+    const PayloadField * fields;
+    size_t count;
+} DiscoveryTable;
+
+//! One Discovery Message: a named field and the topic it is published on
+typedef struct {
+    const char * module_sn;
+    const char * state_topic;
+    const PayloadField * field;
+} DiscoveryConfig;
+
+/**
+ * Initialize Discovery
+ * @param [in] module_sn module serial number string
+ * @param [in] tables announced field tables
+ * @param [in] count number of tables
+ * @param [in] retain discovery messages are retained
+ *
+ * Hashes everything the discovery messages are built from and compares it
+ * with the hash stored in EEPROM by the last complete round. Discovery is
+ * only marked pending if they differ, so a reboot with an unchanged config
+ * sends nothing.
+ */
+void discovery_init(const char *, const DiscoveryTable *, size_t, bool);
+
+/**
+ * Request Discovery
+ * @param [in] delay_ms delay before the messages are sent
+ *
+ * Called when Home Assistant announces itself, so it rebuilds its entities
+ * even if the retained config messages were lost.
+ */
+void discovery_request(uint32_t);
+
+/**
+ * Check for Pending Discovery
+ * @return true if discovery is pending and its delay has passed
+ */
+bool discovery_due();
+
+/**
+ * Complete Discovery
+ *
+ * Clears the pending flag and stores the config hash in EEPROM if it
+ * changed. Call once every discovery message has been sent.
+ */
+void discovery_done();
+
+/**
+ * Format a Discovery Topic
+ * @param [out] out output buffer
+ * @param [in] len output buffer size
+ * @param [in] module_sn module serial number string
+ * @param [in] field payload field (with a name)
+ * @return topic length, or zero if it did not fit
+ */
+size_t discovery_topic(char *, size_t, const char *, const PayloadField *);
+
+/**
+ * Build a Discovery Config Message
+ * @param [out] out output buffer
+ * @param [in] len output buffer size
+ * @param [in] ctx DiscoveryConfig for the message
+ * @return message length (no terminator), or zero if it did not fit
+ *
+ * Matches PayloadBuilder, for callers that want the message in memory.
+ */
+size_t discovery_config(uint8_t *, size_t, const void *);
+
+/**
+ * Stream a Discovery Config Message
+ * @param [in] sink output stream, or NULL to only measure the message
+ * @param [in] out context passed to the sink
+ * @param [in] ctx DiscoveryConfig for the message
+ * @return message length, or zero if the sink failed
+ *
+ * Matches PayloadStream: the message is passed to the sink in pieces as it
+ * is built, so it goes to the socket without a buffer of its size.
+ */
+size_t discovery_config_stream(PayloadSink, void *, const void *);
+
+#endif // DISCOVERY_H__
@@ -9,7 +9,22 @@
 #define ERROR_PMS5003_NOT_FOUND     13
 
 #define ERROR_MQTT_CONNECT_FAILED   20
+#define ERROR_MQTT_PUBLISH_FAILED   21
 
+#define ERROR_QUEUE_EMPTY           30
+#define ERROR_QUEUE_FLASH           31
+#define ERROR_QUEUE_DISABLED        32
+
+#define ERROR_JOURNAL_EMPTY         40
+#define ERROR_JOURNAL_FLASH         41
+#define ERROR_JOURNAL_DISABLED      42
+
+#define ERROR_COMMAND_UNKNOWN       50
+#define ERROR_COMMAND_ARGS          51
+#define ERROR_SETTING_UNKNOWN       52
+#define ERROR_SETTING_RANGE         53
+
+#define ERROR_BME280_READ_FAILED    (1 << 1)
 #define ERROR_SGP30_READ_FAILED     (1 << 2)
 #define ERROR_PMS3003_READ_FAILED   (1 << 3)
 
@@ -0,0 +1,58 @@
+/** Air Quality Sensor - Fixed-Point Formatting */
+
+#ifndef FIXED_H__
+#define FIXED_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Longest output of fixed_format1 including the terminator
+#define FIXED_FORMAT_MAX 16
+
+/**
+ * Format a Fixed-Point Value with One Decimal Place
+ * @param [out] buf output buffer (at least FIXED_FORMAT_MAX bytes)
+ * @param [in] num value numerator
+ * @param [in] den value denominator (scale)
+ * @return number of characters written, excluding the terminator
+ *
+ * Produces exactly the text of printf("%.1f", (float)num / den) using only
+ * integer arithmetic: the quotient is first rounded to the nearest float
+ * (24-bit mantissa) and then to the nearest tenth, both with ties to even.
+ * This keeps the output identical to the float driver path while avoiding
+ * soft-float on the ESP8266. The magnitude of num / den must be below 2^24.
+ */
+size_t fixed_format1(char *, int64_t, uint32_t);
+
+/**
+ * Round a Fixed-Point Value to Tenths
+ * @param [in] num value numerator
+ * @param [in] den value denominator (scale)
+ * @return the value in tenths, rounded as by fixed_format1
+ */
+int64_t fixed_round1(int64_t, uint32_t);
+
+/**
+ * Get the Length of a Fixed-Point Value with One Decimal Place
+ * @param [in] num value numerator
+ * @param [in] den value denominator (scale)
+ * @return number of characters fixed_format1 would write
+ */
+size_t fixed_length1(int64_t, uint32_t);
+
+/**
+ * Format an Unsigned Integer
+ * @param [out] buf output buffer (at least 11 bytes)
+ * @param [in] value value to format
+ * @return number of characters written, excluding the terminator
+ */
+size_t fixed_format_u32(char *, uint32_t);
+
+/**
+ * Get the Length of an Unsigned Integer
+ * @param [in] value value to format
+ * @return number of decimal digits in the value
+ */
+size_t fixed_length_u32(uint32_t);
+
+#endif // FIXED_H__
@@ -0,0 +1,64 @@
+/** Air Quality Sensor - Flash Record Regions */
+
+#ifndef FLASH_RECORD_H__
+#define FLASH_RECORD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Record States
+#define RECORD_ERROR        (-1)    //< The flash could not be read
+#define RECORD_EMPTY        0       //< Erased
+#define RECORD_VALID        1
+#define RECORD_CORRUPT      2       //< Written, with a bad checksum
+
+/**
+ * Flash Record Region
+ *
+ * A run of sectors in the filesystem area holding fixed-size records, as
+ * used by the offline queue and the baseline journal. Records do not span
+ * sectors, and each one carries a CRC-32 of the bytes before its crc field.
+ */
+typedef struct {
+    uint32_t sector;            //< First sector, counted from FS_PHYS_ADDR
+    uint32_t sectors;           //< Sectors in the region
+    uint16_t size;              //< Record size (bytes, a multiple of 4)
+    uint16_t crc_offset;        //< Offset of the record's CRC-32
+} FlashRegion;
+
+/**
+ * Check that a Region Lies in the Filesystem Area
+ * @param [in] region record region
+ * @return true if every sector of the region is below FS_PHYS_SIZE
+ *
+ * The area is set by the board's flash layout at link time, so this is
+ * checked at boot; a region that does not fit must not be read or written.
+ */
+bool flash_record_fits(const FlashRegion *);
+
+/**
+ * Flash Address of a Record Slot
+ * @param [in] region record region
+ * @param [in] slot record slot, counted from the start of the region
+ * @return flash address
+ */
+uint32_t flash_record_addr(const FlashRegion *, uint32_t);
+
+/**
+ * Read a Record Slot and Classify it
+ * @param [in] region record region
+ * @param [in] slot record slot
+ * @param [out] rec record buffer of region->size bytes (word aligned)
+ * @return one of the RECORD_* states
+ */
+int flash_record_read(const FlashRegion *, uint32_t, void *);
+
+/**
+ * Erase the Sector Holding a Record Slot
+ * @param [in] region record region
+ * @param [in] slot record slot
+ * @return true on success
+ */
+bool flash_record_erase(const FlashRegion *, uint32_t);
+
+#endif // FLASH_RECORD_H__
@@ -0,0 +1,30 @@
+/** Air Quality Sensor - Absolute Humidity */
+
+#ifndef HUMIDITY_H__
+#define HUMIDITY_H__
+
+#include <stdint.h>
+
+//! Temperature Range of the Table (0.01 °C, the SGP30 operating range)
+#define HUMIDITY_T_MIN      (-4000)
+#define HUMIDITY_T_MAX      8500
+
+//! Largest Absolute Humidity the SGP30 Accepts (1/256 g/m³)
+#define HUMIDITY_AH_MAX     UINT16_MAX
+
+/**
+ * Absolute Humidity for SGP30 Compensation
+ * @param [in] temperature temperature in 0.01 °C (as in SensorData)
+ * @param [in] humidity relative humidity in 1/1024 %RH (as in SensorData)
+ * @return absolute humidity in 1/256 g/m³ (the SGP30's 8.8 fixed point),
+ *   saturating at HUMIDITY_AH_MAX
+ *
+ * Follows the approximation formula from Sensirion's SGP30 driver
+ * integration guide without floating point: the saturation vapour density
+ * is tabulated every 1 °C at compile time and interpolated quadratically.
+ * Temperatures outside HUMIDITY_T_MIN to HUMIDITY_T_MAX are clamped. Within
+ * the range the result is within one LSB of the formula.
+ */
+uint16_t humidity_absolute(int16_t, uint32_t);
+
+#endif // HUMIDITY_H__
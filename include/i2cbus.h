@@ -0,0 +1,124 @@
+/** Air Quality Sensor - I2C Bus Manager */
+
+#ifndef I2CBUS_H__
+#define I2CBUS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensor.h"
+
+//! Transaction Results (error classes)
+#define I2CBUS_OK           0
+#define I2CBUS_NACK         1   //< The device did not acknowledge
+#define I2CBUS_TIMEOUT      2   //< A line was held low or the clock stretched too long
+#define I2CBUS_CHECKSUM     3   //< The data arrived but failed its CRC or frame check
+#define I2CBUS_FAILED       4   //< A driver call failed; classified from the bus state
+
+//! Bus Statistics of one Device
+typedef struct {
+    uint32_t transactions;
+    uint32_t bus_ms;            //< Time spent on the bus
+    uint16_t nacks;
+    uint16_t timeouts;
+    uint16_t checksums;
+    uint16_t reinits;           //< Re-initialisations after a bus recovery
+    uint8_t failures;           //< Consecutive failed transactions
+} I2CDeviceStatus;
+
+//! I2C Bus Status
+typedef struct {
+    I2CDeviceStatus device[SENSOR_COUNT];   //< By SENSOR_* index
+    uint32_t nacks;                         //< Totals over the devices
+    uint32_t timeouts;
+    uint32_t checksums;
+    uint16_t recoveries;        //< Bus recoveries run
+    uint16_t stuck;             //< Recoveries that could not free SDA
+} I2CBusStatus;
+
+//! Global I2C Bus Status
+extern const I2CBusStatus * i2cbus_status;
+
+/**
+ * Device Re-Initialisation
+ * @return true if the device answered
+ *
+ * Runs after a bus recovery, outside any transaction.
+ */
+typedef bool (*I2CBusReinit)();
+
+/**
+ * Initialize the Bus
+ *
+ * Starts Wire with the I2C_STRETCH_LIMIT_US clock stretch limit and clears
+ * the statistics. A device left holding SDA by the last reset is clocked
+ * free first.
+ */
+void i2cbus_setup();
+
+/**
+ * Register a Device's Re-Initialisation
+ * @param [in] dev SENSOR_* device
+ * @param [in] reinit function to run after a recovery, or NULL
+ */
+void i2cbus_attach(uint8_t, I2CBusReinit);
+
+/**
+ * Start a Transaction
+ * @param [in] dev SENSOR_* device
+ *
+ * Every sensor read goes through the manager as a begin/end pair around the
+ * I2C traffic, so the time between them is charged to the device. Pairs do
+ * not nest: the bus is the loop's alone between them, and recoveries only
+ * run from i2cbus_end() once the failed transaction is over.
+ */
+void i2cbus_begin(uint8_t);
+
+/**
+ * Finish a Transaction
+ * @param [in] dev SENSOR_* device
+ * @param [in] result I2CBUS_* result of the transaction
+ * @return the result as recorded
+ *
+ * A transaction that leaves SDA or SCL held low is recorded as a timeout
+ * whatever its result, and I2CBUS_FAILED becomes a timeout or a NACK by the
+ * same test. After I2C_RECOVER_FAILURES consecutive failures of the device
+ * the bus is recovered with i2cbus_recover() and a device re-initialised:
+ * the one whose transaction left the bus held, or else this one. While the
+ * failures go on, each further recovery waits for twice as many, up to
+ * I2C_RECOVER_MAX.
+ */
+uint8_t i2cbus_end(uint8_t, uint8_t);
+
+/**
+ * Write to a Device
+ * @param [in] addr 7-bit address
+ * @param [in] data bytes to write
+ * @param [in] len number of bytes
+ * @return I2CBUS_OK, I2CBUS_NACK or I2CBUS_TIMEOUT
+ *
+ * For use inside a transaction, with the error class that the Adafruit
+ * drivers do not report.
+ */
+uint8_t i2cbus_write(uint8_t, const uint8_t *, size_t);
+
+/**
+ * Read from a Device
+ * @param [in] addr 7-bit address
+ * @param [out] data read buffer
+ * @param [in] len number of bytes
+ * @return I2CBUS_OK, I2CBUS_NACK or I2CBUS_TIMEOUT
+ */
+uint8_t i2cbus_read(uint8_t, uint8_t *, size_t);
+
+/**
+ * Recover a Stuck Bus
+ * @return true if SDA is released
+ *
+ * A device that lost a transaction mid-byte holds SDA low and waits for the
+ * rest of its clocks. Up to nine SCL pulses are sent as GPIO until it lets
+ * go, then a STOP condition, and Wire is started again (NXP UM10204 3.1.16).
+ */
+bool i2cbus_recover();
+
+#endif // I2CBUS_H__
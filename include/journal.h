@@ -0,0 +1,63 @@
+/** Air Quality Sensor - SGP30 Baseline Journal */
+
+#ifndef JOURNAL_H__
+#define JOURNAL_H__
+
+#include <stdint.h>
+
+//! Baseline Journal Status
+typedef struct {
+    uint32_t writes;            //< Records written since boot
+    uint32_t skipped;           //< Writes skipped inside BASELINE_DEADBAND
+    uint32_t corrupt;           //< Records found with a bad checksum on boot
+} JournalStatus;
+
+//! Global Journal Status
+extern const JournalStatus * journal_status;
+
+/**
+ * Initialize the Baseline Journal
+ * @return zero on success, ERROR_JOURNAL_FLASH if the flash could not be read,
+ *   or ERROR_JOURNAL_DISABLED if the sectors do not fit in the filesystem area
+ *
+ * The journal is an append-only log of small records in JOURNAL_SECTORS
+ * flash sectors after the offline queue. Every record carries a sequence
+ * number and checksum, so the newest baseline is recovered by scanning the
+ * sectors on boot, and a record torn by a reset mid-write is skipped in
+ * favour of the one before it. A sector is only erased when the log wraps
+ * into it. If the journal does not fit in the board's filesystem area,
+ * nothing is read or written and the baselines start fresh on every boot.
+ */
+int journal_init();
+
+/**
+ * Read the Newest Baseline
+ * @param [out] eco2 eCO2 baseline
+ * @param [out] tvoc TVOC baseline
+ * @return zero on success, or ERROR_JOURNAL_EMPTY if no baseline was stored
+ */
+int journal_read(uint16_t *, uint16_t *);
+
+/**
+ * Append a Baseline
+ * @param [in] eco2 eCO2 baseline
+ * @param [in] tvoc TVOC baseline
+ * @return zero on success (or if the write was skipped),
+ *   ERROR_JOURNAL_FLASH if the write failed, or ERROR_JOURNAL_DISABLED
+ *
+ * Nothing is written while both values are within BASELINE_DEADBAND of the
+ * newest record.
+ */
+int journal_write(uint16_t, uint16_t);
+
+/**
+ * Store a Cleared Baseline
+ * @return zero on success, ERROR_JOURNAL_FLASH if the write failed, or
+ *   ERROR_JOURNAL_DISABLED
+ *
+ * Appends a zero baseline regardless of BASELINE_DEADBAND, so a reset is
+ * recorded even when the newest record is already close to zero.
+ */
+int journal_clear();
+
+#endif // JOURNAL_H__
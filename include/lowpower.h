@@ -0,0 +1,135 @@
+/** Air Quality Sensor - Deep-Sleep Duty Cycling */
+
+#ifndef LOWPOWER_H__
+#define LOWPOWER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "batch.h"
+#include "config.h"
+#include "sensor.h"
+
+//! Deep-Sleep State Format Version
+#define LOWPOWER_VERSION        1
+
+//! RTC Memory Available for the State (bytes, after the OTA boot command)
+#define LOWPOWER_RTC_SIZE       384
+
+//! Bytes of Encoded Samples held across Deep Sleep
+#define LOWPOWER_WINDOW_BYTES   (LOWPOWER_RTC_SIZE - 48)
+
+//! Deep-Sleep State, kept in RTC User Memory
+typedef struct {
+    uint32_t crc;               //< CRC-32 of everything after it
+    uint8_t version;
+    uint8_t failures;           //< Consecutive failed flushes
+    uint16_t window_len;        //< Bytes used in window
+    uint64_t epoch_ms;          //< Epoch time at this wake, or 0 if unknown
+    uint32_t cycle;             //< Wake cycles since power-on
+    uint32_t next_flush;        //< Cycle of the next flush
+    uint32_t clock_ms;          //< Time since power-on at this wake (wraps)
+    uint32_t awake_ms;          //< Time awake (halved with asleep_ms when large)
+    uint32_t asleep_ms;         //< Time in deep sleep
+    uint32_t baseline_ms;       //< clock_ms when the baseline was last stored
+    uint16_t bl_tvoc;           //< SGP30 baseline at the last sleep
+    uint16_t bl_eCO2;
+    uint16_t dropped;           //< Samples lost while the window was full
+    uint16_t reserved;
+    uint8_t window[LOWPOWER_WINDOW_BYTES];  //< Unsent samples (batch_encode)
+} LowPowerState;
+
+//! Deep-Sleep Status
+typedef struct {
+    uint32_t cycle;             //< Wake cycles since power-on
+    uint16_t duty;              //< Time awake in 0.1 %
+    uint16_t dropped;           //< Samples lost while the window was full
+} LowPowerStatus;
+
+//! Global Deep-Sleep Status
+extern const LowPowerStatus * lowpower_status;
+
+/**
+ * Restore the State from RTC Memory
+ * @param [out] state deep-sleep state
+ * @return true if a valid state was restored, or false after a power-on
+ *   (the state is then reset, with a flush due on this cycle)
+ *
+ * The state is checked with a CRC-32, so the random contents of RTC memory
+ * after power-on, or a state from another firmware version, are never used.
+ */
+bool lowpower_restore(LowPowerState *);
+
+/**
+ * Save the State to RTC Memory
+ * @param [in,out] state deep-sleep state (the CRC is updated)
+ */
+void lowpower_save(LowPowerState *);
+
+/**
+ * Add a Sample to the Window
+ * @param [in,out] state deep-sleep state
+ * @param [in] data sensor sample
+ * @param [in] awake_ms time since this wake
+ *
+ * Samples are kept batch-encoded (see batch.h), about 18 bytes each. If the
+ * window is full the oldest samples are dropped to make room.
+ */
+void lowpower_push(LowPowerState *, const SensorData *, uint32_t);
+
+/**
+ * Decode the Window
+ * @param [in] state deep-sleep state
+ * @param [out] batch samples with their times (clock_ms)
+ * @return number of samples
+ */
+uint8_t lowpower_samples(const LowPowerState *, SampleBatch *);
+
+/**
+ * Check whether this Cycle Brings the Network Up
+ * @param [in] state deep-sleep state
+ * @return true if the window should be flushed on this cycle
+ */
+bool lowpower_flush_due(const LowPowerState *);
+
+/**
+ * Record a Flush Attempt
+ * @param [in,out] state deep-sleep state
+ * @param [in] ok whether every sample was sent
+ *
+ * A successful flush empties the window and schedules the next one after
+ * SLEEP_FLUSH_CYCLES cycles. Failed flushes are retried after 2, 4 and then
+ * 8 times as many cycles, so an unreachable broker does not cost a WiFi
+ * connection attempt on every wake.
+ */
+void lowpower_flushed(LowPowerState *, bool);
+
+/**
+ * Get the Epoch Time of a Sample
+ * @param [in] state deep-sleep state
+ * @param [in] ms sample time (clock_ms)
+ * @return epoch time in ms, or 0 if unknown
+ */
+uint64_t lowpower_epoch_ms(const LowPowerState *, uint32_t);
+
+/**
+ * Set the Epoch Time
+ * @param [in,out] state deep-sleep state
+ * @param [in] epoch current epoch time in seconds
+ * @param [in] awake_ms time since this wake
+ */
+void lowpower_set_epoch(LowPowerState *, uint32_t, uint32_t);
+
+/**
+ * End the Cycle
+ * @param [in,out] state deep-sleep state
+ * @param [in] awake_ms time since this wake
+ * @return time to sleep in ms
+ *
+ * Sleeps for the rest of SLEEP_INTERVAL (at least SLEEP_MIN_MS), advances
+ * the clock and the duty cycle totals to the next wake and moves to the
+ * next cycle. Save the state after this call.
+ */
+uint32_t lowpower_sleep(LowPowerState *, uint32_t);
+
+#endif // LOWPOWER_H__
@@ -0,0 +1,28 @@
+/** Air Quality Sensor - Memory Instrumentation */
+
+#ifndef MEMSTAT_H__
+#define MEMSTAT_H__
+
+#include <stdint.h>
+
+//! Memory Status
+typedef struct {
+    uint16_t stack_free;        //< Least free stack since boot (B)
+    uint32_t heap_free;         //< Free heap (B)
+    uint16_t heap_block;        //< Largest free heap block (B)
+} MemoryStatus;
+
+//! Global Memory Status
+extern const MemoryStatus * memory_status;
+
+/**
+ * Update the Memory Status
+ *
+ * The stack figure is the high-water mark of the 4 KB loop stack: the core
+ * paints it when the sketch starts, and the unpainted part is what the
+ * deepest call so far has used. The heap figures are taken now; a largest
+ * block well below the free heap means the heap is fragmented.
+ */
+void memstat_update();
+
+#endif // MEMSTAT_H__
@@ -0,0 +1,120 @@
+/** Air Quality Sensor - Execution Time Metrics */
+
+#ifndef METRICS_H__
+#define METRICS_H__
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+#ifdef METRICS
+
+//! Metric Identifiers
+#define METRIC_LOOP             0   //< Main loop period (start to start)
+#define METRIC_MQTT             1   //< MQTT connection manager and packet processing
+#define METRIC_WLAN             2   //< WiFi link supervisor task
+#define METRIC_READ_DATA        3   //< Sensor conversion start tasks
+#define METRIC_COLLECT_DATA     4   //< Sensor poll/collect task
+#define METRIC_PUBLISH          5   //< Data publish task
+#define METRIC_REPLAY           6   //< Offline queue replay task
+#define METRIC_BASELINE         7   //< Sensor baseline task
+#define METRIC_SAMPLE           8   //< Sample task
+#define METRIC_COUNT            9
+
+//! Histogram Buckets: bucket b counts durations of [2^(b+8), 2^(b+9)) cycles;
+//! the first and last buckets also take everything below and above
+#define METRICS_BUCKETS         20
+#define METRICS_BUCKET_SHIFT    8
+
+//! Execution Time Histogram (CPU cycles)
+typedef struct {
+    uint32_t count;             //< Samples recorded
+    uint32_t min;               //< Shortest sample
+    uint32_t max;               //< Longest sample
+    uint64_t total;             //< Sum of all samples
+    uint16_t hist[METRICS_BUCKETS];     //< Log2 buckets (saturating)
+} Metric;
+
+//! Histograms for the Current Window (use metrics_record() to update)
+extern Metric metrics_table[METRIC_COUNT];
+
+//! Metric Names used as Message Keys
+extern const char * const metric_names[METRIC_COUNT];
+
+//! Cycle Count at the Start of the Previous Main Loop Pass (0 after a reset)
+extern uint32_t metrics_loop_start;
+
+/**
+ * Record one Execution Time Sample
+ * @param [in] id metric identifier
+ * @param [in] cycles duration in CPU cycles
+ *
+ * A handful of adds and compares plus one count-leading-zeros; safe to call
+ * from every loop pass. Durations must be shorter than one cycle counter
+ * wrap (about 53 s at 80 MHz).
+ */
+static inline void metrics_record(uint8_t id, uint32_t cycles) {
+    Metric * m = &metrics_table[id];
+    int8_t b = (cycles ? 31 - __builtin_clz(cycles) : 0) - METRICS_BUCKET_SHIFT;
+
+    if (b < 0) b = 0;
+    if (b >= METRICS_BUCKETS) b = METRICS_BUCKETS - 1;
+    if (m->hist[b] != 0xFFFF) m->hist[b]++;
+
+    if (cycles < m->min) m->min = cycles;
+    if (cycles > m->max) m->max = cycles;
+    m->total += cycles;
+    m->count++;
+}
+
+//! Times the Enclosing Scope into a Metric
+class MetricsTimer {
+public:
+    explicit MetricsTimer(uint8_t id) : id(id), start(ESP.getCycleCount()) {}
+    ~MetricsTimer() { metrics_record(id, ESP.getCycleCount() - start); }
+
+private:
+    uint8_t id;
+    uint32_t start;
+};
+
+/**
+ * Clear the Metrics Window
+ *
+ * Called at boot and after each metrics message is sent.
+ */
+void metrics_reset();
+
+/**
+ * Format the Metrics Window
+ * @param [out] buf output buffer
+ * @param [in] len output buffer size
+ * @param [in] hist include the histogram buckets
+ * @return message length, or -1 if it did not fit
+ *
+ * Writes {"mhz":80,"s":<window>,"<name>":[n,mean,min,max,first,c...],...}
+ * with times in microseconds. The bucket counts start at bucket <first>
+ * and leading and trailing empty buckets are left out.
+ */
+int metrics_format(char *, size_t, bool);
+
+//! Time the Enclosing Scope
+#define METRICS_SCOPE(id) MetricsTimer metrics_timer__(id)
+
+//! Record the Time since the Previous Main Loop Pass
+#define METRICS_LOOP() do { \
+        uint32_t metrics_now__ = ESP.getCycleCount(); \
+        if (metrics_loop_start) metrics_record(METRIC_LOOP, metrics_now__ - metrics_loop_start); \
+        metrics_loop_start = metrics_now__; \
+    } while (0)
+
+#else
+
+#define METRICS_SCOPE(id)
+#define METRICS_LOOP()
+
+#endif // METRICS
+
+#endif // METRICS_H__
@@ -5,39 +5,193 @@
 
 #include <stdint.h>
 
+#include <ESP8266WiFi.h>
+
+#include "aqi.h"
+#include "batch.h"
+#include "config.h"
+#include "mqtt_client.h"
 #include "sensor.h"
+#include "tcp_client.h"
+
+//! MQTT Connection States
+#define MQTT_STATE_OFFLINE      0   //< Waiting for WiFi or the retry backoff
+#define MQTT_STATE_OPENING      1   //< DNS lookup and TCP handshake running (plain TCP only)
+#define MQTT_STATE_CONNECTING   2   //< CONNECT sent, waiting for the CONNACK
+#define MQTT_STATE_CONNECTED    3   //< Session open
+
+//! MQTT Connection Status
+typedef struct {
+    uint8_t state;              //< MQTT_STATE_* value
+    uint32_t attempts;          //< Connection attempts started
+    uint32_t connects;          //< Sessions opened
+    uint32_t backoff_ms;        //< Delay before the next attempt
+} MqttStatus;
+
+//! MQTT Topic Buffer Length
+#define MQTT_TOPIC_LEN      40
 
 /**
- * Setup the WiFi and MQTT Connection
+ * MQTT Session State
+ *
+ * Everything the routines below keep for the connection to the broker: the
+ * transport, the client (constructed in place here instead of on the heap,
+ * so it shows up in the link map and setup_mqtt() can run again without
+ * leaking), the connection manager and the device's topics. The client's
+ * transmit buffer is the one packet buffer; payloads are streamed through
+ * it or, for replies, built directly in it.
+ */
+typedef struct {
+#ifdef MQTT_SECURE
+    WiFiClientSecure client;
+#else
+    TcpClient client;
+#endif
+    alignas(MQTT_Client) uint8_t storage[sizeof(MQTT_Client)];
+    MQTT_Client * mqtt;         //< Client in storage, once set up
+
+    // Connection manager
+    MqttStatus status;
+    uint32_t backoff_window;
+    uint32_t retry_at;
+    uint32_t connect_start;
+
+    // Subscription polling time (micros(), for latency probes)
+    uint32_t poll_start;
+    bool polling;               //< Inside process_mqtt()
+
+#ifdef AQI_TOPIC
+    uint32_t aqi_sent_hour;     //< Hour of the last NowCast sent
+#endif
+
+    // Topics and subscriptions (formatted by setup_mqtt())
+    char topic_status[MQTT_TOPIC_LEN];
+    char topic_echo[MQTT_TOPIC_LEN];
+    char topic_reply[MQTT_TOPIC_LEN];
+    char topic_cmd[MQTT_TOPIC_LEN];
+    char topic_data[MQTT_TOPIC_LEN];
+    char topic_history[MQTT_TOPIC_LEN];
+#ifdef AQI_TOPIC
+    char topic_aqi[MQTT_TOPIC_LEN];
+#endif
+#ifdef METRICS
+    char topic_metrics[MQTT_TOPIC_LEN];
+#endif
+#ifdef PUBLISH_BATCH
+    char topic_batch[MQTT_TOPIC_LEN];
+#endif
+#ifdef MQTT_CBOR
+    char topic_status_cbor[MQTT_TOPIC_LEN];
+    char topic_data_cbor[MQTT_TOPIC_LEN];
+    char topic_history_cbor[MQTT_TOPIC_LEN];
+#ifdef AQI_TOPIC
+    char topic_aqi_cbor[MQTT_TOPIC_LEN];
+#endif
+#endif
+    MqttSubscription sub_echo;
+    MqttSubscription sub_cmd;
+} MqttSession;
+
+//! Session the Routines Below Act On (the firmware has one; a host
+//! simulation points this at each simulated device's own)
+extern MqttSession * mqtt_session;
+
+//! Global MQTT Connection Status
+#define mqtt_status         ((const MqttStatus *)&mqtt_session->status)
+
+/**
+ * Setup the MQTT Client
  * @param [in] module_sn module serial number string
  * @return zero if initialization succeeded, or non-zero if an error occurred
+ *
+ * Does not connect; connect_mqtt() opens the session once the WiFi link is up.
+ * The client is built in static storage, not on the heap, and calling this
+ * again replaces it in place.
  */
 int setup_mqtt(const char *);
 
 /**
- * Connect to the MQTT Server
+ * Run the MQTT Connection Manager
  * @param [in] module_sn module serial number string
- * @return zero if connection succeeded, or non-zero if an error occurred
+ * @return zero if the session is open, or ERROR_MQTT_CONNECT_FAILED
+ *
+ * Advances the connection state machine by one step without waiting on the
+ * network: for a plain connection the DNS lookup and TCP handshake are polled
+ * (see TcpClient), and so is the CONNACK. Failed attempts are retried after an exponential backoff
+ * with jitter, and an open session is checked with keepalive pings only when
+ * the server has been silent. Call this from the main loop; tasks should use
+ * connected_mqtt().
+ *
+ * With MQTT_SECURE the TLS client cannot take over a polled socket or poll
+ * its own handshake, so each attempt opens the connection with one blocking
+ * call: the loop stalls for the DNS lookup, the TCP connect and the TLS
+ * handshake, up to MQTT_TLS_TIMEOUT_MS, whether or not the server answers.
  */
 int connect_mqtt(const char *);
 
+/**
+ * Check the MQTT Connection
+ * @return true if the session is open (no network traffic)
+ */
+bool connected_mqtt();
+
+/**
+ * Close the MQTT Session
+ *
+ * Sends a DISCONNECT so the broker ends the session at once instead of
+ * waiting out the keepalive (before deep sleep).
+ */
+void disconnect_mqtt();
+
 /**
  * Process MQTT Subscription Packets
  * @param [in] timeout timeout in milliseconds
+ *
+ * A message on the echo topic is sent back on echo/reply. A latency probe,
+ * "probe <id>", is answered at once with the time the device can account
+ * for: {"probe":id,"poll_us":..,"reply_us":..}. poll_us is the time from the
+ * start of this call to the probe being read, and reply_us the time to
+ * build the reply. The device cannot see when the probe reached its socket:
+ * whatever the sender cannot put down to the network is time the probe
+ * waited for the scheduled tasks before this call.
  */
 void process_mqtt(int16_t);
 
 /**
  * Send Home Assistant Discovery MQTT messages
  * @param [in] module_sn module serial number string
+ * @param [in] retain set the retain flag
+ * @return zero if every message was sent, or ERROR_MQTT_PUBLISH_FAILED
+ *
+ * Sends one config message per named data, status and AQI field, each
+ * streamed to the socket with MQTT_Client::publishStream() (measured first,
+ * then written through the packet buffer), so a config may be longer than
+ * MQTT_TX_BUFFER. Discovery is marked done once all are sent.
+ * The main loop calls this only while discovery_due() is true.
  */
-void haDiscovery(const char *, bool);
+int haDiscovery(const char *, bool);
 
 /**
  * Report sensor data.
  * @param [in] data Sensor data
+ * @return zero if the data was sent, or ERROR_MQTT_PUBLISH_FAILED
+ *
+ * Also sends the NowCast and AQI (see aqi.h), retained, on the aqi topic
+ * after each hour that updated them.
+ */
+int publish_data(const SensorData *);
+
+/**
+ * Report a queued sample on the history topic.
+ * @param [in] data Sensor data
+ * @param [in] timestamp sample time (seconds since the epoch, or 0 if unknown)
+ * @param [in] seq queue sequence number (see queue_next())
+ * @return zero if the data was sent, or ERROR_MQTT_PUBLISH_FAILED
+ *
+ * The sample is acknowledged in the queue once the broker has it: as soon
+ * as it is sent at QoS 0, and on its PUBACK at QoS 1.
  */
-void publish_data(const SensorData *);
+int publish_history(const SensorData *, uint32_t, uint32_t);
 
 /**
  * Report status data.
@@ -45,4 +199,29 @@ void publish_data(const SensorData *);
  */
 void publish_status(const char *);
 
+#ifdef PUBLISH_BATCH
+/**
+ * Report a batch of samples on the batch topic.
+ * @param [in,out] batch sample batch
+ * @param [in] base_ms epoch time of the first sample in ms, or 0 if unknown
+ * @return zero if the whole batch was sent, or ERROR_MQTT_PUBLISH_FAILED
+ *
+ * A batch too large for one packet is split over several messages. Samples
+ * are removed from the batch as they are sent, so a failed call can simply
+ * be retried with the remainder.
+ */
+int publish_batch(SampleBatch *, uint64_t);
+#endif
+
+#ifdef METRICS
+/**
+ * Report execution time metrics.
+ * @return zero if the metrics were sent, or ERROR_MQTT_PUBLISH_FAILED
+ *
+ * The histograms are left out if the full message would not fit in one
+ * packet, and the metrics window is cleared once the message is sent.
+ */
+int publish_metrics();
+#endif
+
 #endif // MQTT_H__
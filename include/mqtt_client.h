@@ -0,0 +1,315 @@
+/** Air Quality Sensor - MQTT Client */
+
+#ifndef MQTT_CLIENT_H__
+#define MQTT_CLIENT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Client.h>
+
+#include "config.h"
+#include "payload.h"
+
+//! pollConnect() Result while the CONNACK is Outstanding
+#define MQTT_CONNECT_PENDING    (-3)
+
+//! Most Topics the Client can Subscribe to
+#define MQTT_MAX_SUBSCRIPTIONS  4
+
+//! Milliseconds between Socket Polls while Waiting
+#define MQTT_READ_INTERVAL_MS   10
+
+//! Milliseconds to Wait for a PUBACK to Free an In-Flight Slot
+#define MQTT_ACK_TIMEOUT_MS     500
+
+/**
+ * Payload Builder for MQTT_Client::publishWith()
+ * @param [out] out payload buffer
+ * @param [in] len payload buffer size
+ * @param [in] ctx caller context
+ * @return payload length, or zero if it did not fit
+ */
+typedef size_t (*PayloadBuilder)(uint8_t *, size_t, const void *);
+
+/**
+ * Payload Writer for MQTT_Client::publishStream()
+ * @param [in] sink output stream, or NULL to only measure the payload
+ * @param [in] out context passed to the sink
+ * @param [in] ctx caller context
+ * @return payload length, or zero if the sink failed
+ *
+ * Called twice: once without a sink for the length, then to send.
+ */
+typedef size_t (*PayloadStream)(PayloadSink, void *, const void *);
+
+/**
+ * Subscription Callback
+ * @param [in] data message payload, NUL-terminated in the receive buffer
+ * @param [in] len payload length
+ */
+typedef void (*MqttCallback)(char *, uint16_t);
+
+/**
+ * Acknowledgement Callback
+ * @param [in] tag tag the QoS 1 message was published with
+ */
+typedef void (*MqttAckCallback)(uint32_t);
+
+//! Topic Subscription
+typedef struct {
+    const char * topic;
+    uint8_t qos;                //< Requested QoS (0 or 1)
+    MqttCallback callback;
+} MqttSubscription;
+
+/**
+ * MQTT 3.1.1 Client with Streamed Payloads
+ *
+ * A small client for the firmware's own traffic, talking to any Arduino
+ * Client. Packets are written through MQTT_TX_BUFFER, which combines the
+ * header and the pieces of a payload into as few socket writes as possible;
+ * payloads are serialized straight into it as the packet goes out, so a
+ * message may be larger than the buffer and is never copied whole.
+ *
+ * QoS 1 publishes do not wait for their PUBACK: up to MQTT_INFLIGHT may be
+ * outstanding, and a publish only blocks when that window is full. Nothing
+ * is retransmitted; the session is clean, so a message still in flight when
+ * the connection drops is lost. A caller that must not lose a message tags
+ * it and keeps it until the acknowledgement callback reports that tag.
+ *
+ * Inbound packets are read without blocking into MQTT_RX_BUFFER. Longer
+ * messages are acknowledged if needed and dropped.
+ */
+class MQTT_Client {
+public:
+    MQTT_Client(Client *, const char *, uint16_t,
+        const char * = "", const char * = "", const char * = "");
+
+    /** Keepalive Interval (seconds) sent in CONNECT */
+    void setKeepAliveInterval(uint16_t keepalive) { keepalive_s = keepalive; }
+
+    /**
+     * Set the QoS 1 Window
+     * @param [in] window in-flight messages allowed (1 to MQTT_INFLIGHT)
+     */
+    void setWindow(uint8_t);
+
+    /**
+     * Set the Acknowledgement Callback
+     * @param [in] cb called from the packet reader with the tag of each
+     *   QoS 1 message the server acknowledges (tag 0 is not reported)
+     */
+    void setAckCallback(MqttAckCallback cb) { ack_cb = cb; }
+
+    /**
+     * Register a Subscription
+     * @param [in] sub subscription, which must outlive the client
+     * @return true if the subscription was registered
+     *
+     * The topic is subscribed by pollConnect() each time a session opens.
+     */
+    bool subscribe(const MqttSubscription *);
+
+    /**
+     * Start Connecting to the Server
+     * @return true if the TCP connection opened and CONNECT was sent
+     *
+     * A transport that is already connected (see TcpClient) is used as it
+     * is. Otherwise it is connected here, which blocks for the TCP (and TLS)
+     * handshake, bounded by the transport timeout. The CONNACK is collected
+     * by pollConnect().
+     */
+    bool beginConnect();
+
+    /**
+     * Check for the Server's CONNACK without Waiting
+     * @return zero once connected, MQTT_CONNECT_PENDING if no reply has
+     *   arrived yet, -1 if the connection failed, -2 if a subscription
+     *   could not be sent, or the server's CONNACK return code
+     *
+     * On success the registered subscriptions are sent; their SUBACKs are
+     * consumed later by processPackets().
+     */
+    int8_t pollConnect();
+
+    /**
+     * Keepalive Liveness Check
+     * @param [in] idle_ms receive silence (ms) after which a PINGREQ is sent
+     * @param [in] timeout_ms time (ms) to wait for traffic after a PINGREQ
+     * @return false if the server stopped answering
+     *
+     * Any inbound packet counts as a sign of life, so a busy session never
+     * pings. Replies are read by processPackets().
+     */
+    bool keepAlive(uint32_t, uint32_t);
+
+    /** Check the Connection */
+    bool connected();
+
+    /** Send DISCONNECT and Close the Connection */
+    void disconnect();
+
+    /**
+     * Read and Handle Inbound Packets
+     * @param [in] timeout time (ms) to keep reading
+     *
+     * Subscription callbacks run from here; they may publish at QoS 0.
+     */
+    void processPackets(int16_t);
+
+    /**
+     * Check the Last Received Message
+     * @return true if the last PUBLISH from the server had the retain flag
+     *   set, i.e. it was stored before this session subscribed
+     *
+     * Valid inside a subscription callback.
+     */
+    bool retained() const;
+
+    /**
+     * Publish a Message
+     * @param [in] topic topic name
+     * @param [in] payload message (NUL-terminated) or bytes
+     * @param [in] len payload length (bytes form only)
+     * @param [in] qos 0 or 1
+     * @param [in] retain set the retain flag
+     * @return true if the packet was sent
+     */
+    bool publish(const char *, const char *, uint8_t = 0, bool = false);
+    bool publish(const char *, const uint8_t *, size_t, uint8_t = 0, bool = false);
+
+    /**
+     * Publish a Structure
+     * @param [in] topic topic name
+     * @param [in] fields field table
+     * @param [in] count number of fields
+     * @param [in] base structure holding the values
+     * @param [in] format PAYLOAD_JSON or PAYLOAD_CBOR
+     * @param [in] retain set the retain flag
+     * @param [in] qos 0 or 1
+     * @param [in] tag reported to the acknowledgement callback (QoS 1)
+     * @return true if the packet was sent
+     *
+     * The payload length is computed first for the header, then the fields
+     * are streamed to the socket by payload_stream().
+     */
+    bool publishFields(const char *, const PayloadField *, size_t, const void *,
+        uint8_t = PAYLOAD_JSON, bool = false, uint8_t = 0, uint32_t = 0);
+
+    /**
+     * Publish a Payload Built in Place (QoS 0)
+     * @param [in] topic topic name
+     * @param [in] build payload builder
+     * @param [in] ctx context passed to the builder
+     * @param [in] retain set the retain flag
+     * @return true if the packet was sent
+     *
+     * The builder writes straight into the transmit buffer after the topic,
+     * for payloads whose length is not known up front; they are limited to
+     * what fits in MQTT_TX_BUFFER. Returns false without sending if the
+     * builder reports that the payload did not fit.
+     */
+    bool publishWith(const char *, PayloadBuilder, const void *, bool = false);
+
+    /**
+     * Publish a Streamed Payload (QoS 0)
+     * @param [in] topic topic name
+     * @param [in] write payload writer
+     * @param [in] ctx context passed to the writer
+     * @param [in] retain set the retain flag
+     * @return true if the packet was sent
+     *
+     * For payloads of any length that can be produced twice: the writer
+     * measures the payload, then streams it to the socket.
+     */
+    bool publishStream(const char *, PayloadStream, const void *, bool = false);
+
+    /**
+     * Start a PUBLISH Packet
+     * @param [in] topic topic name
+     * @param [in] len payload length
+     * @param [in] qos 0 or 1
+     * @param [in] retain set the retain flag
+     * @param [in] tag reported to the acknowledgement callback (QoS 1)
+     * @return true if the header was written; exactly len payload bytes
+     *   must follow through write(), then endPublish()
+     *
+     * At QoS 1 this waits for a free in-flight slot, reading PUBACKs, for up
+     * to MQTT_ACK_TIMEOUT_MS.
+     */
+    bool beginPublish(const char *, size_t, uint8_t = 0, bool = false, uint32_t = 0);
+
+    /** Write Payload Bytes of the Current PUBLISH */
+    bool write(const uint8_t *, size_t);
+
+    /**
+     * Finish the Current PUBLISH
+     * @return true if the whole packet was sent
+     *
+     * A packet cut short cannot be recovered, so the connection is closed.
+     */
+    bool endPublish();
+
+    /** PayloadSink writing to the Current PUBLISH of the Client in ctx */
+    static bool sink(void *, const uint8_t *, size_t);
+
+    /** QoS 1 Messages Awaiting PUBACK */
+    uint8_t inflight() const { return inflight_count; }
+
+    /**
+     * Wait for the In-Flight Messages
+     * @param [in] timeout_ms time (ms) to wait
+     * @return true if every QoS 1 message was acknowledged
+     */
+    bool drain(uint32_t);
+
+protected:
+    void reset();
+    bool send(const uint8_t *, size_t);
+    bool flush();
+    bool reserve();
+    void poll();
+    void handle();
+    void deliver();
+
+    Client * transport;
+    const char * host;
+    uint16_t port;
+    const char * client_id;
+    const char * user;
+    const char * pass;
+    uint16_t keepalive_s;
+
+    const MqttSubscription * subs[MQTT_MAX_SUBSCRIPTIONS];
+
+    // Transmit
+    uint8_t tx[MQTT_TX_BUFFER];
+    size_t tx_len;
+    size_t pub_remaining;       //< Payload bytes the current PUBLISH still needs
+    bool tx_ok;                 //< No write failed since the packet started
+    uint16_t packet_id;
+
+    // QoS 1 window
+    uint16_t inflight_ids[MQTT_INFLIGHT];
+    uint32_t inflight_tags[MQTT_INFLIGHT];
+    uint8_t inflight_count;
+    uint8_t window;
+    MqttAckCallback ack_cb;
+
+    // Receive
+    uint8_t rx[MQTT_RX_BUFFER + 1];     //< Packet body, room for a terminator
+    uint8_t rx_state;
+    uint8_t rx_header;          //< Fixed header of the current or last packet
+    uint8_t rx_shift;
+    uint32_t rx_len;            //< Remaining length of the current packet
+    uint32_t rx_got;            //< Body bytes read so far
+    int16_t connack;            //< CONNACK return code, or -1 until it arrives
+    bool dispatching;           //< A subscription callback is running
+
+    uint32_t rx_ms;             //< Time of the last inbound packet
+    uint32_t ping_ms;           //< Time the outstanding PINGREQ was sent
+    bool ping_pending;          //< A PINGREQ is waiting for a reply
+};
+
+#endif // MQTT_CLIENT_H__
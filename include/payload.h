@@ -0,0 +1,185 @@
+/** Air Quality Sensor - Table-Driven Payload Serializer */
+
+#ifndef PAYLOAD_H__
+#define PAYLOAD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aqi.h"
+#include "config.h"
+#include "i2cbus.h"
+#include "lowpower.h"
+#include "memstat.h"
+#include "sensor.h"
+#include "wlan.h"
+
+//! Payload Encodings
+#define PAYLOAD_JSON    0
+#define PAYLOAD_CBOR    1
+
+//! Largest Piece payload_stream() Stages (one key and value, with room to spare)
+#define PAYLOAD_PIECE_MAX   96
+
+//! Field Storage Types
+#define FIELD_INT16     0
+#define FIELD_UINT16    1
+#define FIELD_UINT32    2
+#define FIELD_STRING    3       //< const char * (written quoted, not escaped)
+
+/**
+ * Payload Field Descriptor
+ *
+ * Describes one member of a structure and how it is published. Integer
+ * fields with a precision of zero are written as-is; fields with a precision
+ * of one are divided by scale and written with one decimal place (see
+ * fixed_format1), and the type's invalid sentinel (INT16_MIN or UINT32_MAX)
+ * is written as nan. Fields with a name are also announced to Home Assistant
+ * by haDiscovery() (see discovery.h).
+ *
+ * In CBOR payloads the field is keyed by its id instead of the JSON key, so
+ * ids must stay stable once published.
+ */
+typedef struct {
+    const char * key;           //< JSON key
+    uint8_t key_len;            //< Length of the JSON key
+    uint8_t id;                 //< CBOR integer key (0 - 23)
+    uint8_t type;               //< FIELD_INT16 ... FIELD_STRING
+    uint8_t offset;             //< Offset of the value in the structure
+    uint8_t precision;          //< Decimal places (0 or 1)
+    uint16_t scale;             //< Fixed-point scale when precision is 1
+
+    // Home Assistant Discovery
+    const char * name;          //< Sensor name, or NULL if not announced
+    const char * units;         //< Unit of measurement
+    const char * device_class;  //< Device class, or NULL for none
+} PayloadField;
+
+//! Define a Payload Field
+#define PAYLOAD_FIELD(id, key, type, st, member, precision, scale, name, units, dc) \
+    { key, sizeof(key) - 1, id, type, offsetof(st, member), precision, scale, name, units, dc }
+
+//! Status Message Contents
+typedef struct {
+    const char * status;
+    SensorStatus sensor;
+    WlanStatus wlan;
+#ifdef LOW_POWER
+    LowPowerStatus power;
+#endif
+    MemoryStatus memory;
+    I2CBusStatus i2c;
+} StatusPayload;
+
+//! Queued Sample Contents
+typedef struct {
+    uint32_t timestamp;
+    SensorData data;
+} HistoryPayload;
+
+//! Sensor Data Fields (the data topic)
+extern const PayloadField data_fields[];
+extern const size_t data_field_count;
+
+//! Sensor Status Fields (the status topic)
+extern const PayloadField status_fields[];
+extern const size_t status_field_count;
+
+//! NowCast and AQI Fields (the aqi topic, from AqiStatus)
+extern const PayloadField aqi_fields[];
+extern const size_t aqi_field_count;
+
+//! Queued Sample Fields (the history topic: timestamp plus the data fields)
+extern const PayloadField history_fields[];
+extern const size_t history_field_count;
+
+/**
+ * Get the Exact Length of a JSON Payload
+ * @param [in] fields field table
+ * @param [in] count number of fields
+ * @param [in] base structure holding the values
+ * @return number of bytes payload_json will write
+ */
+size_t payload_json_length(const PayloadField *, size_t, const void *);
+
+/**
+ * Serialize a Structure as a JSON Object
+ * @param [out] out output buffer (at least payload_json_length bytes)
+ * @param [in] fields field table
+ * @param [in] count number of fields
+ * @param [in] base structure holding the values
+ * @return number of bytes written (no terminator is added)
+ */
+size_t payload_json(uint8_t *, const PayloadField *, size_t, const void *);
+
+/**
+ * Get the Exact Length of a CBOR Payload
+ * @param [in] fields field table (at most 23 fields)
+ * @param [in] count number of fields
+ * @param [in] base structure holding the values
+ * @return number of bytes payload_cbor will write
+ */
+size_t payload_cbor_length(const PayloadField *, size_t, const void *);
+
+/**
+ * Serialize a Structure as a CBOR Map (RFC 8949)
+ * @param [out] out output buffer (at least payload_cbor_length bytes)
+ * @param [in] fields field table (at most 23 fields)
+ * @param [in] count number of fields
+ * @param [in] base structure holding the values
+ * @return number of bytes written
+ *
+ * The map is keyed by field id. Integers are written in their shortest form
+ * and strings as text strings. Fields with a precision of one are written as
+ * decimal fractions (tag 4) of [-1, tenths], rounded exactly as in the JSON
+ * payload, and invalid values as a half-precision NaN.
+ */
+size_t payload_cbor(uint8_t *, const PayloadField *, size_t, const void *);
+
+/**
+ * Get the Exact Length of a Payload
+ * @param [in] format PAYLOAD_JSON or PAYLOAD_CBOR
+ * @param [in] fields field table
+ * @param [in] count number of fields
+ * @param [in] base structure holding the values
+ * @return number of bytes payload_encode will write
+ */
+size_t payload_length(uint8_t, const PayloadField *, size_t, const void *);
+
+/**
+ * Serialize a Structure
+ * @param [in] format PAYLOAD_JSON or PAYLOAD_CBOR
+ * @param [out] out output buffer (at least payload_length bytes)
+ * @param [in] fields field table
+ * @param [in] count number of fields
+ * @param [in] base structure holding the values
+ * @return number of bytes written
+ */
+size_t payload_encode(uint8_t, uint8_t *, const PayloadField *, size_t, const void *);
+
+/**
+ * Payload Output Stream
+ * @param [in] ctx sink context
+ * @param [in] data next piece of the payload
+ * @param [in] len piece length
+ * @return false to abandon the payload
+ */
+typedef bool (*PayloadSink)(void *, const uint8_t *, size_t);
+
+/**
+ * Serialize a Structure to a Stream
+ * @param [in] format PAYLOAD_JSON or PAYLOAD_CBOR
+ * @param [in] sink output stream
+ * @param [in] ctx context passed to the sink
+ * @param [in] fields field table
+ * @param [in] count number of fields
+ * @param [in] base structure holding the values
+ * @return true if the sink took the whole payload
+ *
+ * Produces the same bytes as payload_encode() (payload_length() of them)
+ * without an output buffer: fields are staged a few at a time in a small
+ * buffer on the stack, and string values are passed to the sink directly.
+ */
+bool payload_stream(uint8_t, PayloadSink, void *, const PayloadField *, size_t, const void *);
+
+#endif // PAYLOAD_H__
@@ -0,0 +1,96 @@
+/** Air Quality Sensor - Offline Sample Queue */
+
+#ifndef QUEUE_H__
+#define QUEUE_H__
+
+#include <stdint.h>
+
+#include "sensor.h"
+
+//! Offline Queue Status
+typedef struct {
+    uint32_t pending;           //< Samples waiting to be replayed
+    uint32_t capacity;          //< Maximum number of queued samples
+    uint32_t dropped;           //< Samples overwritten before replay
+    uint32_t corrupt;           //< Records skipped with a bad checksum
+} QueueStatus;
+
+//! Global Queue Status
+extern const QueueStatus * queue_status;
+
+/**
+ * Initialize the Offline Queue
+ * @return zero on success, ERROR_QUEUE_FLASH if the flash could not be read,
+ *   or ERROR_QUEUE_DISABLED if the sectors do not fit in the filesystem area
+ *
+ * The queue is a ring of fixed-size records in the first QUEUE_SECTORS flash
+ * sectors of the filesystem area. If the board's flash layout leaves fewer
+ * sectors than that, the queue stays empty with zero capacity and samples
+ * are not stored. Every record carries a sequence number and
+ * checksum, so the head and tail are recovered by scanning the sectors on
+ * boot, and a record torn by a reset mid-write is skipped rather than
+ * replayed.
+ */
+int queue_init();
+
+/**
+ * Queue a Sample
+ * @param [in] data sensor data
+ * @param [in] timestamp sample time (seconds since the epoch, or 0 if unknown)
+ * @return zero on success, ERROR_QUEUE_FLASH if the write failed, or
+ *   ERROR_QUEUE_DISABLED
+ *
+ * When the ring is full the oldest sector is erased and its samples are
+ * dropped.
+ */
+int queue_push(const SensorData *, uint32_t);
+
+/**
+ * Get the Oldest Queued Sample
+ * @param [out] data sensor data
+ * @param [out] timestamp sample time
+ * @return zero on success, or ERROR_QUEUE_EMPTY if nothing is queued
+ */
+int queue_peek(SensorData *, uint32_t *);
+
+/**
+ * Remove the Oldest Queued Sample
+ * @return zero on success, or non-zero if nothing is queued or the write failed
+ *
+ * Marks the record consumed in place without erasing. A reset between a
+ * publish and this call replays that sample again after boot.
+ */
+int queue_pop();
+
+/**
+ * Get the Next Sample to Replay
+ * @param [out] data sensor data
+ * @param [out] timestamp sample time
+ * @param [out] seq record sequence number, for queue_ack()
+ * @return zero on success, or ERROR_QUEUE_EMPTY if every queued sample has
+ *   been handed out
+ *
+ * Steps a replay cursor past the sample, so several can be in flight at
+ * once. The sample stays queued until it is acknowledged.
+ */
+int queue_next(SensorData *, uint32_t *, uint32_t *);
+
+/**
+ * Acknowledge a Replayed Sample
+ * @param [in] seq sequence number from queue_next()
+ * @return zero on success, or non-zero if the sample is no longer queued or
+ *   the write failed
+ *
+ * Marks the record consumed as queue_pop() does, in any order.
+ */
+int queue_ack(uint32_t);
+
+/**
+ * Replay Again from the Oldest Queued Sample
+ *
+ * Called when samples handed out by queue_next() may not have reached the
+ * broker (a dropped connection), so they are handed out again.
+ */
+void queue_rewind();
+
+#endif // QUEUE_H__
@@ -0,0 +1,55 @@
+/** Air Quality Sensor - Report-by-Exception Publishing */
+
+#ifndef REPORT_H__
+#define REPORT_H__
+
+#include <stdint.h>
+
+#include "config.h"
+#include "sensor.h"
+
+//! Samples in the Spike Rejection Filter
+#define REPORT_FILTER   5
+
+//! Report-by-Exception State
+typedef struct {
+    SensorData recent[REPORT_FILTER];   //< Latest raw samples (ring buffer)
+    SensorData current;         //< Filtered current value
+    SensorData reported;        //< Value last published or queued
+    uint8_t head;
+    uint8_t count;
+    uint8_t has_reported;
+} ReportState;
+
+/**
+ * Reset the Report-by-Exception State
+ * @param [out] state report state
+ */
+void report_reset(ReportState *);
+
+/**
+ * Add a Sample and Check the Deadbands
+ * @param [in,out] state report state
+ * @param [in] data sensor sample
+ * @return bitmask of the fields (in data_fields order) whose filtered value
+ *   has moved past its deadband since the last report, or all fields if
+ *   nothing has been reported yet
+ *
+ * Each field is filtered with a median of the last REPORT_FILTER samples,
+ * so spikes shorter than half the filter never trigger a report, and a real
+ * step is seen REPORT_FILTER / 2 samples later. The deadband of a field is
+ * the larger of its absolute and relative (percent of the reported value)
+ * thresholds from config.h; a field with both set to zero never triggers. A
+ * change between a valid and an invalid reading always does.
+ */
+uint32_t report_push(ReportState *, const SensorData *);
+
+/**
+ * Mark the Current Value as Reported
+ * @param [in,out] state report state
+ *
+ * Call after state->current was published or queued.
+ */
+void report_sent(ReportState *);
+
+#endif // REPORT_H__
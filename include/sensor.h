@@ -4,31 +4,108 @@
 #define SENSOR_H__
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+//! poll_sensors() Result while Conversions are Running
+#define SENSOR_PENDING      (-1)
+
+//! poll_sensor() Result if no Read was Started
+#define SENSOR_IDLE         (-2)
+
+//! Sensor Devices (bit positions in SensorStatus.stale)
+#define SENSOR_BME280       0   //< Temperature, pressure and humidity
+#define SENSOR_SGP30        1   //< TVOC and eCO2
+#define SENSOR_PMS5003      2   //< PM and particle counts
+#define SENSOR_COUNT        3
+
+//! Sensors in this Build (1 << SENSOR_*; see NO_BME280 and NO_PMS5003)
+#ifdef NO_BME280
+#define SENSOR_FITTED_BME280    0
+#else
+#define SENSOR_FITTED_BME280    (1 << SENSOR_BME280)
+#endif
+#ifdef NO_PMS5003
+#define SENSOR_FITTED_PMS5003   0
+#else
+#define SENSOR_FITTED_PMS5003   (1 << SENSOR_PMS5003)
+#endif
+#define SENSOR_FITTED       (SENSOR_FITTED_BME280 | (1 << SENSOR_SGP30) | SENSOR_FITTED_PMS5003)
+
+//! Invalid BME280 Readings
+#define SENSOR_T_INVALID    INT16_MIN
+#define SENSOR_P_INVALID    UINT32_MAX
+#define SENSOR_RH_INVALID   UINT32_MAX
 
-//! Sensor Data Structure
-typedef struct {
-    // BME280
-    double temperature;
-    double pressure;
-    double humidity;
-
-    // SGP30
-    uint16_t tvoc;
-    uint16_t eCO2;
-
-    // PMS5003I PM
-    uint16_t pm10;
-    uint16_t pm25;
-    uint16_t pm100;
-
-    // PMS5003I Particle Count
-    uint16_t pc03;
-    uint16_t pc05;
-    uint16_t pc10;
-    uint16_t pc25;
-    uint16_t pc50;
-    uint16_t pc100;
+/**
+ * Channels of each Sensor
+ *
+ *   X(channel, member, type, invalid, id, key, field, precision, scale,
+ *     name, units, class, deadband)
+ *
+ * channel names the AGG_* index, member and type the SensorData member,
+ * and invalid the reading the sensor reports when a value is missing
+ * (INT32_MIN if it always reports one). id through class are the
+ * PAYLOAD_FIELD() columns, and deadband is the DEADBAND_* pair for
+ * report-by-exception. A sensor left out of the build has no channels, so
+ * the structure, the aggregation window, the payload tables and the
+ * deadbands all follow this list without a check of their own.
+ */
+#ifdef NO_BME280
+#define BME280_CHANNELS(X)
+#else
+#define BME280_CHANNELS(X) \
+    X(T, temperature, int16_t, SENSOR_T_INVALID, 0, "t", FIELD_INT16, 1, 100, "temperature", "°C", "temperature", DEADBAND_T) \
+    X(P, pressure, uint32_t, (int32_t)SENSOR_P_INVALID, 1, "p", FIELD_UINT32, 1, 256, "pressure", "Pa", "pressure", DEADBAND_P) \
+    X(RH, humidity, uint32_t, (int32_t)SENSOR_RH_INVALID, 2, "rh", FIELD_UINT32, 1, 1024, "humidity", "%", "humidity", DEADBAND_RH)
+#endif
+
+#define SGP30_CHANNELS(X) \
+    X(TVOC, tvoc, uint16_t, INT32_MIN, 3, "tvoc", FIELD_UINT16, 0, 1, "tvoc", "ppb", NULL, DEADBAND_TVOC) \
+    X(ECO2, eCO2, uint16_t, INT32_MIN, 4, "co2", FIELD_UINT16, 0, 1, "eco2", "ppm", "carbon_dioxide", DEADBAND_ECO2)
+
+#ifdef NO_PMS5003
+#define PMS5003_CHANNELS(X)
+#else
+#define PMS5003_CHANNELS(X) \
+    X(PM10, pm10, uint16_t, INT32_MIN, 5, "pm10", FIELD_UINT16, 0, 1, "pm10", "µg/m³", NULL, DEADBAND_PM) \
+    X(PM25, pm25, uint16_t, INT32_MIN, 6, "pm25", FIELD_UINT16, 0, 1, "pm25", "µg/m³", NULL, DEADBAND_PM) \
+    X(PM100, pm100, uint16_t, INT32_MIN, 7, "pm100", FIELD_UINT16, 0, 1, "pm100", "µg/m³", NULL, DEADBAND_PM) \
+    X(PC03, pc03, uint16_t, INT32_MIN, 8, "particles03", FIELD_UINT16, 0, 1, NULL, NULL, NULL, DEADBAND_PARTICLES) \
+    X(PC05, pc05, uint16_t, INT32_MIN, 9, "particles05", FIELD_UINT16, 0, 1, NULL, NULL, NULL, DEADBAND_PARTICLES) \
+    X(PC10, pc10, uint16_t, INT32_MIN, 10, "particles10", FIELD_UINT16, 0, 1, NULL, NULL, NULL, DEADBAND_PARTICLES) \
+    X(PC25, pc25, uint16_t, INT32_MIN, 11, "particles25", FIELD_UINT16, 0, 1, NULL, NULL, NULL, DEADBAND_PARTICLES) \
+    X(PC50, pc50, uint16_t, INT32_MIN, 12, "particles50", FIELD_UINT16, 0, 1, NULL, NULL, NULL, DEADBAND_PARTICLES) \
+    X(PC100, pc100, uint16_t, INT32_MIN, 13, "particles100", FIELD_UINT16, 0, 1, NULL, NULL, NULL, DEADBAND_PARTICLES)
+#endif
+
+//! Channels of the Fitted Sensors, in payload order
+#define SENSOR_CHANNELS(X) \
+    BME280_CHANNELS(X) \
+    SGP30_CHANNELS(X) \
+    PMS5003_CHANNELS(X)
+
+// SensorData members, 32-bit channels first so the structure has no padding
+#define SENSOR_MEMBER_WIDE(ch, member, type, ...)   SENSOR_WIDE_##type(member)
+#define SENSOR_MEMBER_NARROW(ch, member, type, ...) SENSOR_NARROW_##type(member)
+#define SENSOR_WIDE_uint32_t(m)     uint32_t m;
+#define SENSOR_WIDE_uint16_t(m)
+#define SENSOR_WIDE_int16_t(m)
+#define SENSOR_NARROW_uint32_t(m)
+#define SENSOR_NARROW_uint16_t(m)   uint16_t m;
+#define SENSOR_NARROW_int16_t(m)    int16_t m;
 
+/**
+ * Sensor Data Structure (the channels of the fitted sensors)
+ *
+ * BME280 readings are fixed point at the sensor's native resolution:
+ * pressure in 1/256 Pa (Q24.8), humidity in 1/1024 %RH (Q22.10) and
+ * temperature in 0.01 °C.
+ */
+typedef struct {
+    SENSOR_CHANNELS(SENSOR_MEMBER_WIDE)
+    SENSOR_CHANNELS(SENSOR_MEMBER_NARROW)
 } SensorData;
 
 //! Sensor Status Structure
@@ -41,6 +118,10 @@ typedef struct {
     uint32_t sgp30_errors;
     uint32_t pms5003_errors;
 
+    // Sensors whose last read failed (1 << SENSOR_*); their channels hold
+    // the invalid values (BME280) or the last good reading
+    uint16_t stale;
+
 } SensorStatus;
 
 //! Global Sensor Status
@@ -55,10 +136,61 @@ extern const SensorStatus * sensor_status;
  * Initializes the air quality sensor suite and sets the module serial number,
  * which is read from the SGP30 sensor. The serial number is a formatted 
  * 12-character hex string, so the character buffer should be at least 13 bytes
- * in length.
+ * in length. Only the sensors in SENSOR_FITTED are set up (see
+ * sensor_driver.h).
  */
 int setup_sensors(char *, size_t);
 
+/**
+ * Start a Read of one Sensor
+ * @param [in] sensor SENSOR_* device
+ * @return zero if the read was started, SENSOR_PENDING if the previous
+ *   read of this sensor has not been collected yet, or 1 if the sensor is
+ *   not fitted
+ *
+ * Each sensor runs its own start/poll/collect sequence, so the firmware can
+ * read them on separate schedules. Call poll_sensor() until it stops
+ * returning SENSOR_PENDING.
+ */
+int start_sensor(uint8_t);
+
+/**
+ * Advance a Read of one Sensor
+ * @param [in] sensor SENSOR_* device
+ * @param [out] data current sensor data (only this sensor's channels are written)
+ * @return SENSOR_PENDING while the read is running, SENSOR_IDLE if no read
+ *   was started, zero once the values were collected, or the sensor's error
+ *   bit as for read_sensors()
+ *
+ * A call performs at most one short I2C step. The sensor's bit in
+ * SensorStatus.stale is set when a read fails and cleared when one succeeds.
+ */
+int poll_sensor(uint8_t, SensorData *);
+
+/**
+ * Start a Sensor Read
+ * @return zero if the conversions were started, or SENSOR_PENDING if the
+ *   previous read has not been collected yet
+ *
+ * Starts a read of every fitted sensor with start_sensor(): a BME280 forced-mode
+ * conversion, the SGP30 humidity update that precedes each IAQ measurement,
+ * and a PMS5003 frame read. Call poll_sensors() until it stops returning
+ * SENSOR_PENDING.
+ */
+int start_sensors();
+
+/**
+ * Advance a Sensor Read
+ * @param [out] data current sensor data
+ * @return SENSOR_PENDING while conversions are running, zero once every value
+ *   was collected, or an error bitmask as for read_sensors()
+ *
+ * A call performs at most one short I2C step across all sensors, so it never
+ * waits out a conversion. Values are written to the output structure as each
+ * sensor is collected.
+ */
+int poll_sensors(SensorData *);
+
 /**
  * Read Sensor Data
  * @param [out] data current sensor data
@@ -67,12 +199,30 @@ int setup_sensors(char *, size_t);
  * Reads and copies the current sensor data into the output data structure. The
  * return value on failure is a bitmask of ERROR_SGP30_READ_FAILED and
  * ERROR_PMS3003_READ_FAILED (or 1, indicating an invalid argument).
+ *
+ * This runs start_sensors() and poll_sensors() to completion and blocks for
+ * the whole conversion; the firmware drives the split-phase calls from the
+ * task scheduler instead.
  */
 int read_sensors(SensorData *);
 
-/** Read Current Sensor Baselines */
+/** Read Current Sensor Baselines and Store them in the Flash Journal */
 int read_baselines();
 
+/** Read Current Sensor Baselines into the Status without Storing them */
+int fetch_baselines();
+
+/**
+ * Set the Sensor Baselines
+ * @param [in] eco2 eCO2 baseline
+ * @param [in] tvoc TVOC baseline
+ * @return zero on success, or ERROR_SGP30_BASELINE
+ *
+ * Restores baselines kept elsewhere than the journal (across deep sleep);
+ * the stored copy is not changed.
+ */
+int set_baselines(uint16_t, uint16_t);
+
 /** Reset Sensor Baseline */
 int reset_baselines();
 
@@ -0,0 +1,81 @@
+/** Air Quality Sensor - Sensor Driver Registry */
+
+#ifndef SENSOR_DRIVER_H__
+#define SENSOR_DRIVER_H__
+
+#include <stdint.h>
+
+#include "i2cbus.h"
+#include "sensor.h"
+
+/**
+ * Compile-Time Sensor List
+ *
+ * Each driver is a class with only static members:
+ *
+ *   static const uint8_t id;               SENSOR_* device
+ *   static int begin();                    probe and configure at boot,
+ *                                          returning zero or an ERROR_* code
+ *   static bool reinit();                  configure again after a bus
+ *                                          recovery (see I2CBusReinit)
+ *   static void start();                   start a read
+ *   static bool poll(SensorData * data);   take the read's next I2C step if
+ *                                          it is due, returning true if one
+ *                                          was taken
+ *
+ * The list is a type, so every call through it is resolved when the
+ * firmware is built: the read loop calls each driver directly, with nothing
+ * looked up per read, and a sensor that is not in the list costs no code.
+ * Drivers are called in list order, which is also the order of their I2C
+ * steps when several are due at once.
+ */
+template <typename... Drivers>
+struct SensorList {
+    //! Sensors in the List (1 << SENSOR_*)
+    static constexpr uint16_t fitted = (0 | ... | (1 << Drivers::id));
+
+    /** Register each Sensor's Re-Initialisation with the Bus Manager */
+    static void attach() {
+        (i2cbus_attach(Drivers::id, Drivers::reinit), ...);
+    }
+
+    /**
+     * Set up the Sensors
+     * @return zero, or the ERROR_* code of the first sensor that failed
+     */
+    static int begin() {
+        int ret = 0;
+        (void)(((ret = Drivers::begin()) == 0) && ...);
+        return ret;
+    }
+
+    /**
+     * Start a Read of one Sensor
+     * @param [in] sensor SENSOR_* device
+     * @return false if the sensor is not in the list
+     */
+    static bool start(uint8_t sensor) {
+        return ((sensor == Drivers::id && (Drivers::start(), true)) || ...);
+    }
+
+    /**
+     * Advance a Read of one Sensor
+     * @param [in] sensor SENSOR_* device
+     * @param [out] data current sensor data
+     * @return true if an I2C step was taken
+     */
+    static bool poll(uint8_t sensor, SensorData * data) {
+        return ((sensor == Drivers::id && Drivers::poll(data)) || ...);
+    }
+
+    /**
+     * Advance the First Sensor with a Step Due
+     * @param [out] data current sensor data
+     * @return true if an I2C step was taken
+     */
+    static bool step(SensorData * data) {
+        return (Drivers::poll(data) || ...);
+    }
+};
+
+#endif // SENSOR_DRIVER_H__
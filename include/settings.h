@@ -0,0 +1,81 @@
+/** Air Quality Sensor - Runtime Settings */
+
+#ifndef SETTINGS_H__
+#define SETTINGS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+//! Setting Identifiers (index into setting_fields)
+#define SETTING_SAMPLE_INTERVAL     0
+#define SETTING_PUBLISH_INTERVAL    1
+#define SETTING_BASELINE_INTERVAL   2
+#define SETTING_BME280_INTERVAL     3
+#define SETTING_PMS5003_INTERVAL    4
+
+//! Runtime Settings (defaults from config.h)
+typedef struct {
+    uint16_t sample_interval;   //< Sample task interval (s)
+    uint16_t publish_interval;  //< Data publish interval, or the heartbeat with PUBLISH_ON_CHANGE (s)
+    uint16_t baseline_interval; //< SGP30 baseline read interval (min)
+    uint16_t bme280_interval;   //< BME280 read interval (s)
+    uint16_t pms5003_interval;  //< PMS5003 read interval (s)
+} Settings;
+
+//! Setting Descriptor
+typedef struct {
+    const char * name;          //< Name used by the set and get commands
+    size_t offset;              //< Offset in Settings
+    uint16_t min;
+    uint16_t max;
+} SettingField;
+
+//! Setting Change Callback (receives the SETTING_* identifier)
+typedef void (*setting_cb)(uint8_t);
+
+//! Global Runtime Settings
+extern const Settings * settings;
+
+//! Setting Descriptors, by SETTING_* Identifier
+extern const SettingField setting_fields[];
+extern const size_t setting_field_count;
+
+/**
+ * Load the Settings
+ * @param [in] on_change called after a setting is changed, or NULL
+ *
+ * Reads the settings stored by settings_set() from EEPROM. The defaults from
+ * config.h are used if nothing was stored, the record fails its checksum, or
+ * a value is out of range.
+ */
+void settings_init(setting_cb);
+
+/**
+ * Find a Setting by Name
+ * @param [in] name setting name (not case sensitive)
+ * @return SETTING_* identifier, or -1 if there is no such setting
+ */
+int settings_find(const char *);
+
+/**
+ * Get a Setting
+ * @param [in] id SETTING_* identifier
+ * @return current value
+ */
+uint16_t settings_get(uint8_t);
+
+/**
+ * Change a Setting
+ * @param [in] id SETTING_* identifier
+ * @param [in] value new value
+ * @return zero if the setting was changed, or ERROR_SETTING_RANGE
+ *
+ * The settings are committed to EEPROM only when a value actually changes,
+ * and EEPROM_Rotate spreads the commits over its sectors. The change
+ * callback runs after the commit.
+ */
+int settings_set(uint8_t, uint32_t);
+
+#endif // SETTINGS_H__
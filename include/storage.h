@@ -0,0 +1,31 @@
+/** Air Quality Sensor - EEPROM, Flash and RTC Memory Layout */
+
+#ifndef STORAGE_H__
+#define STORAGE_H__
+
+#include "EEPROM_Rotate.h"
+
+#include "config.h"
+
+//! EEPROM Rotation (sectors) and Emulated Size (bytes)
+#define EEPROM_SECTORS          2
+#define EEPROM_SIZE             4096
+
+//! EEPROM Addresses (the first bytes are used by EEPROM_Rotate)
+#define EEPROM_ADDR_ECO2        4   //< SGP30 eCO2 baseline (uint16_t, moved to the journal)
+#define EEPROM_ADDR_TVOC        6   //< SGP30 TVOC baseline (uint16_t, moved to the journal)
+#define EEPROM_ADDR_DISCOVERY   8   //< Last published discovery hash (uint32_t)
+#define EEPROM_ADDR_SETTINGS    12  //< Runtime settings (settings.cpp)
+
+//! Flash Filesystem Area (sectors from FS_PHYS_ADDR; the offline queue
+//! uses the first QUEUE_SECTORS)
+#define FLASH_SECTOR_JOURNAL    QUEUE_SECTORS   //< Baseline journal (JOURNAL_SECTORS)
+
+//! RTC User Memory (4-byte blocks; the first 32 hold the OTA boot command)
+#define RTC_USER_BLOCKS         128
+#define RTC_BLOCK_LOWPOWER      32  //< Deep-sleep state (LowPowerState)
+
+//! Shared EEPROM (open with begin() and close with end() around each use)
+extern EEPROM_Rotate eeprom;
+
+#endif // STORAGE_H__
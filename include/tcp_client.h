@@ -0,0 +1,52 @@
+/** Air Quality Sensor - Non-Blocking TCP Client */
+
+#ifndef TCP_CLIENT_H__
+#define TCP_CLIENT_H__
+
+#include <stdint.h>
+
+#include <ESP8266WiFi.h>
+
+//! connectPoll() Result while the Lookup or Handshake is Running
+#define TCP_CONNECT_PENDING     0
+
+/**
+ * WiFiClient that Opens its Connection without Blocking
+ *
+ * WiFiClient::connect() waits in the core for the DNS lookup and the TCP
+ * handshake. This client starts both with the lwIP callback API instead and
+ * is polled until the connection is open; from then on it is an ordinary
+ * WiFiClient. There is no timeout of its own: the caller gives up with
+ * stop(), which also abandons a pending lookup.
+ *
+ * On the host the handshake takes one simulated round trip, and a broker
+ * that is offline leaves it pending for sim_broker.timeout_ms.
+ */
+class TcpClient : public WiFiClient {
+public:
+    TcpClient() : _state(0), _port(0), _since(0) { }
+
+    /**
+     * Start Connecting
+     * @param [in] host server name or address
+     * @param [in] port server port
+     * @return true if the lookup or handshake was started
+     */
+    bool connectStart(const char *, uint16_t);
+
+    /**
+     * Check the Connection without Waiting
+     * @return 1 once the connection is open, TCP_CONNECT_PENDING while it is
+     *   being opened, or -1 if it failed
+     */
+    int8_t connectPoll();
+
+protected:
+    bool open(const IPAddress &);
+
+    uint8_t _state;             //< Step of the connection being opened
+    uint16_t _port;
+    uint32_t _since;            //< Time (ms) the connection was started
+};
+
+#endif // TCP_CLIENT_H__
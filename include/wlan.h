@@ -0,0 +1,43 @@
+/** Air Quality Sensor - WiFi Link Supervisor */
+
+#ifndef WLAN_H__
+#define WLAN_H__
+
+#include <stdint.h>
+
+//! WiFi Link Status
+typedef struct {
+    uint8_t up;                 //< Link is associated and has an address
+    uint32_t reconnects;        //< Links re-established after a loss
+    uint32_t offline_s;         //< Total seconds without a link since boot
+} WlanStatus;
+
+//! Global WiFi Link Status
+extern const WlanStatus * wlan_status;
+
+/**
+ * Start the WiFi Link
+ * @return zero if the station was started, or non-zero if an error occurred
+ *
+ * Starts association with the configured access point and returns without
+ * waiting for it to complete. SNTP is configured here as well; it syncs in
+ * the background once the link comes up.
+ */
+int setup_wlan();
+
+/**
+ * Supervise the WiFi Link
+ *
+ * Called periodically from the task scheduler. Tracks link transitions and
+ * offline time, and restarts association every WIFI_RETRY_INTERVAL seconds
+ * while the link stays down. Never waits on the radio.
+ */
+void check_wlan();
+
+/**
+ * Check the WiFi Link
+ * @return true if the station is associated (no network traffic)
+ */
+bool connected_wlan();
+
+#endif // WLAN_H__
@@ -0,0 +1,235 @@
+/** Native Adafruit BME280 Driver Stand-In */
+
+#include "Adafruit_BME280.h"
+
+Adafruit_BME280::Adafruit_BME280()
+    : _wire(NULL), i2c_dev(NULL), _i2caddr(BME280_ADDRESS), _sensorID(0), t_fine(0), t_fine_adjust(0) {
+}
+
+Adafruit_BME280::~Adafruit_BME280() {
+    delete i2c_dev;
+}
+
+bool Adafruit_BME280::begin(uint8_t addr, TwoWire * theWire) {
+    delete i2c_dev;
+
+    _i2caddr = addr;
+    _wire = theWire;
+    i2c_dev = new Adafruit_I2CDevice(addr, theWire);
+    if (!i2c_dev->begin()) {
+        return false;
+    }
+
+    return init();
+}
+
+bool Adafruit_BME280::init() {
+    _sensorID = read8(BME280_REGISTER_CHIPID);
+    if (_sensorID != 0x60) {
+        return false;
+    }
+
+    write8(BME280_REGISTER_SOFTRESET, 0xB6);
+    delay(10);
+
+    while (isReadingCalibration()) {
+        delay(10);
+    }
+
+    readCoefficients();
+    setSampling();
+    delay(100);
+
+    return true;
+}
+
+void Adafruit_BME280::setSampling(sensor_mode mode, sensor_sampling tempSampling,
+    sensor_sampling pressSampling, sensor_sampling humSampling,
+    sensor_filter filter, standby_duration duration)
+{
+    _measReg.mode = mode;
+    _measReg.osrs_t = tempSampling;
+    _measReg.osrs_p = pressSampling;
+
+    _humReg.osrs_h = humSampling;
+    _configReg.filter = filter;
+    _configReg.t_sb = duration;
+    _configReg.spi3w_en = 0;
+
+    // Settings only take effect in sleep mode
+    write8(BME280_REGISTER_CONTROL, MODE_SLEEP);
+    write8(BME280_REGISTER_CONTROLHUMID, _humReg.get());
+    write8(BME280_REGISTER_CONFIG, _configReg.get());
+    write8(BME280_REGISTER_CONTROL, _measReg.get());
+}
+
+bool Adafruit_BME280::takeForcedMeasurement() {
+    bool return_value = false;
+
+    if (_measReg.mode == MODE_FORCED) {
+        return_value = true;
+        write8(BME280_REGISTER_CONTROL, _measReg.get());
+
+        uint32_t timeout_start = millis();
+        while (read8(BME280_REGISTER_STATUS) & 0x08) {
+            if ((millis() - timeout_start) > 2000) {
+                return_value = false;
+                break;
+            }
+            delay(1);
+        }
+    }
+
+    return return_value;
+}
+
+void Adafruit_BME280::write8(byte reg, byte value) {
+    uint8_t buffer[2] = { reg, value };
+    i2c_dev->write(buffer, 2);
+}
+
+uint8_t Adafruit_BME280::read8(byte reg) {
+    uint8_t buffer[1] = { reg };
+    i2c_dev->write_then_read(buffer, 1, buffer, 1);
+    return buffer[0];
+}
+
+uint16_t Adafruit_BME280::read16(byte reg) {
+    uint8_t buffer[2] = { reg, 0 };
+    i2c_dev->write_then_read(buffer, 1, buffer, 2);
+    return (uint16_t)(buffer[0] << 8) | buffer[1];
+}
+
+uint32_t Adafruit_BME280::read24(byte reg) {
+    uint8_t buffer[3] = { reg, 0, 0 };
+    i2c_dev->write_then_read(buffer, 1, buffer, 3);
+    return ((uint32_t)buffer[0] << 16) | ((uint32_t)buffer[1] << 8) | buffer[2];
+}
+
+int16_t Adafruit_BME280::readS16(byte reg) {
+    return (int16_t)read16(reg);
+}
+
+uint16_t Adafruit_BME280::read16_LE(byte reg) {
+    uint16_t temp = read16(reg);
+    return (temp >> 8) | (temp << 8);
+}
+
+int16_t Adafruit_BME280::readS16_LE(byte reg) {
+    return (int16_t)read16_LE(reg);
+}
+
+bool Adafruit_BME280::isReadingCalibration() {
+    return (read8(BME280_REGISTER_STATUS) & (1 << 0)) != 0;
+}
+
+void Adafruit_BME280::readCoefficients() {
+    _bme280_calib.dig_T1 = read16_LE(BME280_REGISTER_DIG_T1);
+    _bme280_calib.dig_T2 = readS16_LE(BME280_REGISTER_DIG_T2);
+    _bme280_calib.dig_T3 = readS16_LE(BME280_REGISTER_DIG_T3);
+
+    _bme280_calib.dig_P1 = read16_LE(BME280_REGISTER_DIG_P1);
+    _bme280_calib.dig_P2 = readS16_LE(BME280_REGISTER_DIG_P2);
+    _bme280_calib.dig_P3 = readS16_LE(BME280_REGISTER_DIG_P3);
+    _bme280_calib.dig_P4 = readS16_LE(BME280_REGISTER_DIG_P4);
+    _bme280_calib.dig_P5 = readS16_LE(BME280_REGISTER_DIG_P5);
+    _bme280_calib.dig_P6 = readS16_LE(BME280_REGISTER_DIG_P6);
+    _bme280_calib.dig_P7 = readS16_LE(BME280_REGISTER_DIG_P7);
+    _bme280_calib.dig_P8 = readS16_LE(BME280_REGISTER_DIG_P8);
+    _bme280_calib.dig_P9 = readS16_LE(BME280_REGISTER_DIG_P9);
+
+    _bme280_calib.dig_H1 = read8(BME280_REGISTER_DIG_H1);
+    _bme280_calib.dig_H2 = readS16_LE(BME280_REGISTER_DIG_H2);
+    _bme280_calib.dig_H3 = read8(BME280_REGISTER_DIG_H3);
+    _bme280_calib.dig_H4 = ((int8_t)read8(BME280_REGISTER_DIG_H4) << 4) |
+        (read8(BME280_REGISTER_DIG_H4 + 1) & 0xF);
+    _bme280_calib.dig_H5 = ((int8_t)read8(BME280_REGISTER_DIG_H5 + 1) << 4) |
+        (read8(BME280_REGISTER_DIG_H5) >> 4);
+    _bme280_calib.dig_H6 = (int8_t)read8(BME280_REGISTER_DIG_H6);
+}
+
+float Adafruit_BME280::readTemperature() {
+    int32_t var1, var2;
+
+    int32_t adc_T = read24(BME280_REGISTER_TEMPDATA);
+    if (adc_T == 0x800000) {
+        return NAN;
+    }
+    adc_T >>= 4;
+
+    var1 = (int32_t)((adc_T / 8) - ((int32_t)_bme280_calib.dig_T1 * 2));
+    var1 = (var1 * ((int32_t)_bme280_calib.dig_T2)) / 2048;
+    var2 = (int32_t)((adc_T / 16) - ((int32_t)_bme280_calib.dig_T1));
+    var2 = (((var2 * var2) / 4096) * ((int32_t)_bme280_calib.dig_T3)) / 16384;
+
+    t_fine = var1 + var2 + t_fine_adjust;
+
+    int32_t T = (t_fine * 5 + 128) / 256;
+
+    return (float)T / 100;
+}
+
+float Adafruit_BME280::readPressure() {
+    int64_t var1, var2, var3, var4;
+
+    readTemperature(); // must be done first to get t_fine
+
+    int32_t adc_P = read24(BME280_REGISTER_PRESSUREDATA);
+    if (adc_P == 0x800000) {
+        return NAN;
+    }
+    adc_P >>= 4;
+
+    var1 = ((int64_t)t_fine) - 128000;
+    var2 = var1 * var1 * (int64_t)_bme280_calib.dig_P6;
+    var2 = var2 + ((var1 * (int64_t)_bme280_calib.dig_P5) * 131072);
+    var2 = var2 + (((int64_t)_bme280_calib.dig_P4) * 34359738368);
+    var1 = ((var1 * var1 * (int64_t)_bme280_calib.dig_P3) / 256) +
+        ((var1 * ((int64_t)_bme280_calib.dig_P2) * 4096));
+    var3 = ((int64_t)1) * 140737488355328;
+    var1 = (var3 + var1) * ((int64_t)_bme280_calib.dig_P1) / 8589934592;
+
+    if (var1 == 0) {
+        return 0; // avoid exception caused by division by zero
+    }
+
+    var4 = 1048576 - adc_P;
+    var4 = (((var4 * 2147483648) - var2) * 3125) / var1;
+    var1 = (((int64_t)_bme280_calib.dig_P9) * (var4 / 8192) * (var4 / 8192)) / 33554432;
+    var2 = (((int64_t)_bme280_calib.dig_P8) * var4) / 524288;
+    var4 = ((var4 + var1 + var2) / 256) + (((int64_t)_bme280_calib.dig_P7) * 16);
+
+    float P = var4 / 256.0;
+
+    return P;
+}
+
+float Adafruit_BME280::readHumidity() {
+    int32_t var1, var2, var3, var4, var5;
+
+    readTemperature(); // must be done first to get t_fine
+
+    int32_t adc_H = read16(BME280_REGISTER_HUMIDDATA);
+    if (adc_H == 0x8000) {
+        return NAN;
+    }
+
+    var1 = t_fine - ((int32_t)76800);
+    var2 = (int32_t)(adc_H * 16384);
+    var3 = (int32_t)(((int32_t)_bme280_calib.dig_H4) * 1048576);
+    var4 = ((int32_t)_bme280_calib.dig_H5) * var1;
+    var5 = (((var2 - var3) - var4) + (int32_t)16384) / 32768;
+    var2 = (var1 * ((int32_t)_bme280_calib.dig_H6)) / 1024;
+    var3 = (var1 * ((int32_t)_bme280_calib.dig_H3)) / 2048;
+    var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
+    var2 = ((var4 * ((int32_t)_bme280_calib.dig_H2)) + 8192) / 16384;
+    var3 = var5 * var2;
+    var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+    var5 = var3 - ((var4 * ((int32_t)_bme280_calib.dig_H1)) / 16);
+    var5 = (var5 < 0 ? 0 : var5);
+    var5 = (var5 > 419430400 ? 419430400 : var5);
+
+    uint32_t H = (uint32_t)(var5 / 4096);
+
+    return (float)H / 1024.0;
+}
@@ -0,0 +1,55 @@
+/** Native Adafruit BusIO I2C Device Stand-In */
+
+#include "Adafruit_I2CDevice.h"
+
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire * theWire)
+    : _addr(addr), _wire(theWire), _begin(false) {
+}
+
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+    _wire->begin();
+    _begin = true;
+
+    return addr_detect ? detected() : true;
+}
+
+bool Adafruit_I2CDevice::detected() {
+    _wire->beginTransmission(_addr);
+    return _wire->endTransmission() == 0;
+}
+
+bool Adafruit_I2CDevice::read(uint8_t * buffer, size_t len, bool stop) {
+    if (_wire->requestFrom(_addr, len, stop) != len) {
+        return false;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        buffer[i] = (uint8_t)_wire->read();
+    }
+
+    return true;
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t * buffer, size_t len, bool stop,
+    const uint8_t * prefix_buffer, size_t prefix_len)
+{
+    _wire->beginTransmission(_addr);
+    if (prefix_len && _wire->write(prefix_buffer, prefix_len) != prefix_len) {
+        return false;
+    }
+    if (_wire->write(buffer, len) != len) {
+        return false;
+    }
+
+    return _wire->endTransmission(stop) == 0;
+}
+
+bool Adafruit_I2CDevice::write_then_read(const uint8_t * write_buffer, size_t write_len,
+    uint8_t * read_buffer, size_t read_len, bool stop)
+{
+    if (!write(write_buffer, write_len, stop)) {
+        return false;
+    }
+
+    return read(read_buffer, read_len);
+}
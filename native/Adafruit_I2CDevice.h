@@ -0,0 +1,33 @@
+/** Native Adafruit BusIO I2C Device Stand-In */
+
+#ifndef ADAFRUIT_I2CDEVICE_H__
+#define ADAFRUIT_I2CDEVICE_H__
+
+#include "Arduino.h"
+#include "Wire.h"
+
+//! I2C Device Helper (Adafruit BusIO API)
+class Adafruit_I2CDevice {
+public:
+    Adafruit_I2CDevice(uint8_t addr, TwoWire * theWire = &Wire);
+
+    uint8_t address() const { return _addr; }
+    bool begin(bool addr_detect = true);
+    void end() { _begin = false; }
+    bool detected();
+
+    bool read(uint8_t * buffer, size_t len, bool stop = true);
+    bool write(const uint8_t * buffer, size_t len, bool stop = true,
+        const uint8_t * prefix_buffer = NULL, size_t prefix_len = 0);
+    bool write_then_read(const uint8_t * write_buffer, size_t write_len,
+        uint8_t * read_buffer, size_t read_len, bool stop = false);
+
+    size_t maxBufferSize() const { return WIRE_BUFFER_SIZE; }
+
+private:
+    uint8_t _addr;
+    TwoWire * _wire;
+    bool _begin;
+};
+
+#endif // ADAFRUIT_I2CDEVICE_H__
@@ -0,0 +1,542 @@
+/** Native Adafruit MQTT Library Stand-In */
+
+#include <strings.h>
+
+#include "Adafruit_MQTT.h"
+#include "Adafruit_MQTT_Client.h"
+
+// Write a length-prefixed MQTT string
+static uint8_t * stringprint(uint8_t * p, const char * s, uint16_t maxlen = 0) {
+    uint16_t len = strlen(s);
+    if (maxlen > 0 && len > maxlen) len = maxlen;
+
+    p[0] = len >> 8;
+    p[1] = len & 0xFF;
+    memmove(p + 2, s, len);
+
+    return p + 2 + len;
+}
+
+Adafruit_MQTT::Adafruit_MQTT(const char * server, uint16_t port, const char * cid,
+    const char * user, const char * pass)
+    : servername(server), portnum(port), clientid(cid), username(user), password(pass),
+      keepAliveInterval(MQTT_CONN_KEEPALIVE), packet_id_counter(0)
+{
+    for (uint8_t i = 0; i < MAXSUBSCRIPTIONS; i++) {
+        subscriptions[i] = 0;
+    }
+}
+
+int8_t Adafruit_MQTT::connect(const char * user, const char * pass) {
+    username = user;
+    password = pass;
+    return connect();
+}
+
+int8_t Adafruit_MQTT::connect() {
+    if (!connectServer()) {
+        return -1;
+    }
+
+    uint8_t len = connectPacket(buffer);
+    if (!sendPacket(buffer, len)) {
+        return -1;
+    }
+
+    len = readFullPacket(buffer, MAXBUFFERSIZE, CONNECT_TIMEOUT_MS);
+    if (len != 4) {
+        return -1;
+    }
+    if ((buffer[0] != (MQTT_CTRL_CONNECTACK << 4)) || (buffer[1] != 2)) {
+        return -1;
+    }
+    if (buffer[3] != 0) {
+        return buffer[3];
+    }
+
+    // Setup subscriptions once connected
+    for (uint8_t i = 0; i < MAXSUBSCRIPTIONS; i++) {
+        if (subscriptions[i] == 0) continue;
+
+        bool success = false;
+        for (uint8_t retry = 0; (retry < 3) && !success; retry++) {
+            len = subscribePacket(buffer, subscriptions[i]->topic, subscriptions[i]->qos);
+            if (!sendPacket(buffer, len)) {
+                return -1;
+            }
+
+            if (processPacketsUntil(buffer, MQTT_CTRL_SUBACK, SUBACK_TIMEOUT_MS)) {
+                success = true;
+            }
+        }
+
+        if (!success) {
+            return -2;
+        }
+    }
+
+    return 0;
+}
+
+const __FlashStringHelper * Adafruit_MQTT::connectErrorString(int8_t code) {
+    switch (code) {
+    case 1: return F("The Server does not support the level of the MQTT protocol requested");
+    case 2: return F("The Client identifier is correct UTF-8 but not allowed by the Server");
+    case 3: return F("The MQTT service is unavailable");
+    case 4: return F("The data in the user name or password is malformed");
+    case 5: return F("Not authorized to connect");
+    case 6: return F("Exceeded reconnect rate limit. Please try again later.");
+    case 7: return F("You have been banned from connecting. Please contact the MQTT server administrator for more details.");
+    case -1: return F("Connection failed");
+    case -2: return F("Failed to subscribe");
+    default: return F("Unknown error");
+    }
+}
+
+bool Adafruit_MQTT::disconnect() {
+    uint8_t len = disconnectPacket(buffer);
+    sendPacket(buffer, len);
+
+    return disconnectServer();
+}
+
+bool Adafruit_MQTT::ping(uint8_t num) {
+    while (num--) {
+        uint8_t len = pingPacket(buffer);
+        if (!sendPacket(buffer, len)) continue;
+
+        len = processPacketsUntil(buffer, MQTT_CTRL_PINGRESP, PING_TIMEOUT_MS);
+        if (len) return true;
+    }
+
+    return false;
+}
+
+bool Adafruit_MQTT::publish(const char * topic, const char * data, uint8_t qos, bool retain) {
+    return publish(topic, (uint8_t *)(data), strlen(data), qos, retain);
+}
+
+bool Adafruit_MQTT::publish(const char * topic, uint8_t * data, uint16_t bLen, uint8_t qos, bool retain) {
+    uint16_t len = publishPacket(buffer, topic, data, bLen, qos, (uint16_t)sizeof(buffer), retain);
+    if (!sendPacket(buffer, len)) {
+        return false;
+    }
+
+    if (qos > 0) {
+        len = processPacketsUntil(buffer, MQTT_CTRL_PUBACK, PUBLISH_TIMEOUT_MS);
+        if (len != 4) return false;
+
+        uint16_t packnum = (buffer[2] << 8) | buffer[3];
+        if (packnum != packet_id_counter - 1) return false;
+    }
+
+    return true;
+}
+
+bool Adafruit_MQTT::subscribe(Adafruit_MQTT_Subscribe * sub) {
+    uint8_t i;
+
+    for (i = 0; i < MAXSUBSCRIPTIONS; i++) {
+        if (subscriptions[i] == sub) return true;
+    }
+    for (i = 0; i < MAXSUBSCRIPTIONS; i++) {
+        if (subscriptions[i] == 0) {
+            subscriptions[i] = sub;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Adafruit_MQTT::unsubscribe(Adafruit_MQTT_Subscribe * sub) {
+    for (uint8_t i = 0; i < MAXSUBSCRIPTIONS; i++) {
+        if (subscriptions[i] == sub) {
+            if (connected()) {
+                uint8_t len = unsubscribePacket(buffer, subscriptions[i]->topic);
+                if (!sendPacket(buffer, len)) return false;
+                processPacketsUntil(buffer, MQTT_CTRL_UNSUBACK, SUBACK_TIMEOUT_MS);
+            }
+
+            subscriptions[i] = 0;
+            return true;
+        }
+    }
+
+    return true;
+}
+
+void Adafruit_MQTT::processPackets(int16_t timeout) {
+    uint32_t elapsed = 0, endtime, starttime = millis();
+
+    while (elapsed < (uint32_t)timeout) {
+        // The host clock only advances in delay(), so bail out when the link
+        // drops instead of spinning forever
+        if (!connected()) break;
+
+        Adafruit_MQTT_Subscribe * sub = readSubscription(timeout - elapsed);
+        if (sub) {
+            if (sub->callback_uint32t != NULL) {
+                sub->callback_uint32t(atoi((char *)sub->lastread));
+            } else if (sub->callback_buffer != NULL) {
+                sub->callback_buffer((char *)sub->lastread, sub->datalen);
+            }
+        }
+
+        // keep track over elapsed time (accumulates like the upstream code)
+        endtime = millis();
+        if (endtime < starttime) {
+            starttime = endtime;
+        }
+        elapsed += (endtime - starttime);
+    }
+}
+
+Adafruit_MQTT_Subscribe * Adafruit_MQTT::readSubscription(int16_t timeout) {
+    uint16_t len = readFullPacket(buffer, MAXBUFFERSIZE, timeout);
+    if (!len) {
+        return NULL;
+    }
+
+    return handleSubscriptionPacket(len);
+}
+
+Adafruit_MQTT_Subscribe * Adafruit_MQTT::handleSubscriptionPacket(uint16_t len) {
+    uint8_t i;
+    uint16_t topicstart, topiclen, datastart, datalen;
+
+    if ((buffer[0] >> 4) != MQTT_CTRL_PUBLISH) {
+        return NULL;
+    }
+
+    // Skip the variable length header
+    topicstart = 2;
+    while (topicstart < len && (buffer[topicstart - 1] & 0x80)) {
+        topicstart++;
+    }
+
+    topiclen = buffer[topicstart + 1];
+    topicstart += 2;
+
+    for (i = 0; i < MAXSUBSCRIPTIONS; i++) {
+        if (subscriptions[i] &&
+            strlen(subscriptions[i]->topic) == topiclen &&
+            strncasecmp((char *)buffer + topicstart, subscriptions[i]->topic, topiclen) == 0) {
+            break;
+        }
+    }
+    if (i == MAXSUBSCRIPTIONS) {
+        return NULL;
+    }
+
+    uint16_t packetid = 0;
+    datastart = topicstart + topiclen;
+    if ((buffer[0] & 0x6) == 0x2) {
+        packetid = (buffer[datastart] << 8) | buffer[datastart + 1];
+        datastart += 2;
+    }
+
+    datalen = len - datastart;
+    if (datalen >= SUBSCRIPTIONDATALEN) {
+        datalen = SUBSCRIPTIONDATALEN - 1;
+    }
+
+    memset(subscriptions[i]->lastread, 0, SUBSCRIPTIONDATALEN);
+    memmove(subscriptions[i]->lastread, buffer + datastart, datalen);
+    subscriptions[i]->datalen = datalen;
+
+    if ((buffer[0] & 0x6) == 0x2) {
+        uint8_t ackpacket[4];
+        uint8_t alen = pubackPacket(ackpacket, packetid);
+        sendPacket(ackpacket, alen);
+    }
+
+    return subscriptions[i];
+}
+
+uint16_t Adafruit_MQTT::readFullPacket(uint8_t * buffer, uint16_t maxsize, uint16_t timeout) {
+    uint8_t * pbuff = buffer;
+    uint8_t rlen;
+
+    rlen = readPacket(pbuff, 1, timeout);
+    if (rlen != 1) return 0;
+    pbuff++;
+
+    uint32_t value = 0;
+    uint32_t multiplier = 1;
+    uint8_t encodedByte;
+
+    do {
+        rlen = readPacket(pbuff, 1, timeout);
+        if (rlen != 1) return 0;
+
+        encodedByte = pbuff[0];
+        value += (uint32_t)(encodedByte & 0x7F) * multiplier;
+        multiplier *= 128;
+        if (multiplier > (128UL * 128UL * 128UL)) return 0;
+
+        pbuff++;
+    } while (encodedByte & 0x80);
+
+    if (value > (uint32_t)(maxsize - (pbuff - buffer) - 1)) {
+        rlen = readPacket(pbuff, (maxsize - (pbuff - buffer) - 1), timeout);
+    } else {
+        rlen = readPacket(pbuff, value, timeout);
+    }
+
+    return ((pbuff - buffer) + rlen);
+}
+
+uint16_t Adafruit_MQTT::processPacketsUntil(uint8_t * buffer, uint8_t waitforpackettype, uint16_t timeout) {
+    uint16_t len;
+
+    while (true) {
+        len = readFullPacket(buffer, MAXBUFFERSIZE, timeout);
+        if (len == 0) break;
+
+        uint8_t packetType = (buffer[0] >> 4);
+        if (packetType == waitforpackettype) {
+            return len;
+        }
+
+        if (packetType == MQTT_CTRL_PUBLISH) {
+            handleSubscriptionPacket(len);
+        }
+    }
+
+    return 0;
+}
+
+uint8_t Adafruit_MQTT::connectPacket(uint8_t * packet) {
+    uint8_t * p = packet;
+    uint16_t len;
+
+    p[0] = (MQTT_CTRL_CONNECT << 4);
+    p += 2;  // fill in packet[1] last
+
+    p = stringprint(p, "MQTT");
+    p[0] = MQTT_PROTOCOL_LEVEL;
+    p++;
+
+    p[0] = MQTT_CONN_CLEANSESSION;
+    if (username && username[0]) p[0] |= MQTT_CONN_USERNAMEFLAG;
+    if (password && password[0]) p[0] |= MQTT_CONN_PASSWORDFLAG;
+    p++;
+
+    p[0] = keepAliveInterval >> 8;
+    p[1] = keepAliveInterval & 0xFF;
+    p += 2;
+
+    p = stringprint(p, clientid ? clientid : "");
+    if (username && username[0]) p = stringprint(p, username);
+    if (password && password[0]) p = stringprint(p, password);
+
+    len = p - packet;
+    packet[1] = len - 2;
+
+    return len;
+}
+
+uint16_t Adafruit_MQTT::publishPacket(uint8_t * packet, const char * topic, uint8_t * data,
+    uint16_t bLen, uint8_t qos, uint16_t maxPacketLen, bool retain)
+{
+    uint8_t * p = packet;
+    uint16_t len = 0;
+
+    // calc length of non-header data
+    len += 2;
+    len += strlen(topic);
+    if (qos > 0) {
+        len += 2;
+    }
+    len += bLen;
+
+    // Fixed header plus up to two length bytes must fit the packet buffer
+    if ((uint32_t)len + 3 > maxPacketLen) {
+        return 0;
+    }
+
+    p[0] = MQTT_CTRL_PUBLISH << 4 | qos << 1 | (retain ? 1 : 0);
+    p++;
+
+    do {
+        uint8_t encodedByte = len % 128;
+        len /= 128;
+        if (len > 0) {
+            encodedByte |= 0x80;
+        }
+        p[0] = encodedByte;
+        p++;
+    } while (len > 0);
+
+    p = stringprint(p, topic);
+
+    if (qos > 0) {
+        p[0] = (packet_id_counter >> 8) & 0xFF;
+        p[1] = packet_id_counter & 0xFF;
+        p += 2;
+        packet_id_counter++;
+    }
+
+    memmove(p, data, bLen);
+    p += bLen;
+
+    return p - packet;
+}
+
+uint8_t Adafruit_MQTT::subscribePacket(uint8_t * packet, const char * topic, uint8_t qos) {
+    uint8_t * p = packet;
+    uint16_t len;
+
+    p[0] = MQTT_CTRL_SUBSCRIBE << 4 | MQTT_QOS_1 << 1;
+    p += 2;
+
+    p[0] = (packet_id_counter >> 8) & 0xFF;
+    p[1] = packet_id_counter & 0xFF;
+    p += 2;
+    packet_id_counter++;
+
+    p = stringprint(p, topic);
+    p[0] = qos;
+    p++;
+
+    len = p - packet;
+    packet[1] = len - 2;
+
+    return len;
+}
+
+uint8_t Adafruit_MQTT::unsubscribePacket(uint8_t * packet, const char * topic) {
+    uint8_t * p = packet;
+    uint16_t len;
+
+    p[0] = MQTT_CTRL_UNSUBSCRIBE << 4 | 0x1;
+    p += 2;
+
+    p[0] = (packet_id_counter >> 8) & 0xFF;
+    p[1] = packet_id_counter & 0xFF;
+    p += 2;
+    packet_id_counter++;
+
+    p = stringprint(p, topic);
+
+    len = p - packet;
+    packet[1] = len - 2;
+
+    return len;
+}
+
+uint8_t Adafruit_MQTT::pingPacket(uint8_t * packet) {
+    packet[0] = MQTT_CTRL_PINGREQ << 4;
+    packet[1] = 0;
+    return 2;
+}
+
+uint8_t Adafruit_MQTT::pubackPacket(uint8_t * packet, uint16_t packetid) {
+    packet[0] = MQTT_CTRL_PUBACK << 4;
+    packet[1] = 2;
+    packet[2] = packetid >> 8;
+    packet[3] = packetid;
+    return 4;
+}
+
+uint8_t Adafruit_MQTT::disconnectPacket(uint8_t * packet) {
+    packet[0] = MQTT_CTRL_DISCONNECT << 4;
+    packet[1] = 0;
+    return 2;
+}
+
+/* --- Feeds -------------------------------------------------------------- */
+
+Adafruit_MQTT_Publish::Adafruit_MQTT_Publish(Adafruit_MQTT * mqttserver, const char * feed, uint8_t q)
+    : mqtt(mqttserver), topic(feed), qos(q) {
+}
+
+bool Adafruit_MQTT_Publish::publish(const char * payload) {
+    return mqtt->publish(topic, payload, qos);
+}
+
+bool Adafruit_MQTT_Publish::publish(int32_t i) {
+    char payload[12];
+    snprintf(payload, sizeof(payload), "%d", (int)i);
+    return mqtt->publish(topic, payload, qos);
+}
+
+bool Adafruit_MQTT_Publish::publish(uint32_t i) {
+    char payload[11];
+    snprintf(payload, sizeof(payload), "%u", (unsigned)i);
+    return mqtt->publish(topic, payload, qos);
+}
+
+bool Adafruit_MQTT_Publish::publish(uint8_t * payload, uint16_t bLen) {
+    return mqtt->publish(topic, payload, bLen, qos);
+}
+
+Adafruit_MQTT_Subscribe::Adafruit_MQTT_Subscribe(Adafruit_MQTT * mqttserver, const char * feed, uint8_t q)
+    : topic(feed), qos(q), datalen(0), callback_uint32t(NULL), callback_buffer(NULL), mqtt(mqttserver) {
+    memset(lastread, 0, sizeof(lastread));
+}
+
+/* --- Adafruit_MQTT_Client ----------------------------------------------- */
+
+bool Adafruit_MQTT_Client::connectServer() {
+    return client->connect(servername, portnum);
+}
+
+bool Adafruit_MQTT_Client::disconnectServer() {
+    if (connected()) {
+        client->stop();
+    }
+    return true;
+}
+
+bool Adafruit_MQTT_Client::connected() {
+    return client->connected();
+}
+
+uint16_t Adafruit_MQTT_Client::readPacket(uint8_t * buffer, uint16_t maxlen, int16_t timeout) {
+    uint16_t len = 0;
+    int16_t t = timeout;
+
+    if (maxlen == 0) {
+        return 0;
+    }
+
+    while (client->connected() && (timeout >= 0)) {
+        while (client->available()) {
+            buffer[len] = client->read();
+            timeout = t;    // reset the timeout
+            len++;
+
+            if (len == maxlen) {
+                return len;
+            }
+        }
+
+        timeout -= MQTT_CLIENT_READINTERVAL_MS;
+        delay(MQTT_CLIENT_READINTERVAL_MS);
+    }
+
+    return len;
+}
+
+bool Adafruit_MQTT_Client::sendPacket(uint8_t * buffer, uint16_t len) {
+    uint16_t offset = 0;
+
+    while (len > 0) {
+        if (!client->connected()) {
+            return false;
+        }
+
+        uint16_t sendlen = len > 250 ? 250 : len;
+        uint16_t ret = client->write(buffer + offset, sendlen);
+        len -= ret;
+        offset += ret;
+
+        if (ret != sendlen) {
+            return false;
+        }
+    }
+
+    return true;
+}
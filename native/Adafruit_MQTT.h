@@ -0,0 +1,154 @@
+/** Native Adafruit MQTT Library Stand-In */
+
+#ifndef ADAFRUIT_MQTT_H__
+#define ADAFRUIT_MQTT_H__
+
+#include "Arduino.h"
+
+#define MQTT_PROTOCOL_LEVEL 4
+
+#define MQTT_CTRL_CONNECT       0x1
+#define MQTT_CTRL_CONNECTACK    0x2
+#define MQTT_CTRL_PUBLISH       0x3
+#define MQTT_CTRL_PUBACK        0x4
+#define MQTT_CTRL_PUBREC        0x5
+#define MQTT_CTRL_PUBREL        0x6
+#define MQTT_CTRL_PUBCOMP       0x7
+#define MQTT_CTRL_SUBSCRIBE     0x8
+#define MQTT_CTRL_SUBACK        0x9
+#define MQTT_CTRL_UNSUBSCRIBE   0xA
+#define MQTT_CTRL_UNSUBACK      0xB
+#define MQTT_CTRL_PINGREQ       0xC
+#define MQTT_CTRL_PINGRESP      0xD
+#define MQTT_CTRL_DISCONNECT    0xE
+
+#define MQTT_QOS_1 0x1
+#define MQTT_QOS_0 0x0
+
+#define CONNECT_TIMEOUT_MS  6000
+#define PUBLISH_TIMEOUT_MS  500
+#define PING_TIMEOUT_MS     500
+#define SUBACK_TIMEOUT_MS   500
+
+#define MQTT_CONN_USERNAMEFLAG      0x80
+#define MQTT_CONN_PASSWORDFLAG      0x40
+#define MQTT_CONN_WILLRETAIN        0x20
+#define MQTT_CONN_WILLQOS_1         0x08
+#define MQTT_CONN_WILLQOS_2         0x18
+#define MQTT_CONN_WILLFLAG          0x04
+#define MQTT_CONN_CLEANSESSION      0x02
+
+#define MQTT_CONN_KEEPALIVE 300
+
+#define SUBSCRIPTIONDATALEN 100
+#define MAXSUBSCRIPTIONS    5
+
+// The firmware once needed MAXBUFFERSIZE raised in the real library so the
+// discovery messages fit; the stand-in keeps that patch for the comparison in
+// bench/bench_transport.cpp.
+#ifndef MAXBUFFERSIZE
+#define MAXBUFFERSIZE (500)
+#endif
+
+typedef void (*SubscribeCallbackUInt32Type)(uint32_t);
+typedef void (*SubscribeCallbackBufferType)(char * str, uint16_t len);
+
+class Adafruit_MQTT_Subscribe;
+
+//! MQTT 3.1.1 Client Core (Adafruit API)
+class Adafruit_MQTT {
+public:
+    Adafruit_MQTT(const char * server, uint16_t port, const char * cid,
+        const char * user, const char * pass);
+    virtual ~Adafruit_MQTT() { }
+
+    int8_t connect();
+    int8_t connect(const char * user, const char * pass);
+    const __FlashStringHelper * connectErrorString(int8_t code);
+    bool disconnect();
+
+    virtual bool connected() = 0;
+
+    bool ping(uint8_t n = 1);
+    void setKeepAliveInterval(uint16_t keepAlive) { keepAliveInterval = keepAlive; }
+
+    bool publish(const char * topic, const char * payload, uint8_t qos = 0, bool retain = false);
+    bool publish(const char * topic, uint8_t * payload, uint16_t bLen, uint8_t qos = 0, bool retain = false);
+
+    bool subscribe(Adafruit_MQTT_Subscribe * sub);
+    bool unsubscribe(Adafruit_MQTT_Subscribe * sub);
+
+    Adafruit_MQTT_Subscribe * readSubscription(int16_t timeout = 0);
+    void processPackets(int16_t timeout);
+
+protected:
+    virtual bool connectServer() = 0;
+    virtual bool disconnectServer() = 0;
+    virtual uint16_t readPacket(uint8_t * buffer, uint16_t maxlen, int16_t timeout) = 0;
+    virtual bool sendPacket(uint8_t * buffer, uint16_t len) = 0;
+
+    uint16_t readFullPacket(uint8_t * buffer, uint16_t maxsize, uint16_t timeout);
+    uint16_t processPacketsUntil(uint8_t * buffer, uint8_t waitforpackettype, uint16_t timeout);
+    Adafruit_MQTT_Subscribe * handleSubscriptionPacket(uint16_t len);
+
+    const char * servername;
+    int16_t portnum;
+    const char * clientid;
+    const char * username;
+    const char * password;
+    uint16_t keepAliveInterval;
+
+    uint8_t buffer[MAXBUFFERSIZE];
+    uint16_t packet_id_counter;
+
+private:
+    Adafruit_MQTT_Subscribe * subscriptions[MAXSUBSCRIPTIONS];
+
+    uint8_t connectPacket(uint8_t * packet);
+    uint8_t disconnectPacket(uint8_t * packet);
+    uint16_t publishPacket(uint8_t * packet, const char * topic, uint8_t * payload,
+        uint16_t bLen, uint8_t qos, uint16_t maxPacketLen, bool retain);
+    uint8_t subscribePacket(uint8_t * packet, const char * topic, uint8_t qos);
+    uint8_t unsubscribePacket(uint8_t * packet, const char * topic);
+    uint8_t pingPacket(uint8_t * packet);
+    uint8_t pubackPacket(uint8_t * packet, uint16_t packetid);
+};
+
+//! MQTT Publishing Feed
+class Adafruit_MQTT_Publish {
+public:
+    Adafruit_MQTT_Publish(Adafruit_MQTT * mqttserver, const char * feed, uint8_t qos = 0);
+
+    bool publish(const char * s);
+    bool publish(int32_t i);
+    bool publish(uint32_t i);
+    bool publish(uint8_t * b, uint16_t bLen);
+
+private:
+    Adafruit_MQTT * mqtt;
+    const char * topic;
+    uint8_t qos;
+};
+
+//! MQTT Subscription Feed
+class Adafruit_MQTT_Subscribe {
+public:
+    Adafruit_MQTT_Subscribe(Adafruit_MQTT * mqttserver, const char * feedname, uint8_t q = 0);
+
+    void setCallback(SubscribeCallbackUInt32Type callb) { callback_uint32t = callb; }
+    void setCallback(SubscribeCallbackBufferType callb) { callback_buffer = callb; }
+    void removeCallback() { callback_uint32t = NULL; callback_buffer = NULL; }
+
+    const char * topic;
+    uint8_t qos;
+
+    uint8_t lastread[SUBSCRIPTIONDATALEN];
+    uint16_t datalen;
+
+    SubscribeCallbackUInt32Type callback_uint32t;
+    SubscribeCallbackBufferType callback_buffer;
+
+    Adafruit_MQTT * mqtt;
+};
+
+#endif // ADAFRUIT_MQTT_H__
@@ -0,0 +1,28 @@
+/** Native Adafruit MQTT Client Stand-In */
+
+#ifndef ADAFRUIT_MQTT_CLIENT_H__
+#define ADAFRUIT_MQTT_CLIENT_H__
+
+#include "Adafruit_MQTT.h"
+#include "Client.h"
+
+#define MQTT_CLIENT_READINTERVAL_MS 10
+
+//! MQTT Client over an Arduino Client
+class Adafruit_MQTT_Client : public Adafruit_MQTT {
+public:
+    Adafruit_MQTT_Client(Client * client, const char * server, uint16_t port,
+        const char * cid = "", const char * user = "", const char * pass = "")
+        : Adafruit_MQTT(server, port, cid, user, pass), client(client) { }
+
+    bool connectServer();
+    bool disconnectServer();
+    bool connected();
+    uint16_t readPacket(uint8_t * buffer, uint16_t maxlen, int16_t timeout);
+    bool sendPacket(uint8_t * buffer, uint16_t len);
+
+private:
+    Client * client;
+};
+
+#endif // ADAFRUIT_MQTT_CLIENT_H__
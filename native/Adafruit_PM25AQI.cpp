@@ -0,0 +1,50 @@
+/** Native Adafruit PM25 AQI Driver Stand-In */
+
+#include "Adafruit_PM25AQI.h"
+
+Adafruit_PM25AQI::Adafruit_PM25AQI() : i2c_dev(NULL) {
+}
+
+Adafruit_PM25AQI::~Adafruit_PM25AQI() {
+    delete i2c_dev;
+}
+
+bool Adafruit_PM25AQI::begin_I2C(TwoWire * theWire) {
+    delete i2c_dev;
+
+    i2c_dev = new Adafruit_I2CDevice(PMSA003I_I2CADDR_DEFAULT, theWire);
+    return i2c_dev->begin();
+}
+
+bool Adafruit_PM25AQI::read(PM25_AQI_Data * data) {
+    uint8_t buffer[32];
+    uint16_t sum = 0;
+
+    if (!data || !i2c_dev->read(buffer, 32)) {
+        return false;
+    }
+
+    // Check the frame header
+    if (buffer[0] != 0x42) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < 30; i++) {
+        sum += buffer[i];
+    }
+
+    // The data comes in big endian
+    uint16_t buffer_u16[15];
+    for (uint8_t i = 0; i < 15; i++) {
+        buffer_u16[i] = buffer[2 + i * 2 + 1];
+        buffer_u16[i] += (buffer[2 + i * 2] << 8);
+    }
+
+    memcpy((void *)data, (void *)buffer_u16, 30);
+
+    if (sum != data->checksum) {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,45 @@
+/** Native Adafruit PM25 AQI Driver Stand-In */
+
+#ifndef ADAFRUIT_PM25AQI_H__
+#define ADAFRUIT_PM25AQI_H__
+
+#include "Adafruit_I2CDevice.h"
+#include "Arduino.h"
+#include "Wire.h"
+
+#define PMSA003I_I2CADDR_DEFAULT 0x12
+
+//! PMS5003 / PMSA003I Data Frame
+typedef struct PMSAQIdata {
+    uint16_t framelen;
+    uint16_t pm10_standard,
+        pm25_standard,
+        pm100_standard;
+    uint16_t pm10_env,
+        pm25_env,
+        pm100_env;
+    uint16_t particles_03um,
+        particles_05um,
+        particles_10um,
+        particles_25um,
+        particles_50um,
+        particles_100um;
+    uint16_t unused;
+    uint16_t checksum;
+} PM25_AQI_Data;
+
+//! PM2.5 AQI Sensor Driver (Adafruit API, I2C only)
+class Adafruit_PM25AQI {
+public:
+    Adafruit_PM25AQI();
+    ~Adafruit_PM25AQI();
+
+    bool begin_I2C(TwoWire * theWire = &Wire);
+    bool read(PM25_AQI_Data * data);
+
+private:
+    Adafruit_I2CDevice * i2c_dev;
+    uint8_t _readbuffer[32];
+};
+
+#endif // ADAFRUIT_PM25AQI_H__
@@ -0,0 +1,166 @@
+/** Native Adafruit SGP30 Driver Stand-In */
+
+#include "Adafruit_SGP30.h"
+
+Adafruit_SGP30::Adafruit_SGP30()
+    : TVOC(0), eCO2(0), rawH2(0), rawEthanol(0), i2c_dev(NULL) {
+    serialnumber[0] = serialnumber[1] = serialnumber[2] = 0;
+}
+
+Adafruit_SGP30::~Adafruit_SGP30() {
+    delete i2c_dev;
+}
+
+boolean Adafruit_SGP30::begin(TwoWire * theWire, boolean initSensor) {
+    delete i2c_dev;
+
+    i2c_dev = new Adafruit_I2CDevice(SGP30_I2CADDR_DEFAULT, theWire);
+    if (!i2c_dev->begin()) {
+        return false;
+    }
+
+    uint8_t command[2] = { 0x36, 0x82 };
+    if (!readWordFromCommand(command, 2, 10, serialnumber, 3)) {
+        return false;
+    }
+
+    uint16_t featureset;
+    command[0] = 0x20;
+    command[1] = 0x2F;
+    if (!readWordFromCommand(command, 2, 10, &featureset, 1)) {
+        return false;
+    }
+    if ((featureset & 0xF0) != SGP30_FEATURESET) {
+        return false;
+    }
+
+    if (initSensor && !IAQinit()) {
+        return false;
+    }
+
+    return true;
+}
+
+boolean Adafruit_SGP30::softReset() {
+    uint8_t command[2] = { 0x00, 0x06 };
+    return readWordFromCommand(command, 2, 10);
+}
+
+boolean Adafruit_SGP30::IAQinit() {
+    uint8_t command[2] = { 0x20, 0x03 };
+    return readWordFromCommand(command, 2, 10);
+}
+
+boolean Adafruit_SGP30::IAQmeasure() {
+    uint8_t command[2] = { 0x20, 0x08 };
+    uint16_t reply[2];
+    if (!readWordFromCommand(command, 2, 12, reply, 2)) {
+        return false;
+    }
+
+    TVOC = reply[1];
+    eCO2 = reply[0];
+    return true;
+}
+
+boolean Adafruit_SGP30::IAQmeasureRaw() {
+    uint8_t command[2] = { 0x20, 0x50 };
+    uint16_t reply[2];
+    if (!readWordFromCommand(command, 2, 25, reply, 2)) {
+        return false;
+    }
+
+    rawEthanol = reply[1];
+    rawH2 = reply[0];
+    return true;
+}
+
+boolean Adafruit_SGP30::getIAQBaseline(uint16_t * eco2_base, uint16_t * tvoc_base) {
+    uint8_t command[2] = { 0x20, 0x15 };
+    uint16_t reply[2];
+    if (!readWordFromCommand(command, 2, 10, reply, 2)) {
+        return false;
+    }
+
+    *eco2_base = reply[0];
+    *tvoc_base = reply[1];
+    return true;
+}
+
+boolean Adafruit_SGP30::setIAQBaseline(uint16_t eco2_base, uint16_t tvoc_base) {
+    uint8_t command[8];
+    command[0] = 0x20;
+    command[1] = 0x1E;
+    command[2] = tvoc_base >> 8;
+    command[3] = tvoc_base & 0xFF;
+    command[4] = generateCRC(command + 2, 2);
+    command[5] = eco2_base >> 8;
+    command[6] = eco2_base & 0xFF;
+    command[7] = generateCRC(command + 5, 2);
+
+    return readWordFromCommand(command, 8, 10);
+}
+
+boolean Adafruit_SGP30::setHumidity(uint32_t absolute_humidity) {
+    if (absolute_humidity > 256000) {
+        return false;
+    }
+
+    uint16_t ah_scaled = (uint16_t)(((uint64_t)absolute_humidity * 256 * 16777) >> 24);
+    uint8_t command[5];
+    command[0] = 0x20;
+    command[1] = 0x61;
+    command[2] = ah_scaled >> 8;
+    command[3] = ah_scaled & 0xFF;
+    command[4] = generateCRC(command + 2, 2);
+
+    return readWordFromCommand(command, 5, 10);
+}
+
+boolean Adafruit_SGP30::readWordFromCommand(uint8_t command[], uint8_t commandLength,
+    uint16_t delayms, uint16_t * readdata, uint8_t readlen)
+{
+    if (!i2c_dev->write(command, commandLength)) {
+        return false;
+    }
+
+    delay(delayms);
+
+    if (readlen == 0) {
+        return true;
+    }
+
+    uint8_t replylen = readlen * (SGP30_WORD_LEN + 1);
+    uint8_t replybuffer[12];
+    if (!i2c_dev->read(replybuffer, replylen)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < readlen; i++) {
+        uint8_t crc = generateCRC(replybuffer + i * 3, 2);
+        if (crc != replybuffer[i * 3 + 2]) {
+            return false;
+        }
+
+        readdata[i] = (uint16_t)(replybuffer[i * 3] << 8) | replybuffer[i * 3 + 1];
+    }
+
+    return true;
+}
+
+uint8_t Adafruit_SGP30::generateCRC(uint8_t * data, uint8_t datalen) {
+    uint8_t crc = SGP30_CRC8_INIT;
+
+    for (uint8_t i = 0; i < datalen; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            if (crc & 0x80) {
+                crc = (crc << 1) ^ SGP30_CRC8_POLYNOMIAL;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+
+    return crc;
+}
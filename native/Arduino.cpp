@@ -0,0 +1,131 @@
+/** Native Arduino Core Stand-In */
+
+#include <time.h>
+
+#include "Arduino.h"
+#include "sim/sim.h"
+
+HardwareSerial Serial;
+
+unsigned long millis() {
+    return (unsigned long)(sim_clock_us / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)sim_clock_us;
+}
+
+void delay(unsigned long ms) {
+    sim_advance_us((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+    sim_advance_us(us);
+}
+
+void yield() {
+}
+
+// Output levels of the other pins
+static uint8_t gpio_level[17];
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin == SCL) {
+        sim_i2c_scl(val != LOW);
+    } else if (pin < sizeof(gpio_level)) {
+        gpio_level[pin] = val;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin == SDA) {
+        return sim_i2c_sda() ? HIGH : LOW;
+    }
+    if (pin == SCL) {
+        return sim_i2c_scl_level() ? HIGH : LOW;
+    }
+    return pin < sizeof(gpio_level) ? gpio_level[pin] : LOW;
+}
+
+void configTime(int, int, const char *, const char *, const char *) {
+    sim_time_synced = true;
+}
+
+// Wall clock from the simulated clock, zero until SNTP is configured as on
+// the device (replaces the C library's time())
+extern "C" time_t time(time_t * t) {
+    time_t now = sim_time_synced ? (time_t)(SIM_EPOCH + sim_clock_us / 1000000) : 0;
+    if (t) *t = now;
+    return now;
+}
+
+long random(long howbig) {
+    return howbig > 0 ? (long)(sim_rand() % (unsigned long)howbig) : 0;
+}
+
+long random(long howsmall, long howbig) {
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long) {
+}
+
+/* --- Print -------------------------------------------------------------- */
+
+size_t Print::write(const uint8_t * buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::print(const char * s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(int v) { return printf("%d", v); }
+size_t Print::print(unsigned int v) { return printf("%u", v); }
+size_t Print::print(long v) { return printf("%ld", v); }
+size_t Print::print(unsigned long v) { return printf("%lu", v); }
+size_t Print::print(double v, int digits) { return printf("%.*f", digits, v); }
+size_t Print::print(const Printable & p) { return p.printTo(*this); }
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const char * s) { return print(s) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(int v) { return print(v) + println(); }
+size_t Print::println(unsigned int v) { return print(v) + println(); }
+size_t Print::println(long v) { return print(v) + println(); }
+size_t Print::println(unsigned long v) { return print(v) + println(); }
+size_t Print::println(double v, int digits) { return print(v, digits) + println(); }
+size_t Print::println(const Printable & p) { return print(p) + println(); }
+
+size_t Print::printf(const char * format, ...) {
+    char buf[256];
+    va_list args;
+
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    if (n < 0) return 0;
+    return write((const uint8_t *)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+/* --- HardwareSerial ----------------------------------------------------- */
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (sim_serial_echo) {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t * buffer, size_t size) {
+    if (sim_serial_echo) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
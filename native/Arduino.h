@@ -0,0 +1,125 @@
+/** Native Arduino Core Stand-In */
+
+#ifndef ARDUINO_H__
+#define ARDUINO_H__
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Esp.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH    1
+#define LOW     0
+
+#define INPUT               0
+#define OUTPUT              1
+#define INPUT_PULLUP        2
+#define OUTPUT_OPEN_DRAIN   3
+
+//! Default I2C Pins (GPIO4 and GPIO5, D2 and D1 on a NodeMCU)
+static const uint8_t SDA = 4;
+static const uint8_t SCL = 5;
+
+//! Flash String Helper (strings live in RAM on the host)
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+/** Time Functions (driven by the simulated clock) */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+void yield();
+
+/** Digital I/O (SDA and SCL follow the simulated I2C bus) */
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+
+/** SNTP Time (the host clock is always set) */
+void configTime(int, int, const char *, const char * = NULL, const char * = NULL);
+
+/** Pseudo-Random Numbers */
+long random(long);
+long random(long, long);
+void randomSeed(unsigned long);
+
+class Print;
+
+//! Printable Object Interface
+class Printable {
+public:
+    virtual ~Printable() { }
+    virtual size_t printTo(Print &) const = 0;
+};
+
+//! Character Output Base Class
+class Print {
+public:
+    virtual ~Print() { }
+
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t * buffer, size_t size);
+
+    size_t write(const char * str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+
+    size_t print(const char *);
+    size_t print(const __FlashStringHelper * s) { return print((const char *)s); }
+    size_t print(char);
+    size_t print(int);
+    size_t print(unsigned int);
+    size_t print(long);
+    size_t print(unsigned long);
+    size_t print(double, int = 2);
+    size_t print(const Printable &);
+
+    size_t println();
+    size_t println(const char *);
+    size_t println(const __FlashStringHelper * s) { return println((const char *)s); }
+    size_t println(char);
+    size_t println(int);
+    size_t println(unsigned int);
+    size_t println(long);
+    size_t println(unsigned long);
+    size_t println(double, int = 2);
+    size_t println(const Printable &);
+
+    size_t printf(const char *, ...) __attribute__((format(printf, 2, 3)));
+};
+
+//! Byte Stream Base Class
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() { }
+};
+
+//! Serial Port Stand-In (echoes to stdout when enabled)
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) { }
+    void end() { }
+    operator bool() const { return true; }
+
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+
+    size_t write(uint8_t);
+    size_t write(const uint8_t *, size_t);
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H__
@@ -0,0 +1,55 @@
+/** Native EEPROM_Rotate Stand-In */
+
+#ifndef EEPROM_ROTATE_H__
+#define EEPROM_ROTATE_H__
+
+#include "Arduino.h"
+
+#define EEPROM_ROTATE_SIZE 4096
+
+//! Rotating EEPROM Emulation (RAM-backed on the host)
+class EEPROM_Rotate {
+public:
+    EEPROM_Rotate() : _size(0), _sectors(1), _commits(0) { }
+
+    void size(uint8_t sectors) { _sectors = sectors; }
+    void begin(size_t size) { _size = size > EEPROM_ROTATE_SIZE ? EEPROM_ROTATE_SIZE : size; }
+    void end() { _size = 0; }
+    bool commit() { _commits++; return true; }
+
+    template<typename T>
+    T & get(int address, T & t) {
+        memcpy(&t, &_data()[address], sizeof(T));
+        return t;
+    }
+
+    template<typename T>
+    const T & put(int address, const T & t) {
+        memcpy(&_data()[address], &t, sizeof(T));
+        return t;
+    }
+
+    uint32_t commits() const { return _commits; }
+
+    //! Erase the Backing Store (host only; called from sim_reset())
+    static void erase() {
+        memset(_data(), 0xFF, EEPROM_ROTATE_SIZE);
+    }
+
+private:
+    static uint8_t * _data() {
+        static uint8_t data[EEPROM_ROTATE_SIZE];
+        static bool erased = false;
+        if (!erased) {
+            memset(data, 0xFF, sizeof(data));
+            erased = true;
+        }
+        return data;
+    }
+
+    size_t _size;
+    uint8_t _sectors;
+    uint32_t _commits;
+};
+
+#endif // EEPROM_ROTATE_H__
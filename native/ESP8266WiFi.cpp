@@ -0,0 +1,173 @@
+/** Native ESP8266 WiFi Stand-In */
+
+#include "ESP8266WiFi.h"
+#include "sim/sim.h"
+#include "sim/sim_broker.h"
+
+ESP8266WiFiClass WiFi;
+
+ESP8266WiFiClass::ESP8266WiFiClass()
+    : _mode(WIFI_STA), _begun(false), _auto(true), _linked(false), _assoc_us(0) {
+}
+
+wl_status_t ESP8266WiFiClass::begin(const char *, const char *) {
+    _begun = true;
+    _linked = false;
+    _assoc_us = sim_clock_us + (uint64_t)sim_wifi_assoc_ms * 1000;
+    return status();
+}
+
+bool ESP8266WiFiClass::disconnect(bool) {
+    _begun = false;
+    _linked = false;
+    sim_broker.drop_all();
+    return true;
+}
+
+bool ESP8266WiFiClass::reconnect() {
+    if (!_begun) return false;
+    begin(NULL, NULL);
+    return true;
+}
+
+wl_status_t ESP8266WiFiClass::status() {
+    if (!_begun) {
+        return WL_IDLE_STATUS;
+    }
+
+    // Woken with WAKE_RF_DISABLED: the radio stays off
+    if (sim_rf_disabled) {
+        return WL_DISCONNECTED;
+    }
+
+    if (!sim_wifi_ap_up) {
+        if (_linked) {
+            // Link lost; the TCP connections go with it
+            _linked = false;
+            sim_broker.drop_all();
+        }
+
+        // Association restarts once the access point returns
+        _assoc_us = 0;
+        return WL_DISCONNECTED;
+    }
+
+    if (!_assoc_us) {
+        if (!_auto) return WL_CONNECTION_LOST;
+        _assoc_us = sim_clock_us + (uint64_t)sim_wifi_assoc_ms * 1000;
+    }
+
+    if (sim_clock_us < _assoc_us) {
+        return WL_DISCONNECTED;
+    }
+
+    _linked = true;
+    return WL_CONNECTED;
+}
+
+IPAddress ESP8266WiFiClass::localIP() {
+    return isConnected() ? IPAddress(192, 168, 1, 42) : IPAddress();
+}
+
+/* --- WiFiClient --------------------------------------------------------- */
+
+WiFiClient::WiFiClient() : _session(-1), _wrote(false), _timeout(5000), _peek(-1) {
+}
+
+WiFiClient::~WiFiClient() {
+    // Clients are globals; the broker may already be destroyed at exit
+}
+
+int WiFiClient::connect(const char *, uint16_t) {
+    stop();
+    _wrote = false;
+
+    if (WiFi.status() != WL_CONNECTED) {
+        return 0;
+    }
+
+    _session = sim_broker.attach();
+    if (_session < 0) {
+        // An unreachable broker costs the full connect timeout
+        unsigned long ms = sim_broker.timeout_ms < _timeout ? sim_broker.timeout_ms : _timeout;
+        sim_advance_us((uint64_t)ms * 1000);
+        return 0;
+    }
+
+    sim_advance_us((uint64_t)sim_broker.connect_ms * 1000);
+    return 1;
+}
+
+// A reply to data we sent arrives one round trip later
+void WiFiClient::settle() {
+    // Only an answer to what was written waits for the round trip; messages
+    // from other clients are already in the receive buffer
+    if (_wrote && sim_broker.replied(_session)) {
+        sim_advance_us(sim_broker.rtt_us);
+        _wrote = false;
+    }
+}
+
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t * buf, size_t size) {
+    if (!connected()) return 0;
+
+    sim_advance_us(sim_broker.write_us);
+    sim_broker.receive(_session, buf, size);
+    _wrote = true;
+    return size;
+}
+
+int WiFiClient::available() {
+    if (!connected()) return 0;
+
+    settle();
+    return (int)sim_broker.pending(_session) + (_peek >= 0 ? 1 : 0);
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t * buf, size_t size) {
+    if (!size || !connected()) return 0;
+
+    settle();
+
+    size_t n = 0;
+    if (_peek >= 0) {
+        buf[n++] = (uint8_t)_peek;
+        _peek = -1;
+    }
+
+    return (int)(n + sim_broker.take(_session, buf + n, size - n));
+}
+
+int WiFiClient::peek() {
+    if (_peek < 0) {
+        uint8_t c;
+        if (connected() && sim_broker.take(_session, &c, 1) == 1) {
+            _peek = c;
+        }
+    }
+    return _peek;
+}
+
+void WiFiClient::stop() {
+    if (_session >= 0) {
+        sim_broker.detach(_session);
+        _session = -1;
+    }
+    _peek = -1;
+}
+
+uint8_t WiFiClient::connected() {
+    if (_session >= 0 && !sim_broker.connected(_session)) {
+        _session = -1;
+    }
+    return _session >= 0 || _peek >= 0;
+}
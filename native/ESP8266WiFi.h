@@ -0,0 +1,109 @@
+/** Native ESP8266 WiFi Stand-In */
+
+#ifndef ESP8266WIFI_H__
+#define ESP8266WIFI_H__
+
+#include "Arduino.h"
+#include "Client.h"
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_WRONG_PASSWORD = 6,
+    WL_DISCONNECTED = 7
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+//! IPv4 Address
+class IPAddress : public Printable {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) {
+        _addr[0] = a; _addr[1] = b; _addr[2] = c; _addr[3] = d;
+    }
+
+    size_t printTo(Print & p) const {
+        return p.printf("%u.%u.%u.%u", _addr[0], _addr[1], _addr[2], _addr[3]);
+    }
+
+private:
+    uint8_t _addr[4];
+};
+
+//! WiFi Station Interface on the Simulated Access Point
+class ESP8266WiFiClass {
+public:
+    ESP8266WiFiClass();
+
+    wl_status_t begin(const char * ssid, const char * passphrase = NULL);
+    bool disconnect(bool wifioff = false);
+    bool mode(WiFiMode_t m) { _mode = m; return true; }
+    bool setAutoReconnect(bool autoReconnect) { _auto = autoReconnect; return true; }
+    bool reconnect();
+
+    wl_status_t status();
+    bool isConnected() { return status() == WL_CONNECTED; }
+    IPAddress localIP();
+    int32_t RSSI() { return isConnected() ? -60 : 31; }
+
+private:
+    WiFiMode_t _mode;
+    bool _begun;
+    bool _auto;
+    bool _linked;
+    uint64_t _assoc_us;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+//! TCP Client connected to the Simulated Broker
+class WiFiClient : public Client {
+public:
+    WiFiClient();
+    virtual ~WiFiClient();
+
+    int connect(const char * host, uint16_t port);
+    size_t write(uint8_t);
+    size_t write(const uint8_t * buf, size_t size);
+    int available();
+    int read();
+    int read(uint8_t * buf, size_t size);
+    int peek();
+    void flush() { }
+    void stop();
+    uint8_t connected();
+    operator bool() { return connected(); }
+
+    void setTimeout(unsigned long ms) { _timeout = ms; }
+
+    using Print::write;
+
+protected:
+    void settle();
+
+    int _session;
+    bool _wrote;
+    unsigned long _timeout;
+    int _peek;
+};
+
+//! TLS Client (TLS is not simulated beyond the handshake time)
+class WiFiClientSecure : public WiFiClient {
+public:
+    bool setFingerprint(const char *) { return true; }
+    bool setFingerprint(const uint8_t *) { return true; }
+    void setInsecure() { }
+    void setBufferSizes(int, int) { }
+};
+
+#endif // ESP8266WIFI_H__
@@ -0,0 +1,59 @@
+/** Native ESP8266 EspClass Stand-In */
+
+#include <string.h>
+
+#include "ESP8266WiFi.h"
+#include "Esp.h"
+#include "sim/sim.h"
+#include "sim/sim_flash.h"
+
+EspClass ESP;
+
+bool EspClass::flashEraseSector(uint32_t sector) {
+    return sim_flash.erase(sector);
+}
+
+bool EspClass::flashWrite(uint32_t address, const uint32_t * data, size_t size) {
+    if ((address & 3) || (size & 3)) return false;
+    return sim_flash.write(address, (const uint8_t *)data, size);
+}
+
+bool EspClass::flashRead(uint32_t address, uint32_t * data, size_t size) {
+    if ((address & 3) || (size & 3)) return false;
+    return sim_flash.read(address, (uint8_t *)data, size);
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t * data, size_t size) {
+    if (offset * 4 + size > sizeof(sim_rtc_mem) || (size & 3)) return false;
+    memcpy(data, (const uint8_t *)sim_rtc_mem + offset * 4, size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t * data, size_t size) {
+    if (offset * 4 + size > sizeof(sim_rtc_mem) || (size & 3)) return false;
+    memcpy((uint8_t *)sim_rtc_mem + offset * 4, data, size);
+    return true;
+}
+
+void EspClass::deepSleep(uint64_t time_us, RFMode mode) {
+    // The radio and its TCP connections go down with the chip
+    WiFi.disconnect();
+    sim_sleep_us = time_us ? time_us : 1;
+    sim_sleep_rf = mode;
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(sim_clock_us * 80);
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return sim_heap_free;
+}
+
+uint16_t EspClass::getMaxFreeBlockSize() {
+    return sim_heap_max_block;
+}
+
+uint32_t EspClass::getFreeContStack() {
+    return sim_stack_free;
+}
@@ -0,0 +1,50 @@
+/** Native ESP8266 EspClass Stand-In */
+
+#ifndef ESP_H__
+#define ESP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Radio State after Waking from Deep Sleep
+typedef enum {
+    RF_DEFAULT = 0,             //< Calibration as configured in the init data
+    RF_CAL = 1,                 //< Full RF calibration
+    RF_NO_CAL = 2,              //< No RF calibration
+    RF_DISABLED = 4             //< Radio off until the next deep sleep
+} RFMode;
+
+#define WAKE_RF_DEFAULT     RF_DEFAULT
+#define WAKE_RFCAL          RF_CAL
+#define WAKE_NO_RFCAL       RF_NO_CAL
+#define WAKE_RF_DISABLED    RF_DISABLED
+
+//! ESP8266 System Interface (subset)
+class EspClass {
+public:
+    bool flashEraseSector(uint32_t sector);
+    bool flashWrite(uint32_t address, const uint32_t * data, size_t size);
+    bool flashRead(uint32_t address, uint32_t * data, size_t size);
+
+    // RTC user memory: 128 four-byte blocks kept across deep sleep
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t * data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t * data, size_t size);
+
+    // On the device this does not return; the host records the request
+    // for sim_wake()
+    void deepSleep(uint64_t time_us, RFMode mode = RF_DEFAULT);
+
+    // CPU cycle counter, derived from the simulated clock at 80 MHz
+    uint32_t getCycleCount();
+    uint8_t getCpuFreqMHz() { return 80; }
+
+    // Memory figures; the host reports the sim_heap_* and sim_stack_free values
+    uint32_t getFreeHeap();
+    uint16_t getMaxFreeBlockSize();
+    uint32_t getFreeContStack();
+    void resetFreeContStack() { }
+};
+
+extern EspClass ESP;
+
+#endif // ESP_H__
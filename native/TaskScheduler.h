@@ -0,0 +1,213 @@
+/** Native TaskScheduler Stand-In */
+
+#ifndef TASKSCHEDULER_H__
+#define TASKSCHEDULER_H__
+
+#include "Arduino.h"
+
+#define TASK_IMMEDIATE      0
+#define TASK_FOREVER        (-1)
+#define TASK_ONCE           1
+
+#define TASK_MILLISECOND    1UL
+#define TASK_SECOND         1000UL
+#define TASK_MINUTE         60000UL
+#define TASK_HOUR           3600000UL
+
+class Scheduler;
+
+typedef void (*TaskCallback)();
+
+//! Cooperative Task (TaskScheduler API subset)
+class Task {
+public:
+    Task(unsigned long aInterval = 0, long aIterations = 0, TaskCallback aCallback = NULL,
+        Scheduler * aScheduler = NULL, bool aEnable = false);
+
+    bool enable();
+    bool enableDelayed(unsigned long aDelay = 0);
+    bool disable();
+    bool isEnabled() const { return _enabled; }
+
+    void delay(unsigned long aDelay = 0);
+    void restart() { enable(); }
+    void restartDelayed(unsigned long aDelay = 0) { enableDelayed(aDelay); }
+    void forceNextIteration();
+
+    void setInterval(unsigned long aInterval);
+    unsigned long getInterval() const { return _interval; }
+    void setIterations(long aIterations) { _iterations = _setIterations = aIterations; }
+    long getIterations() const { return _iterations; }
+    unsigned long getRunCounter() const { return _runCounter; }
+    bool isFirstIteration() const { return _runCounter <= 1; }
+    bool isLastIteration() const { return _iterations == 0; }
+    void setCallback(TaskCallback aCallback) { _callback = aCallback; }
+
+    // Host-only instrumentation: longest callback in simulated time
+    unsigned long getMaxRunMicros() const { return _maxRunMicros; }
+    void resetMaxRunMicros() { _maxRunMicros = 0; }
+
+private:
+    friend class Scheduler;
+
+    bool _enabled;
+    unsigned long _interval;
+    unsigned long _delay;
+    unsigned long _previousMillis;
+    long _iterations;
+    long _setIterations;
+    unsigned long _runCounter;
+    TaskCallback _callback;
+    unsigned long _maxRunMicros;
+
+    Task * _next;
+    Scheduler * _scheduler;
+};
+
+//! Cooperative Task Scheduler
+class Scheduler {
+public:
+    Scheduler() : _first(NULL), _last(NULL) { }
+
+    void init();
+    void addTask(Task & aTask);
+    void deleteTask(Task & aTask);
+    void enableAll();
+    void disableAll();
+    bool execute();
+
+private:
+    Task * _first;
+    Task * _last;
+};
+
+/* --- Implementation (header-only like the upstream library) ------------- */
+
+inline Task::Task(unsigned long aInterval, long aIterations, TaskCallback aCallback,
+    Scheduler * aScheduler, bool aEnable)
+    : _enabled(false), _interval(aInterval), _delay(aInterval), _previousMillis(0),
+      _iterations(aIterations), _setIterations(aIterations), _runCounter(0),
+      _callback(aCallback), _maxRunMicros(0), _next(NULL), _scheduler(NULL)
+{
+    if (aScheduler) aScheduler->addTask(*this);
+    if (aEnable) enable();
+}
+
+inline bool Task::enable() {
+    _enabled = true;
+    _runCounter = 0;
+    _iterations = _setIterations;
+    _delay = _interval;
+    _previousMillis = millis() - _delay;
+    return true;
+}
+
+inline bool Task::enableDelayed(unsigned long aDelay) {
+    enable();
+    delay(aDelay);
+    return true;
+}
+
+inline bool Task::disable() {
+    bool was = _enabled;
+    _enabled = false;
+    return was;
+}
+
+inline void Task::delay(unsigned long aDelay) {
+    _delay = aDelay ? aDelay : _interval;
+    _previousMillis = millis();
+}
+
+inline void Task::forceNextIteration() {
+    _delay = _interval;
+    _previousMillis = millis() - _delay;
+}
+
+inline void Task::setInterval(unsigned long aInterval) {
+    _interval = aInterval;
+    delay(aInterval);
+}
+
+// Benchmarks call setup() more than once, so release the tasks of the
+// previous run as a reboot would
+inline void Scheduler::init() {
+    Task * t = _first;
+    while (t) {
+        Task * next = t->_next;
+        t->disable();
+        t->_scheduler = NULL;
+        t->_next = NULL;
+        t = next;
+    }
+
+    _first = _last = NULL;
+}
+
+inline void Scheduler::addTask(Task & aTask) {
+    if (aTask._scheduler) return;
+
+    aTask._scheduler = this;
+    aTask._next = NULL;
+    if (_last) {
+        _last->_next = &aTask;
+    } else {
+        _first = &aTask;
+    }
+    _last = &aTask;
+}
+
+inline void Scheduler::deleteTask(Task & aTask) {
+    Task * prev = NULL;
+    for (Task * t = _first; t; prev = t, t = t->_next) {
+        if (t != &aTask) continue;
+
+        if (prev) prev->_next = t->_next; else _first = t->_next;
+        if (_last == t) _last = prev;
+        t->_scheduler = NULL;
+        t->_next = NULL;
+        return;
+    }
+}
+
+inline void Scheduler::enableAll() {
+    for (Task * t = _first; t; t = t->_next) t->enable();
+}
+
+inline void Scheduler::disableAll() {
+    for (Task * t = _first; t; t = t->_next) t->disable();
+}
+
+inline bool Scheduler::execute() {
+    bool idle = true;
+
+    for (Task * t = _first; t; t = t->_next) {
+        if (!t->_enabled) continue;
+
+        if (t->_iterations == 0) {
+            t->disable();
+            continue;
+        }
+
+        unsigned long m = millis();
+        if (m - t->_previousMillis < t->_delay) continue;
+
+        // Keep the schedule (TASK_SCHEDULE): advance by the nominal period
+        t->_previousMillis += t->_delay;
+        t->_delay = t->_interval;
+
+        if (t->_iterations > 0) t->_iterations--;
+        t->_runCounter++;
+        idle = false;
+
+        if (t->_callback) {
+            unsigned long start = micros();
+            t->_callback();
+            if (micros() - start > t->_maxRunMicros) t->_maxRunMicros = micros() - start;
+        }
+    }
+
+    return idle;
+}
+
+#endif // TASKSCHEDULER_H__
@@ -0,0 +1,104 @@
+/** Native Wire (I2C) Stand-In */
+
+#include "Wire.h"
+#include "sim/sim.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : _addr(0), _tx_len(0), _rx_len(0), _rx_pos(0) {
+}
+
+void TwoWire::setClock(uint32_t hz) {
+    sim_i2c_clock_hz = hz;
+}
+
+void TwoWire::setClockStretchLimit(uint32_t us) {
+    sim_i2c_stretch_us = us;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+    _addr = addr;
+    _tx_len = 0;
+}
+
+// Return codes follow the Arduino Wire API: 2 address NACK, 3 data NACK,
+// 4 other error (here a line held low) and 5 timeout (a clock stretch)
+uint8_t TwoWire::endTransmission(bool) {
+    // A device holding SDA low prevents the START condition
+    if (!sim_i2c_sda()) {
+        return 4;
+    }
+
+    SimI2CDevice * dev = sim_i2c_find(_addr);
+    int fault = dev ? sim_i2c_next_fault(_addr) : -1;
+    if (!dev || fault == SIM_I2C_NACK) {
+        sim_i2c_transaction(0, false);
+        return 2;   // address NACK
+    }
+    if (fault == SIM_I2C_STRETCH) {
+        sim_advance_us(sim_i2c_stretch_us);
+        sim_i2c_transaction(0, false);
+        return 5;
+    }
+    if (fault == SIM_I2C_SDA_STUCK) {
+        sim_i2c_transaction(0, false);
+        return 4;
+    }
+
+    // An empty write is an address probe; any present device ACKs it
+    bool ack = !_tx_len || dev->onWrite(_tx, _tx_len);
+    sim_i2c_transaction(_tx_len, ack);
+
+    return ack ? 0 : 3;   // data NACK
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, size_t len, bool) {
+    _rx_len = _rx_pos = 0;
+    if (!sim_i2c_sda()) {
+        return 0;
+    }
+
+    SimI2CDevice * dev = sim_i2c_find(addr);
+    int fault = dev ? sim_i2c_next_fault(addr) : -1;
+    if (len > WIRE_BUFFER_SIZE) len = WIRE_BUFFER_SIZE;
+    if (fault == SIM_I2C_STRETCH) {
+        sim_advance_us(sim_i2c_stretch_us);
+    }
+    if (!dev || fault == SIM_I2C_NACK || fault == SIM_I2C_STRETCH
+        || fault == SIM_I2C_SDA_STUCK || !dev->onRead(_rx, len)) {
+        sim_i2c_transaction(0, false);
+        return 0;
+    }
+
+    if (fault == SIM_I2C_CORRUPT) {
+        _rx[len / 2] ^= 0x01;
+    }
+    sim_i2c_transaction(len, true);
+    _rx_len = len;
+
+    return (uint8_t)len;
+}
+
+size_t TwoWire::write(uint8_t c) {
+    if (_tx_len >= WIRE_BUFFER_SIZE) return 0;
+    _tx[_tx_len++] = c;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t * data, size_t len) {
+    size_t n = 0;
+    while (n < len && write(data[n])) n++;
+    return n;
+}
+
+int TwoWire::available() {
+    return (int)(_rx_len - _rx_pos);
+}
+
+int TwoWire::read() {
+    return _rx_pos < _rx_len ? _rx[_rx_pos++] : -1;
+}
+
+int TwoWire::peek() {
+    return _rx_pos < _rx_len ? _rx[_rx_pos] : -1;
+}
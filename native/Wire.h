@@ -0,0 +1,43 @@
+/** Native Wire (I2C) Stand-In */
+
+#ifndef WIRE_H__
+#define WIRE_H__
+
+#include "Arduino.h"
+
+#define WIRE_BUFFER_SIZE 128
+
+//! I2C Master on the Simulated Bus
+class TwoWire : public Stream {
+public:
+    TwoWire();
+
+    void begin() { }
+    void begin(int, int) { }
+    void setClock(uint32_t);
+    void setClockStretchLimit(uint32_t);
+
+    void beginTransmission(uint8_t);
+    uint8_t endTransmission(bool = true);
+    uint8_t requestFrom(uint8_t, size_t, bool = true);
+
+    size_t write(uint8_t);
+    size_t write(const uint8_t *, size_t);
+    using Print::write;
+
+    int available();
+    int read();
+    int peek();
+
+private:
+    uint8_t _addr;
+    uint8_t _tx[WIRE_BUFFER_SIZE];
+    size_t _tx_len;
+    uint8_t _rx[WIRE_BUFFER_SIZE];
+    size_t _rx_len;
+    size_t _rx_pos;
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H__
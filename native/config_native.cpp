@@ -0,0 +1,14 @@
+/** Native Configuration (stands in for src/config.cpp) */
+
+#include <stdint.h>
+
+/** WiFi SSID */
+const char * wifi_ssid = "ssid-sim";
+const char * wifi_passwd = "ssid-psk";
+
+/** MQTT Connection */
+const char * mqtt_host = "mqtt.sim";
+const char * mqtt_user = "sensors";
+const char * mqtt_passwd = "sensors";
+const char * mqtt_fingerprint = "01 23 45 67 89 AB CD EF 01 23 45 67 89 AB CD EF 01 23 45 67";
+uint16_t mqtt_port = 1883;
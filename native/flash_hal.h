@@ -0,0 +1,12 @@
+/** Native ESP8266 Flash HAL Stand-In */
+
+#ifndef FLASH_HAL_H__
+#define FLASH_HAL_H__
+
+#define FLASH_SECTOR_SIZE   0x1000
+
+// Filesystem area (256 KiB on the host, see native/sim/sim_flash.h)
+#define FS_PHYS_ADDR        0x200000
+#define FS_PHYS_SIZE        0x40000
+
+#endif // FLASH_HAL_H__
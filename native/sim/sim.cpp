@@ -0,0 +1,207 @@
+/** Native Simulation Environment */
+
+#include "EEPROM_Rotate.h"
+
+#include "sim.h"
+#include "sim_broker.h"
+#include "sim_flash.h"
+#include "sim_sensors.h"
+
+// Simulated Clock
+uint64_t sim_clock_us = 0;
+
+// Scheduled Event
+void (*sim_event)() = NULL;
+uint64_t sim_event_us = 0;
+
+// Serial Echo
+bool sim_serial_echo = false;
+
+// Simulated I2C Bus
+uint32_t sim_i2c_clock_hz = 100000;
+SimI2CStats sim_i2c_stats;
+
+#define SIM_I2C_MAX_DEVICES 8
+
+static SimI2CDevice * i2c_devices[SIM_I2C_MAX_DEVICES];
+static size_t i2c_count = 0;
+
+// Scripted I2C Faults and Bus Lines
+uint32_t sim_i2c_stretch_us = 230;
+
+#define SIM_I2C_MAX_FAULTS 8
+
+static SimI2CFault i2c_faults[SIM_I2C_MAX_FAULTS];
+static uint32_t i2c_fault_seen[SIM_I2C_MAX_FAULTS];
+static size_t i2c_fault_count = 0;
+static uint32_t sda_clocks;         // Clocks until the stuck device lets go
+static bool sda_held;
+static bool scl_level = true;
+
+// Simulated Access Point
+bool sim_wifi_ap_up = true;
+uint32_t sim_wifi_assoc_ms = 1500;
+
+// Pseudo-Random State (xorshift32)
+static uint32_t rand_state = 1;
+
+void sim_advance_us(uint64_t us) {
+    uint64_t end = sim_clock_us + us;
+
+    while (sim_event && sim_event_us <= end) {
+        void (*event)() = sim_event;
+        if (sim_event_us > sim_clock_us) {
+            sim_clock_us = sim_event_us;
+        }
+        sim_event = NULL;
+        event();
+    }
+
+    sim_clock_us = end;
+}
+
+uint32_t sim_rand() {
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+void sim_i2c_attach(SimI2CDevice * dev) {
+    if (i2c_count < SIM_I2C_MAX_DEVICES) {
+        i2c_devices[i2c_count++] = dev;
+    }
+}
+
+void sim_i2c_detach_all() {
+    i2c_count = 0;
+}
+
+SimI2CDevice * sim_i2c_find(uint8_t addr) {
+    for (size_t i = 0; i < i2c_count; i++) {
+        if (i2c_devices[i]->address == addr) {
+            return i2c_devices[i];
+        }
+    }
+
+    return NULL;
+}
+
+void sim_i2c_transaction(size_t bytes, bool ack) {
+    // START + address + data bytes (9 clocks each) + STOP
+    uint64_t bits = 2 + 9 * (1 + bytes);
+    uint64_t us = (bits * 1000000 + sim_i2c_clock_hz - 1) / sim_i2c_clock_hz;
+
+    sim_i2c_stats.transactions++;
+    sim_i2c_stats.bus_us += us;
+    if (!ack) {
+        sim_i2c_stats.nacks++;
+    }
+
+    sim_advance_us(us);
+}
+
+void sim_i2c_fault(const SimI2CFault & fault) {
+    if (i2c_fault_count < SIM_I2C_MAX_FAULTS) {
+        i2c_fault_seen[i2c_fault_count] = 0;
+        i2c_faults[i2c_fault_count++] = fault;
+    }
+}
+
+int sim_i2c_next_fault(uint8_t addr) {
+    int kind = -1;
+
+    for (size_t i = 0; i < i2c_fault_count; i++) {
+        const SimI2CFault & f = i2c_faults[i];
+        if (f.address != addr) continue;
+
+        uint32_t n = i2c_fault_seen[i]++;
+        if (f.kind == SIM_I2C_SDA_STUCK) {
+            // Stops mid-byte once; the clocks it still needs release it
+            if (n == f.after) {
+                sda_held = true;
+                sda_clocks = f.count;
+                kind = f.kind;
+            }
+        } else if (n >= f.after && n - f.after < f.count) {
+            kind = f.kind;
+        }
+    }
+
+    return kind;
+}
+
+bool sim_i2c_sda() {
+    return !sda_held;
+}
+
+void sim_i2c_scl(bool level) {
+    // The stuck device shifts out one bit per rising edge
+    if (level && !scl_level && sda_held && sda_clocks <= 9 && --sda_clocks == 0) {
+        sda_held = false;
+    }
+    scl_level = level;
+}
+
+bool sim_i2c_scl_level() {
+    return scl_level;
+}
+
+uint32_t sim_rtc_mem[128];
+uint64_t sim_sleep_us;
+int sim_sleep_rf;
+bool sim_rf_disabled;
+bool sim_time_synced;
+uint32_t sim_heap_free;
+uint16_t sim_heap_max_block;
+uint32_t sim_stack_free;
+
+void sim_wake() {
+    sim_advance_us(sim_sleep_us);
+    sim_sleep_us = 0;
+    sim_rf_disabled = sim_sleep_rf == 4;    // RF_DISABLED
+}
+
+void sim_reset(uint32_t seed) {
+    sim_clock_us = 0;
+    sim_event = NULL;
+    rand_state = seed ? seed : 1;
+
+    // Sensor Suite
+    sim_i2c_detach_all();
+    sim_i2c_stats = SimI2CStats();
+    sim_i2c_clock_hz = 100000;
+    sim_i2c_stretch_us = 230;
+    i2c_fault_count = 0;
+    sda_held = false;
+    scl_level = true;
+
+    sim_bme280.reset();
+    sim_sgp30.reset();
+    sim_pms5003.reset();
+
+    sim_i2c_attach(&sim_bme280);
+    sim_i2c_attach(&sim_sgp30);
+    sim_i2c_attach(&sim_pms5003);
+
+    // Power-on: RTC memory holds garbage
+    for (size_t i = 0; i < sizeof(sim_rtc_mem) / sizeof(sim_rtc_mem[0]); i++) {
+        sim_rtc_mem[i] = sim_rand();
+    }
+    sim_sleep_us = 0;
+    sim_sleep_rf = 0;
+    sim_rf_disabled = false;
+    sim_time_synced = false;
+    sim_heap_free = 41000;
+    sim_heap_max_block = 38000;
+    sim_stack_free = 2600;
+
+    // Network
+    sim_wifi_ap_up = true;
+    sim_wifi_assoc_ms = 1500;
+    sim_broker.reset();
+
+    // Storage
+    sim_flash.reset();
+    EEPROM_Rotate::erase();
+}
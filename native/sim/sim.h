@@ -0,0 +1,172 @@
+/** Native Simulation Environment */
+
+#ifndef SIM_H__
+#define SIM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Simulated clock, in microseconds since the last reset */
+extern uint64_t sim_clock_us;
+
+/** Simulated wall clock at sim_clock_us 0 (2026-01-01 00:00 UTC) */
+#define SIM_EPOCH 1767225600
+
+/** time() follows SIM_EPOCH once configTime() has been called (until sim_reset) */
+extern bool sim_time_synced;
+
+/** Echo Serial output to stdout (off by default) */
+extern bool sim_serial_echo;
+
+/**
+ * Advance the Simulated Clock
+ * @param [in] us number of microseconds to advance
+ */
+void sim_advance_us(uint64_t);
+
+/**
+ * Scheduled Simulation Event
+ *
+ * sim_advance_us() stops the clock at sim_event_us and calls sim_event, so
+ * a host bench can inject traffic while the firmware is in the middle of a
+ * delay or an I2C transaction. The callback may schedule the next event;
+ * sim_reset() clears it.
+ */
+extern void (*sim_event)();
+extern uint64_t sim_event_us;
+
+/**
+ * Reset the Simulation
+ * @param [in] seed pseudo-random seed for the simulated sensors
+ *
+ * Resets the clock, re-attaches the default sensor suite to the I2C bus,
+ * brings the simulated access point and broker online and erases the
+ * simulated flash and EEPROM.
+ */
+void sim_reset(uint32_t = 1);
+
+/** Deterministic pseudo-random number generator used by the simulation */
+uint32_t sim_rand();
+
+/** Simulated RTC user memory (kept across deep sleep, random after sim_reset) */
+extern uint32_t sim_rtc_mem[128];
+
+/** Pending deep sleep from ESP.deepSleep() (microseconds, 0 if none) */
+extern uint64_t sim_sleep_us;
+
+/** Radio mode requested for the next wake (RFMode) */
+extern int sim_sleep_rf;
+
+/** Radio disabled since the last wake (WAKE_RF_DISABLED) */
+extern bool sim_rf_disabled;
+
+/** Free heap, largest free block and least free stack reported by ESP (reset to a typical build) */
+extern uint32_t sim_heap_free;
+extern uint16_t sim_heap_max_block;
+extern uint32_t sim_stack_free;
+
+/**
+ * Wake from Deep Sleep
+ *
+ * Advances the clock by the pending deep sleep as the RTC timer would, and
+ * applies the requested radio mode. RAM is not cleared; the firmware must
+ * restore its state from RTC memory the same way it does on the device.
+ */
+void sim_wake();
+
+/**
+ * Simulated I2C Device
+ *
+ * Devices attach to the simulated bus at a 7-bit address and receive each
+ * master write and read transaction as a whole. Returning false NACKs the
+ * transaction.
+ */
+class SimI2CDevice {
+public:
+    explicit SimI2CDevice(uint8_t addr) : address(addr) { }
+    virtual ~SimI2CDevice() { }
+
+    virtual bool onWrite(const uint8_t *, size_t) = 0;
+    virtual bool onRead(uint8_t *, size_t) = 0;
+    virtual void reset() { }
+
+    const uint8_t address;
+};
+
+//! Simulated I2C Bus Statistics
+typedef struct {
+    uint32_t transactions;      //< Number of address phases
+    uint32_t nacks;             //< Number of NACKed transactions
+    uint64_t bus_us;            //< Total time the bus was occupied
+} SimI2CStats;
+
+/** Simulated I2C bus clock (Hz) */
+extern uint32_t sim_i2c_clock_hz;
+
+/** Simulated I2C bus statistics */
+extern SimI2CStats sim_i2c_stats;
+
+/** Attach a device to the simulated I2C bus */
+void sim_i2c_attach(SimI2CDevice *);
+
+/** Detach all devices from the simulated I2C bus */
+void sim_i2c_detach_all();
+
+/** Find the device at an address, or NULL if nothing answers */
+SimI2CDevice * sim_i2c_find(uint8_t);
+
+/**
+ * Account for one I2C transaction on the simulated bus
+ * @param [in] bytes number of data bytes transferred after the address
+ * @param [in] ack whether the transaction was acknowledged
+ */
+void sim_i2c_transaction(size_t, bool);
+
+/** Clock-stretch limit of the master (us), set by Wire.setClockStretchLimit() */
+extern uint32_t sim_i2c_stretch_us;
+
+//! Scripted I2C Fault Kinds
+#define SIM_I2C_NACK        0   //< The device NACKs the transaction
+#define SIM_I2C_CORRUPT     1   //< A read returns a flipped bit
+#define SIM_I2C_STRETCH     2   //< The device stretches SCL past the master's limit
+#define SIM_I2C_SDA_STUCK   3   //< The device stops mid-byte, holding SDA low
+
+/**
+ * Scripted I2C Fault
+ *
+ * The fault starts after the given number of transactions with the device,
+ * counted from when it is added, and affects the next count transactions.
+ * A stuck SDA line instead blocks the whole bus until the master clocks SCL
+ * count times; a count above 9 is a device that never lets go.
+ */
+typedef struct {
+    uint8_t address;
+    uint8_t kind;               //< SIM_I2C_*
+    uint32_t after;             //< Transactions before the fault starts
+    uint32_t count;             //< Transactions affected, or clocks to release SDA
+} SimI2CFault;
+
+/** Add a Fault to the Script (cleared by sim_reset) */
+void sim_i2c_fault(const SimI2CFault &);
+
+/**
+ * Fault for the Next Transaction with a Device
+ * @param [in] addr device address
+ * @return SIM_I2C_* fault kind, or -1 if the transaction goes through
+ */
+int sim_i2c_next_fault(uint8_t);
+
+/** SDA Level (false while a device holds it low) */
+bool sim_i2c_sda();
+
+/** Drive SCL as a GPIO (bus recovery); a stuck device counts the clocks */
+void sim_i2c_scl(bool);
+
+/** SCL Level */
+bool sim_i2c_scl_level();
+
+/** Simulated WiFi Access Point */
+extern bool sim_wifi_ap_up;             //< Access point is reachable
+extern uint32_t sim_wifi_assoc_ms;      //< Association time after WiFi.begin()
+
+#endif // SIM_H__
@@ -0,0 +1,389 @@
+/** Native Simulation - MQTT Broker */
+
+#include <string.h>
+
+#include "sim.h"
+#include "sim_broker.h"
+
+SimBroker sim_broker;
+
+// MQTT Control Packet Types
+#define PKT_CONNECT     1
+#define PKT_CONNACK     2
+#define PKT_PUBLISH     3
+#define PKT_PUBACK      4
+#define PKT_SUBSCRIBE   8
+#define PKT_SUBACK      9
+#define PKT_UNSUBSCRIBE 10
+#define PKT_UNSUBACK    11
+#define PKT_PINGREQ     12
+#define PKT_PINGRESP    13
+#define PKT_DISCONNECT  14
+
+// Read a length-prefixed MQTT string
+static size_t read_string(const uint8_t * p, size_t len, std::string & out) {
+    if (len < 2) return 0;
+    size_t n = (p[0] << 8) | p[1];
+    if (len < 2 + n) return 0;
+    out.assign((const char *)p + 2, n);
+    return 2 + n;
+}
+
+// Append an MQTT remaining-length field
+static void put_length(std::vector<uint8_t> & pkt, size_t len) {
+    do {
+        uint8_t b = len % 128;
+        len /= 128;
+        pkt.push_back(len ? (b | 0x80) : b);
+    } while (len);
+}
+
+void SimBroker::reset() {
+    online = true;
+    stalled = false;
+    connect_ms = 250;
+    timeout_ms = 5000;
+    rtt_us = 20000;
+    service_us = 0;
+    delivery_us = 0;
+    write_us = 0;
+    last_latency_us = 0;
+    _backlog_us = 0;
+    _backlog_at = 0;
+    on_publish = NULL;
+    stats = SimBrokerStats();
+    _receiving = -1;
+    _sessions.clear();
+    _retained.clear();
+}
+
+void SimBroker::drop_all() {
+    for (size_t i = 0; i < _sessions.size(); i++) {
+        detach((int)i);
+    }
+}
+
+bool SimBroker::match(const char * filter, const char * topic) {
+    while (*filter) {
+        if (*filter == '#') {
+            return true;
+        }
+
+        if (*filter == '+') {
+            while (*topic && *topic != '/') topic++;
+            filter++;
+            continue;
+        }
+
+        if (*filter != *topic) {
+            // "a/#" also matches the parent level "a"
+            return !*topic && filter[0] == '/' && filter[1] == '#';
+        }
+
+        filter++;
+        topic++;
+    }
+
+    return !*topic;
+}
+
+const std::vector<uint8_t> * SimBroker::retained(const char * topic) const {
+    std::map<std::string, std::vector<uint8_t> >::const_iterator it = _retained.find(topic);
+    return it == _retained.end() ? NULL : &it->second;
+}
+
+int SimBroker::attach() {
+    if (!online) {
+        stats.refused++;
+        return -1;
+    }
+
+    // Session ids are never reused so stale clients cannot alias them
+    size_t i = _sessions.size();
+    _sessions.push_back(Session());
+
+    Session & s = _sessions[i];
+    s.open = true;
+    s.client_id.clear();
+    s.filters.clear();
+    s.in.clear();
+    s.out.clear();
+    s.out_pos = 0;
+    s.out_at.clear();
+    s.read_at = 0;
+    s.replied = false;
+
+    return (int)i;
+}
+
+void SimBroker::detach(int id) {
+    if (id < 0 || id >= (int)_sessions.size()) return;
+
+    Session & s = _sessions[id];
+    s.open = false;
+    s.filters.clear();
+    s.in.clear();
+    s.out.clear();
+    s.out_pos = 0;
+    s.out_at.clear();
+    s.replied = false;
+}
+
+bool SimBroker::connected(int id) const {
+    return id >= 0 && id < (int)_sessions.size() && _sessions[id].open;
+}
+
+size_t SimBroker::pending(int id) const {
+    if (!connected(id)) return 0;
+    return _sessions[id].out.size() - _sessions[id].out_pos;
+}
+
+bool SimBroker::replied(int id) const {
+    return pending(id) && _sessions[id].replied;
+}
+
+size_t SimBroker::take(int id, uint8_t * buf, size_t len) {
+    if (!connected(id)) return 0;
+
+    Session & s = _sessions[id];
+    size_t n = s.out.size() - s.out_pos;
+    if (n > len) n = len;
+
+    memcpy(buf, s.out.data() + s.out_pos, n);
+    s.out_pos += n;
+
+    // Every send the read reached into has been seen by the client
+    size_t seen = 0;
+    while (seen < s.out_at.size() && s.out_at[seen].first < s.out_pos) {
+        s.read_at = s.out_at[seen++].second;
+    }
+    s.out_at.erase(s.out_at.begin(), s.out_at.begin() + seen);
+
+    if (s.out_pos == s.out.size()) {
+        s.out.clear();
+        s.out_pos = 0;
+        s.replied = false;
+    }
+
+    return n;
+}
+
+uint64_t SimBroker::arrived(int id) const {
+    if (id < 0 || id >= (int)_sessions.size()) return 0;
+    return _sessions[id].read_at;
+}
+
+void SimBroker::send(int id, const uint8_t * data, size_t len) {
+    _sessions[id].out_at.push_back(std::make_pair(_sessions[id].out.size(), sim_clock_us));
+    _sessions[id].out.insert(_sessions[id].out.end(), data, data + len);
+    _sessions[id].replied |= id == _receiving;
+    stats.bytes_out += len;
+}
+
+void SimBroker::deliver(int id, const char * topic, const uint8_t * payload, size_t len, bool retain) {
+    std::vector<uint8_t> pkt;
+    size_t tlen = strlen(topic);
+
+    pkt.push_back((PKT_PUBLISH << 4) | (retain ? 1 : 0));
+    put_length(pkt, 2 + tlen + len);
+    pkt.push_back(tlen >> 8);
+    pkt.push_back(tlen & 0xFF);
+    pkt.insert(pkt.end(), topic, topic + tlen);
+    pkt.insert(pkt.end(), payload, payload + len);
+
+    send(id, pkt.data(), pkt.size());
+    stats.deliveries++;
+}
+
+void SimBroker::publish(const char * topic, const uint8_t * payload, size_t len, bool retain) {
+    if (retain) {
+        if (len) {
+            _retained[topic].assign(payload, payload + len);
+        } else {
+            _retained.erase(topic);
+        }
+    }
+
+    for (size_t i = 0; i < _sessions.size(); i++) {
+        if (!_sessions[i].open) continue;
+        for (size_t f = 0; f < _sessions[i].filters.size(); f++) {
+            if (match(_sessions[i].filters[f].c_str(), topic)) {
+                deliver((int)i, topic, payload, len, false);
+                break;
+            }
+        }
+    }
+}
+
+void SimBroker::publish(const char * topic, const char * payload, bool retain) {
+    publish(topic, (const uint8_t *)payload, strlen(payload), retain);
+}
+
+void SimBroker::receive(int id, const uint8_t * data, size_t len) {
+    if (!connected(id)) return;
+
+    stats.bytes_in += len;
+    stats.segments++;
+    if (stalled) return;
+
+    _sessions[id].in.insert(_sessions[id].in.end(), data, data + len);
+
+    // Process every complete packet in the input buffer
+    for (;;) {
+        std::vector<uint8_t> & in = _sessions[id].in;
+        size_t rlen = 0, mult = 1, pos = 1;
+
+        for (;;) {
+            if (pos >= in.size()) return;
+            rlen += (in[pos] & 0x7F) * mult;
+            mult *= 128;
+            if (!(in[pos++] & 0x80)) break;
+        }
+
+        if (in.size() < pos + rlen) return;
+
+        std::vector<uint8_t> body(in.begin() + pos, in.begin() + pos + rlen);
+        uint8_t hdr = in[0];
+        in.erase(in.begin(), in.begin() + pos + rlen);
+
+        uint32_t deliveries = stats.deliveries;
+        _receiving = id;
+        process(id, hdr, body.data(), body.size());
+        _receiving = -1;
+
+        // Single-server queue: the backlog drains in simulated time. Clients
+        // stepped on their own clocks can arrive slightly out of order, so
+        // only a later arrival drains it.
+        if (sim_clock_us > _backlog_at) {
+            uint64_t elapsed = sim_clock_us - _backlog_at;
+            _backlog_us = _backlog_us > elapsed ? _backlog_us - elapsed : 0;
+            _backlog_at = sim_clock_us;
+        }
+        _backlog_us += service_us + (uint64_t)(stats.deliveries - deliveries) * delivery_us;
+        if ((hdr >> 4) == PKT_PUBLISH) {
+            last_latency_us = _backlog_us;
+        }
+
+        if (!connected(id)) return;
+    }
+}
+
+void SimBroker::process(int id, uint8_t hdr, const uint8_t * p, size_t len) {
+    Session & s = _sessions[id];
+
+    switch (hdr >> 4) {
+    case PKT_CONNECT: {
+        std::string proto;
+        size_t n = read_string(p, len, proto);
+        if (!n || len < n + 4) { detach(id); return; }
+        read_string(p + n + 4, len - n - 4, s.client_id);
+
+        const uint8_t connack[] = { PKT_CONNACK << 4, 2, 0, 0 };
+        send(id, connack, sizeof(connack));
+        stats.connects++;
+        break;
+    }
+
+    case PKT_PUBLISH: {
+        uint8_t qos = (hdr >> 1) & 3;
+        bool retain = hdr & 1;
+        std::string topic;
+        size_t n = read_string(p, len, topic);
+        if (!n) { detach(id); return; }
+
+        uint16_t pid = 0;
+        if (qos) {
+            pid = (p[n] << 8) | p[n + 1];
+            n += 2;
+        }
+
+        stats.publishes++;
+        stats.payload_bytes += len - n;
+        if (on_publish) {
+            on_publish(id, topic.c_str(), p + n, len - n, retain);
+        }
+
+        publish(topic.c_str(), p + n, len - n, retain);
+
+        if (qos) {
+            const uint8_t puback[] = { PKT_PUBACK << 4, 2, (uint8_t)(pid >> 8), (uint8_t)(pid & 0xFF) };
+            send(id, puback, sizeof(puback));
+        }
+        break;
+    }
+
+    case PKT_SUBSCRIBE: {
+        std::vector<uint8_t> suback;
+        std::vector<std::string> added;
+        size_t pos = 2;
+
+        suback.push_back(PKT_SUBACK << 4);
+        suback.push_back(0);
+        suback.push_back(p[0]);
+        suback.push_back(p[1]);
+
+        while (pos < len) {
+            std::string filter;
+            size_t n = read_string(p + pos, len - pos, filter);
+            if (!n || pos + n >= len) break;
+            uint8_t qos = p[pos + n];
+            pos += n + 1;
+
+            s.filters.push_back(filter);
+            added.push_back(filter);
+            suback.push_back(qos > 1 ? 1 : qos);
+        }
+
+        suback[1] = (uint8_t)(suback.size() - 2);
+        send(id, suback.data(), suback.size());
+        stats.subscribes++;
+
+        // Deliver matching retained messages
+        std::map<std::string, std::vector<uint8_t> >::const_iterator it;
+        for (it = _retained.begin(); it != _retained.end(); ++it) {
+            for (size_t f = 0; f < added.size(); f++) {
+                if (match(added[f].c_str(), it->first.c_str())) {
+                    deliver(id, it->first.c_str(), it->second.data(), it->second.size(), true);
+                    break;
+                }
+            }
+        }
+        break;
+    }
+
+    case PKT_UNSUBSCRIBE: {
+        size_t pos = 2;
+        while (pos < len) {
+            std::string filter;
+            size_t n = read_string(p + pos, len - pos, filter);
+            if (!n) break;
+            pos += n;
+
+            for (size_t f = 0; f < s.filters.size(); f++) {
+                if (s.filters[f] == filter) {
+                    s.filters.erase(s.filters.begin() + f);
+                    break;
+                }
+            }
+        }
+
+        const uint8_t unsuback[] = { PKT_UNSUBACK << 4, 2, p[0], p[1] };
+        send(id, unsuback, sizeof(unsuback));
+        break;
+    }
+
+    case PKT_PINGREQ: {
+        const uint8_t pingresp[] = { PKT_PINGRESP << 4, 0 };
+        send(id, pingresp, sizeof(pingresp));
+        stats.pings++;
+        break;
+    }
+
+    case PKT_DISCONNECT:
+        detach(id);
+        break;
+
+    default:
+        break;
+    }
+}
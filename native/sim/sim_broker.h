@@ -0,0 +1,114 @@
+/** Native Simulation - MQTT Broker */
+
+#ifndef SIM_BROKER_H__
+#define SIM_BROKER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+//! Simulated Broker Statistics
+typedef struct {
+    uint32_t connects;          //< CONNECT packets accepted
+    uint32_t refused;           //< TCP connections refused (broker offline)
+    uint32_t publishes;         //< PUBLISH packets received from clients
+    uint32_t deliveries;        //< PUBLISH packets delivered to clients
+    uint32_t pings;             //< PINGREQ packets received
+    uint32_t subscribes;        //< SUBSCRIBE packets received
+    uint64_t bytes_in;          //< Bytes received from clients
+    uint32_t segments;          //< Socket writes received from clients
+    uint64_t bytes_out;         //< Bytes sent to clients
+    uint64_t payload_bytes;     //< PUBLISH payload bytes received
+} SimBrokerStats;
+
+/**
+ * Simulated MQTT 3.1.1 Broker
+ *
+ * A minimal in-process broker speaking the MQTT wire protocol to WiFiClient
+ * stand-ins. It supports QoS 0/1 publishes, wildcard subscriptions, retained
+ * messages and keepalive pings, and counts everything that crosses the wire.
+ *
+ * Load is modelled as a single server: each packet adds service_us of work,
+ * plus delivery_us per subscriber it goes out to, to a backlog that drains
+ * in simulated time. Clients are not held up by the backlog; the time a
+ * PUBLISH waited in it is left in last_latency_us.
+ */
+class SimBroker {
+public:
+    //! Callback for every PUBLISH received from a client
+    typedef void (*publish_cb)(int, const char *, const uint8_t *, size_t, bool);
+
+    SimBroker() { reset(); }
+
+    /** Reset the broker, dropping all sessions and retained messages */
+    void reset();
+
+    /** Sever every client connection (network outage) */
+    void drop_all();
+
+    /** Publish a message from the broker side (e.g. Home Assistant) */
+    void publish(const char *, const uint8_t *, size_t, bool = false);
+    void publish(const char *, const char *, bool = false);
+
+    /** Number of retained messages currently stored */
+    size_t retained() const { return _retained.size(); }
+
+    /** Retained payload for a topic, or NULL if none is stored */
+    const std::vector<uint8_t> * retained(const char *) const;
+
+    bool online;                //< Broker accepts TCP connections
+    bool stalled;               //< Open sessions silently drop traffic (half-open link)
+    uint32_t connect_ms;        //< Simulated TCP/TLS handshake time
+    uint32_t timeout_ms;        //< Simulated TCP connect timeout when offline
+    uint32_t rtt_us;            //< Simulated network round-trip time
+    uint32_t service_us;        //< Broker time to handle a packet (0: instant)
+    uint32_t delivery_us;       //< Broker time per message delivered to a subscriber
+    uint32_t write_us;          //< Client time per socket write (TCP segment, TLS record)
+    uint64_t last_latency_us;   //< Queueing and handling time of the last PUBLISH
+    publish_cb on_publish;      //< Observer for client publishes
+    SimBrokerStats stats;       //< Traffic statistics
+
+    // Transport interface for WiFiClient
+    int attach();
+    void detach(int);
+    bool connected(int) const;
+    void receive(int, const uint8_t *, size_t);
+    size_t pending(int) const;
+    bool replied(int) const;
+    size_t take(int, uint8_t *, size_t);
+
+    /** Time (sim_clock_us) the last packet a client started reading reached its socket */
+    uint64_t arrived(int) const;
+
+    static bool match(const char *, const char *);
+
+private:
+    struct Session {
+        bool open;
+        std::string client_id;
+        std::vector<std::string> filters;
+        std::vector<uint8_t> in;
+        std::vector<uint8_t> out;
+        size_t out_pos;
+        std::vector<std::pair<size_t, uint64_t> > out_at;  //< Offset in out and arrival time of each send
+        uint64_t read_at;       //< Arrival time of the data last read
+        bool replied;           //< out holds an answer to the client's own packet
+    };
+
+    void process(int, uint8_t, const uint8_t *, size_t);
+    void send(int, const uint8_t *, size_t);
+    void deliver(int, const char *, const uint8_t *, size_t, bool);
+
+    std::vector<Session> _sessions;
+    int _receiving;             //< Session whose packets are being processed
+    uint64_t _backlog_us;       //< Queued work at _backlog_at
+    uint64_t _backlog_at;
+    std::map<std::string, std::vector<uint8_t> > _retained;
+};
+
+extern SimBroker sim_broker;
+
+#endif // SIM_BROKER_H__
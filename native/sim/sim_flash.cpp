@@ -0,0 +1,79 @@
+/** Native Simulation - SPI NOR Flash */
+
+#include <string.h>
+
+#include "flash_hal.h"
+#include "sim.h"
+#include "sim_flash.h"
+
+SimFlash sim_flash;
+
+#define SIM_FLASH_PAGE 256
+
+void SimFlash::reset() {
+    _data.assign(FS_PHYS_SIZE, 0xFF);
+    sector_erases.assign(FS_PHYS_SIZE / FLASH_SECTOR_SIZE, 0);
+    stats = SimFlashStats();
+    cut_after = -1;
+    powered = true;
+    erase_us = 45000;
+    page_us = 400;
+}
+
+bool SimFlash::erase(uint32_t sector) {
+    uint32_t first = FS_PHYS_ADDR / FLASH_SECTOR_SIZE;
+    if (!powered || sector < first || sector - first >= sector_erases.size()) {
+        return false;
+    }
+
+    memset(&_data[(sector - first) * FLASH_SECTOR_SIZE], 0xFF, FLASH_SECTOR_SIZE);
+    sector_erases[sector - first]++;
+    stats.erases++;
+    sim_advance_us(erase_us);
+
+    return true;
+}
+
+bool SimFlash::write(uint32_t addr, const uint8_t * data, size_t len) {
+    if (!powered || addr < FS_PHYS_ADDR || addr - FS_PHYS_ADDR + len > _data.size()) {
+        return false;
+    }
+
+    uint8_t * p = &_data[addr - FS_PHYS_ADDR];
+    size_t n = len;
+    if (cut_after >= 0 && (int64_t)len > cut_after) {
+        n = cut_after;
+    }
+
+    // Programming can only clear bits
+    for (size_t i = 0; i < n; i++) {
+        p[i] &= data[i];
+    }
+
+    uint32_t pages = (addr + n + SIM_FLASH_PAGE - 1) / SIM_FLASH_PAGE - addr / SIM_FLASH_PAGE;
+    sim_advance_us((uint64_t)pages * page_us);
+    stats.writes++;
+    stats.bytes_written += n;
+
+    if (cut_after >= 0) {
+        cut_after -= n;
+        if (n < len || !cut_after) {
+            powered = false;
+            return n == len;
+        }
+    }
+
+    return true;
+}
+
+bool SimFlash::read(uint32_t addr, uint8_t * data, size_t len) {
+    if (addr < FS_PHYS_ADDR || addr - FS_PHYS_ADDR + len > _data.size()) {
+        return false;
+    }
+
+    memcpy(data, &_data[addr - FS_PHYS_ADDR], len);
+    stats.reads++;
+    stats.bytes_read += len;
+
+    return true;
+}
@@ -0,0 +1,61 @@
+/** Native Simulation - SPI NOR Flash */
+
+#ifndef SIM_FLASH_H__
+#define SIM_FLASH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+//! Simulated Flash Statistics
+typedef struct {
+    uint32_t erases;            //< Sector erases
+    uint32_t writes;            //< Program operations
+    uint32_t reads;             //< Read operations
+    uint64_t bytes_written;     //< Bytes programmed
+    uint64_t bytes_read;        //< Bytes read
+} SimFlashStats;
+
+/**
+ * Simulated SPI NOR Flash
+ *
+ * Models the filesystem area of the ESP8266 flash with NOR semantics: an
+ * erase sets a 4 KiB sector to 0xFF and programming can only clear bits.
+ * Erases and page programs charge typical datasheet times to the simulated
+ * clock. A power cut can be scheduled to interrupt a write part way through
+ * to exercise crash recovery.
+ */
+class SimFlash {
+public:
+    SimFlash() { reset(); }
+
+    /** Erase the whole region and clear statistics */
+    void reset();
+
+    /** Schedule a power cut after this many more programmed bytes (-1: never) */
+    int64_t cut_after;
+
+    /** Flash has power (false after a scheduled cut, until power_on) */
+    bool powered;
+
+    /** Restore power after a cut */
+    void power_on() { powered = true; cut_after = -1; }
+
+    uint32_t erase_us;          //< Sector erase time
+    uint32_t page_us;           //< Page (256 B) program time
+    SimFlashStats stats;        //< Operation statistics
+    std::vector<uint32_t> sector_erases; //< Erase count per sector
+
+    // Flash interface for EspClass
+    bool erase(uint32_t);
+    bool write(uint32_t, const uint8_t *, size_t);
+    bool read(uint32_t, uint8_t *, size_t);
+
+private:
+    std::vector<uint8_t> _data;
+};
+
+extern SimFlash sim_flash;
+
+#endif // SIM_FLASH_H__
@@ -0,0 +1,340 @@
+/** Native Simulation - Sensor Devices */
+
+#include <string.h>
+
+#include "sim_sensors.h"
+
+SimBME280 sim_bme280;
+SimSGP30 sim_sgp30;
+SimPMS5003 sim_pms5003;
+
+// Bounded random walk around a base value
+static int32_t walk(int32_t value, int32_t base, int32_t step, int32_t range) {
+    value += (int32_t)(sim_rand() % (2 * step + 1)) - step;
+    if (value < base - range) value = base - range;
+    if (value > base + range) value = base + range;
+    return value;
+}
+
+// Sensirion CRC-8 (polynomial 0x31, init 0xFF)
+static uint8_t sgp_crc(const uint8_t * data, size_t len) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* --- BME280 ------------------------------------------------------------- */
+
+#define BME_BASE_T  519888
+#define BME_BASE_P  415148
+#define BME_BASE_H  27000
+
+// Datasheet Calibration Constants (little endian register image)
+static const uint8_t bme_calib_tp[] = {
+    0x70, 0x6B,     // dig_T1 = 27504
+    0x43, 0x67,     // dig_T2 = 26435
+    0x18, 0xFC,     // dig_T3 = -1000
+    0x7D, 0x8E,     // dig_P1 = 36477
+    0x43, 0xD6,     // dig_P2 = -10685
+    0xD0, 0x0B,     // dig_P3 = 3024
+    0x27, 0x0B,     // dig_P4 = 2855
+    0x8C, 0x00,     // dig_P5 = 140
+    0xF9, 0xFF,     // dig_P6 = -7
+    0x8C, 0x3C,     // dig_P7 = 15500
+    0xF8, 0xC6,     // dig_P8 = -14600
+    0x70, 0x17,     // dig_P9 = 6000
+};
+
+static const uint8_t bme_calib_h[] = {
+    0x6A, 0x01,     // dig_H2 = 362
+    0x00,           // dig_H3 = 0
+    0x13, 0x29,     // dig_H4 = 313 (0x13 << 4 | 0x9)
+    0x03,           // dig_H5 = 50 (0x03 << 4 | 0x2)
+    0x1E,           // dig_H6 = 30
+};
+
+// Oversampling setting to sample count
+static const uint8_t bme_osrs[] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+
+SimBME280::SimBME280() : SimI2CDevice(0x77) {
+    reset();
+}
+
+void SimBME280::reset() {
+    memset(regs, 0, sizeof(regs));
+    memcpy(&regs[0x88], bme_calib_tp, sizeof(bme_calib_tp));
+    regs[0xA1] = 75;
+    memcpy(&regs[0xE1], bme_calib_h, sizeof(bme_calib_h));
+    regs[0xD0] = 0x60;
+    regs[0xF7] = regs[0xFA] = regs[0xFD] = 0x80;
+
+    adc_T = BME_BASE_T;
+    adc_P = BME_BASE_P;
+    adc_H = BME_BASE_H;
+    conv_us = 1250;
+    measurements = 0;
+    ptr = 0;
+    ready_us = 0;
+}
+
+bool SimBME280::busy() const {
+    return sim_clock_us < ready_us;
+}
+
+void SimBME280::measure() {
+    adc_T = walk(adc_T, BME_BASE_T, 40, 8000);
+    adc_P = walk(adc_P, BME_BASE_P, 20, 4000);
+    adc_H = walk(adc_H, BME_BASE_H, 30, 6000);
+    measurements++;
+
+    uint32_t p = (uint32_t)adc_P << 4;
+    uint32_t t = (uint32_t)adc_T << 4;
+    regs[0xF7] = p >> 16; regs[0xF8] = p >> 8; regs[0xF9] = p & 0xF0;
+    regs[0xFA] = t >> 16; regs[0xFB] = t >> 8; regs[0xFC] = t & 0xF0;
+    regs[0xFD] = adc_H >> 8; regs[0xFE] = adc_H & 0xFF;
+}
+
+bool SimBME280::onWrite(const uint8_t * data, size_t len) {
+    if (!len) return true;
+
+    latch();
+
+    ptr = data[0];
+    for (size_t i = 1; i < len; i++, ptr++) {
+        if (ptr == 0xE0 && data[i] == 0xB6) {
+            regs[0xF2] = regs[0xF4] = regs[0xF5] = 0;
+            continue;
+        }
+        regs[ptr] = data[i];
+
+        if (ptr == 0xF4 && (data[i] & 0x03)) {
+            // Start conversion (forced or normal mode)
+            conv_us = 1250
+                + 2300 * bme_osrs[(regs[0xF4] >> 5) & 7]
+                + 2300 * bme_osrs[(regs[0xF4] >> 2) & 7] + 575
+                + 2300 * bme_osrs[regs[0xF2] & 7] + 575;
+            ready_us = sim_clock_us + conv_us;
+        }
+    }
+
+    return true;
+}
+
+// Latch a completed conversion into the data registers
+void SimBME280::latch() {
+    uint8_t mode = regs[0xF4] & 0x03;
+    if (mode && ready_us && !busy()) {
+        measure();
+        if (mode == 1) {
+            regs[0xF4] &= ~0x03;
+            ready_us = 0;
+        } else {
+            ready_us = sim_clock_us + conv_us;
+        }
+    }
+}
+
+bool SimBME280::onRead(uint8_t * data, size_t len) {
+    latch();
+
+    uint8_t mode = regs[0xF4] & 0x03;
+    regs[0xF3] = (mode == 1 && busy()) ? 0x08 : 0x00;
+    for (size_t i = 0; i < len; i++) {
+        data[i] = regs[(uint8_t)(ptr + i)];
+    }
+
+    return true;
+}
+
+/* --- SGP30 -------------------------------------------------------------- */
+
+SimSGP30::SimSGP30() : SimI2CDevice(0x58) {
+    reset();
+}
+
+void SimSGP30::reset() {
+    tvoc = 0;
+    eco2 = 400;
+    bl_tvoc = 0x8F9E;
+    bl_eco2 = 0x9374;
+    humidity = 0;
+    serial[0] = 0x0000;
+    serial[1] = 0x01A2;
+    serial[2] = 0xB3C4;
+    measurements = 0;
+    humidity_writes = 0;
+    resp_len = 0;
+    ready_us = 0;
+}
+
+void SimSGP30::respond(const uint16_t * words, size_t count, uint32_t exec_us) {
+    resp_len = 0;
+    for (size_t i = 0; i < count; i++) {
+        resp[resp_len++] = words[i] >> 8;
+        resp[resp_len++] = words[i] & 0xFF;
+        resp[resp_len] = sgp_crc(&resp[resp_len - 2], 2);
+        resp_len++;
+    }
+
+    ready_us = sim_clock_us + exec_us;
+}
+
+bool SimSGP30::onWrite(const uint8_t * data, size_t len) {
+    if (len < 2) return false;
+
+    // Argument words carry a CRC
+    for (size_t i = 2; i + 3 <= len; i += 3) {
+        if (sgp_crc(&data[i], 2) != data[i + 2]) return false;
+    }
+
+    uint16_t cmd = (data[0] << 8) | data[1];
+    uint16_t words[3];
+
+    switch (cmd) {
+    case 0x3682:    // Get Serial ID
+        respond(serial, 3, 500);
+        break;
+
+    case 0x202F:    // Get Feature Set
+        words[0] = 0x0022;
+        respond(words, 1, 2000);
+        break;
+
+    case 0x2003:    // IAQ Init
+        respond(words, 0, 10000);
+        break;
+
+    case 0x2008:    // Measure IAQ
+        eco2 = (uint16_t)walk(eco2, 450, 6, 250);
+        tvoc = (uint16_t)walk(tvoc, 40, 4, 40);
+        measurements++;
+        words[0] = eco2;
+        words[1] = tvoc;
+        respond(words, 2, 12000);
+        break;
+
+    case 0x2050:    // Measure Raw
+        words[0] = 13600;
+        words[1] = 19300;
+        respond(words, 2, 25000);
+        break;
+
+    case 0x2015:    // Get IAQ Baseline
+        words[0] = bl_eco2;
+        words[1] = bl_tvoc;
+        respond(words, 2, 10000);
+        break;
+
+    case 0x201E:    // Set IAQ Baseline (TVOC, eCO2)
+        if (len < 8) return false;
+        bl_tvoc = (data[2] << 8) | data[3];
+        bl_eco2 = (data[5] << 8) | data[6];
+        respond(words, 0, 10000);
+        break;
+
+    case 0x2061:    // Set Absolute Humidity
+        if (len < 5) return false;
+        humidity = (data[2] << 8) | data[3];
+        humidity_writes++;
+        respond(words, 0, 10000);
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+bool SimSGP30::onRead(uint8_t * data, size_t len) {
+    // The SGP30 NACKs reads while a command is executing
+    if (sim_clock_us < ready_us || len > resp_len) {
+        return false;
+    }
+
+    memcpy(data, resp, len);
+    return true;
+}
+
+/* --- PMS5003 ------------------------------------------------------------ */
+
+static const uint16_t pms_base[6] = { 2100, 620, 130, 12, 5, 1 };
+
+SimPMS5003::SimPMS5003() : SimI2CDevice(0x12) {
+    reset();
+}
+
+void SimPMS5003::reset() {
+    pm_std[0] = pm_env[0] = 12;
+    pm_std[1] = pm_env[1] = 18;
+    pm_std[2] = pm_env[2] = 22;
+    memcpy(particles, pms_base, sizeof(particles));
+    fail_pct = 0;
+    spike_pct = 0;
+    frames = 0;
+}
+
+void SimPMS5003::update() {
+    for (int i = 0; i < 6; i++) {
+        particles[i] = (uint16_t)walk(particles[i], pms_base[i], 1 + pms_base[i] / 50, pms_base[i] / 2);
+    }
+
+    pm_std[0] = (uint16_t)walk(pm_std[0], 12, 1, 6);
+    pm_std[1] = (uint16_t)walk(pm_std[1], 18, 1, 8);
+    pm_std[2] = (uint16_t)walk(pm_std[2], 22, 1, 10);
+    if (pm_std[1] < pm_std[0]) pm_std[1] = pm_std[0];
+    if (pm_std[2] < pm_std[1]) pm_std[2] = pm_std[1];
+
+    for (int i = 0; i < 3; i++) {
+        pm_env[i] = pm_std[i];
+    }
+}
+
+bool SimPMS5003::onWrite(const uint8_t *, size_t) {
+    return true;
+}
+
+bool SimPMS5003::onRead(uint8_t * data, size_t len) {
+    uint16_t words[13];
+    uint8_t frame[32];
+
+    update();
+    frames++;
+
+    bool spike = spike_pct && (sim_rand() % 100) < spike_pct;
+    for (int i = 0; i < 3; i++) {
+        words[i] = spike ? pm_std[i] * 8 : pm_std[i];
+        words[3 + i] = spike ? pm_env[i] * 8 : pm_env[i];
+    }
+    for (int i = 0; i < 6; i++) {
+        words[6 + i] = particles[i];
+    }
+    words[12] = 0;
+
+    frame[0] = 0x42;
+    frame[1] = 0x4D;
+    frame[2] = 0;
+    frame[3] = 28;
+
+    uint16_t sum = 0x42 + 0x4D + 28;
+    for (int i = 0; i < 13; i++) {
+        frame[4 + 2 * i] = words[i] >> 8;
+        frame[5 + 2 * i] = words[i] & 0xFF;
+        sum += frame[4 + 2 * i] + frame[5 + 2 * i];
+    }
+    frame[30] = sum >> 8;
+    frame[31] = sum & 0xFF;
+
+    if (fail_pct && (sim_rand() % 100) < fail_pct) {
+        frame[4 + sim_rand() % 26] ^= 0x10;
+    }
+
+    memset(data, 0, len);
+    memcpy(data, frame, len < sizeof(frame) ? len : sizeof(frame));
+    return true;
+}
@@ -0,0 +1,104 @@
+/** Native Simulation - Sensor Devices */
+
+#ifndef SIM_SENSORS_H__
+#define SIM_SENSORS_H__
+
+#include "sim.h"
+
+/**
+ * Simulated BME280
+ *
+ * Register-level model of the Bosch BME280 with the datasheet calibration
+ * constants. Raw ADC values follow a slow random walk; a measurement takes
+ * conv_us in forced mode, during which the status register reports busy.
+ */
+class SimBME280 : public SimI2CDevice {
+public:
+    SimBME280();
+
+    bool onWrite(const uint8_t *, size_t);
+    bool onRead(uint8_t *, size_t);
+    void reset();
+
+    int32_t adc_T;              //< Raw temperature (20 bits)
+    int32_t adc_P;              //< Raw pressure (20 bits)
+    int32_t adc_H;              //< Raw humidity (16 bits)
+    uint32_t conv_us;           //< Conversion time
+
+    uint32_t measurements;      //< Number of conversions performed
+
+private:
+    void measure();
+    void latch();
+    bool busy() const;
+
+    uint8_t regs[256];
+    uint8_t ptr;
+    uint64_t ready_us;
+};
+
+/**
+ * Simulated SGP30
+ *
+ * Command-level model of the Sensirion SGP30 including CRC-8 word checks and
+ * per-command execution times. Reading before a command completes is NACKed
+ * just like the real part.
+ */
+class SimSGP30 : public SimI2CDevice {
+public:
+    SimSGP30();
+
+    bool onWrite(const uint8_t *, size_t);
+    bool onRead(uint8_t *, size_t);
+    void reset();
+
+    uint16_t tvoc;              //< Current TVOC (ppb)
+    uint16_t eco2;              //< Current eCO2 (ppm)
+    uint16_t bl_tvoc;           //< Current TVOC baseline
+    uint16_t bl_eco2;           //< Current eCO2 baseline
+    uint16_t humidity;          //< Last absolute humidity (8.8 g/m³)
+    uint16_t serial[3];         //< Serial number words
+
+    uint32_t measurements;      //< Number of IAQ measurements
+    uint32_t humidity_writes;   //< Number of Set Humidity commands
+
+private:
+    void respond(const uint16_t *, size_t, uint32_t);
+
+    uint8_t resp[12];
+    size_t resp_len;
+    uint64_t ready_us;
+};
+
+/**
+ * Simulated PMS5003 (I2C)
+ *
+ * Serves 32-byte PMS5003 frames. Particle counts follow a random walk with
+ * occasional short spikes; fail_pct corrupts that percentage of frames to
+ * model a flaky I2C/UART bridge.
+ */
+class SimPMS5003 : public SimI2CDevice {
+public:
+    SimPMS5003();
+
+    bool onWrite(const uint8_t *, size_t);
+    bool onRead(uint8_t *, size_t);
+    void reset();
+
+    uint16_t pm_std[3];         //< PM1.0/2.5/10 standard (µg/m³)
+    uint16_t pm_env[3];         //< PM1.0/2.5/10 environmental (µg/m³)
+    uint16_t particles[6];      //< Counts for 0.3/0.5/1.0/2.5/5.0/10 µm
+    uint8_t fail_pct;           //< Percentage of corrupted frames
+    uint8_t spike_pct;          //< Percentage of frames with a PM spike
+
+    uint32_t frames;            //< Number of frames read
+
+private:
+    void update();
+};
+
+extern SimBME280 sim_bme280;
+extern SimSGP30 sim_sgp30;
+extern SimPMS5003 sim_pms5003;
+
+#endif // SIM_SENSORS_H__
@@ -0,0 +1,21 @@
+/** Native Simulation - Per-Device Firmware Sessions */
+
+#include "sim_session.h"
+
+// The firmware's own state, from before the first switch
+static MqttSession * boot_mqtt;
+static DiscoveryState * boot_discovery;
+
+void sim_session_select(SimSession * session) {
+    if (!boot_mqtt) {
+        boot_mqtt = mqtt_session;
+        boot_discovery = discovery_state;
+    }
+
+    mqtt_session = session ? &session->mqtt : boot_mqtt;
+    discovery_state = session ? &session->discovery : boot_discovery;
+}
+
+void sim_session_close(SimSession * session) {
+    session->mqtt.client.stop();
+}
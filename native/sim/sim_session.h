@@ -0,0 +1,35 @@
+/** Native Simulation - Per-Device Firmware Sessions */
+
+#ifndef SIM_SESSION_H__
+#define SIM_SESSION_H__
+
+#include "discovery.h"
+#include "mqtt.h"
+
+//! Network State of one Simulated Device
+typedef struct {
+    MqttSession mqtt;           //< Connection, client and topics
+    DiscoveryState discovery;   //< Pending discovery and its delay
+} SimSession;
+
+/**
+ * Select the Session the Firmware Acts On
+ * @param [in] session device session, or NULL for the firmware's own
+ *
+ * Points the MQTT and discovery routines at the session's state, so a host
+ * program can drive many simulated devices through the firmware's own code,
+ * subscription callbacks included. Nothing is copied. A new session is set
+ * up by selecting it and calling setup_mqtt().
+ */
+void sim_session_select(SimSession *);
+
+/**
+ * Close a Session's Sockets
+ * @param [in] session device session
+ *
+ * Call before sim_reset() to reuse a session, while the broker still knows
+ * its connections.
+ */
+void sim_session_close(SimSession *);
+
+#endif // SIM_SESSION_H__
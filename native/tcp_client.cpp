@@ -0,0 +1,51 @@
+/** Native Non-Blocking TCP Client Stand-In */
+
+#include "sim/sim_broker.h"
+#include "tcp_client.h"
+
+// Connection Steps
+#define STEP_IDLE           0
+#define STEP_OPENING        2
+
+// Names need no lookup on the host
+bool TcpClient::open(const IPAddress &) {
+    _state = STEP_OPENING;
+    return true;
+}
+
+bool TcpClient::connectStart(const char *, uint16_t port) {
+    stop();
+    _wrote = false;
+    _state = STEP_IDLE;
+    _port = port;
+    _since = millis();
+
+    if (WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+
+    return open(IPAddress());
+}
+
+int8_t TcpClient::connectPoll() {
+    if (_state != STEP_OPENING) {
+        return connected() ? 1 : -1;
+    }
+
+    // The SYN is answered after a round trip; an offline broker leaves it
+    // unanswered until the stack gives up
+    uint32_t ms = millis() - _since;
+    if (WiFi.status() != WL_CONNECTED) {
+        _state = STEP_IDLE;
+        return -1;
+    }
+    if ((uint64_t)ms * 1000 < sim_broker.rtt_us
+        || (!sim_broker.online && ms < sim_broker.timeout_ms))
+    {
+        return TCP_CONNECT_PENDING;
+    }
+
+    _state = STEP_IDLE;
+    _session = sim_broker.attach();
+    return _session >= 0 ? 1 : -1;
+}
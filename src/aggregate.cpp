@@ -0,0 +1,161 @@
+/** Sample Window Aggregation */
+
+#include <string.h>
+
+#include "aggregate.h"
+
+// Split a sample into channel values
+static void agg_unpack(const SensorData * data, int32_t * v) {
+#define AGG_UNPACK(ch, member, ...) v[AGG_##ch] = data->member;
+    SENSOR_CHANNELS(AGG_UNPACK)
+#undef AGG_UNPACK
+}
+
+// Build a sample from channel values
+static void agg_pack(const int32_t * v, SensorData * data) {
+#define AGG_PACK(ch, member, ...) data->member = v[AGG_##ch];
+    SENSOR_CHANNELS(AGG_PACK)
+#undef AGG_PACK
+}
+
+// Invalid reading of each channel (INT32_MIN, which no reading takes, if the
+// sensor always reports a value)
+static const int32_t agg_invalid[AGG_CHANNELS] = {
+#define AGG_INVALID(ch, member, type, invalid, ...) invalid,
+    SENSOR_CHANNELS(AGG_INVALID)
+#undef AGG_INVALID
+};
+
+// Divide with rounding to nearest
+static int64_t div_round(int64_t num, int64_t den) {
+    return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+// Integer square root
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)res;
+}
+
+// Index of the first element not less than value
+static uint8_t lower_bound(const int32_t * a, uint8_t n, int32_t value) {
+    uint8_t lo = 0, hi = n;
+    while (lo < hi) {
+        uint8_t mid = (lo + hi) / 2;
+        if (a[mid] < value) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+void agg_reset(SampleWindow * window) {
+    memset(window, 0, sizeof(SampleWindow));
+}
+
+void agg_push(SampleWindow * window, const SensorData * data) {
+    int32_t v[AGG_CHANNELS];
+    bool evict = window->count == AGGREGATE_WINDOW;
+
+    agg_unpack(data, v);
+
+    int32_t * slot = window->ring[window->head];
+    for (uint8_t c = 0; c < AGG_CHANNELS; c++) {
+        int32_t * sorted = window->sorted[c];
+        int32_t invalid = agg_invalid[c];
+        uint8_t n = window->valid[c];
+
+        if (evict && slot[c] != invalid) {
+            int64_t o = (int64_t)slot[c] - window->ref[c];
+            window->sum[c] -= o;
+            window->sumsq[c] -= o * o;
+
+            uint8_t i = lower_bound(sorted, n, slot[c]);
+            memmove(&sorted[i], &sorted[i + 1], (n - i - 1) * sizeof(int32_t));
+            n--;
+        }
+
+        if (v[c] != invalid) {
+            // The first valid sample sets the reference that keeps the sums
+            // small (the sums are zero whenever the channel is empty)
+            if (!n) {
+                window->ref[c] = v[c];
+            }
+
+            int64_t d = (int64_t)v[c] - window->ref[c];
+            window->sum[c] += d;
+            window->sumsq[c] += d * d;
+
+            uint8_t i = lower_bound(sorted, n, v[c]);
+            memmove(&sorted[i + 1], &sorted[i], (n - i) * sizeof(int32_t));
+            sorted[i] = v[c];
+            n++;
+        }
+
+        window->valid[c] = n;
+        slot[c] = v[c];
+    }
+
+    window->head = (window->head + 1) % AGGREGATE_WINDOW;
+    if (!evict) {
+        window->count++;
+    }
+}
+
+int agg_stats(const SampleWindow * window, uint8_t channel, AggStats * stats) {
+    if (channel >= AGG_CHANNELS) return 1;
+
+    uint8_t n = window->valid[channel];
+    if (!n) {
+        int32_t invalid = agg_invalid[channel];
+        stats->mean = stats->median = stats->min = stats->max = invalid;
+        stats->stddev = 0;
+        return 1;
+    }
+
+    const int32_t * sorted = window->sorted[channel];
+    int64_t sum = window->sum[channel];
+
+    stats->mean = window->ref[channel] + (int32_t)div_round(sum, n);
+    stats->min = sorted[0];
+    stats->max = sorted[n - 1];
+    stats->median = (n & 1) ? sorted[n / 2]
+        : (int32_t)div_round((int64_t)sorted[n / 2 - 1] + sorted[n / 2], 2);
+
+    // Population variance from the shifted sums
+    int64_t var = (int64_t)n * window->sumsq[channel] - sum * sum;
+    stats->stddev = var > 0 ? (isqrt64((uint64_t)var) + n / 2) / n : 0;
+
+    return 0;
+}
+
+int agg_result(const SampleWindow * window, uint8_t statistic, SensorData * data) {
+    int32_t v[AGG_CHANNELS];
+    AggStats stats;
+
+    if (!window->count) return 1;
+
+    for (uint8_t c = 0; c < AGG_CHANNELS; c++) {
+        agg_stats(window, c, &stats);
+        switch (statistic) {
+        case AGG_MEDIAN: v[c] = stats.median; break;
+        case AGG_MIN: v[c] = stats.min; break;
+        case AGG_MAX: v[c] = stats.max; break;
+        default: v[c] = stats.mean; break;
+        }
+    }
+
+    agg_pack(v, data);
+    return 0;
+}
@@ -0,0 +1,198 @@
+/** EPA NowCast and Air Quality Index */
+
+#include <string.h>
+
+#include "aqi.h"
+
+// The NowCast is built from the PMS5003 channels
+#ifndef NO_PMS5003
+
+static_assert(NOWCAST_HOURS <= 32, "NowCast weights underflow past 32 hours");
+
+// AQI Breakpoint (concentrations in 0.1 µg/m³)
+typedef struct {
+    uint16_t c_lo, c_hi;
+    uint16_t i_lo, i_hi;
+} Breakpoint;
+
+// PM2.5 (24-hour, 2024 revision)
+static const Breakpoint pm25_breakpoints[] = {
+    { 0, 90, 0, 50 },
+    { 91, 354, 51, 100 },
+    { 355, 554, 101, 150 },
+    { 555, 1254, 151, 200 },
+    { 1255, 2254, 201, 300 },
+    { 2255, 3254, 301, 500 },
+};
+
+// PM10 (24-hour)
+static const Breakpoint pm100_breakpoints[] = {
+    { 0, 540, 0, 50 },
+    { 550, 1540, 51, 100 },
+    { 1550, 2540, 101, 150 },
+    { 2550, 3540, 151, 200 },
+    { 3550, 4240, 201, 300 },
+    { 4250, 6040, 301, 500 },
+};
+
+#define BREAKPOINTS (sizeof(pm25_breakpoints) / sizeof(pm25_breakpoints[0]))
+
+static const char * const category_names[] = {
+    "good",
+    "moderate",
+    "unhealthy_sensitive",
+    "unhealthy",
+    "very_unhealthy",
+    "hazardous",
+};
+
+// NowCast Engine
+static NowCastState state;
+
+// NowCast and AQI Status
+static AqiStatus astatus;
+
+// Global NowCast and AQI Status
+const AqiStatus * aqi_status = &astatus;
+
+void aqi_reset() {
+    memset(&state, 0, sizeof(NowCastState));
+    memset(state.avg, 0xFF, sizeof(state.avg));
+
+    memset(&astatus, 0, sizeof(AqiStatus));
+    astatus.category_name = category_names[0];
+    astatus.pollutant = "pm25";
+}
+
+uint16_t nowcast(const uint16_t * avg, uint8_t hours) {
+    uint16_t lo = UINT16_MAX, hi = 0;
+    uint8_t recent = 0;
+
+    for (uint8_t i = 0; i < hours; i++) {
+        if (avg[i] == NOWCAST_INVALID) continue;
+        if (i < 3) recent++;
+        if (avg[i] < lo) lo = avg[i];
+        if (avg[i] > hi) hi = avg[i];
+    }
+    if (recent < 2) {
+        return NOWCAST_INVALID;
+    }
+
+    // Weight factor min/max, at least 0.5 (Q15)
+    uint32_t w = hi ? ((uint32_t)lo << 15) / hi : 1UL << 15;
+    if (w < (1UL << 14)) {
+        w = 1UL << 14;
+    }
+
+    // Sum of w^i c_i over sum of w^i, across the hours present
+    uint64_t num = 0, den = 0;
+    uint32_t wi = 1UL << 30;
+    for (uint8_t i = 0; i < hours; i++) {
+        if (avg[i] != NOWCAST_INVALID) {
+            num += (uint64_t)avg[i] * wi;
+            den += wi;
+        }
+        wi = (uint32_t)(((uint64_t)wi * w) >> 15);
+    }
+
+    // Truncated to 0.1 µg/m³ as EPA reports it
+    return (uint16_t)(num / den);
+}
+
+uint16_t aqi_index(uint8_t channel, uint16_t c) {
+    const Breakpoint * bp = channel == NOWCAST_PM25 ? pm25_breakpoints : pm100_breakpoints;
+
+    for (size_t i = 0; i < BREAKPOINTS; i++) {
+        if (c <= bp[i].c_hi) {
+            // Linear within the band, rounded to the nearest integer
+            uint32_t span = bp[i].c_hi - bp[i].c_lo;
+            uint32_t num = 2 * (uint32_t)(bp[i].i_hi - bp[i].i_lo) * (c - bp[i].c_lo) + span;
+            return bp[i].i_lo + num / (2 * span);
+        }
+    }
+
+    return 500;
+}
+
+uint8_t aqi_category(uint16_t aqi) {
+    if (aqi <= 50) return AQI_GOOD;
+    if (aqi <= 100) return AQI_MODERATE;
+    if (aqi <= 150) return AQI_SENSITIVE;
+    if (aqi <= 200) return AQI_UNHEALTHY;
+    if (aqi <= 300) return AQI_VERY_UNHEALTHY;
+    return AQI_HAZARDOUS;
+}
+
+// Close the open hour and move the ring on to the given hour
+static void close_hour(uint32_t hour) {
+    uint32_t gap = hour - state.hour;
+
+    for (uint32_t h = 0; h < gap && h < NOWCAST_HOURS; h++) {
+        state.newest = (state.newest + 1) % NOWCAST_HOURS;
+        for (uint8_t c = 0; c < NOWCAST_CHANNELS; c++) {
+            // Average to 0.1 µg/m³, rounded; only the first hour has samples
+            uint16_t avg = NOWCAST_INVALID;
+            if (!h && state.count) {
+                avg = (uint16_t)((state.sum[c] * 10 + state.count / 2) / state.count);
+            }
+            state.avg[c][state.newest] = avg;
+        }
+    }
+
+    state.hour = hour;
+    state.count = 0;
+    memset(state.sum, 0, sizeof(state.sum));
+}
+
+// Recompute the NowCast and AQI from the closed hours
+static void update_status() {
+    uint16_t avg[NOWCAST_HOURS];
+    uint16_t nc[NOWCAST_CHANNELS];
+
+    for (uint8_t c = 0; c < NOWCAST_CHANNELS; c++) {
+        for (uint8_t i = 0; i < NOWCAST_HOURS; i++) {
+            avg[i] = state.avg[c][(state.newest + NOWCAST_HOURS - i) % NOWCAST_HOURS];
+        }
+        nc[c] = nowcast(avg, NOWCAST_HOURS);
+    }
+
+    astatus.hour = state.hour - 1;
+    astatus.valid = nc[NOWCAST_PM25] != NOWCAST_INVALID && nc[NOWCAST_PM100] != NOWCAST_INVALID;
+    if (!astatus.valid) {
+        return;
+    }
+
+    // PM10 is reported in whole µg/m³
+    astatus.pm25 = nc[NOWCAST_PM25];
+    astatus.pm100 = nc[NOWCAST_PM100] / 10 * 10;
+
+    uint16_t i25 = aqi_index(NOWCAST_PM25, astatus.pm25);
+    uint16_t i100 = aqi_index(NOWCAST_PM100, astatus.pm100);
+    astatus.aqi = i25 >= i100 ? i25 : i100;
+    astatus.pollutant = i25 >= i100 ? "pm25" : "pm100";
+    astatus.category = aqi_category(astatus.aqi);
+    astatus.category_name = category_names[astatus.category];
+}
+
+bool aqi_update(const SensorData * data, uint32_t hour) {
+    bool closed = false;
+
+    // Start over on the first sample, a step back, or a gap of the whole window
+    if (!state.started || hour < state.hour || hour - state.hour > NOWCAST_HOURS) {
+        aqi_reset();
+        state.started = 1;
+        state.hour = hour;
+    } else if (hour != state.hour) {
+        close_hour(hour);
+        update_status();
+        closed = true;
+    }
+
+    state.sum[NOWCAST_PM25] += data->pm25;
+    state.sum[NOWCAST_PM100] += data->pm100;
+    state.count++;
+
+    return closed;
+}
+
+#endif // NO_PMS5003
@@ -0,0 +1,233 @@
+/** Batched Columnar Sample Encoding */
+
+#include <string.h>
+
+#include "batch.h"
+#include "payload.h"
+
+// Batch Header Size before the Varint Fields (version, count, channels)
+#define BATCH_HEADER    3
+
+// Zig-zag map a signed value so small magnitudes encode short
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static size_t varint_length(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static uint8_t * put_varint(uint8_t * p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// Read a varint, returning NULL if it runs past the end or overflows
+static const uint8_t * get_varint(const uint8_t * p, const uint8_t * end, uint64_t * v) {
+    *v = 0;
+    for (uint8_t shift = 0; shift < 64; shift += 7) {
+        if (p >= end) {
+            return NULL;
+        }
+
+        uint8_t b = *p++;
+        *v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+// Load a channel value (sentinels included) as a signed integer
+static int64_t channel_get(const PayloadField * f, const SensorData * data) {
+    const uint8_t * p = (const uint8_t *)data + f->offset;
+
+    switch (f->type) {
+    case FIELD_INT16: {
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    case FIELD_UINT16: {
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    default: {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    }
+}
+
+// Store a channel value, returning false if it is out of range for the field
+static bool channel_set(const PayloadField * f, SensorData * data, int64_t value) {
+    uint8_t * p = (uint8_t *)data + f->offset;
+
+    switch (f->type) {
+    case FIELD_INT16: {
+        if (value < INT16_MIN || value > INT16_MAX) return false;
+        int16_t v = (int16_t)value;
+        memcpy(p, &v, sizeof(v));
+        return true;
+    }
+    case FIELD_UINT16: {
+        if (value < 0 || value > UINT16_MAX) return false;
+        uint16_t v = (uint16_t)value;
+        memcpy(p, &v, sizeof(v));
+        return true;
+    }
+    default: {
+        if (value < 0 || value > UINT32_MAX) return false;
+        uint32_t v = (uint32_t)value;
+        memcpy(p, &v, sizeof(v));
+        return true;
+    }
+    }
+}
+
+// Reset a Batch
+void batch_reset(SampleBatch * batch) {
+    memset(batch, 0, sizeof(*batch));
+}
+
+// Add a Sample to a Batch
+void batch_push(SampleBatch * batch, const SensorData * data, uint32_t ms) {
+    if (batch->count == BATCH_MAX) {
+        batch_drop(batch, 1);
+        batch->dropped++;
+    }
+
+    batch->samples[batch->count] = *data;
+    batch->ms[batch->count] = ms;
+    batch->count++;
+}
+
+// Remove Samples from the Front of a Batch
+void batch_drop(SampleBatch * batch, uint8_t count) {
+    if (count >= batch->count) {
+        batch->count = 0;
+        return;
+    }
+
+    batch->count -= count;
+    memmove(batch->samples, batch->samples + count, batch->count * sizeof(SensorData));
+    memmove(batch->ms, batch->ms + count, batch->count * sizeof(uint32_t));
+}
+
+// Encode the Start of a Batch
+size_t batch_encode(uint8_t * out, size_t len, const SampleBatch * batch,
+    uint64_t base_ms, uint32_t interval_ms, uint8_t * encoded)
+{
+    size_t used = BATCH_HEADER + varint_length(base_ms) + varint_length(interval_ms);
+    uint8_t n = 0;
+
+    // Each sample adds one varint per column; find how many fit
+    while (n < batch->count) {
+        size_t row = 0;
+        if (n) {
+            row += varint_length(zigzag((int64_t)(batch->ms[n] - batch->ms[n - 1]) - interval_ms));
+        }
+        for (size_t c = 0; c < data_field_count; c++) {
+            int64_t prev = n ? channel_get(&data_fields[c], &batch->samples[n - 1]) : 0;
+            row += varint_length(zigzag(channel_get(&data_fields[c], &batch->samples[n]) - prev));
+        }
+
+        if (used + row > len) {
+            break;
+        }
+        used += row;
+        n++;
+    }
+
+    *encoded = n;
+    if (!n) {
+        return 0;
+    }
+
+    uint8_t * p = out;
+    *p++ = BATCH_VERSION;
+    *p++ = n;
+    *p++ = (uint8_t)data_field_count;
+    p = put_varint(p, base_ms);
+    p = put_varint(p, interval_ms);
+
+    for (uint8_t i = 1; i < n; i++) {
+        p = put_varint(p, zigzag((int64_t)(batch->ms[i] - batch->ms[i - 1]) - interval_ms));
+    }
+
+    for (size_t c = 0; c < data_field_count; c++) {
+        int64_t prev = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            int64_t v = channel_get(&data_fields[c], &batch->samples[i]);
+            p = put_varint(p, zigzag(v - prev));
+            prev = v;
+        }
+    }
+
+    return p - out;
+}
+
+// Decode a Batch
+int batch_decode(const uint8_t * in, size_t len, SensorData * samples, uint64_t * times, uint8_t max) {
+    const uint8_t * end = in + len;
+    const uint8_t * p = in;
+    uint64_t base_ms, interval_ms, v;
+
+    if (len < BATCH_HEADER || p[0] != BATCH_VERSION || p[2] != data_field_count) {
+        return -1;
+    }
+
+    uint8_t n = p[1];
+    if (n > max) {
+        return -1;
+    }
+    p += BATCH_HEADER;
+
+    if (!(p = get_varint(p, end, &base_ms)) || !(p = get_varint(p, end, &interval_ms))) {
+        return -1;
+    }
+
+    memset(samples, 0, n * sizeof(SensorData));
+    for (uint8_t i = 0; i < n; i++) {
+        if (i == 0) {
+            times[i] = base_ms;
+            continue;
+        }
+        if (!(p = get_varint(p, end, &v))) {
+            return -1;
+        }
+        times[i] = times[i - 1] + interval_ms + unzigzag(v);
+    }
+
+    for (size_t c = 0; c < data_field_count; c++) {
+        int64_t prev = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            if (!(p = get_varint(p, end, &v))) {
+                return -1;
+            }
+            prev += unzigzag(v);
+            if (!channel_set(&data_fields[c], &samples[i], prev)) {
+                return -1;
+            }
+        }
+    }
+
+    return p == end ? n : -1;
+}
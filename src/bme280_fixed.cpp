@@ -0,0 +1,137 @@
+/** Fixed-Point BME280 Driver */
+
+#include "bme280_fixed.h"
+#include "sensor.h"
+
+// Burst read of the data registers (0xF7 - 0xFE)
+#define BME280_DATA_LEN 8
+
+bool BME280_Fixed::startForced() {
+    uint8_t cmd[2] = { BME280_REGISTER_CONTROL, (uint8_t)_measReg.get() };
+
+    if (_measReg.mode != MODE_FORCED) {
+        return false;
+    }
+
+    return i2c_dev->write(cmd, sizeof(cmd));
+}
+
+bool BME280_Fixed::measuring(bool * busy) {
+    uint8_t reg = BME280_REGISTER_STATUS;
+    uint8_t status;
+
+    if (!i2c_dev->write_then_read(&reg, 1, &status, 1)) {
+        return false;
+    }
+
+    *busy = status & 0x08;
+    return true;
+}
+
+// Oversampling setting to sample count (0 means skipped)
+static uint32_t osrs_count(unsigned int osrs) {
+    return osrs ? 1 << (osrs > 5 ? 4 : osrs - 1) : 0;
+}
+
+uint32_t BME280_Fixed::conversionTime() {
+    uint32_t t = 1250 + 2300 * osrs_count(_measReg.osrs_t);
+
+    if (_measReg.osrs_p) t += 2300 * osrs_count(_measReg.osrs_p) + 575;
+    if (_humReg.osrs_h) t += 2300 * osrs_count(_humReg.osrs_h) + 575;
+
+    return t;
+}
+
+bool BME280_Fixed::readFixed(int16_t * t, uint32_t * p, uint32_t * h) {
+    uint8_t reg = BME280_REGISTER_PRESSUREDATA;
+    uint8_t buf[BME280_DATA_LEN];
+
+    *t = SENSOR_T_INVALID;
+    *p = SENSOR_P_INVALID;
+    *h = SENSOR_RH_INVALID;
+
+    if (!i2c_dev->write_then_read(&reg, 1, buf, sizeof(buf))) {
+        return false;
+    }
+
+    int32_t adc_P = ((uint32_t)buf[0] << 16) | ((uint32_t)buf[1] << 8) | buf[2];
+    int32_t adc_T = ((uint32_t)buf[3] << 16) | ((uint32_t)buf[4] << 8) | buf[5];
+    int32_t adc_H = ((uint32_t)buf[6] << 8) | buf[7];
+
+    // Temperature must be compensated first to set t_fine
+    if (adc_T == 0x800000) {
+        return false;
+    }
+    *t = compensateT(adc_T >> 4);
+
+    if (adc_P != 0x800000) {
+        *p = compensateP(adc_P >> 4);
+    }
+    if (adc_H != 0x8000) {
+        *h = compensateH(adc_H);
+    }
+
+    return *p != SENSOR_P_INVALID && *h != SENSOR_RH_INVALID;
+}
+
+// Temperature compensation (BME280 datasheet 4.2.3)
+int32_t BME280_Fixed::compensateT(int32_t adc_T) {
+    int32_t var1, var2;
+
+    var1 = (int32_t)((adc_T / 8) - ((int32_t)_bme280_calib.dig_T1 * 2));
+    var1 = (var1 * ((int32_t)_bme280_calib.dig_T2)) / 2048;
+    var2 = (int32_t)((adc_T / 16) - ((int32_t)_bme280_calib.dig_T1));
+    var2 = (((var2 * var2) / 4096) * ((int32_t)_bme280_calib.dig_T3)) / 16384;
+
+    t_fine = var1 + var2 + t_fine_adjust;
+
+    return (t_fine * 5 + 128) / 256;
+}
+
+// Pressure compensation (64-bit variant)
+uint32_t BME280_Fixed::compensateP(int32_t adc_P) {
+    int64_t var1, var2, var3, var4;
+
+    var1 = ((int64_t)t_fine) - 128000;
+    var2 = var1 * var1 * (int64_t)_bme280_calib.dig_P6;
+    var2 = var2 + ((var1 * (int64_t)_bme280_calib.dig_P5) * 131072);
+    var2 = var2 + (((int64_t)_bme280_calib.dig_P4) * 34359738368);
+    var1 = ((var1 * var1 * (int64_t)_bme280_calib.dig_P3) / 256) +
+        ((var1 * ((int64_t)_bme280_calib.dig_P2) * 4096));
+    var3 = ((int64_t)1) * 140737488355328;
+    var1 = (var3 + var1) * ((int64_t)_bme280_calib.dig_P1) / 8589934592;
+
+    if (var1 == 0) {
+        return 0; // avoid exception caused by division by zero
+    }
+
+    var4 = 1048576 - adc_P;
+    var4 = (((var4 * 2147483648) - var2) * 3125) / var1;
+    var1 = (((int64_t)_bme280_calib.dig_P9) * (var4 / 8192) * (var4 / 8192)) / 33554432;
+    var2 = (((int64_t)_bme280_calib.dig_P8) * var4) / 524288;
+    var4 = ((var4 + var1 + var2) / 256) + (((int64_t)_bme280_calib.dig_P7) * 16);
+
+    return (uint32_t)var4;
+}
+
+// Humidity compensation (requires t_fine)
+uint32_t BME280_Fixed::compensateH(int32_t adc_H) {
+    int32_t var1, var2, var3, var4, var5;
+
+    var1 = t_fine - ((int32_t)76800);
+    var2 = (int32_t)(adc_H * 16384);
+    var3 = (int32_t)(((int32_t)_bme280_calib.dig_H4) * 1048576);
+    var4 = ((int32_t)_bme280_calib.dig_H5) * var1;
+    var5 = (((var2 - var3) - var4) + (int32_t)16384) / 32768;
+    var2 = (var1 * ((int32_t)_bme280_calib.dig_H6)) / 1024;
+    var3 = (var1 * ((int32_t)_bme280_calib.dig_H3)) / 2048;
+    var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
+    var2 = ((var4 * ((int32_t)_bme280_calib.dig_H2)) + 8192) / 16384;
+    var3 = var5 * var2;
+    var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+    var5 = var3 - ((var4 * ((int32_t)_bme280_calib.dig_H1)) / 16);
+    var5 = (var5 < 0 ? 0 : var5);
+    var5 = (var5 > 419430400 ? 419430400 : var5);
+
+    return (uint32_t)(var5 / 4096);
+}
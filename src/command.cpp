@@ -0,0 +1,164 @@
+/** Command Protocol */
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "command.h"
+#include "error.h"
+#include "sensor.h"
+#include "settings.h"
+
+// Command Handler: appends its results to the reply and returns an error code
+typedef int (*command_fn)(uint8_t argc, char ** argv, char * reply, size_t len);
+
+// Command Table Entry
+typedef struct {
+    const char * name;
+    uint8_t min_args;           //< Words after the name
+    uint8_t max_args;
+    command_fn fn;
+} Command;
+
+// Append to a reply, truncating at the buffer end
+static void append(char * reply, size_t len, const char * fmt, ...) {
+    size_t n = strlen(reply);
+    if (n + 1 >= len) {
+        return;
+    }
+
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(reply + n, len - n, fmt, ap);
+    va_end(ap);
+}
+
+static void append_setting(char * reply, size_t len, uint8_t id) {
+    append(reply, len, ",\"%s\":%u", setting_fields[id].name, settings_get(id));
+}
+
+// Parse a whole decimal number
+static bool parse_uint(const char * s, uint32_t * value) {
+    char * end;
+    if (*s < '0' || *s > '9') {
+        return false;
+    }
+
+    unsigned long v = strtoul(s, &end, 10);
+    if (*end || v > UINT32_MAX) {
+        return false;
+    }
+
+    *value = (uint32_t)v;
+    return true;
+}
+
+static int cmd_set(uint8_t, char ** argv, char * reply, size_t len) {
+    uint32_t value;
+    int id = settings_find(argv[1]);
+
+    if (id < 0) {
+        return ERROR_SETTING_UNKNOWN;
+    }
+    if (!parse_uint(argv[2], &value) || settings_set(id, value)) {
+        append(reply, len, ",\"min\":%u,\"max\":%u", setting_fields[id].min, setting_fields[id].max);
+        return ERROR_SETTING_RANGE;
+    }
+
+    append_setting(reply, len, id);
+    return 0;
+}
+
+static int cmd_get(uint8_t, char ** argv, char * reply, size_t len) {
+    if (!strcasecmp(argv[1], "config")) {
+        for (size_t i = 0; i < setting_field_count; i++) {
+            append_setting(reply, len, i);
+        }
+        return 0;
+    }
+
+    int id = settings_find(argv[1]);
+    if (id < 0) {
+        return ERROR_SETTING_UNKNOWN;
+    }
+
+    append_setting(reply, len, id);
+    return 0;
+}
+
+static int cmd_reset_baseline(uint8_t, char **, char *, size_t) {
+    Serial.print("Resetting Baseline Values... ");
+    int ret = reset_baselines();
+    Serial.println(ret ? "Failed" : "OK");
+    return ret;
+}
+
+static const Command commands[] = {
+    { "set", 2, 2, cmd_set },
+    { "get", 1, 1, cmd_get },
+    { "resetBaseline", 0, 0, cmd_reset_baseline },
+};
+
+static const char * error_message(int ret) {
+    switch (ret) {
+    case ERROR_COMMAND_UNKNOWN: return "unknown command";
+    case ERROR_COMMAND_ARGS: return "wrong number of arguments";
+    case ERROR_SETTING_UNKNOWN: return "unknown setting";
+    case ERROR_SETTING_RANGE: return "value out of range";
+    default: return "failed";
+    }
+}
+
+int command_run(const char * line, char * reply, size_t len) {
+    char buf[64];
+    char * argv[COMMAND_MAX_ARGS];
+    uint8_t argc = 0;
+    const Command * cmd = NULL;
+    int ret;
+
+    // Split into words in a copy of the line
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    for (char * p = buf; *p; ) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') *p++ = 0;
+        if (!*p) break;
+        if (argc == COMMAND_MAX_ARGS) {
+            argc++;
+            break;
+        }
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+    }
+
+    if (argc) {
+        for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+            if (!strcasecmp(argv[0], commands[i].name)) {
+                cmd = &commands[i];
+                break;
+            }
+        }
+    }
+
+    reply[0] = 0;
+    if (!cmd) {
+        append(reply, len, "{\"cmd\":null");
+        ret = ERROR_COMMAND_UNKNOWN;
+    } else {
+        append(reply, len, "{\"cmd\":\"%s\"", cmd->name);
+        if (argc - 1 < cmd->min_args || argc - 1 > cmd->max_args) {
+            ret = ERROR_COMMAND_ARGS;
+        } else {
+            ret = cmd->fn(argc, argv, reply, len);
+        }
+    }
+
+    if (ret) {
+        append(reply, len, ",\"ok\":false,\"error\":\"%s\"}", error_message(ret));
+    } else {
+        append(reply, len, ",\"ok\":true}");
+    }
+
+    return ret;
+}
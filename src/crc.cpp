@@ -0,0 +1,14 @@
+/** CRC-32 */
+
+#include "crc.h"
+
+uint32_t crc32(const uint8_t * data, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
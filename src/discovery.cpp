@@ -0,0 +1,198 @@
+/** Home Assistant Discovery */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "discovery.h"
+#include "storage.h"
+
+// Discovery Message Format Version; change it whenever the messages built
+// below change, so every sensor republishes once after the update
+#define DISCOVERY_FORMAT    1
+
+// FNV-1a Hash Parameters
+#define FNV_OFFSET          2166136261UL
+#define FNV_PRIME           16777619UL
+
+// Discovery State
+static DiscoveryState dstate;
+
+DiscoveryState * discovery_state = &dstate;
+
+// Hash a string including its terminator, so adjacent strings cannot alias
+static uint32_t hash_string(uint32_t h, const char * s) {
+    if (!s) {
+        s = "";
+    }
+
+    do {
+        h = (h ^ (uint8_t)*s) * FNV_PRIME;
+    } while (*s++);
+
+    return h;
+}
+
+// Initialize Discovery
+void discovery_init(const char * module_sn, const DiscoveryTable * tables, size_t count, bool retain) {
+    uint32_t h = FNV_OFFSET;
+
+    h = (h ^ DISCOVERY_FORMAT) * FNV_PRIME;
+    h = (h ^ (retain ? 1 : 0)) * FNV_PRIME;
+    h = hash_string(h, module_sn);
+    for (size_t t = 0; t < count; t++) {
+        h = hash_string(h, tables[t].state_topic);
+        for (size_t i = 0; i < tables[t].count; i++) {
+            const PayloadField * f = &tables[t].fields[i];
+            if (f->name) {
+                h = hash_string(h, f->name);
+                h = hash_string(h, f->units);
+                h = hash_string(h, f->device_class);
+                h = hash_string(h, f->key);
+            }
+        }
+    }
+
+    DiscoveryStatus * st = &discovery_state->status;
+    memset(st, 0, sizeof(DiscoveryStatus));
+    st->hash = h;
+
+    eeprom.size(EEPROM_SECTORS);
+    eeprom.begin(EEPROM_SIZE);
+    eeprom.get(EEPROM_ADDR_DISCOVERY, st->stored);
+    eeprom.end();
+
+    st->pending = st->stored != st->hash;
+    discovery_state->due_ms = millis();
+
+#ifdef DEBUG
+    Serial.printf("Discovery config %08x, last published %08x\n", st->hash, st->stored);
+#endif
+}
+
+// Request Discovery
+void discovery_request(uint32_t delay_ms) {
+    DiscoveryStatus * st = &discovery_state->status;
+    st->requests++;
+
+    // A request already waiting keeps its earlier slot
+    if (!st->pending) {
+        st->pending = 1;
+        discovery_state->due_ms = millis() + delay_ms;
+    }
+}
+
+// Check for Pending Discovery
+bool discovery_due() {
+    return discovery_state->status.pending && (int32_t)(millis() - discovery_state->due_ms) >= 0;
+}
+
+// Complete Discovery
+void discovery_done() {
+    DiscoveryStatus * st = &discovery_state->status;
+    st->pending = 0;
+    st->published++;
+
+    if (st->stored != st->hash) {
+        eeprom.size(EEPROM_SECTORS);
+        eeprom.begin(EEPROM_SIZE);
+        eeprom.put(EEPROM_ADDR_DISCOVERY, st->hash);
+        eeprom.commit();
+        eeprom.end();
+
+        st->stored = st->hash;
+    }
+}
+
+// String Writer: into a bounded buffer, to a stream, or (neither) counting
+typedef struct {
+    char * p;                   //< Buffer position
+    char * end;
+    PayloadSink sink;           //< Stream, used instead of the buffer if set
+    void * ctx;
+    size_t n;                   //< Bytes written
+    bool ok;                    //< Cleared once the output overflows or fails
+} Writer;
+
+static void put(Writer * w, const char * s) {
+    size_t n = strlen(s);
+
+    if (!w->ok) {
+        return;
+    }
+
+    if (w->sink) {
+        w->ok = w->sink(w->ctx, (const uint8_t *)s, n);
+    } else if (w->p) {
+        if ((size_t)(w->end - w->p) < n) {
+            w->ok = false;
+            return;
+        }
+        memcpy(w->p, s, n);
+        w->p += n;
+    }
+    w->n += n;
+}
+
+// Sensor Name: aq_<module_sn>_<name>
+static void put_name(Writer * w, const char * module_sn, const PayloadField * f) {
+    put(w, "aq_");
+    put(w, module_sn);
+    put(w, "_");
+    put(w, f->name);
+}
+
+// Format a Discovery Topic
+size_t discovery_topic(char * out, size_t len, const char * module_sn, const PayloadField * field) {
+    Writer w = { out, out + len - 1, NULL, NULL, 0, true };
+
+    put(&w, "homeassistant/sensor/");
+    put_name(&w, module_sn, field);
+    put(&w, "/config");
+    if (!w.ok) {
+        return 0;
+    }
+
+    *w.p = 0;
+    return w.n;
+}
+
+// Write a Discovery Config Message
+static size_t put_config(Writer * w, const DiscoveryConfig * cfg) {
+    const PayloadField * f = cfg->field;
+
+    put(w, "{");
+    if (f->device_class) {
+        put(w, "\"dev_cla\":\"");
+        put(w, f->device_class);
+        put(w, "\",");
+    }
+    put(w, "\"name\":\"");
+    put_name(w, cfg->module_sn, f);
+    put(w, "\",\"uniq_id\":\"");
+    put_name(w, cfg->module_sn, f);
+    put(w, "\",\"unit_of_meas\":\"");
+    put(w, f->units);
+    put(w, "\",\"stat_t\":\"");
+    put(w, cfg->state_topic);
+    put(w, "\",\"val_tpl\":\"{{ value_json.");
+    put(w, f->key);
+    put(w, " }}\",\"dev\":{\"ids\":[\"aq_");
+    put(w, cfg->module_sn);
+    put(w, "\"],\"mf\":\"Asymworks, LLC\",\"mdl\":\"AirQualityESP\",\"name\":\"AirQuality ESP ");
+    put(w, cfg->module_sn);
+    put(w, "\"}}");
+
+    return w->ok ? w->n : 0;
+}
+
+// Build a Discovery Config Message
+size_t discovery_config(uint8_t * out, size_t len, const void * ctx) {
+    Writer w = { (char *)out, (char *)out + len, NULL, NULL, 0, true };
+    return put_config(&w, (const DiscoveryConfig *)ctx);
+}
+
+// Stream a Discovery Config Message
+size_t discovery_config_stream(PayloadSink sink, void * out, const void * ctx) {
+    Writer w = { NULL, NULL, sink, out, 0, true };
+    return put_config(&w, (const DiscoveryConfig *)ctx);
+}
@@ -0,0 +1,83 @@
+/** Fixed-Point Formatting */
+
+#include "fixed.h"
+
+// Round |num| / den to a float and then to tenths
+static uint64_t fixed_tenths(uint64_t n, uint32_t den) {
+    if (!n) return 0;
+
+    // Scale the quotient into [2^23, 2^24) and round to a float mantissa
+    uint64_t lo = (uint64_t)den << 23;
+    int shift = __builtin_clzll(n) - __builtin_clzll(lo);
+    if (shift < 0) shift = 0;
+    if ((n << shift) < lo) shift++;
+
+    uint64_t r = (n << shift) % den;
+    uint64_t q = (n << shift) / den;
+    if (2 * r > den || (2 * r == den && (q & 1))) {
+        q++;
+    }
+
+    // Round the float value q / 2^shift to tenths
+    uint64_t t = q * 10;
+    uint64_t tenths = t >> shift;
+    if (shift) {
+        uint64_t rem = t & (((uint64_t)1 << shift) - 1);
+        uint64_t half = (uint64_t)1 << (shift - 1);
+        if (rem > half || (rem == half && (tenths & 1))) {
+            tenths++;
+        }
+    }
+
+    return tenths;
+}
+
+int64_t fixed_round1(int64_t num, uint32_t den) {
+    if (num < 0) {
+        return -(int64_t)fixed_tenths(-(uint64_t)num, den);
+    }
+    return fixed_tenths(num, den);
+}
+
+size_t fixed_length_u32(uint32_t value) {
+    size_t n = 1;
+    while (value >= 10) {
+        value /= 10;
+        n++;
+    }
+    return n;
+}
+
+size_t fixed_format_u32(char * buf, uint32_t value) {
+    size_t n = fixed_length_u32(value);
+
+    buf[n] = 0;
+    for (size_t i = n; i > 0; i--) {
+        buf[i - 1] = '0' + value % 10;
+        value /= 10;
+    }
+
+    return n;
+}
+
+size_t fixed_length1(int64_t num, uint32_t den) {
+    uint64_t n = num < 0 ? -(uint64_t)num : (uint64_t)num;
+    return (num < 0) + fixed_length_u32((uint32_t)(fixed_tenths(n, den) / 10)) + 2;
+}
+
+size_t fixed_format1(char * buf, int64_t num, uint32_t den) {
+    char * p = buf;
+    uint64_t n = num < 0 ? -(uint64_t)num : (uint64_t)num;
+    uint64_t tenths = fixed_tenths(n, den);
+
+    if (num < 0) {
+        *p++ = '-';
+    }
+
+    p += fixed_format_u32(p, (uint32_t)(tenths / 10));
+    *p++ = '.';
+    *p++ = '0' + tenths % 10;
+    *p = 0;
+
+    return p - buf;
+}
@@ -0,0 +1,48 @@
+/** Flash Record Regions */
+
+#include <Arduino.h>
+#include <flash_hal.h>
+
+#include "crc.h"
+#include "flash_record.h"
+
+// Records in each sector of a region
+static uint32_t per_sector(const FlashRegion * region) {
+    return FLASH_SECTOR_SIZE / region->size;
+}
+
+bool flash_record_fits(const FlashRegion * region) {
+    return (uint64_t)(region->sector + region->sectors) * FLASH_SECTOR_SIZE <= FS_PHYS_SIZE;
+}
+
+uint32_t flash_record_addr(const FlashRegion * region, uint32_t slot) {
+    return FS_PHYS_ADDR
+        + (region->sector + slot / per_sector(region)) * FLASH_SECTOR_SIZE
+        + (slot % per_sector(region)) * region->size;
+}
+
+int flash_record_read(const FlashRegion * region, uint32_t slot, void * rec) {
+    if (!ESP.flashRead(flash_record_addr(region, slot), (uint32_t *)rec, region->size)) {
+        return RECORD_ERROR;
+    }
+
+    const uint32_t * w = (const uint32_t *)rec;
+    bool empty = true;
+    for (size_t i = 0; i < region->size / 4u; i++) {
+        empty = empty && w[i] == 0xFFFFFFFF;
+    }
+    if (empty) {
+        return RECORD_EMPTY;
+    }
+
+    uint32_t crc;
+    memcpy(&crc, (const uint8_t *)rec + region->crc_offset, sizeof(crc));
+    if (crc != crc32((const uint8_t *)rec, region->crc_offset)) {
+        return RECORD_CORRUPT;
+    }
+    return RECORD_VALID;
+}
+
+bool flash_record_erase(const FlashRegion * region, uint32_t slot) {
+    return ESP.flashEraseSector(FS_PHYS_ADDR / FLASH_SECTOR_SIZE + region->sector + slot / per_sector(region));
+}
@@ -0,0 +1,61 @@
+/** Absolute Humidity from Temperature and Relative Humidity */
+
+#include "humidity.h"
+
+// Table Spacing (0.01 °C) and Size; the last interval uses the two points
+// after it, so the table runs one point past HUMIDITY_T_MAX
+#define T_STEP      100
+#define T_POINTS    ((HUMIDITY_T_MAX - HUMIDITY_T_MIN) / T_STEP + 2)
+
+// exp() for the table: exp(x / 16) by its Taylor series, squared four times
+static constexpr double table_exp(double x) {
+    double y = x / 16, term = 1, sum = 1;
+    for (int n = 1; n < 20; n++) {
+        term *= y / n;
+        sum += term;
+    }
+    for (int i = 0; i < 4; i++) {
+        sum *= sum;
+    }
+    return sum;
+}
+
+// Saturation vapour density (g/m³) at a temperature (°C), Sensirion's
+// approximation: 216.7 * 6.112 * exp(17.62 T / (243.12 + T)) / (273.15 + T)
+static constexpr double saturation_density(double t) {
+    return 216.7 * 6.112 * table_exp(17.62 * t / (243.12 + t)) / (273.15 + t);
+}
+
+// Saturation Vapour Density Table (1/65536 g/m³)
+typedef struct {
+    uint32_t v[T_POINTS];
+} DensityTable;
+
+static constexpr DensityTable make_table() {
+    DensityTable t = {};
+    for (int i = 0; i < T_POINTS; i++) {
+        t.v[i] = (uint32_t)(saturation_density((HUMIDITY_T_MIN + i * T_STEP) / 100.0) * 65536 + 0.5);
+    }
+    return t;
+}
+
+static constexpr DensityTable density = make_table();
+
+// Absolute Humidity (8.8 fixed point g/m³)
+uint16_t humidity_absolute(int16_t temperature, uint32_t humidity) {
+    int32_t t = temperature;
+    if (t < HUMIDITY_T_MIN) t = HUMIDITY_T_MIN;
+    if (t > HUMIDITY_T_MAX) t = HUMIDITY_T_MAX;
+
+    // Quadratic through the three points from the interval's start
+    int32_t i = (t - HUMIDITY_T_MIN) / T_STEP;
+    if (i > T_POINTS - 3) i = T_POINTS - 3;
+    int64_t r = t - HUMIDITY_T_MIN - i * T_STEP;
+
+    int64_t a = density.v[i], b = density.v[i + 1], c = density.v[i + 2];
+    int64_t v = a + ((b - a) * r * 2 * T_STEP + (c - 2 * b + a) * r * (r - T_STEP)) / (2 * T_STEP * T_STEP);
+
+    // 1/65536 g/m³ times 1/1024 %RH, to 1/256 g/m³
+    uint64_t ah = ((uint64_t)v * humidity + 13107200) / 26214400;
+    return ah > HUMIDITY_AH_MAX ? HUMIDITY_AH_MAX : (uint16_t)ah;
+}
@@ -0,0 +1,221 @@
+/** I2C Bus Manager */
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "config.h"
+#include "i2cbus.h"
+
+// Half an SCL period during recovery (5 us: 100 kHz)
+#define RECOVER_HALF_US     5
+
+static I2CBusStatus bstatus;
+
+const I2CBusStatus * i2cbus_status = &bstatus;
+
+// Re-Initialisation by Device
+static I2CBusReinit reinits[SENSOR_COUNT];
+
+// Failures at which each Device next Recovers the Bus
+static uint8_t recover_at[SENSOR_COUNT];
+
+// Bus Time not yet Counted in bus_ms (us)
+static uint16_t bus_us[SENSOR_COUNT];
+
+// Current Transaction
+static uint32_t txn_start;
+static bool txn_free;               // The lines were released when it started
+
+// Device whose Transaction Left the Bus Held, or SENSOR_COUNT
+static uint8_t culprit;
+
+// Recovery in Progress (re-initialisation does not trigger another)
+static bool recovering;
+
+// Check that Nothing Holds SDA or SCL Low
+static bool lines_free() {
+    return digitalRead(SDA) == HIGH && digitalRead(SCL) == HIGH;
+}
+
+// Start Wire at the Configured Stretch Limit
+static void wire_begin() {
+    Wire.begin(SDA, SCL);
+    Wire.setClockStretchLimit(I2C_STRETCH_LIMIT_US);
+}
+
+// Initialize the Bus
+void i2cbus_setup() {
+    memset(&bstatus, 0, sizeof(I2CBusStatus));
+    memset(bus_us, 0, sizeof(bus_us));
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        recover_at[i] = I2C_RECOVER_FAILURES;
+    }
+    culprit = SENSOR_COUNT;
+    recovering = false;
+
+    // A reset does not reach the sensors: one may still hold SDA mid-byte
+    if (lines_free()) {
+        wire_begin();
+    } else {
+        i2cbus_recover();
+    }
+}
+
+// Register a Device's Re-Initialisation
+void i2cbus_attach(uint8_t dev, I2CBusReinit reinit) {
+    if (dev < SENSOR_COUNT) {
+        reinits[dev] = reinit;
+    }
+}
+
+// Recover a Stuck Bus
+bool i2cbus_recover() {
+    pinMode(SDA, INPUT_PULLUP);
+    pinMode(SCL, OUTPUT_OPEN_DRAIN);
+
+    // Clock out the rest of the byte the device is stuck in
+    for (uint8_t i = 0; i < 9 && digitalRead(SDA) == LOW; i++) {
+        digitalWrite(SCL, LOW);
+        delayMicroseconds(RECOVER_HALF_US);
+        digitalWrite(SCL, HIGH);
+        delayMicroseconds(RECOVER_HALF_US);
+    }
+
+    // STOP: SDA rises while SCL is high
+    digitalWrite(SCL, LOW);
+    pinMode(SDA, OUTPUT_OPEN_DRAIN);
+    digitalWrite(SDA, LOW);
+    delayMicroseconds(RECOVER_HALF_US);
+    digitalWrite(SCL, HIGH);
+    delayMicroseconds(RECOVER_HALF_US);
+    digitalWrite(SDA, HIGH);
+    delayMicroseconds(RECOVER_HALF_US);
+
+    pinMode(SDA, INPUT_PULLUP);
+    bool freed = digitalRead(SDA) == HIGH;
+
+    wire_begin();
+    bstatus.recoveries++;
+    if (!freed) {
+        bstatus.stuck++;
+    }
+
+    return freed;
+}
+
+// Recover the Bus after a Device's Repeated Failures
+static void recover(uint8_t dev) {
+    uint8_t target = culprit < SENSOR_COUNT ? culprit : dev;
+
+    recovering = true;
+    i2cbus_recover();
+    if (reinits[target]) {
+        bstatus.device[target].reinits++;
+        reinits[target]();
+    }
+    recovering = false;
+
+    // A stuck bus failed every device; count afresh
+    culprit = SENSOR_COUNT;
+    for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+        bstatus.device[i].failures = 0;
+    }
+}
+
+// Start a Transaction
+void i2cbus_begin(uint8_t) {
+    txn_start = micros();
+    txn_free = lines_free();
+}
+
+// Finish a Transaction
+uint8_t i2cbus_end(uint8_t dev, uint8_t result) {
+    I2CDeviceStatus * d = &bstatus.device[dev];
+    uint32_t us = bus_us[dev] + (micros() - txn_start);
+
+    d->transactions++;
+    d->bus_ms += us / 1000;
+    bus_us[dev] = us % 1000;
+
+    // Whatever the driver says, a held line is a timeout; this device left
+    // it held if it was free before
+    if (!lines_free()) {
+        result = I2CBUS_TIMEOUT;
+        if (txn_free) {
+            culprit = dev;
+        }
+    } else if (result == I2CBUS_FAILED) {
+        result = I2CBUS_NACK;
+    }
+
+    if (result == I2CBUS_OK) {
+        d->failures = 0;
+        if (!recovering) {
+            recover_at[dev] = I2C_RECOVER_FAILURES;
+        }
+        return result;
+    }
+
+    if (result == I2CBUS_NACK) {
+        d->nacks++;
+        bstatus.nacks++;
+    } else if (result == I2CBUS_TIMEOUT) {
+        d->timeouts++;
+        bstatus.timeouts++;
+    } else {
+        d->checksums++;
+        bstatus.checksums++;
+    }
+
+    if (d->failures < UINT8_MAX) {
+        d->failures++;
+    }
+    if (!recovering && d->failures >= recover_at[dev]) {
+        recover_at[dev] = recover_at[dev] * 2 < I2C_RECOVER_MAX ? recover_at[dev] * 2 : I2C_RECOVER_MAX;
+        recover(dev);
+    }
+
+    return result;
+}
+
+// Class of a Failed Transfer: a held line or a clock stretched to the limit
+// is a timeout, anything else a NACK
+static uint8_t failure(uint32_t start) {
+    if (!lines_free() || micros() - start >= I2C_STRETCH_LIMIT_US) {
+        return I2CBUS_TIMEOUT;
+    }
+    return I2CBUS_NACK;
+}
+
+// Write to a Device
+uint8_t i2cbus_write(uint8_t addr, const uint8_t * data, size_t len) {
+    uint32_t start = micros();
+
+    Wire.beginTransmission(addr);
+    Wire.write(data, len);
+    switch (Wire.endTransmission()) {
+    case 0:
+        return I2CBUS_OK;
+    case 2:
+    case 3:
+        return I2CBUS_NACK;
+    case 5:
+        return I2CBUS_TIMEOUT;
+    default:
+        return failure(start);
+    }
+}
+
+// Read from a Device
+uint8_t i2cbus_read(uint8_t addr, uint8_t * data, size_t len) {
+    uint32_t start = micros();
+
+    if (Wire.requestFrom(addr, len) != len) {
+        return failure(start);
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)Wire.read();
+    }
+
+    return I2CBUS_OK;
+}
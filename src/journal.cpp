@@ -0,0 +1,152 @@
+/** SGP30 Baseline Journal */
+
+#include <Arduino.h>
+#include <flash_hal.h>
+
+#include "config.h"
+#include "crc.h"
+#include "error.h"
+#include "flash_record.h"
+#include "journal.h"
+#include "storage.h"
+
+// On-Flash Record
+typedef struct {
+    uint32_t seq;               //< Sequence number (increases by one per record)
+    uint16_t eco2;              //< eCO2 baseline
+    uint16_t tvoc;              //< TVOC baseline
+    uint32_t crc;               //< CRC-32 of the fields above
+} JournalRecord;
+
+static_assert(sizeof(JournalRecord) % 4 == 0, "flash records must be word aligned");
+static_assert(JOURNAL_SECTORS >= 2, "the newest record must survive erasing a sector");
+
+#define RECORDS_PER_SECTOR  (FLASH_SECTOR_SIZE / sizeof(JournalRecord))
+#define JOURNAL_RECORDS     (JOURNAL_SECTORS * RECORDS_PER_SECTOR)
+
+// Journal Sectors (after the offline queue)
+static const FlashRegion region = { FLASH_SECTOR_JOURNAL, JOURNAL_SECTORS, sizeof(JournalRecord), offsetof(JournalRecord, crc) };
+
+// Journal Status
+static JournalStatus jstatus;
+
+// Global Journal Status
+const JournalStatus * journal_status = &jstatus;
+
+// Log Position and Newest Record
+static uint32_t head;           //< Next slot to write
+static uint32_t next_seq;
+static bool stored;             //< A valid record exists
+static JournalRecord newest;
+
+// The journal's sectors lie past the end of the filesystem area
+static bool disabled;
+
+int journal_init() {
+    JournalRecord rec;
+    uint32_t newest_slot = 0;
+
+    memset(&jstatus, 0, sizeof(JournalStatus));
+    stored = false;
+    head = 0;
+    next_seq = 1;
+
+    disabled = !flash_record_fits(&region);
+    if (disabled) {
+        return ERROR_JOURNAL_DISABLED;
+    }
+
+    // Records are appended in order, so each sector ends at its first empty
+    // slot; a torn record is not empty and is stepped over
+    for (uint32_t slot = 0; slot < JOURNAL_RECORDS; slot++) {
+        int state = flash_record_read(&region, slot, &rec);
+        if (state == RECORD_ERROR) {
+            return ERROR_JOURNAL_FLASH;
+        }
+
+        if (state == RECORD_EMPTY) {
+            slot = (slot / RECORDS_PER_SECTOR + 1) * RECORDS_PER_SECTOR - 1;
+        } else if (state == RECORD_CORRUPT) {
+            jstatus.corrupt++;
+        } else if (!stored || rec.seq > newest.seq) {
+            newest = rec;
+            newest_slot = slot;
+            stored = true;
+        }
+    }
+
+    if (!stored) {
+        return 0;
+    }
+
+    // Resume after the newest record, stepping over a record torn by a reset
+    uint32_t sector_end = (newest_slot / RECORDS_PER_SECTOR + 1) * RECORDS_PER_SECTOR;
+    head = newest_slot + 1;
+    for (uint32_t slot = head; slot < sector_end; slot++) {
+        if (flash_record_read(&region, slot, &rec) != RECORD_EMPTY) {
+            head = slot + 1;
+        }
+    }
+
+    head %= JOURNAL_RECORDS;
+    next_seq = newest.seq + 1;
+
+    return 0;
+}
+
+int journal_read(uint16_t * eco2, uint16_t * tvoc) {
+    if (!stored) {
+        return ERROR_JOURNAL_EMPTY;
+    }
+
+    if (eco2) *eco2 = newest.eco2;
+    if (tvoc) *tvoc = newest.tvoc;
+    return 0;
+}
+
+// Append a record after the newest
+static int journal_append(uint16_t eco2, uint16_t tvoc) {
+    JournalRecord rec;
+
+    if (disabled) {
+        return ERROR_JOURNAL_DISABLED;
+    }
+
+    // Entering a sector: erase it (the newest record is in another sector)
+    if (head % RECORDS_PER_SECTOR == 0) {
+        if (!flash_record_erase(&region, head)) {
+            return ERROR_JOURNAL_FLASH;
+        }
+    }
+
+    rec.seq = next_seq++;
+    rec.eco2 = eco2;
+    rec.tvoc = tvoc;
+    rec.crc = crc32((const uint8_t *)&rec, offsetof(JournalRecord, crc));
+
+    uint32_t slot = head;
+    head = (head + 1) % JOURNAL_RECORDS;
+    if (!ESP.flashWrite(flash_record_addr(&region, slot), (const uint32_t *)&rec, sizeof(rec))) {
+        return ERROR_JOURNAL_FLASH;
+    }
+
+    newest = rec;
+    stored = true;
+    jstatus.writes++;
+    return 0;
+}
+
+int journal_write(uint16_t eco2, uint16_t tvoc) {
+    // Skip baselines that have not moved since the newest record
+    if (stored && abs((int)eco2 - newest.eco2) <= BASELINE_DEADBAND
+        && abs((int)tvoc - newest.tvoc) <= BASELINE_DEADBAND) {
+        jstatus.skipped++;
+        return 0;
+    }
+
+    return journal_append(eco2, tvoc);
+}
+
+int journal_clear() {
+    return journal_append(0, 0);
+}
@@ -0,0 +1,159 @@
+/** Deep-Sleep Duty Cycling */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "crc.h"
+#include "lowpower.h"
+#include "storage.h"
+
+static_assert(sizeof(LowPowerState) == LOWPOWER_RTC_SIZE, "state must fill its RTC area exactly");
+static_assert(RTC_BLOCK_LOWPOWER * 4 + LOWPOWER_RTC_SIZE <= RTC_USER_BLOCKS * 4, "state must fit in RTC memory");
+
+// Longest Retry Backoff (shift of SLEEP_FLUSH_CYCLES)
+#define FLUSH_BACKOFF_MAX   3
+
+// Deep-Sleep Status
+static LowPowerStatus lpstatus;
+
+// Global Deep-Sleep Status
+const LowPowerStatus * lowpower_status = &lpstatus;
+
+// Batch Decoded from the Window (too large for the stack)
+static SampleBatch window_batch;
+
+static uint32_t state_crc(const LowPowerState * state) {
+    return crc32((const uint8_t *)state + sizeof(state->crc), sizeof(*state) - sizeof(state->crc));
+}
+
+static void update_status(const LowPowerState * state) {
+    uint64_t total = (uint64_t)state->awake_ms + state->asleep_ms;
+
+    lpstatus.cycle = state->cycle;
+    lpstatus.duty = total ? (uint16_t)((uint64_t)state->awake_ms * 1000 / total) : 1000;
+    lpstatus.dropped = state->dropped;
+}
+
+// Restore the State from RTC Memory
+bool lowpower_restore(LowPowerState * state) {
+    bool valid = ESP.rtcUserMemoryRead(RTC_BLOCK_LOWPOWER, (uint32_t *)state, sizeof(*state))
+        && state->version == LOWPOWER_VERSION
+        && state->crc == state_crc(state)
+        && state->window_len <= LOWPOWER_WINDOW_BYTES;
+
+    if (!valid) {
+        memset(state, 0, sizeof(*state));
+        state->version = LOWPOWER_VERSION;
+    }
+
+    update_status(state);
+    return valid;
+}
+
+// Save the State to RTC Memory
+void lowpower_save(LowPowerState * state) {
+    state->crc = state_crc(state);
+    ESP.rtcUserMemoryWrite(RTC_BLOCK_LOWPOWER, (uint32_t *)state, sizeof(*state));
+}
+
+// Decode the Window
+uint8_t lowpower_samples(const LowPowerState * state, SampleBatch * batch) {
+    static SensorData samples[BATCH_MAX];
+    static uint64_t times[BATCH_MAX];
+
+    batch_reset(batch);
+    int n = state->window_len ? batch_decode(state->window, state->window_len, samples, times, BATCH_MAX) : 0;
+    for (int i = 0; i < n; i++) {
+        batch_push(batch, &samples[i], (uint32_t)times[i]);
+    }
+
+    return batch->count;
+}
+
+// Add a Sample to the Window
+void lowpower_push(LowPowerState * state, const SensorData * data, uint32_t awake_ms) {
+    uint8_t encoded;
+
+    lowpower_samples(state, &window_batch);
+    if (window_batch.count == BATCH_MAX) {
+        state->dropped++;
+    }
+    batch_push(&window_batch, data, state->clock_ms + awake_ms);
+
+    // Keep the newest samples that fit; times are relative to power-on
+    for (;;) {
+        size_t len = batch_encode(state->window, sizeof(state->window), &window_batch,
+            window_batch.ms[0], SLEEP_INTERVAL * 1000, &encoded);
+        if (encoded == window_batch.count) {
+            state->window_len = len;
+            break;
+        }
+
+        batch_drop(&window_batch, 1);
+        state->dropped++;
+    }
+
+    update_status(state);
+}
+
+// Check whether this Cycle Brings the Network Up
+bool lowpower_flush_due(const LowPowerState * state) {
+    return (int32_t)(state->cycle - state->next_flush) >= 0;
+}
+
+// Record a Flush Attempt
+void lowpower_flushed(LowPowerState * state, bool ok) {
+    uint8_t shift = 0;
+
+    if (ok) {
+        state->failures = 0;
+        state->window_len = 0;
+    } else {
+        if (state->failures < 255) {
+            state->failures++;
+        }
+        shift = state->failures < FLUSH_BACKOFF_MAX ? state->failures : FLUSH_BACKOFF_MAX;
+    }
+
+    state->next_flush = state->cycle + ((uint32_t)SLEEP_FLUSH_CYCLES << shift);
+}
+
+// Get the Epoch Time of a Sample
+uint64_t lowpower_epoch_ms(const LowPowerState * state, uint32_t ms) {
+    if (!state->epoch_ms) {
+        return 0;
+    }
+
+    // Sample times may be before this wake (negative offset)
+    return state->epoch_ms + (int32_t)(ms - state->clock_ms);
+}
+
+// Set the Epoch Time
+void lowpower_set_epoch(LowPowerState * state, uint32_t epoch, uint32_t awake_ms) {
+    state->epoch_ms = (uint64_t)epoch * 1000 - awake_ms;
+}
+
+// End the Cycle
+uint32_t lowpower_sleep(LowPowerState * state, uint32_t awake_ms) {
+    uint32_t sleep_ms = SLEEP_MIN_MS;
+    if (awake_ms + SLEEP_MIN_MS < SLEEP_INTERVAL * 1000UL) {
+        sleep_ms = SLEEP_INTERVAL * 1000UL - awake_ms;
+    }
+
+    // Halve the totals before they overflow, weighting recent cycles
+    if (state->asleep_ms > 0x7FFFFFFF - sleep_ms || state->awake_ms > 0x7FFFFFFF - awake_ms) {
+        state->awake_ms /= 2;
+        state->asleep_ms /= 2;
+    }
+    state->awake_ms += awake_ms;
+    state->asleep_ms += sleep_ms;
+
+    state->clock_ms += awake_ms + sleep_ms;
+    if (state->epoch_ms) {
+        state->epoch_ms += awake_ms + sleep_ms;
+    }
+    state->cycle++;
+
+    update_status(state);
+    return sleep_ms;
+}
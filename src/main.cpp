@@ -6,19 +6,39 @@
  */
 
 #include <Arduino.h>
+#include <time.h>
 
 #include "TaskScheduler.h"
 
+#include "aggregate.h"
+#include "aqi.h"
+#include "batch.h"
 #include "config.h"
+#include "discovery.h"
 #include "error.h"
+#include "lowpower.h"
+#include "metrics.h"
 #include "mqtt.h"
+#include "queue.h"
+#include "report.h"
 #include "sensor.h"
+#include "settings.h"
+#include "wlan.h"
 
 // Task Callbacks
+void t_collect_data();
 void t_discovery();
+#ifdef METRICS
+void t_metrics();
+#endif
 void t_publish();
 void t_read_baseline();
-void t_read_data();
+void t_read_bme();
+void t_read_pms();
+void t_read_sgp();
+void t_replay();
+void t_sample();
+void t_wlan();
 
 //! Module Serial Number
 char module_sn[16];
@@ -26,8 +46,25 @@ char module_sn[16];
 //! Current Sensor Data
 SensorData data;
 
-uint16_t sgp30errors = 0;       //< SGP30 Error Count
-uint16_t pms5003errors = 0;     //< PMS5003 Error Count
+#ifdef PUBLISH_WINDOW_STAT
+//! Samples since the Last Publish
+SampleWindow window;
+#endif
+
+#ifdef PUBLISH_ON_CHANGE
+//! Change Detection for Report-by-Exception Publishing
+ReportState report;
+
+//! Data Publishing Heartbeat (publishes also run on every change)
+#define PUBLISH_PERIOD PUBLISH_HEARTBEAT
+#else
+#define PUBLISH_PERIOD PUBLISH_INTERVAL
+#endif
+
+#ifdef PUBLISH_BATCH
+//! Samples Waiting for the Batch Topic
+SampleBatch batch;
+#endif
 
 //! Scheduled Task Manager
 Scheduler taskManager;
@@ -35,68 +72,395 @@ Scheduler taskManager;
 // Scheduled Tasks
 Task tDiscovery(TASK_SECOND, TASK_FOREVER, &t_discovery);
 Task tReadBaseline(READ_BASELINE_INTERVAL * TASK_MINUTE, TASK_FOREVER, &t_read_baseline);
-Task tReadData(READ_SENSOR_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_read_data);
-Task tPublish(PUBLISH_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_publish);
+Task tReadBME(READ_BME280_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_read_bme);
+Task tReadSGP(READ_SGP30_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_read_sgp);
+Task tReadPMS(READ_PMS5003_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_read_pms);
+Task tCollectData(SENSOR_POLL_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, &t_collect_data);
+Task tSample(READ_SENSOR_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_sample);
+Task tPublish(PUBLISH_PERIOD * TASK_SECOND, TASK_FOREVER, &t_publish);
+Task tReplay(QUEUE_REPLAY_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_replay);
+Task tWlan(WIFI_CHECK_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_wlan);
+#ifdef METRICS
+Task tMetrics(METRICS_INTERVAL * TASK_SECOND, TASK_FOREVER, &t_metrics);
+#endif
 
 //! Send Home Assistant Discovery Messages
 void t_discovery() {
-    if (!connect_mqtt(module_sn)) {
+    // Pending after a config change or a Home Assistant restart
+    if (connected_mqtt() && discovery_due()) {
         haDiscovery(module_sn, MQTT_RETAIN_DISCOVERY);
+    }
+}
 
-        // Discovery only runs once
-        tDiscovery.disable();
+//! WiFi Link Supervisor Callback
+void t_wlan() {
+    METRICS_SCOPE(METRIC_WLAN);
+    check_wlan();
+}
 
-        // Enable read data tasks
-        tReadBaseline.enable();
-        tReadData.enable();
+#ifdef METRICS
+//! Execution Time Metrics Callback
+void t_metrics() {
+    // The window keeps accumulating until a message gets through
+    if (connected_mqtt()) {
+        publish_metrics();
     }
 }
+#endif
+
+//! Current Time (seconds since the epoch, or 0 before SNTP has synced)
+uint32_t timestamp() {
+    time_t now = time(NULL);
+    return now > 1600000000 ? (uint32_t)now : 0;
+}
 
 //! Publish Data Callback
 void t_publish() {
-    if (!connect_mqtt(module_sn)) {
-        publish_data(& data);
+    METRICS_SCOPE(METRIC_PUBLISH);
+    const SensorData * sample = & data;
+
+#if defined(PUBLISH_ON_CHANGE)
+    // Spike-filtered current value, not a window statistic that lags events
+    sample = & report.current;
+#elif defined(PUBLISH_WINDOW_STAT)
+    SensorData stat;
+    if (!agg_result(& window, PUBLISH_WINDOW_STAT, & stat)) {
+        sample = & stat;
     }
+#endif
+
+    // Keep the sample for replay if the broker cannot be reached
+    if (!connected_mqtt() || publish_data(sample)) {
+        queue_push(sample, timestamp());
+    }
+
+#ifdef PUBLISH_ON_CHANGE
+    report_sent(& report);
+#endif
+}
+
+//! Offline Queue Replay Callback
+void t_replay() {
+    METRICS_SCOPE(METRIC_REPLAY);
+    static uint32_t session;
+    SensorData sample;
+    uint32_t ts, seq;
+
+    if (!queue_status->pending || !connected_mqtt()) {
+        return;
+    }
+
+    // Samples still waiting for their PUBACK when the last session dropped
+    // never reached the broker; send them again
+    if (mqtt_status->connects != session) {
+        session = mqtt_status->connects;
+        queue_rewind();
+    }
+
+    // Send one rate-limited burst; each sample stays queued until the
+    // broker acknowledges it
+    for (uint8_t i = 0; i < QUEUE_REPLAY_BATCH; i++) {
+        if (queue_next(& sample, & ts, & seq)) {
+            break;
+        }
+        if (publish_history(& sample, ts, seq)) {
+            queue_rewind();
+            break;
+        }
+    }
+
+    // Space bursts from now rather than catching up after a stalled loop
+    tReplay.delay();
 }
 
 //! Sensor Baseline Read Callback
 void t_read_baseline() {
-    if (!read_baselines() && !connect_mqtt(module_sn)) {
+    METRICS_SCOPE(METRIC_BASELINE);
+    if (!read_baselines() && connected_mqtt()) {
         publish_status("ONLINE");
     }
 }
 
-//! Sensor Data Read Callback
-void t_read_data() {
+// Start a sensor read and make sure the collection task is polling
+static void read_sensor(uint8_t sensor) {
+    METRICS_SCOPE(METRIC_READ_DATA);
+    if (!start_sensor(sensor) && !tCollectData.isEnabled()) {
+        tCollectData.enableDelayed(SENSOR_POLL_INTERVAL);
+    }
+}
+
+//! BME280 Read Callback (starts the conversion)
+void t_read_bme() {
+    read_sensor(SENSOR_BME280);
+}
+
+//! SGP30 Read Callback (starts the measurement)
+void t_read_sgp() {
+    read_sensor(SENSOR_SGP30);
+}
+
+//! PMS5003 Read Callback
+void t_read_pms() {
+    read_sensor(SENSOR_PMS5003);
+}
+
+//! Sensor Data Collection Callback (polls until every started read is done)
+void t_collect_data() {
+    METRICS_SCOPE(METRIC_COLLECT_DATA);
+    bool pending = false;
     bool errs = false;
-    int ret = read_sensors(& data);
-    if ((ret & ERROR_SGP30_READ_FAILED) == ERROR_SGP30_READ_FAILED) {
-        ++sgp30errors;
-        errs = true;
+
+    // A failed read only marks that sensor's channels stale
+    for (uint8_t s = 0; s < SENSOR_COUNT; s++) {
+        int ret = poll_sensor(s, & data);
+        if (ret == SENSOR_PENDING) {
+            pending = true;
+        } else if (ret > 0) {
+            errs = true;
+        }
     }
-    if ((ret & ERROR_PMS3003_READ_FAILED) == ERROR_PMS3003_READ_FAILED) {
-        ++pms5003errors;
-        errs = true;
+
+    if (!pending) {
+        tCollectData.disable();
     }
 
-    if (errs && !connect_mqtt(module_sn)) {
+    if (errs && connected_mqtt()) {
 #ifdef PUBLISH_ERROR_COUNT
         publish_status("ONLINE");
 #endif
     }
+}
 
-    // Ensure we have at least one read before publishing
+//! Sample Callback (combines the latest reading of every sensor)
+void t_sample() {
+    METRICS_SCOPE(METRIC_SAMPLE);
+#ifdef PUBLISH_WINDOW_STAT
+    agg_push(& window, & data);
+#endif
+
+#ifdef PUBLISH_ON_CHANGE
+    // Changes go out now, and the heartbeat restarts from this publish
+    if (report_push(& report, & data) && tPublish.isEnabled()) {
+        tPublish.forceNextIteration();
+    }
+#endif
+
+#ifndef NO_PMS5003
+    // NowCast hours follow the clock once SNTP has synced; a failed particle
+    // read would only repeat the last value
+    if (!(sensor_status->stale & (1 << SENSOR_PMS5003))) {
+        uint32_t ts = timestamp();
+        aqi_update(& data, ts ? ts / 3600 : millis() / 3600000UL);
+    }
+#endif
+
+#ifdef PUBLISH_BATCH
+    // Every raw sample, sent in bulk; the oldest are dropped while offline
+    batch_push(& batch, & data, millis());
+    if (batch.count >= PUBLISH_BATCH && connected_mqtt()) {
+        uint32_t ts = timestamp();
+        uint64_t base_ms = ts ? (uint64_t)ts * 1000 - (millis() - batch.ms[0]) : 0;
+        publish_batch(& batch, base_ms);
+    }
+#endif
+
+    // Ensure we have at least one sample before publishing
     if (!tPublish.isEnabled()) {
         tPublish.enable();
     }
 }
 
+// Enable a task at a phase offset (a zero delay would mean a full interval)
+static void enable_phased(Task & task, unsigned long phase) {
+    if (phase) {
+        task.enableDelayed(phase);
+    } else {
+        task.enable();
+    }
+}
+
+// Start the reads of the fitted sensors and the sample at their phases,
+// together
+static void start_sampling() {
+    enable_phased(tReadSGP, READ_SGP30_PHASE);
+    if (SENSOR_FITTED & (1 << SENSOR_PMS5003)) {
+        enable_phased(tReadPMS, READ_PMS5003_PHASE);
+    }
+    if (SENSOR_FITTED & (1 << SENSOR_BME280)) {
+        enable_phased(tReadBME, READ_BME280_PHASE);
+    }
+    enable_phased(tSample, READ_SAMPLE_PHASE);
+}
+
+// Task Intervals from the Runtime Settings
+static void set_intervals() {
+    tPublish.setInterval(settings->publish_interval * TASK_SECOND);
+    tReadBaseline.setInterval(settings->baseline_interval * TASK_MINUTE);
+    tReadBME.setInterval(settings->bme280_interval * TASK_SECOND);
+    tReadPMS.setInterval(settings->pms5003_interval * TASK_SECOND);
+    tSample.setInterval(settings->sample_interval * TASK_SECOND);
+}
+
+//! Setting Change Callback (a set command on the cmd topic)
+void setting_changed(uint8_t id) {
+    switch (id) {
+    case SETTING_PUBLISH_INTERVAL:
+        tPublish.setInterval(settings->publish_interval * TASK_SECOND);
+        break;
+
+    case SETTING_BASELINE_INTERVAL:
+        tReadBaseline.setInterval(settings->baseline_interval * TASK_MINUTE);
+        break;
+
+    default:
+        // The sampling tasks restart together so their I2C phases stay apart
+        tReadBME.setInterval(settings->bme280_interval * TASK_SECOND);
+        tReadPMS.setInterval(settings->pms5003_interval * TASK_SECOND);
+        tSample.setInterval(settings->sample_interval * TASK_SECOND);
+        start_sampling();
+        break;
+    }
+}
+
+#ifdef LOW_POWER
+// Read the SGP30 alone at 1 Hz until its IAQ algorithm has warmed up, after
+// one BME280 reading for its humidity compensation
+static void warm_up_sgp30() {
+    if (!start_sensor(SENSOR_BME280)) {
+        while (poll_sensor(SENSOR_BME280, & data) == SENSOR_PENDING) {
+            delay(1);
+        }
+    }
+
+    for (uint8_t i = 1; i < SLEEP_SGP30_READS; i++) {
+        uint32_t start = millis();
+        if (!start_sensor(SENSOR_SGP30)) {
+            while (poll_sensor(SENSOR_SGP30, & data) == SENSOR_PENDING) {
+                delay(1);
+            }
+        }
+
+        uint32_t elapsed = millis() - start;
+        if (elapsed < 1000) {
+            delay(1000 - elapsed);
+        }
+    }
+}
+
+// Bring the network up and send the window, returning true if all was sent
+static bool flush_window(LowPowerState * state, uint32_t wake_ms) {
+    static SampleBatch samples;
+    uint32_t start = millis();
+
+    if (setup_wlan() || setup_mqtt(module_sn)) {
+        return false;
+    }
+    while (connect_mqtt(module_sn)) {
+        if (millis() - start >= SLEEP_CONNECT_TIMEOUT * 1000UL) {
+            return false;
+        }
+        check_wlan();
+        delay(10);
+    }
+
+    // SNTP has usually synced by the time the session is open
+    uint32_t ts = timestamp();
+    if (ts) {
+        lowpower_set_epoch(state, ts, millis() - wake_ms);
+    }
+
+    if (lowpower_samples(state, & samples)) {
+#ifdef PUBLISH_WINDOW_STAT
+        // One data message with the statistic over the window
+        SensorData stat;
+        agg_reset(& window);
+        for (uint8_t i = 0; i < samples.count; i++) {
+            agg_push(& window, & samples.samples[i]);
+        }
+        if (!agg_result(& window, PUBLISH_WINDOW_STAT, & stat) && publish_data(& stat)) {
+            return false;
+        }
+#else
+        if (publish_data(& samples.samples[samples.count - 1])) {
+            return false;
+        }
+#endif
+
+#ifdef PUBLISH_BATCH
+        // Every sample, timestamped from the RTC clock
+        if (publish_batch(& samples, lowpower_epoch_ms(state, samples.ms[0]))) {
+            return false;
+        }
+#endif
+    }
+
+    if (discovery_due()) {
+        haDiscovery(module_sn, MQTT_RETAIN_DISCOVERY);
+    }
+    publish_status("ONLINE");
+    process_mqtt(MQTT_PROCESS_MS);
+    disconnect_mqtt();
+    return true;
+}
+
+//! Deep-Sleep Cycle: sample, flush every SLEEP_FLUSH_CYCLES wakes, sleep
+void lowpower_cycle() {
+    static LowPowerState state;
+    uint32_t wake_ms = millis();
+
+    bool restored = lowpower_restore(& state);
+    settings_init(NULL);
+    if (setup_sensors(module_sn, sizeof(module_sn))) {
+        Serial.println("Sensor Initializion Failed");
+    } else {
+        // The baseline in RTC memory is newer than the hourly copy in flash
+        if (restored && (state.bl_eCO2 || state.bl_tvoc)) {
+            set_baselines(state.bl_eCO2, state.bl_tvoc);
+        }
+
+        warm_up_sgp30();
+        read_sensors(& data);
+        lowpower_push(& state, & data, millis() - wake_ms);
+
+        if (!fetch_baselines()) {
+            state.bl_eCO2 = sensor_status->bl_eCO2;
+            state.bl_tvoc = sensor_status->bl_tvoc;
+        }
+        if (state.clock_ms - state.baseline_ms >= settings->baseline_interval * 60000UL) {
+            read_baselines();
+            state.baseline_ms = state.clock_ms;
+        }
+    }
+
+    if (lowpower_flush_due(& state)) {
+        lowpower_flushed(& state, flush_window(& state, wake_ms));
+    }
+
+#ifdef DEBUG
+    Serial.printf("Cycle %u done after %u ms, duty %u.%u%%\n", lowpower_status->cycle,
+        (uint32_t)(millis() - wake_ms), lowpower_status->duty / 10, lowpower_status->duty % 10);
+#endif
+
+    // The radio only comes up on wakes that flush
+    uint32_t sleep_ms = lowpower_sleep(& state, millis() - wake_ms);
+    lowpower_save(& state);
+    ESP.deepSleep((uint64_t)sleep_ms * 1000,
+        lowpower_flush_due(& state) ? WAKE_RF_DEFAULT : WAKE_RF_DISABLED);
+}
+#endif
+
 /** Program Initialization */
 void setup() {
     // Initialize Serial Interface
     Serial.begin(DEBUG_BAUD);
     while (!Serial) delay(100);
 
+#ifdef LOW_POWER
+    // Never returns on the device; the next wake starts from reset
+    lowpower_cycle();
+    return;
+#endif
+
     delay(1000);
     Serial.println("\n\033[2J");
     Serial.println("Asymworks Air Quality Sensor");
@@ -107,7 +471,34 @@ void setup() {
         while (1) ;
     }
 
-    // Initialize WiFi and MQTT
+#ifdef PUBLISH_ON_CHANGE
+    report_reset(& report);
+#endif
+#ifdef PUBLISH_BATCH
+    batch_reset(& batch);
+#endif
+#ifndef NO_PMS5003
+    aqi_reset();
+#endif
+
+    // Intervals changed from the cmd topic are kept across resets
+    settings_init(setting_changed);
+
+    // Recover Samples Queued before the last Reset
+    if (queue_init() == ERROR_QUEUE_DISABLED) {
+        Serial.println("Offline Queue Disabled - Filesystem Area too Small");
+    }
+#ifdef DEBUG
+    Serial.printf("Offline Queue: %u samples pending\n", queue_status->pending);
+#endif
+
+    // Start WiFi; the link comes up in the background
+    if (setup_wlan()) {
+        Serial.println("WiFi Initializion Failed - Please Reset");
+        while (1) ;
+    }
+
+    // Initialize MQTT
     if (setup_mqtt(module_sn)) {
         Serial.println("MQTT Initializion Failed - Please Reset");
         while (1) ;
@@ -118,16 +509,41 @@ void setup() {
     taskManager.addTask(tDiscovery);
     taskManager.addTask(tPublish);
     taskManager.addTask(tReadBaseline);
-    taskManager.addTask(tReadData);
+    taskManager.addTask(tReadBME);
+    taskManager.addTask(tReadSGP);
+    taskManager.addTask(tReadPMS);
+    taskManager.addTask(tCollectData);
+    taskManager.addTask(tSample);
+    taskManager.addTask(tReplay);
+    taskManager.addTask(tWlan);
+#ifdef METRICS
+    taskManager.addTask(tMetrics);
+    metrics_reset();
+#endif
 
-    // The discovery task kicks everything off
+    // Sampling runs whether or not the network is up; discovery waits for
+    // the first MQTT session
+    set_intervals();
+    tWlan.enable();
+    tReadBaseline.enable();
+    start_sampling();
+    tReplay.enable();
     tDiscovery.enableDelayed(1000);
+#ifdef METRICS
+    tMetrics.enableDelayed(METRICS_INTERVAL * TASK_SECOND);
+#endif
 }
 
 /** Main Program Loop */
 void loop() {
-    if (!connect_mqtt(module_sn)) {
-        process_mqtt(MQTT_PROCESS_MS);
+    METRICS_LOOP();
+
+    // Connection manager step; returns immediately while offline
+    {
+        METRICS_SCOPE(METRIC_MQTT);
+        if (!connect_mqtt(module_sn)) {
+            process_mqtt(MQTT_PROCESS_MS);
+        }
     }
 
     taskManager.execute();
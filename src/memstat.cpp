@@ -0,0 +1,16 @@
+/** Memory Instrumentation */
+
+#include <Arduino.h>
+
+#include "memstat.h"
+
+static MemoryStatus mstatus;
+
+const MemoryStatus * memory_status = &mstatus;
+
+// Update the Memory Status
+void memstat_update() {
+    mstatus.stack_free = ESP.getFreeContStack();
+    mstatus.heap_free = ESP.getFreeHeap();
+    mstatus.heap_block = ESP.getMaxFreeBlockSize();
+}
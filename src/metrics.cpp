@@ -0,0 +1,98 @@
+/** Execution Time Metrics */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "metrics.h"
+
+#ifdef METRICS
+
+Metric metrics_table[METRIC_COUNT];
+uint32_t metrics_loop_start;
+
+const char * const metric_names[METRIC_COUNT] = {
+    "loop", "mqtt", "wlan", "read", "collect", "publish", "replay", "baseline", "sample",
+};
+
+// Start of the Current Window
+static uint32_t window_start;
+
+// Clear the Metrics Window
+void metrics_reset() {
+    memset(metrics_table, 0, sizeof(metrics_table));
+    for (uint8_t i = 0; i < METRIC_COUNT; i++) {
+        metrics_table[i].min = 0xFFFFFFFF;
+    }
+
+    metrics_loop_start = 0;
+    window_start = millis();
+}
+
+// Append to the message, tracking the space left
+static bool append(char ** p, size_t * left, const char * fmt, ...) {
+    va_list args;
+
+    va_start(args, fmt);
+    int n = vsnprintf(*p, *left, fmt, args);
+    va_end(args);
+
+    if (n < 0 || (size_t)n >= *left) {
+        return false;
+    }
+
+    *p += n;
+    *left -= n;
+    return true;
+}
+
+// Format the Metrics Window
+int metrics_format(char * buf, size_t len, bool hist) {
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    char * p = buf;
+    size_t left = len;
+
+    if (!append(&p, &left, "{\"mhz\":%u,\"s\":%u", mhz, (uint32_t)(millis() - window_start) / 1000)) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < METRIC_COUNT; i++) {
+        const Metric * m = &metrics_table[i];
+        if (!m->count) {
+            continue;
+        }
+
+        if (!append(&p, &left, ",\"%s\":[%u,%u,%u,%u", metric_names[i], m->count,
+                (uint32_t)(m->total / m->count / mhz), m->min / mhz, m->max / mhz)) {
+            return -1;
+        }
+
+        if (hist) {
+            int8_t first = 0;
+            int8_t last = METRICS_BUCKETS - 1;
+            while (!m->hist[first]) first++;
+            while (!m->hist[last]) last--;
+
+            if (!append(&p, &left, ",%d", first)) {
+                return -1;
+            }
+            for (int8_t b = first; b <= last; b++) {
+                if (!append(&p, &left, ",%u", m->hist[b])) {
+                    return -1;
+                }
+            }
+        }
+
+        if (!append(&p, &left, "]")) {
+            return -1;
+        }
+    }
+
+    if (!append(&p, &left, "}")) {
+        return -1;
+    }
+
+    return p - buf;
+}
+
+#endif // METRICS
@@ -1,287 +1,537 @@
 /** MQTT Support Routines */
 
 #include <ESP8266WiFi.h>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 
-#include "Adafruit_MQTT.h"
-#include "Adafruit_MQTT_Client.h"
-
+#include "command.h"
 #include "config.h"
+#include "discovery.h"
 #include "error.h"
+#include "i2cbus.h"
+#include "memstat.h"
+#include "metrics.h"
 #include "mqtt.h"
-
-// MQTT JSON Template
-#define MQTT_JSON "{" \
-    "\"t\":%.1f," \
-    "\"p\":%.1f," \
-    "\"rh\":%.1f," \
-    "\"tvoc\":%d," \
-    "\"co2\":%d," \
-    "\"pm10\":%d," \
-    "\"pm25\":%d," \
-    "\"pm100\":%d," \
-    "\"particles03\":%d," \
-    "\"particles05\":%d," \
-    "\"particles10\":%d," \
-    "\"particles25\":%d," \
-    "\"particles50\":%d," \
-    "\"particles100\":%d" \
-"}"
-
-// MQTT Status JSON Template
-#define MQTT_STATUS_JSON "{" \
-    "\"status\":\"%s\"," \
-    "\"sgp30_errors\":%d," \
-    "\"pms5003_errors\":%d," \
-    "\"bl_tvoc\":%d," \
-    "\"bl_eco2\":%d" \
-"}"
-
-// SSL Client
-#ifdef MQTT_SECURE
-WiFiClientSecure client;
+#include "mqtt_client.h"
+#include "payload.h"
+#include "queue.h"
+#include "settings.h"
+#include "tcp_client.h"
+#include "wlan.h"
+
+// MQTT Session: the transport, the client and its topics. The connection
+// manager polls the TCP handshake of a plain connection; the TLS client
+// connects with one blocking call.
+static MqttSession session;
+
+MqttSession * mqtt_session = &session;
+
+// Fields Announced to Home Assistant, by State Topic
+#ifdef AQI_TOPIC
+#define HA_TABLES   3
 #else
-WiFiClient client;
+#define HA_TABLES   2
 #endif
 
-// MQTT Client
-Adafruit_MQTT_Client * mqtt;
-
-// MQTT Topic Strings
-char mqtt_topic_status[40];
-
-char mqtt_topic_echo[40];
-char mqtt_topic_reply[40];
-char mqtt_topic_cmd[40];
-
-char mqtt_topic_data[40];
+// Table t of the session's announced fields, built one at a time so
+// haDiscovery() holds only the one it is sending
+static void ha_table(const MqttSession * s, size_t t, DiscoveryTable * table) {
+    switch (t) {
+    case 0:
+        *table = { s->topic_data, data_fields, data_field_count };
+        break;
+    case 1:
+        *table = { s->topic_status, status_fields, status_field_count };
+        break;
+#ifdef AQI_TOPIC
+    case 2:
+        *table = { s->topic_aqi, aqi_fields, aqi_field_count };
+        break;
+#endif
+    }
+}
 
-// MQTT Feeds
-Adafruit_MQTT_Publish * pub_status;
-Adafruit_MQTT_Publish * pub_echo;
-Adafruit_MQTT_Publish * pub_data;
+// Latency Probe Reply
+typedef struct {
+    unsigned long id;
+    uint32_t poll;
+    uint32_t start;
+} ProbeReply;
+
+static size_t probe_reply(uint8_t * out, size_t len, const void * ctx) {
+    const ProbeReply * probe = (const ProbeReply *)ctx;
+    int n = snprintf((char *)out, len, "{\"probe\":%lu,\"poll_us\":%u,\"reply_us\":%u}",
+        probe->id, probe->poll, (uint32_t)(micros() - probe->start));
+    return n > 0 && (size_t)n < len ? n : 0;
+}
 
-Adafruit_MQTT_Subscribe * sub_echo;
-Adafruit_MQTT_Subscribe * sub_cmd;
+// Command Reply, built in the packet buffer
+static size_t command_reply(uint8_t * out, size_t len, const void * ctx) {
+    command_run((const char *)ctx, (char *)out, len);
+    return strlen((const char *)out);
+}
 
 // MQTT Callback for ECHO Topic
-void echo_cb(char * data, uint16_t len) {
-    pub_echo->publish(data);
+void echo_cb(char * data, uint16_t) {
+    MqttSession * s = mqtt_session;
+    uint32_t now = micros();
+
+    // Latency probe: answer at once with the time spent in process_mqtt()
+    // before it was read (none if a publish read it while waiting for its
+    // PUBACK)
+    if (!strncmp(data, "probe ", 6)) {
+        ProbeReply probe;
+        probe.id = strtoul(data + 6, NULL, 10);
+        probe.poll = s->polling ? now - s->poll_start : 0;
+        probe.start = now;
+        s->mqtt->publishWith(s->topic_reply, probe_reply, &probe, false);
+        return;
+    }
+
+    s->mqtt->publish(s->topic_reply, data);
     Serial.print("Echo: ");
     Serial.println(data);
 }
 
-// MQTT Callback for CMD Topic
-void cmd_cb(char * data, uint16_t len) {
-    if (!strcasecmp(data, "resetBaseline")) {
-        Serial.print("Resetting Baseline Values... ");
-        if (!reset_baselines()) {
-            Serial.println("OK");
-        } else {
-            Serial.println("Failed");
-        }
-    } else {
-        Serial.printf("Ignoring unknown command: \"%s\"\n", data);
+// MQTT Callback for the Home Assistant Status Topic
+void ha_status_cb(char * data, uint16_t) {
+    // The retained birth message arrives on every subscribe; only a live one
+    // means Home Assistant has just started. Spread the fleet's replies out.
+    if (!strcmp(data, "online") && !mqtt_session->mqtt->retained()) {
+        discovery_request(random(DISCOVERY_JITTER * 1000UL));
     }
 }
 
-// Setup MQTT
-int setup_mqtt(const char * module_sn) {
-    mqtt = new Adafruit_MQTT_Client(&client, mqtt_host, mqtt_port, module_sn, mqtt_user, mqtt_passwd);
-
-    // Format Topic Paths
-    sprintf(mqtt_topic_status, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "status");
-    sprintf(mqtt_topic_echo, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "echo");
-    sprintf(mqtt_topic_reply, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "echo/reply");
-    sprintf(mqtt_topic_cmd, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "cmd");
-    sprintf(mqtt_topic_data, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "data");
-
+// MQTT Callback for CMD Topic
+void cmd_cb(char * data, uint16_t) {
 #ifdef DEBUG
-    Serial.printf("MQTT Status: %s\n", mqtt_topic_status);
-    Serial.printf("MQTT Echo: %s\n", mqtt_topic_echo);
-    Serial.printf("MQTT Reply: %s\n", mqtt_topic_reply);
-    Serial.printf("MQTT Command: %s\n", mqtt_topic_cmd);
-    Serial.printf("MQTT Data: %s\n", mqtt_topic_data);
+    Serial.printf("Command: %s\n", data);
 #endif
+    mqtt_session->mqtt->publishWith(mqtt_session->topic_reply, command_reply, data, false);
+}
 
-    // Create Pub/Sub Objects
-    pub_status = new Adafruit_MQTT_Publish(mqtt, mqtt_topic_status);
-    pub_echo = new Adafruit_MQTT_Publish(mqtt, mqtt_topic_reply);
-    pub_data = new Adafruit_MQTT_Publish(mqtt, mqtt_topic_data);
+// PUBACK for a Replayed Sample: only now may it leave the queue
+static void history_ack(uint32_t seq) {
+    queue_ack(seq);
+}
 
-    sub_echo = new Adafruit_MQTT_Subscribe(mqtt, mqtt_topic_echo);
-    sub_cmd = new Adafruit_MQTT_Subscribe(mqtt, mqtt_topic_cmd);
+// Home Assistant Subscription (the topic is the same for every device)
+static const MqttSubscription sub_ha_status = { DISCOVERY_HA_STATUS, 0, ha_status_cb };
+
+// Format Topic Paths
+static void format_topics(MqttSession * s, const char * module_sn) {
+    sprintf(s->topic_status, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "status");
+    sprintf(s->topic_echo, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "echo");
+    sprintf(s->topic_reply, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "echo/reply");
+    sprintf(s->topic_cmd, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "cmd");
+    sprintf(s->topic_data, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "data");
+    sprintf(s->topic_history, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "history");
+#ifdef AQI_TOPIC
+    sprintf(s->topic_aqi, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "aqi");
+#endif
+#ifdef METRICS
+    sprintf(s->topic_metrics, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "metrics");
+#endif
+#ifdef PUBLISH_BATCH
+    sprintf(s->topic_batch, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "batch");
+#endif
+#ifdef MQTT_CBOR
+    sprintf(s->topic_status_cbor, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "status/cbor");
+    sprintf(s->topic_data_cbor, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "data/cbor");
+    sprintf(s->topic_history_cbor, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "history/cbor");
+#ifdef AQI_TOPIC
+    sprintf(s->topic_aqi_cbor, "%s/%s/%s", MQTT_TOPIC_BASE, module_sn, "aqi/cbor");
+#endif
+#endif
+}
 
-    // Setup Subscriber Callbacks
-    sub_echo->setCallback(echo_cb);
-    sub_cmd->setCallback(cmd_cb);
+// Setup MQTT
+int setup_mqtt(const char * module_sn) {
+    MqttSession * s = mqtt_session;
+    DiscoveryTable tables[HA_TABLES];
 
-    // Subscribe to Topics
-    mqtt->subscribe(sub_echo);
-    mqtt->subscribe(sub_cmd);
-
-    // Startup WiFi
-    WiFi.begin(wifi_ssid, wifi_passwd);
-    Serial.print("Connecting to ");
-    Serial.print(wifi_ssid);
-    Serial.print("");
-
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(1000);
-        Serial.print(".");
+    // Setting up again replaces the client in the same storage
+    if (s->mqtt) {
+        s->mqtt->~MQTT_Client();
     }
 
-    Serial.println("WiFi Connected");
+    s->mqtt = new (s->storage) MQTT_Client(&s->client, mqtt_host, mqtt_port, module_sn, mqtt_user, mqtt_passwd);
+    s->mqtt->setKeepAliveInterval(MQTT_KEEPALIVE);
+    s->mqtt->setAckCallback(history_ack);
+
+    // The first attempt starts as soon as the WiFi link is up
+    memset(&s->status, 0, sizeof(s->status));
+    s->backoff_window = MQTT_BACKOFF_MIN_MS;
+    s->retry_at = millis();
+    s->connect_start = 0;
+    s->poll_start = micros();
+    s->polling = false;
+
+    format_topics(s, module_sn);
+#ifdef AQI_TOPIC
+    s->aqi_sent_hour = UINT32_MAX;
+#endif
+
 #ifdef DEBUG
-    Serial.print("IP: ");
-    Serial.println(WiFi.localIP());
+    Serial.printf("MQTT Status: %s\n", s->topic_status);
+    Serial.printf("MQTT Echo: %s\n", s->topic_echo);
+    Serial.printf("MQTT Reply: %s\n", s->topic_reply);
+    Serial.printf("MQTT Command: %s\n", s->topic_cmd);
+    Serial.printf("MQTT Data: %s\n", s->topic_data);
+    Serial.printf("MQTT History: %s\n", s->topic_history);
+#ifdef AQI_TOPIC
+    Serial.printf("MQTT AQI: %s\n", s->topic_aqi);
+#endif
+#ifdef METRICS
+    Serial.printf("MQTT Metrics: %s\n", s->topic_metrics);
+#endif
+#ifdef PUBLISH_BATCH
+    Serial.printf("MQTT Batch: %s\n", s->topic_batch);
 #endif
+#ifdef MQTT_CBOR
+    Serial.printf("MQTT Status (CBOR): %s\n", s->topic_status_cbor);
+    Serial.printf("MQTT Data (CBOR): %s\n", s->topic_data_cbor);
+    Serial.printf("MQTT History (CBOR): %s\n", s->topic_history_cbor);
+#ifdef AQI_TOPIC
+    Serial.printf("MQTT AQI (CBOR): %s\n", s->topic_aqi_cbor);
+#endif
+#endif
+#endif
+
+    // Subscribe to Topics
+    s->sub_echo = { s->topic_echo, 0, echo_cb };
+    s->sub_cmd = { s->topic_cmd, 0, cmd_cb };
+    s->mqtt->subscribe(&s->sub_echo);
+    s->mqtt->subscribe(&s->sub_cmd);
+    s->mqtt->subscribe(&sub_ha_status);
+
+    // Discovery is sent only if its config changed since the last boot
+    for (size_t t = 0; t < HA_TABLES; t++) {
+        ha_table(s, t, &tables[t]);
+    }
+    discovery_init(module_sn, tables, HA_TABLES, MQTT_RETAIN_DISCOVERY);
 
 #ifdef MQTT_SECURE
     // Setup MQTT SSL Fingerprint
-    client.setFingerprint(mqtt_fingerprint);
+    s->client.setFingerprint(mqtt_fingerprint);
+#endif
+
+#ifdef MQTT_SECURE
+    // Bound the blocking connect, the TLS handshake and each socket write
+    s->client.setTimeout(MQTT_TLS_TIMEOUT_MS);
+#else
+    // Bound each socket write
+    s->client.setTimeout(MQTT_CONNECT_TIMEOUT_MS);
 #endif
 
     return 0;
 }
 
-// Connect to the MQTT Server
+// Schedule the next connection attempt
+static void mqtt_backoff(const char * reason, int ret) {
+    MqttSession * s = mqtt_session;
+
+    // Equal jitter: half the window is fixed and half is random, so a fleet
+    // that lost the same broker does not come back in lockstep
+    uint32_t delay_ms = s->backoff_window / 2 + random(s->backoff_window / 2 + 1);
+    if (s->backoff_window < MQTT_BACKOFF_MAX_MS / 2) {
+        s->backoff_window *= 2;
+    } else {
+        s->backoff_window = MQTT_BACKOFF_MAX_MS;
+    }
+
+    s->status.state = MQTT_STATE_OFFLINE;
+    s->status.backoff_ms = delay_ms;
+    s->retry_at = millis() + delay_ms;
+
+    Serial.printf("MQTT %s (%d), retrying in %u ms\n", reason, ret, delay_ms);
+}
+
+// Run the MQTT Connection Manager
 int connect_mqtt(const char * module_sn) {
+    MqttSession * s = mqtt_session;
     int8_t ret;
 
-    // Ping the MQTT server
-    if (!mqtt->ping()) {
-        mqtt->disconnect();
-    }
+    switch (s->status.state) {
+    case MQTT_STATE_OFFLINE:
+        if ((int32_t)(millis() - s->retry_at) < 0 || !connected_wlan()) {
+            break;
+        }
+
+        Serial.printf("Connecting to MQTT server at %s:%d as %s\n", mqtt_host, mqtt_port, module_sn);
+        s->status.attempts++;
+#ifdef MQTT_SECURE
+        // The TLS client cannot take over a polled socket, so it connects
+        // and runs the handshake in one blocking call
+        if (!s->mqtt->beginConnect()) {
+            s->client.stop();
+            mqtt_backoff("connection failed", -1);
+            break;
+        }
+
+        s->status.state = MQTT_STATE_CONNECTING;
+#else
+        if (!s->client.connectStart(mqtt_host, mqtt_port)) {
+            mqtt_backoff("connection failed", -1);
+            break;
+        }
+
+        s->status.state = MQTT_STATE_OPENING;
+#endif
+        s->connect_start = millis();
+        break;
+
+#ifndef MQTT_SECURE
+    case MQTT_STATE_OPENING:
+        ret = s->client.connectPoll();
+        if (ret == TCP_CONNECT_PENDING) {
+            if (millis() - s->connect_start >= MQTT_CONNECT_TIMEOUT_MS) {
+                s->client.stop();
+                mqtt_backoff("connect timeout", ret);
+            }
+            break;
+        }
+        if (ret < 0 || !s->mqtt->beginConnect()) {
+            s->client.stop();
+            mqtt_backoff("connection failed", ret);
+            break;
+        }
+
+        s->status.state = MQTT_STATE_CONNECTING;
+        s->connect_start = millis();
+        break;
+#endif
+
+    case MQTT_STATE_CONNECTING:
+        ret = s->mqtt->pollConnect();
+        if (ret == MQTT_CONNECT_PENDING) {
+            if (millis() - s->connect_start >= MQTT_CONNECT_TIMEOUT_MS) {
+                s->mqtt->disconnect();
+                mqtt_backoff("CONNACK timeout", ret);
+            }
+            break;
+        }
+        if (ret != 0) {
+            s->mqtt->disconnect();
+            mqtt_backoff("connect refused", ret);
+            break;
+        }
 
-    // If connected, skip re-connect
-    if (mqtt->connected()) {
+        Serial.println("MQTT Connected");
+        s->status.state = MQTT_STATE_CONNECTED;
+        s->status.connects++;
+        s->status.backoff_ms = 0;
+        s->backoff_window = MQTT_BACKOFF_MIN_MS;
         return 0;
-    }
 
-    // Reconnect to the server
-    Serial.printf("Connecting to MQTT server at %s:%d as %s ", mqtt_host, mqtt_port, module_sn);
-
-    uint8_t retries = 3;
-    while ((ret = mqtt->connect()) != 0) {
-        Serial.print(".");
-        mqtt->disconnect();
-        delay(5000);
-
-        if (--retries == 0) {
-            Serial.println(" Failed - Please Reset");
-            Serial.print("Last Return Value: ");
-            Serial.println(ret);
-            
-            return ERROR_MQTT_CONNECT_FAILED;
+    case MQTT_STATE_CONNECTED:
+        if (!s->mqtt->connected()) {
+            mqtt_backoff("connection lost", 0);
+            break;
+        }
+        if (!s->mqtt->keepAlive(MQTT_KEEPALIVE * 500UL, MQTT_CONNECT_TIMEOUT_MS)) {
+            s->mqtt->disconnect();
+            mqtt_backoff("keepalive timeout", 0);
+            break;
         }
+        return 0;
     }
 
-    Serial.println(" OK");
-    return 0;
+    return ERROR_MQTT_CONNECT_FAILED;
+}
+
+// Check the MQTT Connection
+bool connected_mqtt() {
+    MqttSession * s = mqtt_session;
+
+    return s->status.state == MQTT_STATE_CONNECTED && s->mqtt->connected();
+}
+
+// Close the MQTT Session
+void disconnect_mqtt() {
+    MqttSession * s = mqtt_session;
+
+    if (s->mqtt->connected()) {
+        // Let the broker acknowledge queued samples before the session ends
+        s->mqtt->drain(MQTT_CONNECT_TIMEOUT_MS);
+        s->mqtt->disconnect();
+    }
+    s->status.state = MQTT_STATE_OFFLINE;
 }
 
 // Process MQTT Subscriptions
 void process_mqtt(int16_t timeout) {
-    if (mqtt->connected()) {
-        mqtt->processPackets(timeout);
+    MqttSession * s = mqtt_session;
+
+    if (s->mqtt->connected()) {
+        s->poll_start = micros();
+        s->polling = true;
+        s->mqtt->processPackets(timeout);
+        s->polling = false;
     }
 }
 
-// Send Home Assistant Discovery for one Sensor
-void haRegisterSensor(
-    const char * module_sn,
-    const char * topic,
-    const char * name,
-    const char * units,
-    const char * deviceClass,
-    const char * valueKey,
-    bool retain = true
-) {
-    char cfgSensorName[40];
+// Send Home Assistant Discovery for all sensors
+int haDiscovery(const char * module_sn, bool retain) {
+    MqttSession * s = mqtt_session;
+    DiscoveryTable table;
     char cfgTopic[80];
-    char cfgDev[120];
-    char cfgData[MAXBUFFERSIZE-150];
-    char cfgMessage[MAXBUFFERSIZE];
-
-    snprintf(cfgSensorName, 39, "aq_%s_%s", module_sn, name);
-    snprintf(cfgTopic, 79, "homeassistant/sensor/%s/config", cfgSensorName);
-    snprintf(cfgDev, 119, "\"ids\":[\"aq_%s\"],\"mf\":\"Asymworks, LLC\",\"mdl\":\"AirQualityESP\",\"name\":\"AirQuality ESP %s\"", module_sn, module_sn);
-    snprintf(cfgData, MAXBUFFERSIZE-21, "\"name\":\"%s\",\"uniq_id\":\"%s\",\"unit_of_meas\":\"%s\",\"stat_t\":\"%s\",\"val_tpl\":\"{{ value_json.%s }}\"",
-        cfgSensorName,
-        cfgSensorName,
-        units,
-        topic,
-        valueKey
-    );
-
-    if (deviceClass) {
-        snprintf(cfgMessage, MAXBUFFERSIZE-1, "{\"dev_cla\":\"%s\",%s,\"dev\":{%s}}", deviceClass, cfgData, cfgDev);
-    } else {
-        snprintf(cfgMessage, MAXBUFFERSIZE-1, "{%s,\"dev\":{%s}}", cfgData, cfgDev);
-    }
+    DiscoveryConfig cfg;
+
+    cfg.module_sn = module_sn;
+    for (size_t t = 0; t < HA_TABLES; t++) {
+        ha_table(s, t, &table);
+        cfg.state_topic = table.state_topic;
+        for (size_t i = 0; i < table.count; i++) {
+            cfg.field = &table.fields[i];
+            if (!cfg.field->name) {
+                continue;
+            }
+
+            // Streamed to the socket as it is built, at any length
+            if (!discovery_topic(cfgTopic, sizeof(cfgTopic), module_sn, cfg.field)
+                || !s->mqtt->publishStream(cfgTopic, discovery_config_stream, &cfg, retain)) {
+                return ERROR_MQTT_PUBLISH_FAILED;
+            }
 
 #ifdef DEBUG
-    Serial.printf("%s %s\n", cfgTopic, cfgMessage);
+            Serial.print("Discovery: ");
+            Serial.println(cfgTopic);
 #endif
+        }
+    }
 
-    mqtt->publish(cfgTopic, cfgMessage, 0, retain);
+    discovery_done();
+    return 0;
 }
 
-// Send Home Assistant Discovery for all sensors
-void haDiscovery(const char * module_sn, bool retain) {
-    haRegisterSensor(module_sn, mqtt_topic_data, "temperature", "°C", "temperature", "t", retain);
-    haRegisterSensor(module_sn, mqtt_topic_data, "pressure", "Pa", "pressure", "p", retain);
-    haRegisterSensor(module_sn, mqtt_topic_data, "humidity", "%", "humidity", "rh", retain);
-
-    haRegisterSensor(module_sn, mqtt_topic_data, "tvoc", "ppb", 0, "tvoc", retain);
-    haRegisterSensor(module_sn, mqtt_topic_data, "eco2", "ppm", "carbon_dioxide", "co2", retain);
-
-    haRegisterSensor(module_sn, mqtt_topic_data, "pm10", "µg/m³", 0, "pm10", retain);
-    haRegisterSensor(module_sn, mqtt_topic_data, "pm25", "µg/m³", 0, "pm25", retain);
-    haRegisterSensor(module_sn, mqtt_topic_data, "pm100", "µg/m³", 0, "pm100", retain);
-
-    haRegisterSensor(module_sn, mqtt_topic_status, "sgp_errors", " ", 0, "sgp30_errors");
-    haRegisterSensor(module_sn, mqtt_topic_status, "aqi_errors", " ", 0, "pms5003_errors");
-    haRegisterSensor(module_sn, mqtt_topic_status, "baseline_eco2", " ", 0, "bl_eco2");
-    haRegisterSensor(module_sn, mqtt_topic_status, "baseline_tvoc", " ", 0, "bl_tvoc");
+// Send Sensor Data to MQTT
+int publish_data(const SensorData * data) {
+    MqttSession * s = mqtt_session;
+
+    if (!s->mqtt->publishFields(s->topic_data, data_fields, data_field_count, data)) {
+        return ERROR_MQTT_PUBLISH_FAILED;
+    }
+#ifdef MQTT_CBOR
+    s->mqtt->publishFields(s->topic_data_cbor, data_fields, data_field_count, data, PAYLOAD_CBOR);
+#endif
+
+#ifdef AQI_TOPIC
+    // The NowCast changes once an hour; retained, so it is there on subscribe
+    if (aqi_status->valid && aqi_status->hour != s->aqi_sent_hour
+        && s->mqtt->publishFields(s->topic_aqi, aqi_fields, aqi_field_count, aqi_status, PAYLOAD_JSON, true)) {
+#ifdef MQTT_CBOR
+        s->mqtt->publishFields(s->topic_aqi_cbor, aqi_fields, aqi_field_count, aqi_status, PAYLOAD_CBOR, true);
+#endif
+        s->aqi_sent_hour = aqi_status->hour;
+    }
+#endif
+
+    return 0;
 }
 
-// Send JSON Data to MQTT
-void publish_data(const SensorData * data) {
-    char json[1024];
-    snprintf(
-        json, 1023, MQTT_JSON,
-        data->temperature,
-        data->pressure,
-        data->humidity,
-        data->tvoc,
-        data->eCO2,
-        data->pm10,
-        data->pm25,
-        data->pm100,
-        data->pc03,
-        data->pc05,
-        data->pc10,
-        data->pc25,
-        data->pc50,
-        data->pc100
-    );
-
-    pub_data->publish(json);
+// Send a Queued Sample to MQTT
+int publish_history(const SensorData * data, uint32_t timestamp, uint32_t seq) {
+    MqttSession * s = mqtt_session;
+    HistoryPayload payload;
+    payload.timestamp = timestamp;
+    payload.data = *data;
+
+    if (!s->mqtt->publishFields(s->topic_history, history_fields, history_field_count, &payload,
+        PAYLOAD_JSON, false, MQTT_HISTORY_QOS, seq)) {
+        return ERROR_MQTT_PUBLISH_FAILED;
+    }
+#if MQTT_HISTORY_QOS == 0
+    queue_ack(seq);
+#endif
+#ifdef MQTT_CBOR
+    s->mqtt->publishFields(s->topic_history_cbor, history_fields, history_field_count, &payload, PAYLOAD_CBOR);
+#endif
+
+    return 0;
 }
 
-// Send JSON Sensor Status to MQTT
+// Send Sensor Status to MQTT
 void publish_status(const char * status) {
-    char json[1024];
-    snprintf(
-        json, 1023, MQTT_STATUS_JSON,
-        status,
-        sensor_status->sgp30_errors,
-        sensor_status->pms5003_errors,
-        sensor_status->bl_tvoc,
-        sensor_status->bl_eCO2
-    );
-
-    pub_status->publish(json);
+    MqttSession * s = mqtt_session;
+    StatusPayload payload;
+    payload.status = status;
+    payload.sensor = *sensor_status;
+    payload.wlan = *wlan_status;
+#ifdef LOW_POWER
+    payload.power = *lowpower_status;
+#endif
+    memstat_update();
+    payload.memory = *memory_status;
+    payload.i2c = *i2cbus_status;
+
+    s->mqtt->publishFields(s->topic_status, status_fields, status_field_count, &payload);
+#ifdef MQTT_CBOR
+    s->mqtt->publishFields(s->topic_status_cbor, status_fields, status_field_count, &payload, PAYLOAD_CBOR);
+#endif
+}
+
+#ifdef PUBLISH_BATCH
+// Batch Payload Builder Context
+typedef struct {
+    const SampleBatch * batch;
+    uint64_t base_ms;
+    uint8_t * encoded;
+} BatchMessage;
+
+static size_t batch_payload(uint8_t * out, size_t len, const void * ctx) {
+    const BatchMessage * msg = (const BatchMessage *)ctx;
+    return batch_encode(out, len, msg->batch, msg->base_ms,
+        settings->sample_interval * 1000UL, msg->encoded);
+}
+
+// Send a Batch of Samples to MQTT
+int publish_batch(SampleBatch * batch, uint64_t base_ms) {
+    MqttSession * s = mqtt_session;
+    BatchMessage msg;
+    uint8_t encoded;
+
+    msg.batch = batch;
+    msg.encoded = &encoded;
+    while (batch->count) {
+        // Encoded in the packet buffer; as many samples as fit per message
+        msg.base_ms = base_ms;
+        if (!s->mqtt->publishWith(s->topic_batch, batch_payload, &msg, false)) {
+            return ERROR_MQTT_PUBLISH_FAILED;
+        }
+
+        // Later messages start at the first sample not yet sent
+        if (base_ms && encoded < batch->count) {
+            base_ms += batch->ms[encoded] - batch->ms[0];
+        }
+        batch_drop(batch, encoded);
+    }
+
+    return 0;
+}
+#endif
+
+#ifdef METRICS
+// Metrics Payload Builder: the histograms are dropped if they do not fit
+static size_t metrics_payload(uint8_t * out, size_t len, const void *) {
+    int n = metrics_format((char *)out, len, true);
+    if (n < 0) {
+        n = metrics_format((char *)out, len, false);
+    }
+    return n > 0 ? n : 0;
+}
+
+// Send Execution Time Metrics to MQTT
+int publish_metrics() {
+    MqttSession * s = mqtt_session;
+
+    if (!s->mqtt->publishWith(s->topic_metrics, metrics_payload, NULL, false)) {
+        return ERROR_MQTT_PUBLISH_FAILED;
+    }
+
+    metrics_reset();
+    return 0;
 }
+#endif
@@ -0,0 +1,547 @@
+/** MQTT 3.1.1 Client with Streamed Payloads */
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "mqtt_client.h"
+
+// Control Packet Types
+#define MQTT_CONNECT        0x1
+#define MQTT_CONNACK        0x2
+#define MQTT_PUBLISH        0x3
+#define MQTT_PUBACK         0x4
+#define MQTT_SUBSCRIBE      0x8
+#define MQTT_PINGREQ        0xC
+#define MQTT_DISCONNECT     0xE
+
+// CONNECT Flags
+#define MQTT_CONN_USERNAME  0x80
+#define MQTT_CONN_PASSWORD  0x40
+#define MQTT_CONN_CLEAN     0x02
+
+// Receive States
+#define RX_HEADER           0
+#define RX_LENGTH           1
+#define RX_BODY             2
+
+// Encode an MQTT remaining-length field
+static uint8_t * put_length(uint8_t * p, size_t len) {
+    do {
+        uint8_t encodedByte = len % 128;
+        len /= 128;
+        if (len > 0) {
+            encodedByte |= 0x80;
+        }
+        *p++ = encodedByte;
+    } while (len > 0);
+
+    return p;
+}
+
+// Write a length-prefixed MQTT string
+static uint8_t * put_string(uint8_t * p, const char * s, size_t len) {
+    *p++ = len >> 8;
+    *p++ = len & 0xFF;
+    memcpy(p, s, len);
+    return p + len;
+}
+
+MQTT_Client::MQTT_Client(Client * client, const char * server, uint16_t server_port,
+    const char * cid, const char * username, const char * password)
+    : transport(client), host(server), port(server_port), client_id(cid ? cid : ""),
+      user(username), pass(password), keepalive_s(60), packet_id(0), window(MQTT_INFLIGHT),
+      ack_cb(0)
+{
+    for (uint8_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+        subs[i] = 0;
+    }
+    reset();
+}
+
+// Forget the session: clean sessions keep nothing across connections
+void MQTT_Client::reset() {
+    tx_len = 0;
+    pub_remaining = 0;
+    tx_ok = true;
+    inflight_count = 0;
+    rx_state = RX_HEADER;
+    rx_header = 0;
+    connack = -1;
+    dispatching = false;
+    rx_ms = millis();
+    ping_pending = false;
+}
+
+void MQTT_Client::setWindow(uint8_t n) {
+    window = n < 1 ? 1 : n > MQTT_INFLIGHT ? MQTT_INFLIGHT : n;
+}
+
+bool MQTT_Client::subscribe(const MqttSubscription * sub) {
+    for (uint8_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+        if (subs[i] == sub) return true;
+    }
+    for (uint8_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+        if (subs[i] == 0) {
+            subs[i] = sub;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Queue bytes for the socket; a full buffer is written out, and large
+// pieces go straight to the socket behind whatever is buffered
+bool MQTT_Client::send(const uint8_t * p, size_t len) {
+    if (tx_len + len > sizeof(tx)) {
+        if (!flush()) {
+            return false;
+        }
+        if (len >= sizeof(tx)) {
+            tx_ok = transport->write(p, len) == len;
+            return tx_ok;
+        }
+    }
+
+    memcpy(tx + tx_len, p, len);
+    tx_len += len;
+    return tx_ok;
+}
+
+bool MQTT_Client::flush() {
+    if (tx_len && tx_ok) {
+        tx_ok = transport->write(tx, tx_len) == tx_len;
+    }
+    tx_len = 0;
+    return tx_ok;
+}
+
+bool MQTT_Client::beginConnect() {
+    reset();
+    if (!transport->connected() && !transport->connect(host, port)) {
+        return false;
+    }
+
+    size_t cid_len = strlen(client_id);
+    size_t user_len = user ? strlen(user) : 0;
+    size_t pass_len = pass ? strlen(pass) : 0;
+
+    // Variable header is 10 bytes, then the length-prefixed strings
+    size_t len = 10 + 2 + cid_len;
+    uint8_t flags = MQTT_CONN_CLEAN;
+    if (user_len) {
+        flags |= MQTT_CONN_USERNAME;
+        len += 2 + user_len;
+    }
+    if (pass_len) {
+        flags |= MQTT_CONN_PASSWORD;
+        len += 2 + pass_len;
+    }
+
+    if (len + 5 > sizeof(tx)) {
+        transport->stop();
+        return false;
+    }
+
+    uint8_t * p = tx;
+    *p++ = MQTT_CONNECT << 4;
+    p = put_length(p, len);
+    p = put_string(p, "MQTT", 4);
+    *p++ = 4;       // Protocol level (3.1.1)
+    *p++ = flags;
+    *p++ = keepalive_s >> 8;
+    *p++ = keepalive_s & 0xFF;
+    p = put_string(p, client_id, cid_len);
+    if (user_len) p = put_string(p, user, user_len);
+    if (pass_len) p = put_string(p, pass, pass_len);
+    tx_len = p - tx;
+
+    if (!flush()) {
+        transport->stop();
+        return false;
+    }
+
+    return true;
+}
+
+int8_t MQTT_Client::pollConnect() {
+    if (!connected()) {
+        return -1;
+    }
+
+    poll();
+    if (connack < 0) {
+        return MQTT_CONNECT_PENDING;
+    }
+    if (connack > 0) {
+        return connack;
+    }
+
+    // Subscribe without waiting; the SUBACKs are read by processPackets()
+    for (uint8_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+        if (subs[i] == 0) continue;
+
+        uint8_t hdr[6];
+        size_t topic_len = strlen(subs[i]->topic);
+        uint8_t * p = hdr;
+        if (++packet_id == 0) packet_id = 1;
+        *p++ = MQTT_SUBSCRIBE << 4 | 0x2;
+        p = put_length(p, 2 + 2 + topic_len + 1);
+        *p++ = packet_id >> 8;
+        *p++ = packet_id & 0xFF;
+
+        uint8_t qos = subs[i]->qos;
+        send(hdr, p - hdr);
+        p = hdr;
+        *p++ = topic_len >> 8;
+        *p++ = topic_len & 0xFF;
+        send(hdr, 2);
+        send((const uint8_t *)subs[i]->topic, topic_len);
+        if (!send(&qos, 1) || !flush()) {
+            return -2;
+        }
+    }
+
+    return 0;
+}
+
+bool MQTT_Client::keepAlive(uint32_t idle_ms, uint32_t timeout_ms) {
+    uint32_t now = millis();
+
+    if (ping_pending) {
+        return now - ping_ms < timeout_ms;
+    }
+
+    if (now - rx_ms >= idle_ms) {
+        uint8_t ping[2] = { MQTT_PINGREQ << 4, 0 };
+        ping_ms = now;
+        ping_pending = send(ping, sizeof(ping)) && flush();
+        return ping_pending;
+    }
+
+    return true;
+}
+
+bool MQTT_Client::connected() {
+    return transport->connected();
+}
+
+void MQTT_Client::disconnect() {
+    if (connected()) {
+        uint8_t pkt[2] = { MQTT_DISCONNECT << 4, 0 };
+        tx_len = 0;
+        tx_ok = true;
+        send(pkt, sizeof(pkt));
+        flush();
+        transport->stop();
+    }
+    reset();
+}
+
+void MQTT_Client::processPackets(int16_t timeout) {
+    uint32_t start = millis();
+
+    while (connected()) {
+        poll();
+        if ((int32_t)(millis() - start) >= timeout) {
+            break;
+        }
+        delay(MQTT_READ_INTERVAL_MS);
+    }
+}
+
+bool MQTT_Client::retained() const {
+    return (rx_header >> 4) == MQTT_PUBLISH && (rx_header & 1);
+}
+
+// Read whatever has arrived, handling each packet as it completes
+void MQTT_Client::poll() {
+    uint8_t skip[32];
+    uint8_t c;
+    int n;
+
+    while ((n = transport->available()) > 0) {
+        switch (rx_state) {
+        case RX_HEADER:
+            transport->read(&c, 1);
+            rx_header = c;
+            rx_len = 0;
+            rx_shift = 0;
+            rx_state = RX_LENGTH;
+            break;
+
+        case RX_LENGTH:
+            transport->read(&c, 1);
+            rx_len |= (uint32_t)(c & 0x7F) << rx_shift;
+            rx_shift += 7;
+            if (c & 0x80) {
+                if (rx_shift > 21) {
+                    // Malformed length: the stream cannot be resynchronized
+                    transport->stop();
+                    return;
+                }
+                break;
+            }
+            rx_got = 0;
+            rx_state = RX_BODY;
+            if (rx_len == 0) {
+                rx_state = RX_HEADER;
+                handle();
+            }
+            break;
+
+        case RX_BODY:
+            // The body is kept up to the buffer size, and the rest skipped
+            if ((uint32_t)n > rx_len - rx_got) {
+                n = rx_len - rx_got;
+            }
+            if (rx_got < MQTT_RX_BUFFER) {
+                if ((uint32_t)n > MQTT_RX_BUFFER - rx_got) {
+                    n = MQTT_RX_BUFFER - rx_got;
+                }
+                n = transport->read(rx + rx_got, n);
+            } else {
+                n = transport->read(skip, n < (int)sizeof(skip) ? n : sizeof(skip));
+            }
+            if (n <= 0) {
+                return;
+            }
+            rx_got += n;
+            if (rx_got == rx_len) {
+                rx_state = RX_HEADER;
+                handle();
+            }
+            break;
+        }
+    }
+}
+
+// Act on a complete packet
+void MQTT_Client::handle() {
+    // Anything from the server answers an outstanding ping
+    rx_ms = millis();
+    ping_pending = false;
+
+    switch (rx_header >> 4) {
+    case MQTT_CONNACK:
+        connack = rx_len == 2 ? rx[1] : 0xFF;
+        break;
+
+    case MQTT_PUBACK:
+        if (rx_len == 2) {
+            uint16_t id = rx[0] << 8 | rx[1];
+            for (uint8_t i = 0; i < inflight_count; i++) {
+                if (inflight_ids[i] == id) {
+                    uint32_t tag = inflight_tags[i];
+                    inflight_count--;
+                    inflight_ids[i] = inflight_ids[inflight_count];
+                    inflight_tags[i] = inflight_tags[inflight_count];
+                    if (ack_cb && tag) {
+                        ack_cb(tag);
+                    }
+                    break;
+                }
+            }
+        }
+        break;
+
+    case MQTT_PUBLISH:
+        deliver();
+        break;
+
+    default:
+        // SUBACK and PINGRESP need nothing beyond the liveness update
+        break;
+    }
+}
+
+// Acknowledge an inbound PUBLISH and pass it to its subscription
+void MQTT_Client::deliver() {
+    uint8_t qos = (rx_header >> 1) & 3;
+    size_t stored = rx_got < MQTT_RX_BUFFER ? rx_got : MQTT_RX_BUFFER;
+
+    if (stored < 2) {
+        return;
+    }
+    size_t topic_len = rx[0] << 8 | rx[1];
+    size_t pos = 2 + topic_len;
+
+    if (qos) {
+        if (pos + 2 > stored) {
+            return;
+        }
+        uint8_t ack[4] = { MQTT_PUBACK << 4, 2, rx[pos], rx[pos + 1] };
+        send(ack, sizeof(ack));
+        flush();
+        pos += 2;
+    }
+
+    // Messages longer than the receive buffer are dropped
+    if (rx_got > MQTT_RX_BUFFER || pos > rx_len) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS; i++) {
+        const MqttSubscription * sub = subs[i];
+        if (sub && strlen(sub->topic) == topic_len && !memcmp(rx + 2, sub->topic, topic_len)) {
+            uint16_t len = rx_len - pos;
+            rx[pos + len] = 0;
+            dispatching = true;
+            sub->callback((char *)rx + pos, len);
+            dispatching = false;
+            return;
+        }
+    }
+}
+
+// Wait for a free QoS 1 slot, reading PUBACKs as they arrive
+bool MQTT_Client::reserve() {
+    uint32_t start = millis();
+
+    while (inflight_count >= window) {
+        // A callback cannot read the socket under the packet it is handling
+        if (dispatching || !connected() || millis() - start >= MQTT_ACK_TIMEOUT_MS) {
+            return false;
+        }
+        poll();
+        if (inflight_count >= window) {
+            delay(MQTT_READ_INTERVAL_MS);
+        }
+    }
+
+    return true;
+}
+
+bool MQTT_Client::drain(uint32_t timeout_ms) {
+    uint32_t start = millis();
+
+    while (inflight_count && connected() && millis() - start < timeout_ms) {
+        poll();
+        if (inflight_count) {
+            delay(MQTT_READ_INTERVAL_MS);
+        }
+    }
+
+    return inflight_count == 0;
+}
+
+bool MQTT_Client::beginPublish(const char * topic, size_t len, uint8_t qos, bool retain, uint32_t tag) {
+    uint8_t hdr[9];
+    size_t topic_len = strlen(topic);
+
+    if (!connected() || (qos && !reserve())) {
+        return false;
+    }
+
+    tx_len = 0;
+    tx_ok = true;
+
+    uint8_t * p = hdr;
+    *p++ = MQTT_PUBLISH << 4 | (qos ? 1 : 0) << 1 | (retain ? 1 : 0);
+    p = put_length(p, 2 + topic_len + (qos ? 2 : 0) + len);
+    *p++ = topic_len >> 8;
+    *p++ = topic_len & 0xFF;
+    send(hdr, p - hdr);
+    send((const uint8_t *)topic, topic_len);
+
+    if (qos) {
+        if (++packet_id == 0) packet_id = 1;
+        uint8_t id[2] = { (uint8_t)(packet_id >> 8), (uint8_t)(packet_id & 0xFF) };
+        send(id, sizeof(id));
+        inflight_ids[inflight_count] = packet_id;
+        inflight_tags[inflight_count++] = tag;
+    }
+
+    pub_remaining = len;
+    return tx_ok;
+}
+
+bool MQTT_Client::write(const uint8_t * p, size_t len) {
+    if (len > pub_remaining) {
+        tx_ok = false;
+        return false;
+    }
+
+    pub_remaining -= len;
+    return send(p, len);
+}
+
+bool MQTT_Client::endPublish() {
+    bool ok = pub_remaining == 0 && flush();
+
+    if (!ok) {
+        transport->stop();
+        reset();
+    }
+    return ok;
+}
+
+bool MQTT_Client::sink(void * ctx, const uint8_t * p, size_t len) {
+    return ((MQTT_Client *)ctx)->write(p, len);
+}
+
+bool MQTT_Client::publish(const char * topic, const char * payload, uint8_t qos, bool retain) {
+    return publish(topic, (const uint8_t *)payload, strlen(payload), qos, retain);
+}
+
+bool MQTT_Client::publish(const char * topic, const uint8_t * payload, size_t len,
+    uint8_t qos, bool retain)
+{
+    return beginPublish(topic, len, qos, retain) && write(payload, len) && endPublish();
+}
+
+bool MQTT_Client::publishFields(const char * topic, const PayloadField * fields,
+    size_t count, const void * base, uint8_t format, bool retain, uint8_t qos, uint32_t tag)
+{
+    size_t len = payload_length(format, fields, count, base);
+
+    if (!beginPublish(topic, len, qos, retain, tag)) {
+        return false;
+    }
+    payload_stream(format, sink, this, fields, count, base);
+    return endPublish();
+}
+
+bool MQTT_Client::publishStream(const char * topic, PayloadStream stream,
+    const void * ctx, bool retain)
+{
+    size_t len = stream(NULL, NULL, ctx);
+
+    if (!len || !beginPublish(topic, len, 0, retain)) {
+        return false;
+    }
+    stream(sink, this, ctx);
+    return endPublish();
+}
+
+bool MQTT_Client::publishWith(const char * topic, PayloadBuilder build,
+    const void * ctx, bool retain)
+{
+    size_t topic_len = strlen(topic);
+
+    if (!connected()) {
+        return false;
+    }
+
+    // Leave room for a two-byte remaining length; the buffer is < 16 KiB
+    uint8_t * start = tx + 3;
+    if (start + 2 + topic_len >= tx + sizeof(tx)) {
+        return false;
+    }
+
+    uint8_t * p = put_string(start, topic, topic_len);
+    size_t payload_len = build(p, tx + sizeof(tx) - p, ctx);
+    if (!payload_len) {
+        return false;
+    }
+
+    // Write the fixed header so it ends where the topic starts
+    size_t len = 2 + topic_len + payload_len;
+    uint8_t * hdr = len < 128 ? tx + 1 : tx;
+    hdr[0] = MQTT_PUBLISH << 4 | (retain ? 1 : 0);
+    put_length(hdr + 1, len);
+
+    tx_ok = transport->write(hdr, start - hdr + len) == start - hdr + len;
+    tx_len = 0;
+    return tx_ok;
+}
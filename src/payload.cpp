@@ -0,0 +1,365 @@
+/** Table-Driven Payload Serializer */
+
+#include <string.h>
+
+#include "fixed.h"
+#include "payload.h"
+
+// Payload Fields of the Fitted Sensors, for a bare SensorData and for the one
+// within a queued sample
+#define DATA_FIELD(ch, member, type, invalid, id, key, field, precision, scale, name, units, dc, ...) \
+    PAYLOAD_FIELD(id, key, field, SensorData, member, precision, scale, name, units, dc),
+#define HISTORY_FIELD(ch, member, type, invalid, id, key, field, precision, scale, name, units, dc, ...) \
+    PAYLOAD_FIELD(id, key, field, HistoryPayload, data.member, precision, scale, name, units, dc),
+
+// Sensor Data Fields
+const PayloadField data_fields[] = {
+    SENSOR_CHANNELS(DATA_FIELD)
+};
+
+const size_t data_field_count = sizeof(data_fields) / sizeof(data_fields[0]);
+
+// Sensor Status Fields
+const PayloadField status_fields[] = {
+    PAYLOAD_FIELD(0, "status", FIELD_STRING, StatusPayload, status, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(1, "sgp30_errors", FIELD_UINT32, StatusPayload, sensor.sgp30_errors, 0, 1, "sgp_errors", " ", NULL),
+#ifndef NO_PMS5003
+    PAYLOAD_FIELD(2, "pms5003_errors", FIELD_UINT32, StatusPayload, sensor.pms5003_errors, 0, 1, "aqi_errors", " ", NULL),
+#endif
+    PAYLOAD_FIELD(3, "bl_tvoc", FIELD_UINT16, StatusPayload, sensor.bl_tvoc, 0, 1, "baseline_tvoc", " ", NULL),
+    PAYLOAD_FIELD(4, "bl_eco2", FIELD_UINT16, StatusPayload, sensor.bl_eCO2, 0, 1, "baseline_eco2", " ", NULL),
+    PAYLOAD_FIELD(5, "wifi_reconnects", FIELD_UINT32, StatusPayload, wlan.reconnects, 0, 1, "wifi_reconnects", " ", NULL),
+    PAYLOAD_FIELD(6, "wifi_offline", FIELD_UINT32, StatusPayload, wlan.offline_s, 0, 1, "wifi_offline", "s", "duration"),
+    PAYLOAD_FIELD(7, "stale", FIELD_UINT16, StatusPayload, sensor.stale, 0, 1, NULL, NULL, NULL),
+#ifdef LOW_POWER
+    PAYLOAD_FIELD(8, "duty", FIELD_UINT16, StatusPayload, power.duty, 1, 10, "duty_cycle", "%", NULL),
+#endif
+    PAYLOAD_FIELD(9, "stack_free", FIELD_UINT16, StatusPayload, memory.stack_free, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(10, "heap_free", FIELD_UINT32, StatusPayload, memory.heap_free, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(11, "heap_block", FIELD_UINT16, StatusPayload, memory.heap_block, 0, 1, NULL, NULL, NULL),
+#ifndef NO_BME280
+    PAYLOAD_FIELD(12, "i2c_bme280_ms", FIELD_UINT32, StatusPayload, i2c.device[SENSOR_BME280].bus_ms, 0, 1, NULL, NULL, NULL),
+#endif
+    PAYLOAD_FIELD(13, "i2c_sgp30_ms", FIELD_UINT32, StatusPayload, i2c.device[SENSOR_SGP30].bus_ms, 0, 1, NULL, NULL, NULL),
+#ifndef NO_PMS5003
+    PAYLOAD_FIELD(14, "i2c_pms5003_ms", FIELD_UINT32, StatusPayload, i2c.device[SENSOR_PMS5003].bus_ms, 0, 1, NULL, NULL, NULL),
+#endif
+    PAYLOAD_FIELD(15, "i2c_nacks", FIELD_UINT32, StatusPayload, i2c.nacks, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(16, "i2c_timeouts", FIELD_UINT32, StatusPayload, i2c.timeouts, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(17, "i2c_checksums", FIELD_UINT32, StatusPayload, i2c.checksums, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(18, "i2c_recoveries", FIELD_UINT16, StatusPayload, i2c.recoveries, 0, 1, NULL, NULL, NULL),
+};
+
+const size_t status_field_count = sizeof(status_fields) / sizeof(status_fields[0]);
+
+#ifndef NO_PMS5003
+// NowCast and AQI Fields
+const PayloadField aqi_fields[] = {
+    PAYLOAD_FIELD(0, "aqi", FIELD_UINT16, AqiStatus, aqi, 0, 1, "aqi", " ", "aqi"),
+    PAYLOAD_FIELD(1, "category", FIELD_STRING, AqiStatus, category_name, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(2, "pollutant", FIELD_STRING, AqiStatus, pollutant, 0, 1, NULL, NULL, NULL),
+    PAYLOAD_FIELD(3, "pm25_nowcast", FIELD_UINT16, AqiStatus, pm25, 1, 10, "pm25_nowcast", "µg/m³", NULL),
+    PAYLOAD_FIELD(4, "pm100_nowcast", FIELD_UINT16, AqiStatus, pm100, 1, 10, "pm100_nowcast", "µg/m³", NULL),
+};
+
+const size_t aqi_field_count = sizeof(aqi_fields) / sizeof(aqi_fields[0]);
+#endif
+
+// Queued Sample Fields
+const PayloadField history_fields[] = {
+    PAYLOAD_FIELD(14, "ts", FIELD_UINT32, HistoryPayload, timestamp, 0, 1, NULL, NULL, NULL),
+    SENSOR_CHANNELS(HISTORY_FIELD)
+};
+
+const size_t history_field_count = sizeof(history_fields) / sizeof(history_fields[0]);
+
+// Load a numeric field, returning true if it holds the invalid sentinel
+static bool field_value(const PayloadField * f, const void * base, int64_t * value) {
+    const uint8_t * p = (const uint8_t *)base + f->offset;
+
+    switch (f->type) {
+    case FIELD_INT16: {
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        *value = v;
+        return v == INT16_MIN;
+    }
+    case FIELD_UINT16: {
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        *value = v;
+        return false;
+    }
+    default: {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        *value = v;
+        return v == UINT32_MAX;
+    }
+    }
+}
+
+// Load a string field
+static const char * field_string(const PayloadField * f, const void * base) {
+    const char * s;
+    memcpy(&s, (const uint8_t *)base + f->offset, sizeof(s));
+    return s ? s : "";
+}
+
+size_t payload_json_length(const PayloadField * fields, size_t count, const void * base) {
+    // Braces, plus quotes, colon and separator for each key
+    size_t len = 2 + (count ? count * 4 - 1 : 0);
+
+    for (size_t i = 0; i < count; i++) {
+        const PayloadField * f = &fields[i];
+        int64_t v;
+
+        len += f->key_len;
+        if (f->type == FIELD_STRING) {
+            len += strlen(field_string(f, base)) + 2;
+        } else if (field_value(f, base, &v) && f->precision) {
+            len += 3;
+        } else if (f->precision) {
+            len += fixed_length1(v, f->scale);
+        } else {
+            len += (v < 0) + fixed_length_u32(v < 0 ? -v : v);
+        }
+    }
+
+    return len;
+}
+
+// Write a JSON member up to its value: separator, quoted key and colon
+static char * json_key(char * p, const PayloadField * f, size_t i) {
+    if (i) *p++ = ',';
+    *p++ = '"';
+    memcpy(p, f->key, f->key_len);
+    p += f->key_len;
+    *p++ = '"';
+    *p++ = ':';
+    return p;
+}
+
+// Write a numeric JSON value
+static char * json_number(char * p, const PayloadField * f, const void * base) {
+    int64_t v;
+
+    if (field_value(f, base, &v) && f->precision) {
+        memcpy(p, "nan", 3);
+        return p + 3;
+    }
+    if (f->precision) {
+        return p + fixed_format1(p, v, f->scale);
+    }
+    if (v < 0) {
+        *p++ = '-';
+        v = -v;
+    }
+    return p + fixed_format_u32(p, (uint32_t)v);
+}
+
+size_t payload_json(uint8_t * out, const PayloadField * fields, size_t count, const void * base) {
+    char * p = (char *)out;
+
+    *p++ = '{';
+    for (size_t i = 0; i < count; i++) {
+        const PayloadField * f = &fields[i];
+
+        p = json_key(p, f, i);
+        if (f->type == FIELD_STRING) {
+            const char * s = field_string(f, base);
+            size_t n = strlen(s);
+            *p++ = '"';
+            memcpy(p, s, n);
+            p += n;
+            *p++ = '"';
+        } else {
+            p = json_number(p, f, base);
+        }
+    }
+    *p++ = '}';
+
+    return p - (char *)out;
+}
+
+// Length of a CBOR head (major type and argument)
+static size_t cbor_head_length(uint64_t value) {
+    if (value < 24) return 1;
+    if (value <= 0xFF) return 2;
+    if (value <= 0xFFFF) return 3;
+    if (value <= 0xFFFFFFFF) return 5;
+    return 9;
+}
+
+// Write a CBOR head (major type and argument)
+static uint8_t * cbor_head(uint8_t * p, uint8_t major, uint64_t value) {
+    size_t n = cbor_head_length(value);
+    major <<= 5;
+
+    if (n == 1) {
+        *p++ = major | value;
+        return p;
+    }
+
+    *p++ = major | (n == 2 ? 24 : n == 3 ? 25 : n == 5 ? 26 : 27);
+    for (size_t i = n - 1; i > 0; i--) {
+        *p++ = value >> (8 * (i - 1));
+    }
+    return p;
+}
+
+// Length of a CBOR integer
+static size_t cbor_int_length(int64_t value) {
+    return cbor_head_length(value < 0 ? -(value + 1) : value);
+}
+
+// Write a CBOR integer (major type 0 or 1)
+static uint8_t * cbor_int(uint8_t * p, int64_t value) {
+    if (value < 0) {
+        return cbor_head(p, 1, -(value + 1));
+    }
+    return cbor_head(p, 0, value);
+}
+
+// Decimal fraction prefix: tag 4, array(2), exponent -1
+static const uint8_t cbor_decimal1[] = { 0xC4, 0x82, 0x20 };
+
+// Half-precision NaN
+static const uint8_t cbor_nan[] = { 0xF9, 0x7E, 0x00 };
+
+size_t payload_cbor_length(const PayloadField * fields, size_t count, const void * base) {
+    size_t len = cbor_head_length(count);
+
+    for (size_t i = 0; i < count; i++) {
+        const PayloadField * f = &fields[i];
+        int64_t v;
+
+        len += cbor_head_length(f->id);
+        if (f->type == FIELD_STRING) {
+            size_t n = strlen(field_string(f, base));
+            len += cbor_head_length(n) + n;
+        } else if (field_value(f, base, &v) && f->precision) {
+            len += sizeof(cbor_nan);
+        } else if (f->precision) {
+            len += sizeof(cbor_decimal1) + cbor_int_length(fixed_round1(v, f->scale));
+        } else {
+            len += cbor_int_length(v);
+        }
+    }
+
+    return len;
+}
+
+// Write a numeric CBOR value
+static uint8_t * cbor_number(uint8_t * p, const PayloadField * f, const void * base) {
+    int64_t v;
+
+    if (field_value(f, base, &v) && f->precision) {
+        memcpy(p, cbor_nan, sizeof(cbor_nan));
+        return p + sizeof(cbor_nan);
+    }
+    if (f->precision) {
+        memcpy(p, cbor_decimal1, sizeof(cbor_decimal1));
+        return cbor_int(p + sizeof(cbor_decimal1), fixed_round1(v, f->scale));
+    }
+    return cbor_int(p, v);
+}
+
+size_t payload_cbor(uint8_t * out, const PayloadField * fields, size_t count, const void * base) {
+    uint8_t * p = cbor_head(out, 5, count);
+
+    for (size_t i = 0; i < count; i++) {
+        const PayloadField * f = &fields[i];
+
+        p = cbor_head(p, 0, f->id);
+        if (f->type == FIELD_STRING) {
+            const char * s = field_string(f, base);
+            size_t n = strlen(s);
+            p = cbor_head(p, 3, n);
+            memcpy(p, s, n);
+            p += n;
+        } else {
+            p = cbor_number(p, f, base);
+        }
+    }
+
+    return p - out;
+}
+
+size_t payload_length(uint8_t format, const PayloadField * fields, size_t count, const void * base) {
+    if (format == PAYLOAD_CBOR) {
+        return payload_cbor_length(fields, count, base);
+    }
+    return payload_json_length(fields, count, base);
+}
+
+size_t payload_encode(uint8_t format, uint8_t * out, const PayloadField * fields, size_t count, const void * base) {
+    if (format == PAYLOAD_CBOR) {
+        return payload_cbor(out, fields, count, base);
+    }
+    return payload_json(out, fields, count, base);
+}
+
+// Stream a Structure a field at a time; string values go to the sink as-is,
+// so only the key and number of one field are ever staged here
+bool payload_stream(uint8_t format, PayloadSink sink, void * ctx,
+    const PayloadField * fields, size_t count, const void * base)
+{
+    uint8_t piece[PAYLOAD_PIECE_MAX];
+    uint8_t * p = piece;
+
+    if (format == PAYLOAD_CBOR) {
+        p = cbor_head(p, 5, count);
+    } else {
+        *p++ = '{';
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const PayloadField * f = &fields[i];
+        const char * s = NULL;
+        size_t n = 0;
+
+        if (format == PAYLOAD_CBOR) {
+            p = cbor_head(p, 0, f->id);
+            if (f->type == FIELD_STRING) {
+                s = field_string(f, base);
+                n = strlen(s);
+                p = cbor_head(p, 3, n);
+            } else {
+                p = cbor_number(p, f, base);
+            }
+        } else {
+            p = (uint8_t *)json_key((char *)p, f, i);
+            if (f->type == FIELD_STRING) {
+                s = field_string(f, base);
+                n = strlen(s);
+                *p++ = '"';
+            } else {
+                p = (uint8_t *)json_number((char *)p, f, base);
+            }
+        }
+
+        if (s) {
+            if (!sink(ctx, piece, p - piece) || !sink(ctx, (const uint8_t *)s, n)) {
+                return false;
+            }
+            p = piece;
+            if (format != PAYLOAD_CBOR) {
+                *p++ = '"';
+            }
+        }
+
+        // Keep a whole field's worth of room for the next one
+        if (p - piece > PAYLOAD_PIECE_MAX / 2) {
+            if (!sink(ctx, piece, p - piece)) {
+                return false;
+            }
+            p = piece;
+        }
+    }
+
+    if (format != PAYLOAD_CBOR) {
+        *p++ = '}';
+    }
+    return sink(ctx, piece, p - piece);
+}
@@ -0,0 +1,246 @@
+/** Offline Sample Queue */
+
+#include <Arduino.h>
+#include <flash_hal.h>
+
+#include "config.h"
+#include "crc.h"
+#include "error.h"
+#include "flash_record.h"
+#include "queue.h"
+
+// On-Flash Record
+typedef struct {
+    uint32_t seq;               //< Sequence number (increases by one per record)
+    uint32_t timestamp;         //< Sample time
+    SensorData data;            //< Sample
+    uint32_t crc;               //< CRC-32 of the fields above
+    uint32_t consumed;          //< Left erased until the sample is replayed
+} QueueRecord;
+
+static_assert(sizeof(QueueRecord) % 4 == 0, "flash records must be word aligned");
+
+#define RECORDS_PER_SECTOR  (FLASH_SECTOR_SIZE / sizeof(QueueRecord))
+#define QUEUE_RECORDS       (QUEUE_SECTORS * RECORDS_PER_SECTOR)
+
+// Queue Sectors (the first of the filesystem area)
+static const FlashRegion region = { 0, QUEUE_SECTORS, sizeof(QueueRecord), offsetof(QueueRecord, crc) };
+
+// Queue Status
+static QueueStatus qstatus;
+
+// Global Queue Status
+const QueueStatus * queue_status = &qstatus;
+
+// Ring Positions (record slots)
+static uint32_t head;           //< Next slot to write
+static uint32_t tail;           //< Oldest slot not yet replayed
+static uint32_t sent;           //< Slots from the tail handed out by queue_next()
+static uint32_t next_seq;
+
+// The queue's sectors lie past the end of the filesystem area
+static bool disabled;
+
+// Read a record slot (a flash read error counts as a corrupt record)
+static int slot_read(uint32_t slot, QueueRecord * rec) {
+    int state = flash_record_read(&region, slot, rec);
+    return state == RECORD_ERROR ? RECORD_CORRUPT : state;
+}
+
+int queue_init() {
+    QueueRecord rec;
+    bool found = false;
+    uint32_t newest = 0, oldest = 0;
+    uint32_t max_seq = 0, min_seq = 0;
+
+    memset(&qstatus, 0, sizeof(QueueStatus));
+    head = tail = sent = 0;
+    next_seq = 1;
+
+    disabled = !flash_record_fits(&region);
+    if (disabled) {
+        return ERROR_QUEUE_DISABLED;
+    }
+    qstatus.capacity = QUEUE_RECORDS;
+
+    // Find the newest record and the oldest one not yet replayed
+    for (uint32_t slot = 0; slot < QUEUE_RECORDS; slot++) {
+        if (slot_read(slot, &rec) != RECORD_VALID) continue;
+
+        if (!found || rec.seq > max_seq) {
+            max_seq = rec.seq;
+            newest = slot;
+            found = true;
+        }
+        if (rec.consumed == 0xFFFFFFFF) {
+            if (!qstatus.pending || rec.seq < min_seq) {
+                min_seq = rec.seq;
+                oldest = slot;
+            }
+            qstatus.pending++;
+        }
+    }
+
+    if (!found) {
+        return 0;
+    }
+
+    // Resume after the last written slot in the newest sector, stepping
+    // over a record torn by a reset
+    uint32_t sector_end = (newest / RECORDS_PER_SECTOR + 1) * RECORDS_PER_SECTOR;
+    head = newest + 1;
+    for (uint32_t slot = head; slot < sector_end; slot++) {
+        if (slot_read(slot, &rec) != RECORD_EMPTY) {
+            head = slot + 1;
+        }
+    }
+
+    head %= QUEUE_RECORDS;
+    tail = qstatus.pending ? oldest : head;
+    next_seq = max_seq + 1;
+
+    return 0;
+}
+
+int queue_push(const SensorData * data, uint32_t timestamp) {
+    QueueRecord rec;
+
+    if (disabled) {
+        return ERROR_QUEUE_DISABLED;
+    }
+
+    // Entering a sector: drop anything still queued in it, then erase it
+    if (head % RECORDS_PER_SECTOR == 0) {
+        uint32_t sector = head / RECORDS_PER_SECTOR;
+
+        if (qstatus.pending && tail / RECORDS_PER_SECTOR == sector) {
+            for (uint32_t slot = tail; slot < head + RECORDS_PER_SECTOR; slot++) {
+                if (slot_read(slot, &rec) == RECORD_VALID && rec.consumed == 0xFFFFFFFF) {
+                    qstatus.dropped++;
+                    qstatus.pending--;
+                }
+            }
+
+            uint32_t next = (head + RECORDS_PER_SECTOR) % QUEUE_RECORDS;
+            uint32_t skipped = (next + QUEUE_RECORDS - tail) % QUEUE_RECORDS;
+            sent = sent > skipped ? sent - skipped : 0;
+            tail = next;
+        }
+
+        if (!flash_record_erase(&region, head)) {
+            return ERROR_QUEUE_FLASH;
+        }
+    }
+
+    memset(&rec, 0xFF, sizeof(rec));
+    rec.seq = next_seq++;
+    rec.timestamp = timestamp;
+    rec.data = *data;
+    rec.crc = crc32((const uint8_t *)&rec, offsetof(QueueRecord, crc));
+
+    // The consumed word is left erased so it can be cleared later
+    uint32_t slot = head;
+    head = (head + 1) % QUEUE_RECORDS;
+    if (!qstatus.pending) {
+        tail = slot;
+        sent = 0;
+    }
+
+    if (!ESP.flashWrite(flash_record_addr(&region, slot), (const uint32_t *)&rec, offsetof(QueueRecord, consumed))) {
+        return ERROR_QUEUE_FLASH;
+    }
+
+    qstatus.pending++;
+    return 0;
+}
+
+int queue_peek(SensorData * data, uint32_t * timestamp) {
+    QueueRecord rec;
+
+    // Skip replayed and torn records
+    while (qstatus.pending && tail != head) {
+        int state = slot_read(tail, &rec);
+        if (state == RECORD_VALID && rec.consumed == 0xFFFFFFFF) {
+            if (data) *data = rec.data;
+            if (timestamp) *timestamp = rec.timestamp;
+            return 0;
+        }
+        if (state == RECORD_CORRUPT) {
+            qstatus.corrupt++;
+        }
+        tail = (tail + 1) % QUEUE_RECORDS;
+        if (sent) sent--;
+    }
+
+    qstatus.pending = 0;
+    return ERROR_QUEUE_EMPTY;
+}
+
+// Mark a record consumed
+static int consume(uint32_t slot) {
+    uint32_t consumed = 0;
+
+    uint32_t addr = flash_record_addr(&region, slot) + offsetof(QueueRecord, consumed);
+    if (!ESP.flashWrite(addr, &consumed, sizeof(consumed))) {
+        return ERROR_QUEUE_FLASH;
+    }
+
+    qstatus.pending--;
+    return 0;
+}
+
+int queue_pop() {
+    if (queue_peek(NULL, NULL)) {
+        return ERROR_QUEUE_EMPTY;
+    }
+    if (consume(tail)) {
+        return ERROR_QUEUE_FLASH;
+    }
+
+    tail = (tail + 1) % QUEUE_RECORDS;
+    if (sent) sent--;
+    return 0;
+}
+
+int queue_next(SensorData * data, uint32_t * timestamp, uint32_t * seq) {
+    QueueRecord rec;
+
+    if (queue_peek(NULL, NULL)) {
+        return ERROR_QUEUE_EMPTY;
+    }
+
+    // Torn records were counted when the tail passed them
+    for (uint32_t slot = (tail + sent) % QUEUE_RECORDS; slot != head; slot = (slot + 1) % QUEUE_RECORDS) {
+        sent++;
+        if (slot_read(slot, &rec) == RECORD_VALID && rec.consumed == 0xFFFFFFFF) {
+            if (data) *data = rec.data;
+            if (timestamp) *timestamp = rec.timestamp;
+            if (seq) *seq = rec.seq;
+            return 0;
+        }
+    }
+
+    return ERROR_QUEUE_EMPTY;
+}
+
+int queue_ack(uint32_t seq) {
+    QueueRecord rec;
+
+    // Only a sample handed out and still queued; its slot may have been
+    // dropped and rewritten while the publish was in flight
+    for (uint32_t i = 0; i < sent; i++) {
+        uint32_t slot = (tail + i) % QUEUE_RECORDS;
+        if (slot_read(slot, &rec) != RECORD_VALID || rec.seq != seq) continue;
+        if (rec.consumed != 0xFFFFFFFF) break;
+
+        int ret = consume(slot);
+        queue_peek(NULL, NULL);
+        return ret;
+    }
+
+    return ERROR_QUEUE_EMPTY;
+}
+
+void queue_rewind() {
+    sent = 0;
+}
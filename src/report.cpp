@@ -0,0 +1,136 @@
+/** Report-by-Exception Publishing */
+
+#include <string.h>
+
+#include "aggregate.h"
+#include "payload.h"
+#include "report.h"
+
+//! Field Deadband (absolute in SensorData units, relative in percent)
+typedef struct {
+    uint32_t abs;
+    uint32_t rel;
+} Deadband;
+
+// Deadbands in data_fields order
+static const Deadband deadbands[] = {
+#define DEADBAND(ch, member, type, invalid, id, key, field, precision, scale, name, units, dc, deadband) \
+    { deadband },
+    SENSOR_CHANNELS(DEADBAND)
+#undef DEADBAND
+};
+
+static_assert(sizeof(deadbands) / sizeof(deadbands[0]) == AGG_CHANNELS,
+    "one deadband per SensorData field");
+
+// Load a field; the invalid sentinels sort below (INT16_MIN) or above
+// (UINT32_MAX) every valid reading, so a median skips occasional ones
+static int64_t field_get(const PayloadField * f, const SensorData * data, bool * invalid) {
+    const uint8_t * p = (const uint8_t *)data + f->offset;
+
+    switch (f->type) {
+    case FIELD_INT16: {
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        *invalid = v == INT16_MIN;
+        return v;
+    }
+    case FIELD_UINT16: {
+        uint16_t v;
+        memcpy(&v, p, sizeof(v));
+        *invalid = false;
+        return v;
+    }
+    default: {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        *invalid = v == UINT32_MAX;
+        return v;
+    }
+    }
+}
+
+// Copy a field from one sample to another
+static void field_copy(const PayloadField * f, SensorData * dst, const SensorData * src) {
+    size_t size = f->type == FIELD_UINT32 ? 4 : 2;
+    memcpy((uint8_t *)dst + f->offset, (const uint8_t *)src + f->offset, size);
+}
+
+// Reset the Report-by-Exception State
+void report_reset(ReportState * state) {
+    memset(state, 0, sizeof(*state));
+}
+
+// Add a Sample and Check the Deadbands
+uint32_t report_push(ReportState * state, const SensorData * data) {
+    uint32_t changed = 0;
+    bool invalid;
+
+    state->recent[state->head] = *data;
+    state->head = (state->head + 1) % REPORT_FILTER;
+    if (state->count < REPORT_FILTER) {
+        state->count++;
+    }
+
+    for (size_t i = 0; i < data_field_count; i++) {
+        const PayloadField * f = &data_fields[i];
+
+        // Median of the recent samples (the latest until the filter fills)
+        if (state->count < REPORT_FILTER) {
+            field_copy(f, &state->current, data);
+        } else {
+            int64_t v[REPORT_FILTER];
+            uint8_t idx[REPORT_FILTER];
+
+            // Insertion sort of a handful of values, keeping their samples
+            for (uint8_t j = 0; j < REPORT_FILTER; j++) {
+                int64_t x = field_get(f, &state->recent[j], &invalid);
+                uint8_t k = j;
+                for (; k > 0 && v[k - 1] > x; k--) {
+                    v[k] = v[k - 1];
+                    idx[k] = idx[k - 1];
+                }
+                v[k] = x;
+                idx[k] = j;
+            }
+            field_copy(f, &state->current, &state->recent[idx[REPORT_FILTER / 2]]);
+        }
+
+        if (!state->has_reported) {
+            changed |= 1UL << i;
+            continue;
+        }
+
+        bool cur_invalid, rep_invalid;
+        int64_t cur = field_get(f, &state->current, &cur_invalid);
+        int64_t rep = field_get(f, &state->reported, &rep_invalid);
+        if (cur_invalid || rep_invalid) {
+            if (cur_invalid != rep_invalid) {
+                changed |= 1UL << i;
+            }
+            continue;
+        }
+
+        const Deadband * db = &deadbands[i];
+        if (!db->abs && !db->rel) {
+            continue;
+        }
+
+        uint64_t delta = cur > rep ? cur - rep : rep - cur;
+        uint64_t band = (uint64_t)(rep < 0 ? -rep : rep) * db->rel / 100;
+        if (band < db->abs) {
+            band = db->abs;
+        }
+        if (delta >= band) {
+            changed |= 1UL << i;
+        }
+    }
+
+    return changed;
+}
+
+// Mark the Current Value as Reported
+void report_sent(ReportState * state) {
+    state->reported = state->current;
+    state->has_reported = 1;
+}
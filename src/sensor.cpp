@@ -6,26 +6,62 @@
 #include "Adafruit_PM25AQI.h"
 #include "Adafruit_SGP30.h"
 
-#include "EEPROM_Rotate.h"
-
+#include "bme280_fixed.h"
 #include "config.h"
 #include "error.h"
+#include "humidity.h"
+#include "i2cbus.h"
+#include "journal.h"
 #include "sensor.h"
+#include "sensor_driver.h"
+#include "storage.h"
 
 // Sensor Objects
-Adafruit_BME280 bme;
+#ifndef NO_BME280
+BME280_Fixed bme;
+#endif
 Adafruit_SGP30 sgp;
+#ifndef NO_PMS5003
 Adafruit_PM25AQI aqi;
+#endif
+
+// SGP30 Commands and PMS5003 Frames go Directly through the Bus Manager, for
+// Split-Phase Reads and the Error Class of each Transaction
+
+// SGP30 Command Execution Times (datasheet maximum, microseconds)
+#define SGP30_HUMIDITY_US   10000
+#define SGP30_MEASURE_US    12000
+
+// Split-Phase Read Steps
+#define STEP_IDLE       0       // No read in progress
+#define STEP_COMMAND    1       // Preparatory command executing (SGP30 humidity)
+#define STEP_CONVERT    2       // Conversion running
+#define STEP_COLLECT    3       // Result ready to be read
+#define STEP_DONE       4       // Collected (or failed) for this read
 
-// Sensor Values
-double bmeTemperature = 0;
-double bmePressure = 0;
-double bmeHumidity = 0;
+// Per-Device Read State
+typedef struct {
+    uint8_t step;
+    uint32_t start;             // micros() when the step started
+    uint32_t due;               // micros() when the step should be complete
+    int result;                 // Error bit if this read failed
+} DeviceRead;
 
-uint16_t sgpTVOC = 0;
-uint16_t sgpeCO2 = 0;
+static DeviceRead bme_read;
+static DeviceRead sgp_read;
+static DeviceRead pms_read;
 
-PM25_AQI_Data aqiData;
+// Read State by SENSOR_* Index
+static DeviceRead * const device_reads[SENSOR_COUNT] = { &bme_read, &sgp_read, &pms_read };
+
+// Last Good BME280 Reading, for the SGP30 Humidity Compensation
+static int16_t bme_temperature;
+static uint32_t bme_humidity;
+static bool bme_valid;
+
+// Absolute Humidity Last Sent to the SGP30 (8.8 g/m³), if sgp_ah_sent
+static uint16_t sgp_ah;
+static bool sgp_ah_sent;
 
 // Sensor Status
 SensorStatus status;
@@ -33,150 +69,295 @@ SensorStatus status;
 // Global Sensor Status
 const SensorStatus * sensor_status = &status;
 
-// EEPROM for Baseline Storage
+// EEPROM (baselines before the journal, and the discovery hash)
 EEPROM_Rotate eeprom;
 
-// EEPROM Addresses
-#define EEPROM_ADDR_ECO2    4
-#define EEPROM_ADDR_TVOC    6
-
-// Read Baseline Values from EEPROM
+// Read Baseline Values from the Journal
 void bl_read() {
-    eeprom.size(2);
-    eeprom.begin(4096);
-    eeprom.get(EEPROM_ADDR_ECO2, status.bl_eCO2);
-    eeprom.get(EEPROM_ADDR_TVOC, status.bl_tvoc);
+    status.bl_eCO2 = 0;
+    status.bl_tvoc = 0;
+    if (journal_init() || !journal_read(&status.bl_eCO2, &status.bl_tvoc)) {
+        return;
+    }
+
+    // Move a baseline stored in EEPROM by earlier firmware into the journal
+    uint16_t eco2, tvoc;
+    eeprom.size(EEPROM_SECTORS);
+    eeprom.begin(EEPROM_SIZE);
+    eeprom.get(EEPROM_ADDR_ECO2, eco2);
+    eeprom.get(EEPROM_ADDR_TVOC, tvoc);
     eeprom.end();
 
-    // If the value is MAX_UINT16 (uninitialized), reset to 0
-    if (status.bl_eCO2 == UINT16_MAX) {
-        status.bl_eCO2++;
-    }
-    if (status.bl_tvoc == UINT16_MAX) {
-        status.bl_tvoc++;
+    // MAX_UINT16 is uninitialized EEPROM
+    if (eco2 != UINT16_MAX && tvoc != UINT16_MAX) {
+        status.bl_eCO2 = eco2;
+        status.bl_tvoc = tvoc;
+        journal_write(eco2, tvoc);
     }
 }
 
-// Write Baseline Values to EEPROM
+// Write Baseline Values to the Journal (skipped if they have not changed)
 void bl_write() {
-    eeprom.size(2);
-    eeprom.begin(4096);
-    eeprom.put(EEPROM_ADDR_ECO2, status.bl_eCO2);
-    eeprom.put(EEPROM_ADDR_TVOC, status.bl_tvoc);
-    eeprom.commit();
-    eeprom.end();
+    journal_write(status.bl_eCO2, status.bl_tvoc);
 }
 
-// Clear Baseline Values in EEPROM
+// Clear Baseline Values in the Journal
 void bl_clear() {
-    uint16_t zero = 0;
-    eeprom.size(2);
-    eeprom.begin(4096);
-    eeprom.put(EEPROM_ADDR_ECO2, zero);
-    eeprom.put(EEPROM_ADDR_TVOC, zero);
-    eeprom.commit();
-    eeprom.end();
+    journal_clear();
 }
 
-// Setup Sensors
-int setup_sensors(char * module_sn, size_t len) {
-    memset(&status, 0, sizeof(SensorStatus));
+// Sensirion CRC-8 (polynomial 0x31, initial value 0xFF)
+static uint8_t sgp_crc(const uint8_t * data, uint8_t len) {
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Move a device to the next step, due after a delay
+static void step_to(DeviceRead * d, uint8_t step, uint32_t delay_us) {
+    d->step = step;
+    d->start = micros();
+    d->due = d->start + delay_us;
+}
+
+// Check whether the current step is due
+static bool step_due(const DeviceRead * d) {
+    return (int32_t)(micros() - d->due) >= 0;
+}
 
-    // Setup BME280
-    if (!bme.begin()) {
+#ifndef NO_BME280
+// BME280 Measurement Failed; report invalid values
+static void bme_failed(SensorData * data) {
+    data->temperature = SENSOR_T_INVALID;
+    data->pressure = SENSOR_P_INVALID;
+    data->humidity = SENSOR_RH_INVALID;
+    bme_read.result = ERROR_BME280_READ_FAILED;
+    bme_read.step = STEP_DONE;
 #ifdef DEBUG
-        Serial.println("No BME280 Found - Please Reset");
+    Serial.println("BME280 Measurement Failed");
 #endif
-        return ERROR_BME280_NOT_FOUND;
+}
+
+// Start the BME280 read: one forced conversion
+static void start_bme() {
+    i2cbus_begin(SENSOR_BME280);
+    bool started = bme.startForced();
+
+    // Otherwise collect the previous conversion (or fail on a broken bus)
+    if (i2cbus_end(SENSOR_BME280, started ? I2CBUS_OK : I2CBUS_FAILED) == I2CBUS_OK) {
+        step_to(&bme_read, STEP_CONVERT, bme.conversionTime());
+    } else {
+        step_to(&bme_read, STEP_COLLECT, 0);
     }
+}
 
-#ifdef DEBUG
-    Serial.println("Connected to BME280");
-#endif
+// Advance the BME280 read, returning true if an I2C step was taken
+static bool poll_bme(SensorData * data) {
+    if (bme_read.step == STEP_CONVERT && step_due(&bme_read)) {
+        bool busy;
+        i2cbus_begin(SENSOR_BME280);
+        bool ok = bme.measuring(&busy);
+
+        if (i2cbus_end(SENSOR_BME280, ok ? I2CBUS_OK : I2CBUS_FAILED) != I2CBUS_OK) {
+            bme_failed(data);
+        } else if (!busy) {
+            bme_read.step = STEP_COLLECT;
+        } else if (micros() - bme_read.start > 2 * bme.conversionTime()) {
+            // Conversion never finished
+            bme_failed(data);
+        } else {
+            bme_read.due = micros() + 1000;
+        }
+        return true;
+    }
 
-    // Setup SGP30
-    if (!sgp.begin()) {
-#ifdef DEBUG
-        Serial.println("No SGP30 Found - Please Reset");
-#endif
-        return ERROR_SGP30_NOT_FOUND;
+    if (bme_read.step == STEP_COLLECT) {
+        i2cbus_begin(SENSOR_BME280);
+        bool ok = bme.readFixed(&data->temperature, &data->pressure, &data->humidity);
+        if (i2cbus_end(SENSOR_BME280, ok ? I2CBUS_OK : I2CBUS_FAILED) == I2CBUS_OK) {
+            bme_temperature = data->temperature;
+            bme_humidity = data->humidity;
+            bme_valid = true;
+            bme_read.step = STEP_DONE;
+        } else {
+            bme_failed(data);
+        }
+        return true;
     }
 
-    memset(module_sn, 0, len);
-    snprintf(module_sn, len, "%04x%04x%04x", sgp.serialnumber[0], sgp.serialnumber[1], sgp.serialnumber[2]);
+    return false;
+}
+
+// BME280 Driver
+struct BME280Driver {
+    static const uint8_t id = SENSOR_BME280;
 
+    // One conversion per read, sleeping in between
+    static int begin() {
+        if (!reinit()) {
 #ifdef DEBUG
-    Serial.printf("Connected to SGP30 SN %s\n", module_sn);
+            Serial.println("No BME280 Found - Please Reset");
 #endif
+            return ERROR_BME280_NOT_FOUND;
+        }
 
-    // Setup PM2.5 AQI Sensor
-    if (!aqi.begin_I2C())
-    {
 #ifdef DEBUG
-        Serial.println("No AQI-I2C Found - Please Reset");
+        Serial.println("Connected to BME280");
 #endif
-        return ERROR_PMS5003_NOT_FOUND;
+        return 0;
     }
 
-#ifdef DEBUG
-    Serial.println("Connected to PMS5003I");
+    static bool reinit() {
+        if (!bme.begin()) {
+            return false;
+        }
+        bme.setSampling(Adafruit_BME280::MODE_FORCED);
+        return true;
+    }
+
+    static void start() { start_bme(); }
+    static bool poll(SensorData * data) { return poll_bme(data); }
+};
 #endif
 
-    // Read the Baseline Values from EEPROM
-    bl_read();
-    if (!sgp.setIAQBaseline(status.bl_eCO2, status.bl_tvoc)) {
+// SGP30 Measurement Failed
+static void sgp_failed() {
+    sgp_read.result = ERROR_SGP30_READ_FAILED;
+    status.sgp30_errors++;
+    sgp_read.step = STEP_DONE;
 #ifdef DEBUG
-        Serial.println("Could not set SGP30 baseline - Please Reset");
+    Serial.println("SGP30 Measurement Failed");
 #endif
-        return ERROR_SGP30_BASELINE;
+}
+
+// Start the SGP30 read: humidity compensation, then the IAQ measurement
+static void start_sgp() {
+    // Compensate for the last BME280 reading, but only send a changed value
+    if (bme_valid) {
+        uint16_t ah = humidity_absolute(bme_temperature, bme_humidity);
+        if (!sgp_ah_sent || ah != sgp_ah) {
+            uint8_t cmd[5] = { 0x20, 0x61, (uint8_t)(ah >> 8), (uint8_t)(ah & 0xFF), 0 };
+            cmd[4] = sgp_crc(&cmd[2], 2);
+            i2cbus_begin(SENSOR_SGP30);
+            if (i2cbus_end(SENSOR_SGP30, i2cbus_write(SGP30_I2CADDR_DEFAULT, cmd, sizeof(cmd))) == I2CBUS_OK) {
+                sgp_ah = ah;
+                sgp_ah_sent = true;
+            }
+            step_to(&sgp_read, STEP_COMMAND, SGP30_HUMIDITY_US);
+            return;
+        }
+    }
+
+    // Nothing to send: the measurement command is due at once
+    step_to(&sgp_read, STEP_COMMAND, 0);
+}
+
+// Advance the SGP30 read, returning true if an I2C step was taken
+static bool poll_sgp(SensorData * data) {
+    if (!step_due(&sgp_read)) {
+        return false;
     }
 
+    if (sgp_read.step == STEP_COMMAND) {
+        const uint8_t cmd[2] = { 0x20, 0x08 };     // Measure IAQ
+        i2cbus_begin(SENSOR_SGP30);
+        if (i2cbus_end(SENSOR_SGP30, i2cbus_write(SGP30_I2CADDR_DEFAULT, cmd, sizeof(cmd))) == I2CBUS_OK) {
+            step_to(&sgp_read, STEP_CONVERT, SGP30_MEASURE_US);
+        } else {
+            sgp_failed();
+        }
+        return true;
+    }
+
+    if (sgp_read.step == STEP_CONVERT) {
+        uint8_t reply[6];
+        i2cbus_begin(SENSOR_SGP30);
+        uint8_t ret = i2cbus_read(SGP30_I2CADDR_DEFAULT, reply, sizeof(reply));
+        if (ret == I2CBUS_OK && (sgp_crc(&reply[0], 2) != reply[2] || sgp_crc(&reply[3], 2) != reply[5])) {
+            ret = I2CBUS_CHECKSUM;
+        }
+        if (i2cbus_end(SENSOR_SGP30, ret) != I2CBUS_OK) {
+            sgp_failed();
+            return true;
+        }
+
+        data->eCO2 = (reply[0] << 8) | reply[1];
+        data->tvoc = (reply[3] << 8) | reply[4];
+        sgp_read.step = STEP_DONE;
+        return true;
+    }
+
+    return false;
+}
+
+// SGP30 Driver
+struct SGP30Driver {
+    static const uint8_t id = SENSOR_SGP30;
+
+    static int begin() {
+        if (!sgp.begin()) {
 #ifdef DEBUG
-    Serial.printf("Read Baselines from EEPROM (%d / %d)\n", status.bl_eCO2, status.bl_tvoc);
+            Serial.println("No SGP30 Found - Please Reset");
 #endif
+            return ERROR_SGP30_NOT_FOUND;
+        }
+        return 0;
+    }
 
-    return 0;
+    // IAQ init restarts the algorithm; restore its baseline and compensation
+    static bool reinit() {
+        sgp_ah_sent = false;
+        return sgp.begin() && sgp.setIAQBaseline(status.bl_eCO2, status.bl_tvoc);
+    }
+
+    static void start() { start_sgp(); }
+    static bool poll(SensorData * data) { return poll_sgp(data); }
+};
+
+#ifndef NO_PMS5003
+// Check a PMS5003 Frame: the start characters, then 15 big-endian words
+// ending in the sum of the bytes before it
+static bool pms_frame_ok(const uint8_t * frame) {
+    uint16_t sum = 0;
+    for (uint8_t i = 0; i < 30; i++) {
+        sum += frame[i];
+    }
+
+    return frame[0] == 0x42 && frame[1] == 0x4D && sum == ((frame[30] << 8) | frame[31]);
 }
 
-/* return absolute humidity [mg/m^3] with approximation formula
- * @param temperature [°C]
- * @param humidity [%RH]
- */
-uint32_t getAbsoluteHumidity(float temperature, float humidity) {
-    // approximation formula from Sensirion SGP30 Driver Integration chapter 3.15
-    const float absoluteHumidity = 216.7f * ((humidity / 100.0f) * 6.112f * exp((17.62f * temperature) / (243.12f + temperature)) / (273.15f + temperature)); // [g/m^3]
-    const uint32_t absoluteHumidityScaled = static_cast<uint32_t>(1000.0f * absoluteHumidity); // [mg/m^3]
-    return absoluteHumidityScaled;
+// Decode a Checked PMS5003 Frame
+static void pms_frame(const uint8_t * frame, PM25_AQI_Data * out) {
+    uint16_t words[15];
+    for (uint8_t i = 0; i < 15; i++) {
+        words[i] = (frame[2 + i * 2] << 8) | frame[3 + i * 2];
+    }
+    memcpy(out, words, sizeof(words));
 }
 
-// Read Sensors
-int read_sensors(SensorData * data) {
-    int ret = 0;
+// Advance the PMS5003 read, returning true if an I2C step was taken
+static bool poll_pms(SensorData * data) {
     PM25_AQI_Data aqiData;
+    uint8_t frame[32];
 
-    // Check Return Value
-    if (!data) return 1;
-
-    // Process Climate Sensor
-    data->temperature = bme.readTemperature();
-    data->pressure = bme.readPressure();
-    data->humidity = bme.readHumidity();
+    if (pms_read.step != STEP_COLLECT) {
+        return false;
+    }
+    pms_read.step = STEP_DONE;
 
-    // Process Gas Sensor
-    sgp.setHumidity(getAbsoluteHumidity(bmeTemperature, bmeHumidity));
-    if (sgp.IAQmeasure()) {
-        data->tvoc = sgp.TVOC;
-        data->eCO2 = sgp.eCO2;
-    } else {
-        ret |= ERROR_SGP30_READ_FAILED;
-        status.sgp30_errors++;
-#ifdef DEBUG
-        Serial.println("SGP30 Measurement Failed");
-#endif
+    i2cbus_begin(SENSOR_PMS5003);
+    uint8_t ret = i2cbus_read(PMSA003I_I2CADDR_DEFAULT, frame, sizeof(frame));
+    if (ret == I2CBUS_OK && !pms_frame_ok(frame)) {
+        ret = I2CBUS_CHECKSUM;
     }
 
-    // Process Particulate Sensor
-    if (aqi.read(& aqiData)) {
+    if (i2cbus_end(SENSOR_PMS5003, ret) == I2CBUS_OK) {
+        pms_frame(frame, & aqiData);
 #ifdef PMS5003_REPORT_ENV
         data->pm10 = aqiData.pm10_env;
         data->pm25 = aqiData.pm25_env;
@@ -194,33 +375,239 @@ int read_sensors(SensorData * data) {
         data->pc50 = aqiData.particles_50um;
         data->pc100 = aqiData.particles_100um;
     } else {
-        ret |= ERROR_PMS3003_READ_FAILED;
+        pms_read.result = ERROR_PMS3003_READ_FAILED;
         status.pms5003_errors++;
 #ifdef DEBUG
         Serial.println("PMS5003 Measurement Failed");
 #endif
     }
 
+    return true;
+}
+
+// PMS5003 Driver
+struct PMS5003Driver {
+    static const uint8_t id = SENSOR_PMS5003;
+
+    static int begin() {
+        if (!reinit()) {
+#ifdef DEBUG
+            Serial.println("No AQI-I2C Found - Please Reset");
+#endif
+            return ERROR_PMS5003_NOT_FOUND;
+        }
+
+#ifdef DEBUG
+        Serial.println("Connected to PMS5003I");
+#endif
+        return 0;
+    }
+
+    static bool reinit() { return aqi.begin_I2C(); }
+
+    // Streams continuously, so just read it
+    static void start() { step_to(&pms_read, STEP_COLLECT, 0); }
+    static bool poll(SensorData * data) { return poll_pms(data); }
+};
+#endif
+
+// Fitted Sensors, in the order their I2C steps are taken
+typedef SensorList<
+#ifndef NO_BME280
+    BME280Driver,
+#endif
+    SGP30Driver
+#ifndef NO_PMS5003
+    , PMS5003Driver
+#endif
+> Sensors;
+
+static_assert(Sensors::fitted == SENSOR_FITTED, "the driver list must match the fitted sensors");
+
+// Check whether a sensor is in this build
+static bool fitted(uint8_t sensor) {
+    return sensor < SENSOR_COUNT && (Sensors::fitted & (1 << sensor));
+}
+
+// Setup Sensors
+int setup_sensors(char * module_sn, size_t len) {
+    memset(&status, 0, sizeof(SensorStatus));
+
+    memset(&bme_read, 0, sizeof(DeviceRead));
+    memset(&sgp_read, 0, sizeof(DeviceRead));
+    memset(&pms_read, 0, sizeof(DeviceRead));
+    bme_valid = false;
+    sgp_ah_sent = false;
+
+    i2cbus_setup();
+    Sensors::attach();
+
+    int ret = Sensors::begin();
+    if (ret) {
+        return ret;
+    }
+
+    memset(module_sn, 0, len);
+    snprintf(module_sn, len, "%04x%04x%04x", sgp.serialnumber[0], sgp.serialnumber[1], sgp.serialnumber[2]);
+
+#ifdef DEBUG
+    Serial.printf("Connected to SGP30 SN %s\n", module_sn);
+#endif
+
+    // Read the Baseline Values from Flash
+    bl_read();
+    if (!sgp.setIAQBaseline(status.bl_eCO2, status.bl_tvoc)) {
+#ifdef DEBUG
+        Serial.println("Could not set SGP30 baseline - Please Reset");
+#endif
+        return ERROR_SGP30_BASELINE;
+    }
+
+#ifdef DEBUG
+    Serial.printf("Read Baselines from Flash (%d / %d)\n", status.bl_eCO2, status.bl_tvoc);
+#endif
+
+    return 0;
+}
+
+// Finish a collected read and update the sensor's stale flag
+static int finish_read(uint8_t sensor) {
+    DeviceRead * d = device_reads[sensor];
+
+    d->step = STEP_IDLE;
+    if (d->result) {
+        status.stale |= 1 << sensor;
+    } else {
+        status.stale &= ~(1 << sensor);
+    }
+
+    return d->result;
+}
+
+// Start a Read of one Sensor
+int start_sensor(uint8_t sensor) {
+    if (!fitted(sensor)) return 1;
+
+    DeviceRead * d = device_reads[sensor];
+    if (d->step != STEP_IDLE) {
+        return SENSOR_PENDING;
+    }
+
+    d->result = 0;
+    Sensors::start(sensor);
+
+    return 0;
+}
+
+// Advance a Read of one Sensor
+int poll_sensor(uint8_t sensor, SensorData * data) {
+    if (!data || sensor >= SENSOR_COUNT) return 1;
+
+    DeviceRead * d = device_reads[sensor];
+    if (d->step == STEP_IDLE) {
+        return SENSOR_IDLE;
+    }
+    if (Sensors::poll(sensor, data) || d->step != STEP_DONE) {
+        return SENSOR_PENDING;
+    }
+
+    return finish_read(sensor);
+}
+
+// Start a Sensor Read
+int start_sensors() {
+    for (uint8_t s = 0; s < SENSOR_COUNT; s++) {
+        if (device_reads[s]->step != STEP_IDLE) {
+            return SENSOR_PENDING;
+        }
+    }
+
+    for (uint8_t s = 0; s < SENSOR_COUNT; s++) {
+        if (fitted(s)) {
+            start_sensor(s);
+        }
+    }
+
+    return 0;
+}
+
+// Advance a Sensor Read
+int poll_sensors(SensorData * data) {
+    int result = 0;
+
+    if (!data) return 1;
+
+    // One I2C step per call
+    if (Sensors::step(data)) {
+        return SENSOR_PENDING;
+    }
+
+    for (uint8_t s = 0; s < SENSOR_COUNT; s++) {
+        if (fitted(s) && device_reads[s]->step != STEP_DONE) {
+            return SENSOR_PENDING;
+        }
+    }
+
+    for (uint8_t s = 0; s < SENSOR_COUNT; s++) {
+        if (fitted(s)) {
+            result |= finish_read(s);
+        }
+    }
+
+    return result;
+}
+
+// Read Sensors
+int read_sensors(SensorData * data) {
+    int ret;
+
+    // Check Return Value
+    if (!data) return 1;
+
+    start_sensors();
+    while ((ret = poll_sensors(data)) == SENSOR_PENDING) {
+        delay(1);
+    }
+
     return ret;
 }
 
-int read_baselines() {
+int fetch_baselines() {
     if (!sgp.getIAQBaseline(&status.bl_eCO2, &status.bl_tvoc)) {
         return ERROR_SGP30_READ_FAILED;
     }
 
-    // Write values to EEPROM
+    return 0;
+}
+
+int read_baselines() {
+    int ret = fetch_baselines();
+    if (ret) {
+        return ret;
+    }
+
+    // Write values to the journal
     bl_write();
 
     return 0;
 }
 
+int set_baselines(uint16_t eco2, uint16_t tvoc) {
+    if (!sgp.setIAQBaseline(eco2, tvoc)) {
+        return ERROR_SGP30_BASELINE;
+    }
+
+    status.bl_eCO2 = eco2;
+    status.bl_tvoc = tvoc;
+    return 0;
+}
+
 int reset_baselines() {
     if (!sgp.setIAQBaseline(0, 0)) {
         return ERROR_SGP30_BASELINE;
     }
 
-    // Reset EEPROM
+    // Reset the stored baseline
     bl_clear();
 
     return 0;
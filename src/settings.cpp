@@ -0,0 +1,124 @@
+/** Runtime Settings */
+
+#include <Arduino.h>
+#include <string.h>
+#include <strings.h>
+
+#include "crc.h"
+#include "error.h"
+#include "settings.h"
+#include "storage.h"
+
+#ifdef PUBLISH_ON_CHANGE
+#define DEFAULT_PUBLISH_INTERVAL PUBLISH_HEARTBEAT
+#else
+#define DEFAULT_PUBLISH_INTERVAL PUBLISH_INTERVAL
+#endif
+
+// Record Marker (changes with the Settings layout)
+#define SETTINGS_MAGIC  0x5301
+
+// EEPROM Record
+typedef struct {
+    uint16_t magic;
+    Settings values;
+    uint32_t crc;               //< CRC-32 of the fields above
+} SettingsRecord;
+
+// The SGP30 is read at 1 Hz for its baseline algorithm and is not tunable
+const SettingField setting_fields[] = {
+    { "sample_interval", offsetof(Settings, sample_interval), 1, 60 },
+    { "publish_interval", offsetof(Settings, publish_interval), 1, 3600 },
+    { "baseline_interval", offsetof(Settings, baseline_interval), 1, 1440 },
+    { "bme280_interval", offsetof(Settings, bme280_interval), 1, 600 },
+    { "pms5003_interval", offsetof(Settings, pms5003_interval), 1, 600 },
+};
+
+const size_t setting_field_count = sizeof(setting_fields) / sizeof(setting_fields[0]);
+
+static const Settings defaults = {
+    READ_SENSOR_INTERVAL,
+    DEFAULT_PUBLISH_INTERVAL,
+    READ_BASELINE_INTERVAL,
+    READ_BME280_INTERVAL,
+    READ_PMS5003_INTERVAL,
+};
+
+// Runtime Settings
+static Settings values = defaults;
+
+// Global Runtime Settings
+const Settings * settings = &values;
+
+// Change Callback
+static setting_cb changed;
+
+static uint16_t * field_ptr(Settings * s, uint8_t id) {
+    return (uint16_t *)((uint8_t *)s + setting_fields[id].offset);
+}
+
+void settings_init(setting_cb on_change) {
+    SettingsRecord rec;
+
+    changed = on_change;
+    values = defaults;
+
+    eeprom.size(EEPROM_SECTORS);
+    eeprom.begin(EEPROM_SIZE);
+    eeprom.get(EEPROM_ADDR_SETTINGS, rec);
+    eeprom.end();
+
+    if (rec.magic != SETTINGS_MAGIC || rec.crc != crc32((const uint8_t *)&rec, offsetof(SettingsRecord, crc))) {
+        return;
+    }
+    for (uint8_t i = 0; i < setting_field_count; i++) {
+        uint16_t v = *field_ptr(&rec.values, i);
+        if (v < setting_fields[i].min || v > setting_fields[i].max) {
+            return;
+        }
+    }
+
+    values = rec.values;
+}
+
+int settings_find(const char * name) {
+    for (size_t i = 0; i < setting_field_count; i++) {
+        if (!strcasecmp(name, setting_fields[i].name)) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+uint16_t settings_get(uint8_t id) {
+    return *field_ptr(&values, id);
+}
+
+int settings_set(uint8_t id, uint32_t value) {
+    SettingsRecord rec;
+
+    if (id >= setting_field_count || value < setting_fields[id].min || value > setting_fields[id].max) {
+        return ERROR_SETTING_RANGE;
+    }
+    if (*field_ptr(&values, id) == value) {
+        return 0;
+    }
+
+    *field_ptr(&values, id) = (uint16_t)value;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = SETTINGS_MAGIC;
+    rec.values = values;
+    rec.crc = crc32((const uint8_t *)&rec, offsetof(SettingsRecord, crc));
+
+    eeprom.size(EEPROM_SECTORS);
+    eeprom.begin(EEPROM_SIZE);
+    eeprom.put(EEPROM_ADDR_SETTINGS, rec);
+    eeprom.commit();
+    eeprom.end();
+
+    if (changed) {
+        changed(id);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/** Non-Blocking TCP Client */
+
+// Take the TCP states from lwIP, as the core's own socket sources do
+#define LWIP_INTERNAL
+
+#include <ESP8266WiFi.h>
+
+extern "C" {
+#include "lwip/dns.h"
+#include "lwip/tcp.h"
+}
+#include <include/ClientContext.h>
+
+#include "tcp_client.h"
+
+// Connection Steps
+#define STEP_IDLE           0
+#define STEP_RESOLVING      1
+#define STEP_OPENING        2
+
+// The one DNS lookup in flight; its answer arrives from the lwIP context
+#define DNS_IDLE            0
+#define DNS_PENDING         1
+#define DNS_FOUND           2
+#define DNS_FAILED          3
+
+static volatile uint8_t dns_state;
+static ip_addr_t dns_addr;
+
+static void dns_found(const char *, const ip_addr_t * addr, void *) {
+    if (dns_state != DNS_PENDING) {
+        return;
+    }
+    if (addr) {
+        dns_addr = *addr;
+        dns_state = DNS_FOUND;
+    } else {
+        dns_state = DNS_FAILED;
+    }
+}
+
+// Send the SYN; the ClientContext handles the connection from here, as it
+// does for WiFiClient::connect(), but nothing waits for the handshake
+bool TcpClient::open(const IPAddress & ip) {
+    tcp_pcb * pcb = tcp_new();
+    if (!pcb) {
+        return false;
+    }
+
+    _client = new ClientContext(pcb, nullptr, nullptr);
+    _client->ref();
+    _client->setTimeout(_timeout);
+    if (tcp_connect(pcb, ip, _port, nullptr) != ERR_OK) {
+        _client->unref();
+        _client = nullptr;
+        return false;
+    }
+
+    _state = STEP_OPENING;
+    return true;
+}
+
+bool TcpClient::connectStart(const char * host, uint16_t port) {
+    if (_client) {
+        stop();
+        _client->unref();
+        _client = nullptr;
+    }
+    _state = STEP_IDLE;
+    _port = port;
+    _since = millis();
+
+    if (!WiFi.isConnected()) {
+        return false;
+    }
+
+    // Addresses and cached names are answered at once
+    ip_addr_t addr;
+    dns_state = DNS_PENDING;
+    err_t err = dns_gethostbyname(host, &addr, dns_found, nullptr);
+    if (err == ERR_OK) {
+        dns_state = DNS_IDLE;
+        return open(IPAddress(&addr));
+    }
+    if (err != ERR_INPROGRESS) {
+        dns_state = DNS_IDLE;
+        return false;
+    }
+
+    _state = STEP_RESOLVING;
+    return true;
+}
+
+int8_t TcpClient::connectPoll() {
+    switch (_state) {
+    case STEP_RESOLVING:
+        if (dns_state == DNS_PENDING) {
+            return TCP_CONNECT_PENDING;
+        }
+        _state = STEP_IDLE;
+        if (dns_state != DNS_FOUND || !open(IPAddress(&dns_addr))) {
+            dns_state = DNS_IDLE;
+            return -1;
+        }
+        dns_state = DNS_IDLE;
+        return TCP_CONNECT_PENDING;
+
+    case STEP_OPENING:
+        // A reset or an error clears the PCB, which reads as CLOSED
+        switch (status()) {
+        case ESTABLISHED:
+            _state = STEP_IDLE;
+            setSync(getDefaultSync());
+            setNoDelay(getDefaultNoDelay());
+            return 1;
+        case CLOSED:
+            _state = STEP_IDLE;
+            return -1;
+        default:
+            return TCP_CONNECT_PENDING;
+        }
+
+    default:
+        return connected() ? 1 : -1;
+    }
+}
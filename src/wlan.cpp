@@ -0,0 +1,79 @@
+/** WiFi Link Supervisor */
+
+#include <ESP8266WiFi.h>
+#include <string.h>
+
+#include "config.h"
+#include "wlan.h"
+
+// Link Supervisor State
+static WlanStatus wstatus;
+static bool ever_up;
+static uint32_t last_check;
+static uint32_t offline_ms;
+static uint32_t last_begin;
+
+const WlanStatus * wlan_status = &wstatus;
+
+// Start the WiFi Link
+int setup_wlan() {
+    memset(&wstatus, 0, sizeof(wstatus));
+    ever_up = false;
+    offline_ms = 0;
+    last_check = last_begin = millis();
+
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
+    WiFi.begin(wifi_ssid, wifi_passwd);
+
+    Serial.print("Connecting to ");
+    Serial.println(wifi_ssid);
+
+    // Sample timestamps come from SNTP
+    configTime(0, 0, NTP_SERVER);
+
+    return 0;
+}
+
+// Supervise the WiFi Link
+void check_wlan() {
+    uint32_t now = millis();
+    bool up = WiFi.status() == WL_CONNECTED;
+
+    // Charge the time since the last check while the link was down
+    if (!wstatus.up) {
+        offline_ms += now - last_check;
+        wstatus.offline_s = offline_ms / 1000;
+    }
+    last_check = now;
+
+    if (up && !wstatus.up) {
+        Serial.println("WiFi Connected");
+#ifdef DEBUG
+        Serial.print("IP: ");
+        Serial.println(WiFi.localIP());
+#endif
+
+        if (ever_up) {
+            wstatus.reconnects++;
+        }
+        ever_up = true;
+    } else if (!up && wstatus.up) {
+        Serial.println("WiFi Connection Lost");
+        last_begin = now;
+    }
+    wstatus.up = up;
+
+    // The SDK reassociates on its own, but give it a fresh start if that
+    // has not worked for a while
+    if (!up && now - last_begin >= WIFI_RETRY_INTERVAL * 1000UL) {
+        Serial.printf("Reconnecting to %s\n", wifi_ssid);
+        WiFi.begin(wifi_ssid, wifi_passwd);
+        last_begin = now;
+    }
+}
+
+// Check the WiFi Link
+bool connected_wlan() {
+    return wstatus.up && WiFi.status() == WL_CONNECTED;
+}